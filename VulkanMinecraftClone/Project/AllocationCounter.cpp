@@ -0,0 +1,64 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	std::atomic<uint64_t> g_AllocationCount{};
+	std::atomic<uint64_t> g_AllocatedBytes{};
+}
+
+#ifdef MEMORY_PROFILING
+namespace
+{
+	void* Allocate(size_t size)
+	{
+		g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+		g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+		// malloc(0) may return null, operator new may not
+		if (void* pMemory = std::malloc(size == 0 ? 1 : size))
+		{
+			return pMemory;
+		}
+		throw std::bad_alloc{};
+	}
+}
+
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void operator delete(void* pMemory) noexcept { std::free(pMemory); }
+void operator delete[](void* pMemory) noexcept { std::free(pMemory); }
+void operator delete(void* pMemory, size_t) noexcept { std::free(pMemory); }
+void operator delete[](void* pMemory, size_t) noexcept { std::free(pMemory); }
+#endif
+
+AllocationCounter::Snapshot AllocationCounter::GetSnapshot()
+{
+	return Snapshot{ g_AllocationCount.load(std::memory_order_relaxed), g_AllocatedBytes.load(std::memory_order_relaxed) };
+}
+
+uint64_t AllocationCounter::GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	// Kilobytes on Linux
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
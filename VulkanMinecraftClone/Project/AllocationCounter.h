@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+// Counts the heap allocations of the whole program, the global operator new is replaced in AllocationCounter.cpp.
+// Only in debug builds and with MEMORY_PROFILING, everywhere else the snapshot stays at zero.
+namespace AllocationCounter
+{
+	constexpr bool IsEnabled()
+	{
+#ifdef MEMORY_PROFILING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	struct Snapshot
+	{
+		uint64_t allocationCount;
+		uint64_t allocatedBytes;
+	};
+
+	Snapshot GetSnapshot();
+	// Highest resident memory of the process so far, 0 where the platform doesn't tell
+	uint64_t GetPeakResidentBytes();
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "GraphicsPipeline.h"
+#include "PipelineCache.h"
 #include <stdexcept>
 #include <vector>
 
@@ -104,7 +105,7 @@ public:
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS) {
+		if (vkCreateGraphicsPipelines(device, PipelineCache::GetInstance().GetHandle(), 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create graphics pipeline!");
 		}
 
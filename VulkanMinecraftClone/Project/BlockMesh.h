@@ -9,7 +9,12 @@ struct Vertex
 {
 	glm::vec3 position;
 	glm::vec3 normal;
-	glm::vec2 texCoord;
+	// Texture coordinates inside the tile and the layer of the tile in the block texture array
+	glm::vec3 texCoord;
+	// Brightness left after ambient occlusion, 1 is unoccluded
+	float ambientOcclusion{ 1.f };
+	// Sky and block light of the block in front of the face, 1 is fully lit
+	glm::vec2 light{ 1.f, 0.f };
 
 	static std::unique_ptr<VkVertexInputBindingDescription> getBindingDescription()
 	{
@@ -23,7 +28,7 @@ struct Vertex
 
 	static std::unique_ptr<VkVertexInputAttributeDescription[]> getAttributeDescriptions()
 	{
-		auto attributeDescriptions = std::make_unique<VkVertexInputAttributeDescription[]>(3);
+		auto attributeDescriptions = std::make_unique<VkVertexInputAttributeDescription[]>(5);
 
 		attributeDescriptions[0].binding = 0;
 		attributeDescriptions[0].location = 0;
@@ -37,13 +42,57 @@ struct Vertex
 
 		attributeDescriptions[2].binding = 0;
 		attributeDescriptions[2].location = 2;
-		attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
+		attributeDescriptions[2].format = VK_FORMAT_R32G32B32_SFLOAT;
 		attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
 
+		attributeDescriptions[3].binding = 0;
+		attributeDescriptions[3].location = 3;
+		attributeDescriptions[3].format = VK_FORMAT_R32_SFLOAT;
+		attributeDescriptions[3].offset = offsetof(Vertex, ambientOcclusion);
+
+		attributeDescriptions[4].binding = 0;
+		attributeDescriptions[4].location = 4;
+		attributeDescriptions[4].format = VK_FORMAT_R32G32_SFLOAT;
+		attributeDescriptions[4].offset = offsetof(Vertex, light);
+
 		return attributeDescriptions; // std::move() ?
 	}
 };
 
+// Compact vertex for the water surface
+// The position is stored in block corner coordinates: corner c of an axis lies at c - 0.5 in chunk space.
+// The data packs the face direction (bits 0-2) and the atlas tile column (bits 3-6) and row (bits 7-10),
+// so bits 3-10 are the texture array layer. The shader derives the normal and the texture coordinates from it.
+struct WaterVertex
+{
+	int16_t x;
+	int16_t y;
+	int16_t z;
+	uint16_t data;
+
+	static std::unique_ptr<VkVertexInputBindingDescription> getBindingDescription()
+	{
+		auto bindingDescription = std::make_unique<VkVertexInputBindingDescription>();
+		bindingDescription->binding = 0;
+		bindingDescription->stride = sizeof(WaterVertex);
+		bindingDescription->inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	static std::unique_ptr<VkVertexInputAttributeDescription[]> getAttributeDescriptions()
+	{
+		auto attributeDescriptions = std::make_unique<VkVertexInputAttributeDescription[]>(1);
+
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_SINT;
+		attributeDescriptions[0].offset = offsetof(WaterVertex, x);
+
+		return attributeDescriptions;
+	}
+};
+
 class CommandPool;
 
 //enum class Direction : unsigned short
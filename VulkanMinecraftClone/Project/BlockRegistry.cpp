@@ -0,0 +1,200 @@
+#include "BlockRegistry.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+// Json library used: https://github.com/nlohmann/json
+#include <vendor/json.hpp>
+
+namespace
+{
+    template <typename Enum, size_t Size>
+    bool FindByName(const std::array<const char*, Size>& names, const std::string& name, Enum& value)
+    {
+        for (size_t index = 0; index < names.size(); ++index)
+        {
+            if (name == names[index])
+            {
+                value = static_cast<Enum>(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr std::array<const char*, 4> g_TransparencyNames{ "opaque", "cutout", "translucent", "invisible" };
+    constexpr std::array<const char*, 3> g_RenderLayerNames{ "none", "land", "water" };
+}
+
+BlockRegistry::BlockRegistry()
+{
+    // Air is never part of the json file
+    const size_t air = static_cast<size_t>(BlockType::Air);
+    m_Transparencies[air] = TransparencyClass::Invisible;
+    m_RenderLayers[air] = RenderLayer::None;
+    UpdateMasks();
+}
+
+bool BlockRegistry::Load(const std::string& jsonFilePath)
+{
+    std::ifstream jsonFile(jsonFilePath);
+    if (!jsonFile.is_open())
+    {
+        std::cout << "ERROR: UNABLE TO OPEN BLOCK DATA FILE " << jsonFilePath << "!\n";
+        return false;
+    }
+
+    std::stringstream jsonText;
+    jsonText << jsonFile.rdbuf();
+    return LoadFromString(jsonText.str());
+}
+
+bool BlockRegistry::LoadFromString(const std::string& jsonText)
+{
+    const nlohmann::json jsonData = nlohmann::json::parse(jsonText, nullptr, false);
+    if (jsonData.is_discarded())
+    {
+        std::cout << "ERROR: BLOCK DATA IS NOT VALID JSON!\n";
+        return false;
+    }
+
+    if (!jsonData.is_object() || !jsonData.contains("blocks") || !jsonData["blocks"].is_array())
+    {
+        std::cout << "ERROR: BLOCK DATA HAS NO \"blocks\" ARRAY!\n";
+        return false;
+    }
+
+    // Fill a copy so a bad file doesn't leave half of the properties behind
+    BlockRegistry registry{};
+    std::array<bool, m_BlockTypeCount> isDefined{};
+    bool isValid = true;
+    const auto reportError = [&isValid](const std::string& block, const std::string& message)
+        {
+            std::cout << "ERROR: BLOCK \"" << block << "\": " << message << '\n';
+            isValid = false;
+        };
+
+    for (const nlohmann::json& block : jsonData["blocks"])
+    {
+        if (!block.is_object() || !block.contains("id") || !block["id"].is_string())
+        {
+            reportError("?", "missing \"id\"");
+            continue;
+        }
+
+        const std::string id = block["id"].get<std::string>();
+        BlockType blockType;
+        if (!FindByName(m_BlockIds, id, blockType) || blockType == BlockType::Air)
+        {
+            reportError(id, "unknown id");
+            continue;
+        }
+
+        const size_t index = static_cast<size_t>(blockType);
+        if (isDefined[index])
+        {
+            reportError(id, "defined twice");
+            continue;
+        }
+        isDefined[index] = true;
+
+        TransparencyClass transparency = TransparencyClass::Opaque;
+        if (block.contains("transparency") &&
+            (!block["transparency"].is_string() || !FindByName(g_TransparencyNames, block["transparency"].get<std::string>(), transparency)))
+        {
+            reportError(id, "unknown \"transparency\"");
+        }
+
+        RenderLayer renderLayer = RenderLayer::Land;
+        if (block.contains("layer") &&
+            (!block["layer"].is_string() || !FindByName(g_RenderLayerNames, block["layer"].get<std::string>(), renderLayer)))
+        {
+            reportError(id, "unknown \"layer\"");
+        }
+
+        int emissiveLevel = 0;
+        if (block.contains("emissive"))
+        {
+            if (block["emissive"].is_number_integer())
+            {
+                emissiveLevel = block["emissive"].get<int>();
+            }
+            if (!block["emissive"].is_number_integer() || emissiveLevel < 0 || emissiveLevel > m_MaxEmissiveLevel)
+            {
+                reportError(id, "\"emissive\" must be between 0 and " + std::to_string(m_MaxEmissiveLevel));
+                emissiveLevel = 0;
+            }
+        }
+
+        registry.m_Transparencies[index] = transparency;
+        registry.m_RenderLayers[index] = renderLayer;
+        registry.m_EmissiveLevels[index] = static_cast<uint8_t>(emissiveLevel);
+
+        if (!block.contains("textures") || !block["textures"].is_object())
+        {
+            reportError(id, "missing \"textures\"");
+            continue;
+        }
+
+        const nlohmann::json& textures = block["textures"];
+        for (size_t face = 0; face < m_FaceCount; ++face)
+        {
+            const char* faceName = m_FaceNames[face];
+            if (!textures.contains(faceName))
+            {
+                reportError(id, std::string("missing texture for face \"") + faceName + "\"");
+                continue;
+            }
+
+            const nlohmann::json& texture = textures[faceName];
+            const bool hasTile = texture.is_object() &&
+                texture.contains("row") && texture["row"].is_number_integer() &&
+                texture.contains("col") && texture["col"].is_number_integer();
+            const int row = hasTile ? texture["row"].get<int>() : -1;
+            const int column = hasTile ? texture["col"].get<int>() : -1;
+            if (row < 0 || row >= m_AtlasSize || column < 0 || column >= m_AtlasSize)
+            {
+                reportError(id, std::string("texture of face \"") + faceName + "\" needs a \"row\" and \"col\" inside the atlas");
+                continue;
+            }
+
+            registry.m_FaceTextures[index * m_FaceCount + face] = { static_cast<unsigned short>(row), static_cast<unsigned short>(column) };
+        }
+    }
+
+    for (size_t index = 0; index < static_cast<size_t>(BlockType::Air); ++index)
+    {
+        if (!isDefined[index])
+        {
+            reportError(m_BlockIds[index], "not defined");
+        }
+    }
+
+    if (!isValid)
+    {
+        return false;
+    }
+
+    registry.UpdateMasks();
+    *this = registry;
+    return true;
+}
+
+void BlockRegistry::UpdateMasks()
+{
+    m_OpaqueMask = 0;
+    m_CullSameTypeMask = 0;
+    m_LayerMasks.fill(0);
+    for (size_t index = 0; index < m_BlockTypeCount; ++index)
+    {
+        const uint32_t bit = 1u << index;
+        if (m_Transparencies[index] == TransparencyClass::Opaque)
+        {
+            m_OpaqueMask |= bit;
+        }
+        if (m_Transparencies[index] != TransparencyClass::Cutout)
+        {
+            m_CullSameTypeMask |= bit;
+        }
+        m_LayerMasks[static_cast<size_t>(m_RenderLayers[index])] |= bit;
+    }
+}
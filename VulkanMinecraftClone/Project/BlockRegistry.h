@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include "MemoryTracker.h"
+
+// IMPORTANT:
+// THE BLOCK IDS IN BlockRegistry::m_BlockIds MUST FOLLOW THIS ORDER!!!
+enum class BlockType : unsigned char
+{
+    GrassBlock,
+    Stone,
+    Dirt,
+    Sand,
+    Log,
+    Leaves,
+    Water,
+    Air
+};
+
+// The blocks of a chunk, counted as voxel memory
+using BlockStorage = TaggedVector<BlockType, MemoryTag::Voxels>;
+
+// Sorted alphabetically, the face tables and the shaders depend on this order
+enum class Direction : unsigned char
+{
+    Down,
+    East,
+    North,
+    South,
+    Up,
+    West
+};
+
+struct TextureCoords
+{
+    unsigned short row;
+    unsigned short column;
+};
+
+enum class TransparencyClass : unsigned char
+{
+    Opaque,      // Hides the faces of its neighbors
+    Cutout,      // See through, faces between two blocks of this type are kept
+    Translucent, // See through, faces between two blocks of this type are removed
+    Invisible    // Never meshed
+};
+
+enum class RenderLayer : unsigned char
+{
+    None,
+    Land,
+    Water
+};
+
+// Dense table of the block properties, every array is indexed with the BlockType.
+// Filled from textures/blockdata.json, where blocks and faces are looked up by name so the order in the file doesn't matter.
+class BlockRegistry final
+{
+public:
+    static constexpr size_t m_BlockTypeCount = static_cast<size_t>(BlockType::Air) + 1;
+    static constexpr size_t m_FaceCount = 6;
+    static constexpr int m_AtlasSize = 16;
+    static constexpr int m_MaxEmissiveLevel = 15;
+
+    static constexpr std::array<const char*, m_BlockTypeCount> m_BlockIds{ "grass", "stone", "dirt", "sand", "log", "leaves", "water", "air" };
+    static constexpr std::array<const char*, m_FaceCount> m_FaceNames{ "down", "east", "north", "south", "up", "west" };
+
+public:
+    static BlockRegistry& GetInstance()
+    {
+        static BlockRegistry instance;
+        return instance;
+    }
+
+    // Both return false and keep the current properties when the data is invalid, every problem is written to std::cout
+    bool Load(const std::string& jsonFilePath);
+    bool LoadFromString(const std::string& jsonText);
+
+    bool IsOpaque(BlockType blockType) const { return (m_OpaqueMask >> static_cast<uint32_t>(blockType)) & 1; }
+    // Whether the faces between two blocks of this type are removed
+    bool CullsSameType(BlockType blockType) const { return (m_CullSameTypeMask >> static_cast<uint32_t>(blockType)) & 1; }
+
+    // One bit per block type, for meshers that test several types at once
+    uint32_t GetOpaqueMask() const { return m_OpaqueMask; }
+    uint32_t GetCullSameTypeMask() const { return m_CullSameTypeMask; }
+    uint32_t GetLayerMask(RenderLayer renderLayer) const { return m_LayerMasks[static_cast<size_t>(renderLayer)]; }
+
+    TransparencyClass GetTransparency(BlockType blockType) const { return m_Transparencies[static_cast<size_t>(blockType)]; }
+    RenderLayer GetRenderLayer(BlockType blockType) const { return m_RenderLayers[static_cast<size_t>(blockType)]; }
+    uint8_t GetEmissiveLevel(BlockType blockType) const { return m_EmissiveLevels[static_cast<size_t>(blockType)]; }
+
+    const TextureCoords& GetFaceTexture(BlockType blockType, Direction direction) const
+    {
+        return m_FaceTextures[static_cast<size_t>(blockType) * m_FaceCount + static_cast<size_t>(direction)];
+    }
+
+    // Layer of the face inside the block texture array, the atlas tiles are numbered row by row
+    uint32_t GetFaceLayer(BlockType blockType, Direction direction) const
+    {
+        const TextureCoords& textureCoords = GetFaceTexture(blockType, direction);
+        return static_cast<uint32_t>(textureCoords.row) * m_AtlasSize + textureCoords.column;
+    }
+
+private:
+    BlockRegistry();
+
+    std::array<TransparencyClass, m_BlockTypeCount> m_Transparencies{};
+    std::array<RenderLayer, m_BlockTypeCount> m_RenderLayers{};
+    std::array<uint8_t, m_BlockTypeCount> m_EmissiveLevels{};
+    std::array<TextureCoords, m_BlockTypeCount * m_FaceCount> m_FaceTextures{};
+
+    // Derived from the arrays above
+    uint32_t m_OpaqueMask{};
+    uint32_t m_CullSameTypeMask{};
+    std::array<uint32_t, 3> m_LayerMasks{};
+
+    void UpdateMasks();
+};
@@ -13,6 +13,8 @@ const float SENSITIVITY = 0.1f;
 const float ZOOM = 45.0f;
 const float MAX_MOVE_SPEED = 150.f;
 const float MIN_MOVE_SPEED = 1.f;
+const float NEAR_PLANE = 0.1f;
+const float FAR_PLANE = 2000.f;
 
 // An abstract camera class that processes input and calculates the corresponding Euler Angles, Vectors and Matrices
 class Camera final
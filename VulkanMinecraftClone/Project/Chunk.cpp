@@ -2,8 +2,32 @@
 #include <ChunkGenerator.h>
 #include <algorithm>
 #include "GraphicsPipeline3D.h"
+#include "FaceTable.h"
+#include "FaceVisibility.h"
+#include "GpuCuller.h"
+#include "LandMesher.h"
+#include "TerrainColumn.h"
 #include <random>
 
+namespace
+{
+    // Storage every mesh build reuses, one per thread so the vertices never grow in the middle of a mesh
+    // once a thread has meshed a few chunks. The result is copied into the chunk with a single allocation at most.
+    struct MeshScratch
+    {
+        FaceVisibility faceVisibility{ Chunk::m_Height, Chunk::m_Depth };
+        TaggedVector<Vertex, MemoryTag::Transient> landVertices;
+        TaggedVector<WaterVertex, MemoryTag::Transient> waterVertices;
+        TaggedVector<bool, MemoryTag::Transient> isWaterSurface;
+    };
+
+    MeshScratch& GetMeshScratch()
+    {
+        thread_local MeshScratch meshScratch;
+        return meshScratch;
+    }
+}
+
 const int TREE_HEIGHT = 5;
 const int TREE_TRUNK_HEIGHT = 4;
 const int TREE_LEAF_WIDTH = 5;
@@ -48,137 +72,125 @@ struct Tree
 
 Chunk::Chunk(const glm::ivec3& position, SimplexNoise* noise, VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
     :
-    m_Position{ position },
     m_pNoise{ noise }
 {
-    m_Blocks.resize(m_Width * m_Height * m_Depth, BlockType::Air);
+    Load(position, device, physicalDevice, commandPool);
+}
+
+void Chunk::Load(const glm::ivec3& position, VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
+{
+    m_Position = position;
+    m_VisibleSections.fill(true);
     // Move to chunkgenerator
     GenerateMesh();
 
     m_Device = device;
-    // Create Vulkan buffers
+    // Create Vulkan buffers, only vertices since the indices come from the shared QuadIndexBuffer
     //CreateVertexBuffer(device, physicalDevice, commandPool);
     //CreateIndexBuffer(device, physicalDevice, commandPool);
-    CreateLandVertexBuffer(device, physicalDevice, commandPool);
-    CreateLandIndexBuffer(device, physicalDevice, commandPool);
+    // The land waits for MeshLand, its light depends on the neighbors
     if (!m_VerticesWater.empty())
     {
+        ScopedTimer timer{ "chunk upload" };
         CreateWaterVertexBuffer(device, physicalDevice, commandPool);
-        CreateWaterIndexBuffer(device, physicalDevice, commandPool);
     }
 }
 
-void Chunk::GenerateMesh()
+void Chunk::MeshLand(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
 {
-    // Generate mesh data for the chunk
-    m_VerticesLand.clear();
-    m_IndicesLand.clear();
-    m_VerticesWater.clear();
-    m_IndicesWater.clear();
+    GenerateLandMesh();
+    {
+        ScopedTimer timer{ "chunk upload" };
+        CreateLandVertexBuffer(device, physicalDevice, commandPool);
+    }
+    Profiler::GetInstance().AddCount("chunks uploaded", 1);
+}
 
-    GenerateTerrain();
+void Chunk::EditBlock(const glm::ivec3& position, BlockType blockType, VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
+{
+    m_Blocks.Set(position.x, position.y, position.z, blockType);
+    CalculateSolidHeights();
+    CalculateSectionConnectivity();
 
-    // Create the optimized mesh
-    for (int x = 0; x < m_Width; ++x)
+    // Water can't be edited, but the water faces next to the block can appear or disappear
+    if (m_VerticesWater.empty())
     {
-        for (int y = 0; y < m_Height; ++y)
-        {
-            for (int z = 0; z < m_Depth; ++z)
-            {
-                BlockType blockType = GetBlock({ x, y, z });
+        return;
+    }
+    DeletionQueue::GetInstance().DestroyBuffer(m_VertexBufferWater, m_VertexBufferMemoryWater);
+    GenerateWaterMesh();
+    if (!m_VerticesWater.empty())
+    {
+        CreateWaterVertexBuffer(device, physicalDevice, commandPool);
+    }
+}
 
-                // Skip air blocks
-                if (blockType == BlockType::Air)
-                {
-                    continue;
-                }
+void Chunk::Reset()
+{
+    // The blocks are all written again when the chunk is generated
+    m_Light.Fill(LightData::m_MaxLevel, 0);
+    m_VerticesLand.clear();
+    m_VerticesWater.clear();
+    m_SectionsLand = {};
+    m_SolidHeights = {};
+    m_SectionConnectivity = {};
+    m_WaterDetailQuadCount = 0;
+    m_WaterLodFirstQuad = 0;
+    m_CullSlot = UINT32_MAX;
+
+    m_VertexBufferLand = VK_NULL_HANDLE;
+    m_VertexBufferMemoryLand = VK_NULL_HANDLE;
+    m_VertexBufferWater = VK_NULL_HANDLE;
+    m_VertexBufferMemoryWater = VK_NULL_HANDLE;
+
+    m_IsMarkedForDeletion = false;
+    m_IsDeleted = false;
+    m_DeletionTimer = 0.f;
+}
 
-                // Add faces for opaque blocks
-                for (const auto& [direction, offset] : ChunkGenerator::GetInstance().GetFaceOffsets())
-                {
-                    int nx = x + offset.x;
-                    int ny = y + offset.y;
-                    int nz = z + offset.z;
+void Chunk::GenerateMesh()
+{
+    // Generate mesh data for the chunk
+    m_VerticesWater.clear();
 
-                    if (blockType != BlockType::Leaves)
-                    {
-                        // Check if the neighboring block is the same type
-                        if (IsSameBlockType(blockType, nx, ny, nz))
-                        {
-                            // Skip adding faces if the neighboring block is the same type
-                            continue;
-                        }
-                    }
+    GenerateTerrain();
+    CalculateSolidHeights();
+    CalculateSectionConnectivity();
 
-                    if (!IsOpaqueBlock(nx, ny, nz))
-                    {
-                        if (blockType == BlockType::Water)
-                        {
-                            AddFaceVertices(m_VerticesWater, m_IndicesWater, blockType, direction, glm::vec3(x, y, z));
-                        }
-                        else
-                        {
-                            AddFaceVertices(m_VerticesLand, m_IndicesLand, blockType, direction, glm::vec3(x, y, z));
-                        }
-                    }
-                }
-            }
-        }
-    }
+    GenerateWaterMesh();
 
     // Update Vulkan buffers
     UpdateVertexBuffer();
     UpdateIndexBuffer();
 }
 
-void Chunk::GenerateTerrain()
+void Chunk::GenerateLandMesh()
 {
-    for (int x = 0; x < m_Width; ++x)
-    {
-        for (int z = 0; z < m_Depth; ++z)
-        {
-            glm::ivec3 globalPosition = m_Position + glm::ivec3(x, 0, z);
-            int height = ChunkGenerator::GetInstance().GetHeight(globalPosition);
+    MeshScratch& meshScratch = GetMeshScratch();
+    TaggedVector<Vertex, MemoryTag::Transient>& vertices = meshScratch.landVertices;
 
-            // Fill with water up to sea level
-            for (int y = 0; y < m_Height * m_SeaLevel; ++y)
-            {
-                SetBlock(glm::ivec3(x, y, z), BlockType::Water);
-            }
-
-            // Make the base of the mountains sand inside the water
-            if (height <= m_Height * m_SeaLevel + 3)
-            {
-                // Fill up to the height with sand
-                for (int y = 0; y <= height; ++y)
-                {
-                    SetBlock(glm::ivec3(x, y, z), BlockType::Sand);
-                }
-            }
+    static_assert(m_Width == LightEngine::m_Width && m_Height == LightEngine::m_Height && m_Depth == LightEngine::m_Depth, "the light engine has the chunk size");
+    const bool isAmbientOcclusionEnabled = ChunkGenerator::GetInstance().IsAmbientOcclusionEnabled();
+    LandMesher::Build(m_Blocks, meshScratch.faceVisibility, isAmbientOcclusionEnabled,
+        [this](int x, int y, int z) { return GetLight(x, y, z); }, vertices, m_SectionsLand);
 
-            if (height > m_Height * m_SeaLevel + 3)
-            {
-                // Calculate the number of layers of dirt
-                int dirtLayers = (((height - (m_Height * m_SeaLevel + 1)) < (3)) ? (height - (m_Height * m_SeaLevel + 1)) : (3));
-
-                // Grass layer
-                SetBlock(glm::ivec3(x, height, z), BlockType::GrassBlock);
-
-                // Dirt layers
-                for (int y = height - 1; y > height - dirtLayers - 1; --y)
-                {
-                    SetBlock(glm::ivec3(x, y, z), BlockType::Dirt);
-                }
+    m_VerticesLand.assign(vertices.begin(), vertices.end());
+}
 
-                // Stone below dirt layers
-                for (int y = height - dirtLayers - 1; y >= 0; --y)
-                {
-                    SetBlock(glm::ivec3(x, y, z), BlockType::Stone);
-                }
-            }
+void Chunk::GenerateTerrain()
+{
+    std::array<int, m_Width * m_Depth> heights{};
+    for (int z = 0; z < m_Depth; ++z)
+    {
+        for (int x = 0; x < m_Width; ++x)
+        {
+            heights[x + z * m_Width] = ChunkGenerator::GetInstance().GetHeight(m_Position + glm::ivec3(x, 0, z));
         }
     }
 
+    // Writes every block of the chunk once, a pooled chunk still holds the blocks of the chunk it was before
+    WriteTerrainColumns(m_Blocks, heights.data(), m_SeaLevel);
+
     // Tree generation
     std::random_device rd;
     std::mt19937 gen(rd());
@@ -189,9 +201,7 @@ void Chunk::GenerateTerrain()
     {
         for (int z = 0; z < m_Depth; ++z)
         {
-            glm::ivec3 globalPosition = m_Position + glm::ivec3(x, 0, z);
-            int height = ChunkGenerator::GetInstance().GetHeight(globalPosition);
-            glm::ivec3 grassBlockPosition = glm::ivec3(x, height, z);
+            glm::ivec3 grassBlockPosition = glm::ivec3(x, heights[x + z * m_Width], z);
 
             if (GetBlock(grassBlockPosition) == BlockType::GrassBlock)
             {
@@ -259,6 +269,193 @@ void Chunk::GenerateTerrain()
     }
 }
 
+void Chunk::CalculateSolidHeights()
+{
+    // A section column is solid up to the lowest non opaque block of all the columns of blocks inside it,
+    // which makes it a safe occluder for everything behind it
+    for (int sectionZ = 0; sectionZ < m_SectionsZ; ++sectionZ)
+    {
+        for (int sectionX = 0; sectionX < m_SectionsX; ++sectionX)
+        {
+            int solidHeight = m_Height;
+            for (int x = sectionX * m_SectionSize; x < (sectionX + 1) * m_SectionSize; ++x)
+            {
+                for (int z = sectionZ * m_SectionSize; z < (sectionZ + 1) * m_SectionSize; ++z)
+                {
+                    int y = 0;
+                    while (y < solidHeight && IsOpaqueBlock(x, y, z))
+                    {
+                        ++y;
+                    }
+                    solidHeight = y;
+                }
+            }
+            m_SolidHeights[sectionX + sectionZ * m_SectionsX] = solidHeight;
+        }
+    }
+}
+
+void Chunk::CalculateSectionConnectivity()
+{
+    SectionConnectivity::OpacityGrid isOpaque;
+    for (int sectionZ = 0; sectionZ < m_SectionsZ; ++sectionZ)
+    {
+        for (int sectionY = 0; sectionY < m_SectionsY; ++sectionY)
+        {
+            for (int sectionX = 0; sectionX < m_SectionsX; ++sectionX)
+            {
+                for (int z = 0; z < m_SectionSize; ++z)
+                {
+                    for (int y = 0; y < m_SectionSize; ++y)
+                    {
+                        for (int x = 0; x < m_SectionSize; ++x)
+                        {
+                            isOpaque[x + y * m_SectionSize + z * m_SectionSize * m_SectionSize] = IsOpaqueBlock(
+                                sectionX * m_SectionSize + x,
+                                sectionY * m_SectionSize + y,
+                                sectionZ * m_SectionSize + z);
+                        }
+                    }
+                }
+
+                m_SectionConnectivity[GetSectionIndex(sectionX, sectionY, sectionZ)] = SectionConnectivity::Calculate(isOpaque);
+            }
+        }
+    }
+}
+
+void Chunk::GenerateWaterMesh()
+{
+    MeshScratch& meshScratch = GetMeshScratch();
+    TaggedVector<WaterVertex, MemoryTag::Transient>& vertices = meshScratch.waterVertices;
+    vertices.clear();
+    const auto getQuadCount = [&vertices]() { return static_cast<uint32_t>(vertices.size() / QuadIndexBuffer::m_VerticesPerQuad); };
+
+    // Surface faces, one per block so the waves keep their resolution close by
+    TaggedVector<bool, MemoryTag::Transient>& isSurface = meshScratch.isWaterSurface;
+    isSurface.assign(m_Width * m_Height * m_Depth, false);
+    for (int z = 0; z < m_Depth; ++z)
+    {
+        for (int y = 0; y < m_Height; ++y)
+        {
+            for (int x = 0; x < m_Width; ++x)
+            {
+                if (GetBlock({ x, y, z }) == BlockType::Water && IsWaterFaceVisible(x, y + 1, z))
+                {
+                    isSurface[GetIndex(x, y, z)] = true;
+                    AddWaterFace(vertices, Direction::Up, { x, y, z }, { 1, 1, 1 });
+                }
+            }
+        }
+    }
+    m_WaterDetailQuadCount = getQuadCount();
+
+    // Side and bottom faces, only where the water borders a see through block inside the chunk
+    for (int z = 0; z < m_Depth; ++z)
+    {
+        for (int y = 0; y < m_Height; ++y)
+        {
+            for (int x = 0; x < m_Width; ++x)
+            {
+                if (GetBlock({ x, y, z }) != BlockType::Water)
+                {
+                    continue;
+                }
+
+                for (const auto& [direction, offset] : ChunkGenerator::GetInstance().GetFaceOffsets())
+                {
+                    if (direction != Direction::Up && IsWaterFaceVisible(x + offset.x, y + offset.y, z + offset.z))
+                    {
+                        AddWaterFace(vertices, direction, { x, y, z }, { 1, 1, 1 });
+                    }
+                }
+            }
+        }
+    }
+    m_WaterLodFirstQuad = getQuadCount();
+
+    // Surface faces merged greedily into rectangles per layer, an open ocean chunk becomes a single quad
+    for (int y = 0; y < m_Height; ++y)
+    {
+        for (int z = 0; z < m_Depth; ++z)
+        {
+            for (int x = 0; x < m_Width; ++x)
+            {
+                if (!isSurface[GetIndex(x, y, z)])
+                {
+                    continue;
+                }
+
+                // Grow along x, then along z as long as the whole row is surface
+                int width = 1;
+                while (x + width < m_Width && isSurface[GetIndex(x + width, y, z)])
+                {
+                    ++width;
+                }
+
+                int depth = 1;
+                while (z + depth < m_Depth && IsWaterSurfaceRow(isSurface, x, y, z + depth, width))
+                {
+                    ++depth;
+                }
+
+                for (int dz = 0; dz < depth; ++dz)
+                {
+                    for (int dx = 0; dx < width; ++dx)
+                    {
+                        isSurface[GetIndex(x + dx, y, z + dz)] = false;
+                    }
+                }
+
+                AddWaterFace(vertices, Direction::Up, { x, y, z }, { width, 1, depth });
+            }
+        }
+    }
+
+    m_VerticesWater.assign(vertices.begin(), vertices.end());
+}
+
+bool Chunk::IsWaterSurfaceRow(const TaggedVector<bool, MemoryTag::Transient>& isSurface, int x, int y, int z, int width) const
+{
+    for (int dx = 0; dx < width; ++dx)
+    {
+        if (!isSurface[GetIndex(x + dx, y, z)])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Chunk::AddWaterFace(TaggedVector<WaterVertex, MemoryTag::Transient>& vertices, Direction direction, const glm::ivec3& block, const glm::ivec3& size)
+{
+    // Corners of a single block face in corner coordinates, in the same winding as the land faces
+    static const std::unordered_map<Direction, std::array<glm::ivec3, 4>> faceCorners{
+        { Direction::Up, { glm::ivec3{ 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 0 } } },
+        { Direction::Down, { glm::ivec3{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 1 }, { 0, 0, 1 } } },
+        { Direction::North, { glm::ivec3{ 0, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 } } },
+        { Direction::South, { glm::ivec3{ 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }, { 0, 0, 1 } } },
+        { Direction::East, { glm::ivec3{ 1, 0, 1 }, { 1, 0, 0 }, { 1, 1, 0 }, { 1, 1, 1 } } },
+        { Direction::West, { glm::ivec3{ 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 }, { 0, 1, 0 } } }
+    };
+
+    const TextureCoords& textureCoords = BlockRegistry::GetInstance().GetFaceTexture(BlockType::Water, direction);
+    const uint16_t data = static_cast<uint16_t>(
+        static_cast<uint16_t>(direction) |
+        (textureCoords.column << 3) |
+        (textureCoords.row << 7));
+
+    for (const glm::ivec3& corner : faceCorners.at(direction))
+    {
+        const glm::ivec3 position = block + corner * size;
+        vertices.emplace_back(WaterVertex{
+            static_cast<int16_t>(position.x),
+            static_cast<int16_t>(position.y),
+            static_cast<int16_t>(position.z),
+            data });
+    }
+}
+
 bool Chunk::IsWithinBounds(const glm::ivec3& position) const
 {
     return position.x >= 0 && position.x < m_Width &&
@@ -266,15 +463,22 @@ bool Chunk::IsWithinBounds(const glm::ivec3& position) const
         position.z >= 0 && position.z < m_Depth;
 }
 
-void Chunk::RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+void Chunk::RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const QuadIndexBuffer& quadIndexBuffer)
 {
     // Bind vertex buffer
-    VkBuffer vertexBuffers[] = { m_VertexBufferLand };
+    VkBuffer vertexBuffers[] = { m_HasGpuMesh ? m_GpuMesh.vertexBuffer : m_VertexBufferLand };
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
-    // Bind index buffer
-    vkCmdBindIndexBuffer(commandBuffer, m_IndexBufferLand, 0, VK_INDEX_TYPE_UINT32);
+    // Bind index buffer, the gpu mesh writes its own indices
+    if (m_HasGpuMesh)
+    {
+        vkCmdBindIndexBuffer(commandBuffer, m_GpuMesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+    }
+    else
+    {
+        quadIndexBuffer.Bind(commandBuffer);
+    }
 
     // Update push constants
     PushConstants pushConstants{};
@@ -290,11 +494,191 @@ void Chunk::RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineL
         &pushConstants
     );
 
-    // Submit rendering commands
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_IndicesLand.size()), 1, 0, 0, 0);
+    // The gpu mesh isn't split in sections, the face count never leaves the gpu
+    if (m_HasGpuMesh)
+    {
+        vkCmdDrawIndexedIndirect(commandBuffer, m_GpuMesh.drawCommandBuffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+        return;
+    }
+
+    // Submit rendering commands for the visible sections
+    // Sections that follow each other in the vertex buffer are merged into a single draw
+    uint32_t firstQuad = 0;
+    uint32_t quadCount = 0;
+    for (int section = 0; section < m_SectionCount; ++section)
+    {
+        const SectionRange& sectionRange = m_SectionsLand[section];
+        if (!m_VisibleSections[section] || sectionRange.quadCount == 0)
+        {
+            continue;
+        }
+
+        if (quadCount > 0 && firstQuad + quadCount == sectionRange.firstQuad)
+        {
+            quadCount += sectionRange.quadCount;
+            continue;
+        }
+
+        if (quadCount > 0)
+        {
+            quadIndexBuffer.DrawQuads(commandBuffer, firstQuad, quadCount);
+        }
+        firstQuad = sectionRange.firstQuad;
+        quadCount = sectionRange.quadCount;
+    }
+
+    if (quadCount > 0)
+    {
+        quadIndexBuffer.DrawQuads(commandBuffer, firstQuad, quadCount);
+    }
+}
+
+void Chunk::RenderLandCulled(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const QuadIndexBuffer& quadIndexBuffer, const GpuCuller& gpuCuller)
+{
+    VkBuffer vertexBuffers[] = { m_VertexBufferLand };
+    VkDeviceSize offsets[] = { 0 };
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    quadIndexBuffer.Bind(commandBuffer);
+
+    PushConstants pushConstants{};
+    pushConstants.translation = m_Position;
+    pushConstants.time = Timer::GetInstance().GetElapsed();
+    vkCmdPushConstants(
+        commandBuffer,
+        pipelineLayout,
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(PushConstants),
+        &pushConstants
+    );
+
+    gpuCuller.DrawChunk(commandBuffer, m_CullSlot);
+}
+
+void Chunk::CreateFaceMesh(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, PipelineLayout3D& pipelineLayout)
+{
+    DestroyFaceMesh(device, &pipelineLayout);
+
+    CreateFaceBuffer(device, physicalDevice, commandPool);
+    m_FaceMesh.descriptorSet = pipelineLayout.AllocateFaceDescriptorSet(device, m_FaceMesh.faceBuffer);
+    m_HasFaceMesh = true;
+}
+
+void Chunk::DestroyFaceMesh(VkDevice device, PipelineLayout3D* pPipelineLayout)
+{
+    if (!m_HasFaceMesh)
+    {
+        return;
+    }
+
+    if (pPipelineLayout != nullptr)
+    {
+        const VkDescriptorSet descriptorSet = m_FaceMesh.descriptorSet;
+        DeletionQueue::GetInstance().Enqueue([device, pPipelineLayout, descriptorSet]() { pPipelineLayout->FreeFaceDescriptorSet(device, descriptorSet); });
+    }
+    DeletionQueue::GetInstance().DestroyBuffer(m_FaceMesh.faceBuffer, m_FaceMesh.faceBufferMemory);
+    m_FaceMesh = {};
+    m_FaceRecords.clear();
+    m_FaceRecords.shrink_to_fit();
+    m_HasFaceMesh = false;
+}
+
+void Chunk::CreateFaceBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
+{
+    static_assert(m_Width == FaceRecordBuilder::m_RowLength && m_Height <= FaceRecordBuilder::m_MaxHeight && m_Depth <= FaceRecordBuilder::m_MaxDepth,
+        "every block position of the chunk has to fit in a face record");
+    FaceRecordBuilder::Build(m_Blocks, m_Height, m_Depth, m_SectionSize, m_FaceRecords, m_SectionsFaces);
+
+    // The last frame may still be drawing the old records
+    DeletionQueue::GetInstance().DestroyBuffer(m_FaceMesh.faceBuffer, m_FaceMesh.faceBufferMemory);
+    m_FaceMesh.faceCount = static_cast<uint32_t>(m_FaceRecords.size());
+
+    // A buffer can't be empty, a chunk without land faces still gets one record that is never drawn
+    const VkDeviceSize bufferSize = sizeof(FaceRecord) * std::max<size_t>(m_FaceRecords.size(), 1);
+
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    CreateBuffer(
+        device,
+        physicalDevice,
+        bufferSize,
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
+
+    void* data;
+    vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
+    memcpy(data, m_FaceRecords.data(), sizeof(FaceRecord) * m_FaceRecords.size());
+    vkUnmapMemory(device, stagingBufferMemory);
+
+    CreateBuffer(
+        device,
+        physicalDevice,
+        bufferSize,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        m_FaceMesh.faceBuffer, m_FaceMesh.faceBufferMemory, MemoryTag::Meshes);
+
+    CopyBuffer(device, commandPool, stagingBuffer, m_FaceMesh.faceBuffer, bufferSize);
+
+    vkDestroyBuffer(device, stagingBuffer, nullptr);
+    FreeMemory(device, stagingBufferMemory);
+}
+
+void Chunk::RenderFaces(VkCommandBuffer commandBuffer, const PipelineLayout3D& pipelineLayout)
+{
+    if (!m_HasFaceMesh || m_FaceMesh.faceCount == 0)
+    {
+        return;
+    }
+
+    pipelineLayout.BindFaceDescriptorSet(commandBuffer, m_FaceMesh.descriptorSet);
+
+    PushConstants pushConstants{};
+    pushConstants.translation = m_Position;
+    pushConstants.time = Timer::GetInstance().GetElapsed();
+    vkCmdPushConstants(
+        commandBuffer,
+        pipelineLayout.GetHandle(),
+        VK_SHADER_STAGE_VERTEX_BIT,
+        0,
+        sizeof(PushConstants),
+        &pushConstants
+    );
+
+    // Same merging of the visible sections as the indexed land, every face is six vertices without an index buffer
+    constexpr uint32_t verticesPerFace = FaceRecordBuilder::m_VerticesPerFace;
+    uint32_t firstFace = 0;
+    uint32_t faceCount = 0;
+    for (int section = 0; section < m_SectionCount; ++section)
+    {
+        const FaceRecordBuilder::SectionRange& sectionRange = m_SectionsFaces[section];
+        if (!m_VisibleSections[section] || sectionRange.faceCount == 0)
+        {
+            continue;
+        }
+
+        if (faceCount > 0 && firstFace + faceCount == sectionRange.firstFace)
+        {
+            faceCount += sectionRange.faceCount;
+            continue;
+        }
+
+        if (faceCount > 0)
+        {
+            vkCmdDraw(commandBuffer, faceCount * verticesPerFace, 1, firstFace * verticesPerFace, 0);
+        }
+        firstFace = sectionRange.firstFace;
+        faceCount = sectionRange.faceCount;
+    }
+
+    if (faceCount > 0)
+    {
+        vkCmdDraw(commandBuffer, faceCount * verticesPerFace, 1, firstFace * verticesPerFace, 0);
+    }
 }
 
-void Chunk::RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+void Chunk::RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, bool isLod, const QuadIndexBuffer& quadIndexBuffer)
 {
     if (m_VerticesWater.empty()) return;
 
@@ -303,8 +687,7 @@ void Chunk::RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipeline
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
 
-    // Bind index buffer
-    vkCmdBindIndexBuffer(commandBuffer, m_IndexBufferWater, 0, VK_INDEX_TYPE_UINT32);
+    quadIndexBuffer.Bind(commandBuffer);
 
     // Update push constants
     PushConstants pushConstants{};
@@ -321,7 +704,8 @@ void Chunk::RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipeline
     );
 
     // Draw indexed
-    vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_IndicesWater.size()), 1, 0, 0, 0);
+    const uint32_t firstQuad = isLod ? m_WaterDetailQuadCount : 0;
+    quadIndexBuffer.DrawQuads(commandBuffer, firstQuad, GetWaterQuadCount(isLod));
 }
 
 void Chunk::Update()
@@ -344,143 +728,31 @@ void Chunk::Update()
     //test += Timer::GetInstance().GetElapsed();;
 }
 
-void Chunk::AddFaceVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, BlockType blockType, Direction direction, const glm::vec3& position)
+glm::vec2 Chunk::GetLight(int x, int y, int z) const
 {
-    // Check if block data exists for the given block type
-    auto it = ChunkGenerator::GetInstance().GetBlockData().find(blockType);
-    if (it == ChunkGenerator::GetInstance().GetBlockData().end()) {
-        // Handle error: Block data not found for the given block type
-        std::cout << "ERROR: BLOCK DATA NOT FOUND FOR THE GIVEN BLOCK TYPE!\n";
-        return;
-    }
-
-    const BlockData& blockData = it->second;
-
-    constexpr float textureAtlasWidth = 16;
-    constexpr float textureAtlasHeight = 16;
-
-    // Get texture coordinates for the current face
-    auto textureCoordsIt = blockData.textures.find(direction);
-    if (textureCoordsIt == blockData.textures.end()) {
-        std::cout << "ERROR: TEX COORDS NOT FOUND FOR THE CURRENT FACE DIRECTION!\n";
-        return;
-    }
-
-    auto textureCoords = textureCoordsIt->second;
-
-    float texCoordLeft = textureCoords.column * (1.0f / textureAtlasWidth);
-    float texCoordRight = (textureCoords.column + 1) * (1.0f / textureAtlasWidth);
-    float texCoordTop = textureCoords.row * (1.0f / textureAtlasHeight);
-    float texCoordBottom = (textureCoords.row + 1) * (1.0f / textureAtlasHeight);
-
-    // Calculate the base position of the face
-    glm::vec3 basePosition = position;
-
-    // Adjust base position according to face direction
-    switch (direction) {
-    case Direction::Up:
-        basePosition.y += 0.5f;
-        break;
-    case Direction::Down:
-        basePosition.y -= 0.5f;
-        break;
-    case Direction::North:
-        basePosition.z -= 0.5f;
-        break;
-    case Direction::East:
-        basePosition.x += 0.5f;
-        break;
-    case Direction::South:
-        basePosition.z += 0.5f;
-        break;
-    case Direction::West:
-        basePosition.x -= 0.5f;
-        break;
+    if (y >= m_Height)
+    {
+        return { 1.f, 0.f };
     }
-
-    // Calculate normals
-    glm::vec3 normal;
-    switch (direction) {
-    case Direction::Up:
-        normal = { 0.0f, 1.0f, 0.0f };
-        break;
-    case Direction::Down:
-        normal = { 0.0f, -1.0f, 0.0f };
-        break;
-    case Direction::North:
-        normal = { 0.0f, 0.0f, -1.0f };
-        break;
-    case Direction::East:
-        normal = { 1.0f, 0.0f, 0.0f };
-        break;
-    case Direction::South:
-        normal = { 0.0f, 0.0f, 1.0f };
-        break;
-    case Direction::West:
-        normal = { -1.0f, 0.0f, 0.0f };
-        break;
+    if (y < 0)
+    {
+        return { 0.f, 0.f };
     }
 
-    // Add vertices for the face
-    // Define vertices for the face
-    std::vector<Vertex> faceVertices;
-    faceVertices.reserve(4); // We need 4 vertices for a quad
-
-    // Add vertices for the face based on the direction
-    switch (direction) {
-    case Direction::Up:
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y, basePosition.z + 0.5f }, normal, { texCoordLeft, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y, basePosition.z + 0.5f }, normal, { texCoordRight, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y, basePosition.z - 0.5f }, normal, { texCoordRight, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y, basePosition.z - 0.5f }, normal, { texCoordLeft, texCoordTop } });
-        break;
-
-    case Direction::Down:
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y, basePosition.z - 0.5f }, normal, { texCoordLeft, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y, basePosition.z - 0.5f }, normal, { texCoordRight, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y, basePosition.z + 0.5f }, normal, { texCoordRight, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y, basePosition.z + 0.5f }, normal, { texCoordLeft, texCoordBottom } });
-        break;
-
-    case Direction::North:
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y - 0.5f, basePosition.z }, normal, { texCoordRight, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y + 0.5f, basePosition.z }, normal, { texCoordRight, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y + 0.5f, basePosition.z }, normal, { texCoordLeft, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y - 0.5f, basePosition.z }, normal, { texCoordLeft, texCoordBottom } });
-        break;
-
-    case Direction::South:
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y - 0.5f, basePosition.z }, normal, { texCoordRight, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x + 0.5f, basePosition.y + 0.5f, basePosition.z }, normal, { texCoordRight, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y + 0.5f, basePosition.z }, normal, { texCoordLeft, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x - 0.5f, basePosition.y - 0.5f, basePosition.z }, normal, { texCoordLeft, texCoordBottom } });
-        break;
-
-    case Direction::East:
-        faceVertices.emplace_back(Vertex{ { basePosition.x, basePosition.y - 0.5f, basePosition.z + 0.5f }, normal, { texCoordLeft, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x, basePosition.y - 0.5f, basePosition.z - 0.5f }, normal, { texCoordRight, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x, basePosition.y + 0.5f, basePosition.z - 0.5f }, normal, { texCoordRight, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ { basePosition.x, basePosition.y + 0.5f, basePosition.z + 0.5f }, normal, { texCoordLeft, texCoordTop } });
-        break;
-
-    case Direction::West:
-        faceVertices.emplace_back(Vertex{ glm::vec3{ basePosition.x, basePosition.y - 0.5f, basePosition.z - 0.5f }, normal, { texCoordLeft, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ glm::vec3{ basePosition.x, basePosition.y - 0.5f, basePosition.z + 0.5f }, normal, { texCoordRight, texCoordBottom } });
-        faceVertices.emplace_back(Vertex{ glm::vec3{ basePosition.x, basePosition.y + 0.5f, basePosition.z + 0.5f }, normal, { texCoordRight, texCoordTop } });
-        faceVertices.emplace_back(Vertex{ glm::vec3{ basePosition.x, basePosition.y + 0.5f, basePosition.z - 0.5f }, normal, { texCoordLeft, texCoordTop } });
-        break;
+    const Chunk* pChunk = this;
+    if (x < 0 || x >= m_Width || z < 0 || z >= m_Depth)
+    {
+        const glm::ivec3 offset{ x < 0 ? -1 : (x >= m_Width ? 1 : 0), 0, z < 0 ? -1 : (z >= m_Depth ? 1 : 0) };
+        pChunk = ChunkGenerator::GetInstance().GetChunkAtPosition(m_Position / glm::ivec3(m_Width, m_Height, m_Depth) + offset);
+        if (pChunk == nullptr)
+        {
+            return { 1.f, 0.f };
+        }
+        x -= offset.x * m_Width;
+        z -= offset.z * m_Depth;
     }
 
-    // Add vertices to the provided vertices vector
-    // Add vertices to the provided vertices vector
-    size_t vertexOffset = vertices.size();
-    vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
-
-    // Add indices to the provided indices vector
-    indices.emplace_back(vertexOffset);
-    indices.emplace_back(vertexOffset + 1);
-    indices.emplace_back(vertexOffset + 2);
-    indices.emplace_back(vertexOffset + 2);
-    indices.emplace_back(vertexOffset + 3);
-    indices.emplace_back(vertexOffset);
+    const size_t index = GetIndex(x, y, z);
+    constexpr float maxLevel = LightData::m_MaxLevel;
+    return { pChunk->m_Light.GetSkyLight(index) / maxLevel, pChunk->m_Light.GetBlockLight(index) / maxLevel };
 }
@@ -11,83 +11,144 @@
 #include "BlockMesh.h"
 #include "QueueManager.h"
 #include "Timer.h"
+#include "SectionConnectivity.h"
+#include "BlockRegistry.h"
+#include "VoxelStorage.h"
+#include "LightEngine.h"
+#include "FaceRecordBuilder.h"
+#include "LandMesher.h"
+#include "QuadIndexBuffer.h"
+#include "DeletionQueue.h"
 #include <mutex>
+#include <array>
 //#include "vendor/PerlinNoise.hpp"
 #include "vendor/SimplexNoise.h"
 
-// IMPORTANT:
-// ORDER OF APPEARANCE IN THE JSON FILE MUST MATCH!!!
-enum class BlockType : unsigned char
+struct BlockData
 {
-    GrassBlock,
-    Stone,
-    Dirt,
-    Sand,
-    Log,
-    Leaves,
-    Water,
-    Air
+    std::string id;
+    std::unordered_map<Direction, TextureCoords> textures;
 };
 
-// MUST BE SORTED ALFABETICALLY
-// BECAUSE THE JSON READER RETURNS IT ALFABETICALLY
-enum class Direction : unsigned char
+// Land geometry generated by the ComputeMesher, drawn with the draw command the compute shader filled in
+struct GpuMesh
 {
-    Down,
-    East,
-    North,
-    South,
-    Up,
-    West
+    VkBuffer vertexBuffer{ VK_NULL_HANDLE };
+    VkDeviceMemory vertexBufferMemory{ VK_NULL_HANDLE };
+    VkBuffer indexBuffer{ VK_NULL_HANDLE };
+    VkDeviceMemory indexBufferMemory{ VK_NULL_HANDLE };
+    VkBuffer drawCommandBuffer{ VK_NULL_HANDLE };
+    VkDeviceMemory drawCommandBufferMemory{ VK_NULL_HANDLE };
+    uint32_t faceCount{};
 };
 
-struct TextureCoords
+// Land faces as packed records in a storage buffer, drawn by the vertex pulling pipeline without vertex or index buffers
+struct FaceMesh
 {
-    unsigned short row;
-    unsigned short column;
+    VkBuffer faceBuffer{ VK_NULL_HANDLE };
+    VkDeviceMemory faceBufferMemory{ VK_NULL_HANDLE };
+    // Set 1 of the PipelineLayout3D, points at the face buffer
+    VkDescriptorSet descriptorSet{ VK_NULL_HANDLE };
+    uint32_t faceCount{};
 };
 
-struct BlockData
-{
-    std::string id;
-    std::unordered_map<Direction, TextureCoords> textures;
-};
+class PipelineLayout3D;
+class GpuCuller;
 
 class Chunk
 {
 public:
-    static constexpr int m_Width = 64;
-    static constexpr int m_Height = 128;
-    static constexpr int m_Depth = 64;
+    static constexpr int m_Width = CHUNK_WIDTH;
+    static constexpr int m_Height = CHUNK_HEIGHT;
+    static constexpr int m_Depth = CHUNK_DEPTH;
     static constexpr float m_SeaLevel = 0.3f; // Sea level as a fraction of m_Height
     static constexpr float m_MinHeight = 0.0f;
     static constexpr float m_MaxHeight = 1.0f;
+
+    // Chunks are split in cubic sections so they can be culled separately
+    static constexpr int m_SectionSize = SectionConnectivity::m_SectionSize;
+    static constexpr int m_SectionsX = m_Width / m_SectionSize;
+    static constexpr int m_SectionsY = m_Height / m_SectionSize;
+    static constexpr int m_SectionsZ = m_Depth / m_SectionSize;
+    static constexpr int m_SectionCount = m_SectionsX * m_SectionsY * m_SectionsZ;
+    static_assert(m_SectionCount == LandMesher::m_SectionCount, "the land mesher groups the quads in the sections of the chunk");
+    static constexpr int m_SectionColumnCount = m_SectionsX * m_SectionsZ;
 public:
     Chunk(const glm::ivec3& position, SimplexNoise* noise, VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
 
+    // Generates the chunk at the position and uploads its water, the chunk has to be new or Reset.
+    // The land is meshed by MeshLand once the LightEngine has lit the chunk.
+    void Load(const glm::ivec3& position, VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
+    // Meshes and uploads the land of a loaded chunk the first time, RegenerateLandMesh replaces it later
+    void MeshLand(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
+    // Puts a destroyed chunk back in its unloaded state for the ChunkPool, the storage keeps its capacity
+    void Reset();
+
+    // The buffers go through the DeletionQueue, the last frame may still be drawing the chunk
     void Destroy(VkDevice device)
     {
-        // Destroy Vulkan buffers
-        vkDestroyBuffer(device, m_VertexBufferLand, nullptr);
-        vkFreeMemory(device, m_VertexBufferMemoryLand, nullptr);
-        vkDestroyBuffer(device, m_IndexBufferLand, nullptr);
-        vkFreeMemory(device, m_IndexBufferMemoryLand, nullptr);
+        DeletionQueue::GetInstance().DestroyBuffer(m_VertexBufferLand, m_VertexBufferMemoryLand);
         if (!m_VerticesWater.empty())
         {
-            vkDestroyBuffer(device, m_VertexBufferWater, nullptr);
-            vkFreeMemory(device, m_VertexBufferMemoryWater, nullptr);
-            vkDestroyBuffer(device, m_IndexBufferWater, nullptr);
-            vkFreeMemory(device, m_IndexBufferMemoryWater, nullptr);
+            DeletionQueue::GetInstance().DestroyBuffer(m_VertexBufferWater, m_VertexBufferMemoryWater);
+        }
+        DestroyGpuMesh(device);
+        // The descriptor set is left to the pool, call DestroyFaceMesh first while the pool is still in use
+        DestroyFaceMesh(device, nullptr);
+    }
+
+    // While a gpu mesh is set it is drawn instead of the cpu generated land, without section culling
+    void SetGpuMesh(VkDevice device, const GpuMesh& gpuMesh)
+    {
+        DestroyGpuMesh(device);
+        m_GpuMesh = gpuMesh;
+        m_HasGpuMesh = true;
+    }
+
+    void DestroyGpuMesh(VkDevice device)
+    {
+        if (!m_HasGpuMesh)
+        {
+            return;
         }
+
+        DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+        deletionQueue.DestroyBuffer(m_GpuMesh.vertexBuffer, m_GpuMesh.vertexBufferMemory);
+        deletionQueue.DestroyBuffer(m_GpuMesh.indexBuffer, m_GpuMesh.indexBufferMemory);
+        deletionQueue.DestroyBuffer(m_GpuMesh.drawCommandBuffer, m_GpuMesh.drawCommandBufferMemory);
+        m_GpuMesh = {};
+        m_HasGpuMesh = false;
+    }
+
+    bool HasGpuMesh() const { return m_HasGpuMesh; }
+
+    // Builds the face records of the land and uploads them, the descriptor set is allocated from the pipeline layout
+    void CreateFaceMesh(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, PipelineLayout3D& pipelineLayout);
+    // Pass the pipeline layout to give the descriptor set back to it, or null when the set is freed with the whole pool
+    void DestroyFaceMesh(VkDevice device, PipelineLayout3D* pPipelineLayout);
+    bool HasFaceMesh() const { return m_HasFaceMesh; }
+
+    // Size of the land geometry on the gpu, as quad vertices and as face records. The indices are shared by all chunks.
+    size_t GetIndexedLandByteSize() const { return sizeof(Vertex) * m_VerticesLand.size(); }
+    size_t GetFaceRecordByteSize() const { return sizeof(FaceRecord) * m_FaceRecords.size(); }
+    // Size of the 32 bit land and water index buffers the chunk would need without the shared QuadIndexBuffer
+    size_t GetOwnIndexByteSize() const
+    {
+        return sizeof(uint32_t) * QuadIndexBuffer::m_IndicesPerQuad * ((m_VerticesLand.size() + m_VerticesWater.size()) / QuadIndexBuffer::m_VerticesPerQuad);
     }
+    uint32_t GetLandFaceCount() const { return static_cast<uint32_t>(m_VerticesLand.size() / QuadIndexBuffer::m_VerticesPerQuad); }
     void SetBlock(const glm::vec3& position, BlockType blockType)
     {
         if (position.x >= 0 && position.x < m_Width && position.y >= 0 && position.y < m_Height && position.z >= 0 && position.z < m_Depth)
         {
-            m_Blocks[GetIndex(position.x, position.y, position.z)] = blockType;
+            m_Blocks.Set(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z), blockType);
         }
     }
 
+    // Changes a block of a loaded chunk and updates everything but the land mesh and the light.
+    // The water is meshed and uploaded again, its old buffer goes through the DeletionQueue.
+    void EditBlock(const glm::ivec3& position, BlockType blockType, VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
+
     BlockType GetBlock(const glm::vec3& position) const
     {
         if (position.x >= 0 && position.x < m_Width && position.y >= 0 && position.y < m_Height && position.z >= 0 && position.z < m_Depth)
@@ -101,12 +162,35 @@ public:
 
     void GenerateTerrain();
 
+    // Rebuilds the land mesh and its buffers from the current blocks, the old buffers go through the DeletionQueue
+    // because the last frame may still be drawing them. The pipeline layout is only needed when there is a face mesh.
+    void RegenerateLandMesh(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, PipelineLayout3D* pPipelineLayout)
+    {
+        DeletionQueue::GetInstance().DestroyBuffer(m_VertexBufferLand, m_VertexBufferMemoryLand);
+
+        GenerateLandMesh();
+        CreateLandVertexBuffer(device, physicalDevice, commandPool);
+
+        // The face records don't hold light or ambient occlusion, but the blocks may have changed.
+        // The descriptor set of the last frame can't be rewritten either, so the face mesh gets a new one.
+        if (m_HasFaceMesh)
+        {
+            CreateFaceMesh(device, physicalDevice, commandPool, *pPipelineLayout);
+        }
+    }
+
     bool IsWithinBounds(const glm::ivec3& position) const;
 
-    void RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
+    // Both draw the quads of the chunk with the shared quad indices
+    void RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const QuadIndexBuffer& quadIndexBuffer);
+    // Draws the face records with the vertex pulling pipeline, the same sections are culled
+    void RenderFaces(VkCommandBuffer commandBuffer, const PipelineLayout3D& pipelineLayout);
+    // Draws the sections the GpuCuller let through this frame, the visible flags of the sections aren't used
+    void RenderLandCulled(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, const QuadIndexBuffer& quadIndexBuffer, const GpuCuller& gpuCuller);
 
 
-    void RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
+    // The lod version replaces the per block surface faces with merged quads
+    void RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout, bool isLod, const QuadIndexBuffer& quadIndexBuffer);
 
     void Update();
 
@@ -122,28 +206,101 @@ public:
         }
     }
 
+    const ChunkBlocks& GetBlocks() const { return m_Blocks; }
+    LightData& GetLight() { return m_Light; }
+    const LightData& GetLight() const { return m_Light; }
+
     bool IsMarkedForDeletion() const { return m_IsMarkedForDeletion; }
     bool IsDeleted() const { return m_IsDeleted; }
+    // Skips the deletion timer, the chunk is destroyed in the next update
+    void SetIsDeleted(bool state) { m_IsDeleted = state; }
+
+    bool IsSectionEmpty(int section) const { return m_SectionsLand[section].quadCount == 0; }
+    void SetSectionVisible(int section, bool isVisible) { m_VisibleSections[section] = isVisible; }
+    bool IsSectionVisible(int section) const { return m_VisibleSections[section]; }
+    uint16_t GetSectionConnectivity(int section) const { return m_SectionConnectivity[section]; }
+    void GetSectionQuads(int section, uint32_t& firstQuad, uint32_t& quadCount) const
+    {
+        firstQuad = m_SectionsLand[section].firstQuad;
+        quadCount = m_SectionsLand[section].quadCount;
+    }
+
+    // Slot of the section records of the chunk in the GpuCuller, GpuCuller::m_InvalidSlot if it has none
+    uint32_t GetCullSlot() const { return m_CullSlot; }
+    void SetCullSlot(uint32_t cullSlot) { m_CullSlot = cullSlot; }
+
+    uint32_t GetWaterQuadCount(bool isLod) const
+    {
+        const uint32_t quadCount = static_cast<uint32_t>(m_VerticesWater.size() / QuadIndexBuffer::m_VerticesPerQuad);
+        return isLod ? quadCount - m_WaterDetailQuadCount : m_WaterLodFirstQuad;
+    }
+
+    static int GetSectionIndex(int sectionX, int sectionY, int sectionZ)
+    {
+        return sectionX + sectionY * m_SectionsX + sectionZ * m_SectionsX * m_SectionsY;
+    }
+
+    // World space bounds of a section, blocks are centered on their integer position
+    void GetSectionBounds(int section, glm::vec3& min, glm::vec3& max) const
+    {
+        const int sectionX = section % m_SectionsX;
+        const int sectionY = (section / m_SectionsX) % m_SectionsY;
+        const int sectionZ = section / (m_SectionsX * m_SectionsY);
+        min = glm::vec3(m_Position + glm::ivec3(sectionX, sectionY, sectionZ) * m_SectionSize) - glm::vec3(0.5f);
+        max = min + glm::vec3(static_cast<float>(m_SectionSize));
+    }
+
+    // World space bounds of the solid part at the bottom of a section column, returns false if there is none
+    bool GetOccluderBounds(int column, glm::vec3& min, glm::vec3& max) const
+    {
+        if (m_SolidHeights[column] == 0)
+        {
+            return false;
+        }
+
+        const int sectionX = column % m_SectionsX;
+        const int sectionZ = column / m_SectionsX;
+        min = glm::vec3(m_Position + glm::ivec3(sectionX, 0, sectionZ) * m_SectionSize) - glm::vec3(0.5f);
+        max = min + glm::vec3(static_cast<float>(m_SectionSize), static_cast<float>(m_SolidHeights[column]), static_cast<float>(m_SectionSize));
+        return true;
+    }
 private:
+    // Range of the land quads that belong to a section
+    using SectionRange = LandMesher::SectionRange;
+
     glm::ivec3 m_Position{};
-    std::vector<BlockType> m_Blocks;
-    std::vector<Vertex> m_VerticesLand;
-    std::vector<uint32_t> m_IndicesLand;
-    std::vector<Vertex> m_VerticesWater;
-    std::vector<uint32_t> m_IndicesWater;
+    ChunkBlocks m_Blocks;
+    // Fully sky lit until the LightEngine has lit the chunk, in the layout of the blocks
+    LightData m_Light{ ChunkBlocks::m_BlockCount };
+    // Four vertices per quad in the corner order of the QuadIndexBuffer
+    TaggedVector<Vertex, MemoryTag::Meshes> m_VerticesLand;
+    TaggedVector<WaterVertex, MemoryTag::Meshes> m_VerticesWater;
+    LandMesher::SectionRanges m_SectionsLand{};
+    std::array<bool, m_SectionCount> m_VisibleSections{};
+    // Amount of solid blocks at the bottom of every section column, shared by all columns of blocks inside it
+    std::array<int, m_SectionColumnCount> m_SolidHeights{};
+    // Which faces of every section are connected through non opaque blocks
+    std::array<uint16_t, m_SectionCount> m_SectionConnectivity{};
+    // The water quads are laid out as [per block surface faces][side faces][merged surface faces],
+    // close by the first two ranges are drawn, far away the last two
+    uint32_t m_WaterDetailQuadCount{};
+    uint32_t m_WaterLodFirstQuad{};
+    GpuMesh m_GpuMesh{};
+    bool m_HasGpuMesh{};
+    TaggedVector<FaceRecord, MemoryTag::Meshes> m_FaceRecords;
+    std::vector<FaceRecordBuilder::SectionRange> m_SectionsFaces;
+    FaceMesh m_FaceMesh{};
+    bool m_HasFaceMesh{};
+    uint32_t m_CullSlot{ UINT32_MAX };
     VkDevice m_Device;
 
     // Vulkan buffers for land
-    VkBuffer m_VertexBufferLand;
-    VkDeviceMemory m_VertexBufferMemoryLand;
-    VkBuffer m_IndexBufferLand;
-    VkDeviceMemory m_IndexBufferMemoryLand;
+    VkBuffer m_VertexBufferLand{ VK_NULL_HANDLE };
+    VkDeviceMemory m_VertexBufferMemoryLand{ VK_NULL_HANDLE };
 
     // Vulkan buffers for water
-    VkBuffer m_VertexBufferWater;
-    VkDeviceMemory m_VertexBufferMemoryWater;
-    VkBuffer m_IndexBufferWater;
-    VkDeviceMemory m_IndexBufferMemoryWater;
+    VkBuffer m_VertexBufferWater{ VK_NULL_HANDLE };
+    VkDeviceMemory m_VertexBufferMemoryWater{ VK_NULL_HANDLE };
     SimplexNoise* m_pNoise{};
 
     bool m_IsMarkedForDeletion{};
@@ -152,23 +309,27 @@ private:
 private:
     size_t GetIndex(int x, int y, int z) const
     {
-        return static_cast<size_t>(x) + static_cast<size_t>(y) * m_Width + static_cast<size_t>(z) * m_Width * m_Height;
+        return ChunkBlocks::GetIndex(x, y, z);
     }
 
-    bool IsSameBlockType(BlockType blockType, int x, int y, int z) const
+    // Meshes the land blocks, grouped per section
+    void GenerateLandMesh();
+    // Rebuilds the face records and replaces the face buffer, CreateFaceMesh gives it a descriptor set
+    void CreateFaceBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
+    void CalculateSolidHeights();
+    void CalculateSectionConnectivity();
+    void GenerateWaterMesh();
+    bool IsWaterSurfaceRow(const TaggedVector<bool, MemoryTag::Transient>& isSurface, int x, int y, int z, int width) const;
+
+    // Water only shows faces towards air and other see through blocks.
+    // Blocks outside of the chunk are treated as water so no walls are generated on the chunk borders.
+    bool IsWaterFaceVisible(int x, int y, int z) const
     {
-        // Check if the neighboring block is out of bounds
         if (x < 0 || x >= m_Width || y < 0 || y >= m_Height || z < 0 || z >= m_Depth)
         {
-            // Out of bounds blocks are not the same type
             return false;
         }
-
-        // Get the type of the neighboring block
-        BlockType neighborBlockType = GetBlock({ x, y, z });
-
-        // Check if the neighboring block is the same type as the current block
-        return (neighborBlockType == blockType);
+        return GetBlock({ x, y, z }) != BlockType::Water && !IsOpaqueBlock(x, y, z);
     }
 
     bool IsOpaqueBlock(int x, int y, int z) const {
@@ -177,17 +338,7 @@ private:
             return false; // Out of bounds blocks are considered transparent
         }
 
-        // Get the type of the current block
-        BlockType currentBlockType = GetBlock({ x, y, z });
-
-        // Check if the current block is translucent
-        if (currentBlockType == BlockType::Air || currentBlockType == BlockType::Leaves || currentBlockType == BlockType::Water)
-        {
-            return false; // Translucent blocks are considered transparent
-        }
-
-        // If none of the neighboring blocks are translucent, consider the current block as opaque
-        return true;
+        return BlockRegistry::GetInstance().IsOpaque(GetBlock({ x, y, z }));
     }
 
     void UpdateVertexBuffer()
@@ -223,7 +374,7 @@ private:
             bufferSize,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer, stagingBufferMemory);
+            stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
 
         void* data;
         vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
@@ -236,46 +387,13 @@ private:
             bufferSize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            m_VertexBufferLand, m_VertexBufferMemoryLand);
+            m_VertexBufferLand, m_VertexBufferMemoryLand, MemoryTag::Meshes);
 
         CopyBuffer(device, commandPool, stagingBuffer, m_VertexBufferLand, bufferSize);
 
         vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        FreeMemory(device, stagingBufferMemory);
     }
-    void CreateLandIndexBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
-    {
-        VkDeviceSize bufferSize = sizeof(m_IndicesLand[0]) * m_IndicesLand.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        CreateBuffer(
-            device,
-            physicalDevice,
-            bufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, m_IndicesLand.data(), (size_t)bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        CreateBuffer(
-            device,
-            physicalDevice,
-            bufferSize,
-            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            m_IndexBufferLand, m_IndexBufferMemoryLand);
-
-        CopyBuffer(device, commandPool, stagingBuffer, m_IndexBufferLand, bufferSize);
-
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
-    }
-
     void CreateWaterVertexBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
     {
         VkDeviceSize bufferSize = sizeof(m_VerticesWater[0]) * m_VerticesWater.size();
@@ -288,7 +406,7 @@ private:
             bufferSize,
             VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer, stagingBufferMemory);
+            stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
 
         void* data;
         vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
@@ -301,46 +419,17 @@ private:
             bufferSize,
             VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            m_VertexBufferWater, m_VertexBufferMemoryWater);
+            m_VertexBufferWater, m_VertexBufferMemoryWater, MemoryTag::Meshes);
 
         CopyBuffer(device, commandPool, stagingBuffer, m_VertexBufferWater, bufferSize);
 
         vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
+        FreeMemory(device, stagingBufferMemory);
     }
 
-    void CreateWaterIndexBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
-    {
-        VkDeviceSize bufferSize = sizeof(m_IndicesWater[0]) * m_IndicesWater.size();
-
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        CreateBuffer(
-            device,
-            physicalDevice,
-            bufferSize,
-            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-            stagingBuffer, stagingBufferMemory);
-
-        void* data;
-        vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-        memcpy(data, m_IndicesWater.data(), (size_t)bufferSize);
-        vkUnmapMemory(device, stagingBufferMemory);
-
-        CreateBuffer(
-            device,
-            physicalDevice,
-            bufferSize,
-            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            m_IndexBufferWater, m_IndexBufferMemoryWater);
-
-        CopyBuffer(device, commandPool, stagingBuffer, m_IndexBufferWater, bufferSize);
-
-        vkDestroyBuffer(device, stagingBuffer, nullptr);
-        vkFreeMemory(device, stagingBufferMemory, nullptr);
-    }
-    void AddFaceVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, BlockType blockType, Direction direction, const glm::vec3& position);
+    // Adds a water face covering size blocks starting at the given block
+    void AddWaterFace(TaggedVector<WaterVertex, MemoryTag::Transient>& vertices, Direction direction, const glm::ivec3& block, const glm::ivec3& size);
+    // Sky and block light of a block as 0 - 1, blocks outside of the chunk are looked up in the neighboring chunks
+    glm::vec2 GetLight(int x, int y, int z) const;
     //void AddFaceVertices(BlockType blockType, Direction direction, const glm::vec3& position);
 };
\ No newline at end of file
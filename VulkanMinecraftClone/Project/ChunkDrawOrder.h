@@ -0,0 +1,85 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+class Chunk;
+
+// Front to back order of the opaque chunk draws, so the depth test rejects the fragments of hidden hillsides
+// before they are shaded. Chunks are bucketed by their ring around the camera chunk (the largest of the x and z
+// chunk distance) with a counting sort, the order inside a ring doesn't matter much for early depth rejection.
+// The order only changes when the camera enters another chunk, so it is cached until then.
+// Only stores the chunk pointers, nothing in here touches a Chunk or Vulkan.
+class ChunkDrawOrder final
+{
+public:
+    // The cached order has to be rebuilt before the next draw
+    void Invalidate() { m_IsValid = false; }
+    bool IsValid(const glm::ivec3& cameraChunkPosition) const { return m_IsValid && cameraChunkPosition == m_CameraChunkPosition; }
+
+    // Starts a new order, followed by an Add for every chunk and a Finish
+    void Begin(const glm::ivec3& cameraChunkPosition)
+    {
+        m_CameraChunkPosition = cameraChunkPosition;
+        m_Entries.clear();
+    }
+
+    void Add(const glm::ivec3& chunkPosition, Chunk* chunk)
+    {
+        const int ring = std::max(std::abs(chunkPosition.x - m_CameraChunkPosition.x), std::abs(chunkPosition.z - m_CameraChunkPosition.z));
+        m_Entries.push_back({ ring, chunk });
+    }
+
+    // Counting sort of the added chunks on their ring
+    void Finish()
+    {
+        int maxRing = 0;
+        for (const Entry& entry : m_Entries)
+        {
+            maxRing = std::max(maxRing, entry.ring);
+        }
+
+        // First slot of every ring in the order
+        m_RingStarts.assign(static_cast<size_t>(maxRing) + 2, 0);
+        for (const Entry& entry : m_Entries)
+        {
+            ++m_RingStarts[entry.ring + 1];
+        }
+        for (size_t ring = 1; ring < m_RingStarts.size(); ++ring)
+        {
+            m_RingStarts[ring] += m_RingStarts[ring - 1];
+        }
+
+        m_Chunks.resize(m_Entries.size());
+        std::vector<size_t> nextSlots(m_RingStarts.begin(), m_RingStarts.end() - 1);
+        for (const Entry& entry : m_Entries)
+        {
+            m_Chunks[nextSlots[entry.ring]++] = entry.chunk;
+        }
+        m_IsValid = true;
+    }
+
+    // Keeps the order of the other chunks, a destroyed chunk doesn't need a new sort
+    void Remove(Chunk* chunk)
+    {
+        m_Chunks.erase(std::remove(m_Chunks.begin(), m_Chunks.end(), chunk), m_Chunks.end());
+    }
+
+    // Closest ring first
+    const std::vector<Chunk*>& GetChunks() const { return m_Chunks; }
+    int GetRingCount() const { return m_RingStarts.empty() ? 0 : static_cast<int>(m_RingStarts.size()) - 1; }
+
+private:
+    struct Entry
+    {
+        int ring;
+        Chunk* chunk;
+    };
+
+    std::vector<Entry> m_Entries;
+    std::vector<size_t> m_RingStarts;
+    std::vector<Chunk*> m_Chunks;
+    glm::ivec3 m_CameraChunkPosition{};
+    bool m_IsValid{};
+};
@@ -1,9 +1,12 @@
 #include "ChunkGenerator.h"
+#include "Profiler.h"
+#include <cmath>
+#include <limits>
+#include <random>
 
 const int ChunkGenerator::m_ViewDistance{ 10 };  // View distance in grid tiles
 const int ChunkGenerator::m_LoadDistance{ 2 }; // Load distance in grid tiles
 const int ChunkGenerator::m_Padding{ 2 }; // Padding for chunk loading
-const int ChunkGenerator::m_NoiseFractals{ 8 }; // Amount of fractals for the noise
 const float ChunkGenerator::m_ChunkDeletionTime{ 10.f }; // Time to delete chunks after being marked for deletion
 
 void ChunkGenerator::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
@@ -11,15 +14,15 @@ void ChunkGenerator::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCo
     this->m_Device = device;
     this->m_PhysicalDevice = physicalDevice;
     this->m_CommandPool = commandPool;
-    LoadBlockData("textures/blockdata.json");
+    if (!BlockRegistry::GetInstance().Load("textures/blockdata.json"))
+    {
+        throw std::runtime_error("failed to load block data!");
+    }
 
-    // frequency, amplitude, lacunarity, persistence
-    const float frequency = 0.005f;
-    const float amplitude = 1.f;
-    const float lacunarity = 2.f;
-    const float persistence = 1/lacunarity;
-
-    m_pSimplexNoise = std::make_unique<SimplexNoise>(frequency, amplitude, lacunarity, persistence);
+    m_pSimplexNoise = std::make_unique<SimplexNoise>(CreateTerrainNoise());
+    m_ComputeMesher.Init(device, physicalDevice, commandPool);
+    m_QuadIndexBuffer.Init(device, physicalDevice, commandPool);
+    m_GpuCuller.Init(device, physicalDevice, commandPool);
     //m_pSimplexNoise = std::make_unique<SimplexNoise>(0.005f, 10.f, 2.f, 15.f);
 
     // Initialize the player's chunk position
@@ -29,6 +32,606 @@ void ChunkGenerator::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCo
     UpdateChunksAroundPlayer();
 }
 
+void ChunkGenerator::PrepareLandDraws()
+{
+    if (IsGpuCullingActive())
+    {
+        Camera& camera = Camera::GetInstance();
+        const glm::mat4 projection = glm::perspective(glm::radians(camera.m_Zoom), static_cast<float>(WIDTH) / HEIGHT, NEAR_PLANE, FAR_PLANE);
+        m_FrustumPlanes = SectionCuller::ExtractFrustumPlanes(projection * camera.GetViewMatrix());
+    }
+    else
+    {
+        CullSections();
+    }
+
+    if (!m_LandDrawOrder.IsValid(m_PlayerChunkPosition))
+    {
+        ScopedTimer timer{ "land ordering" };
+        m_LandDrawOrder.Begin(m_PlayerChunkPosition);
+        for (const auto& [position, chunk] : m_ChunkMap)
+        {
+            m_LandDrawOrder.Add(position, chunk.get());
+        }
+        m_LandDrawOrder.Finish();
+    }
+}
+
+void ChunkGenerator::CullSections()
+{
+    ScopedTimer timer{ "section culling" };
+
+    uint64_t loadedSections = 0;
+    uint64_t drawnSections = 0;
+    uint64_t occludedSections = 0;
+
+    if (!m_IsOcclusionCullingEnabled)
+    {
+        for (const auto& [position, chunk] : m_ChunkMap)
+        {
+            for (int section = 0; section < Chunk::m_SectionCount; ++section)
+            {
+                chunk->SetSectionVisible(section, true);
+                drawnSections += chunk->IsSectionEmpty(section) ? 0 : 1;
+            }
+        }
+        Profiler::GetInstance().AddCount("sections drawn", drawnSections);
+        return;
+    }
+
+    Camera& camera = Camera::GetInstance();
+    const glm::mat4 projection = glm::perspective(
+        glm::radians(camera.m_Zoom),
+        static_cast<float>(WIDTH) / HEIGHT,
+        NEAR_PLANE,
+        FAR_PLANE);
+    m_OcclusionCuller.BeginFrame(projection * camera.GetViewMatrix(), camera.m_Position);
+
+    // Only the sections that can be seen through the non opaque blocks from the camera are kept
+    const uint64_t visitedSections = MarkReachableSections();
+
+    // The solid bottom of every section column is used as occluder
+    for (const auto& [position, chunk] : m_ChunkMap)
+    {
+        if (chunk->IsMarkedForDeletion())
+        {
+            continue;
+        }
+
+        loadedSections += Chunk::m_SectionCount;
+        for (int column = 0; column < Chunk::m_SectionColumnCount; ++column)
+        {
+            glm::vec3 min, max;
+            if (chunk->GetOccluderBounds(column, min, max))
+            {
+                m_OcclusionCuller.AddOccluder(min, max);
+            }
+        }
+    }
+    m_OcclusionCuller.EndOccluders();
+
+    for (const auto& [position, chunk] : m_ChunkMap)
+    {
+        if (chunk->IsMarkedForDeletion())
+        {
+            continue;
+        }
+
+        for (int section = 0; section < Chunk::m_SectionCount; ++section)
+        {
+            if (!chunk->IsSectionVisible(section) || chunk->IsSectionEmpty(section))
+            {
+                continue;
+            }
+
+            glm::vec3 min, max;
+            chunk->GetSectionBounds(section, min, max);
+            if (m_OcclusionCuller.TestBox(min, max) == OcclusionCuller::Result::Visible)
+            {
+                ++drawnSections;
+            }
+            else
+            {
+                chunk->SetSectionVisible(section, false);
+                ++occludedSections;
+            }
+        }
+    }
+
+    Profiler::GetInstance().AddCount("sections loaded", loadedSections);
+    Profiler::GetInstance().AddCount("sections visited", visitedSections);
+    Profiler::GetInstance().AddCount("sections drawn", drawnSections);
+    Profiler::GetInstance().AddCount("sections occluded", occludedSections);
+}
+
+void ChunkGenerator::LightNewChunks()
+{
+    if (m_UnlitChunks.empty())
+    {
+        return;
+    }
+
+    std::vector<glm::ivec3> changedChunks;
+    {
+        ScopedTimer timer{ "lighting" };
+        changedChunks = m_LightEngine.LightChunks(m_UnlitChunks);
+    }
+
+    // The new chunks are meshed for the first time, the loaded ones next to them only when their light changed
+    for (const glm::ivec3& chunkPosition : changedChunks)
+    {
+        Chunk* chunk = GetChunkAtPosition(chunkPosition);
+        if (std::find(m_UnlitChunks.begin(), m_UnlitChunks.end(), chunkPosition) != m_UnlitChunks.end())
+        {
+            chunk->MeshLand(m_Device, m_PhysicalDevice, m_CommandPool);
+        }
+        else
+        {
+            chunk->RegenerateLandMesh(m_Device, m_PhysicalDevice, m_CommandPool, m_pPipelineLayout3D);
+        }
+    }
+    m_UnlitChunks.clear();
+    m_AreCullRecordsStale = true;
+}
+
+bool ChunkGenerator::SetBlock(const glm::ivec3& blockPosition, BlockType blockType)
+{
+    if (blockPosition.y < 0 || blockPosition.y >= Chunk::m_Height)
+    {
+        return false;
+    }
+
+    const glm::ivec3 chunkPosition{ FloorDivide(blockPosition.x, Chunk::m_Width), 0, FloorDivide(blockPosition.z, Chunk::m_Depth) };
+    Chunk* chunk = GetChunkAtPosition(chunkPosition);
+    if (chunk == nullptr || chunk->IsMarkedForDeletion())
+    {
+        return false;
+    }
+
+    // Water is meshed apart from the land and isn't lit, so it is left alone
+    const glm::ivec3 localPosition = blockPosition - chunk->GetPosition();
+    const BlockType oldBlockType = chunk->GetBlock(localPosition);
+    if (oldBlockType == blockType || oldBlockType == BlockType::Water || blockType == BlockType::Water)
+    {
+        return false;
+    }
+
+    ScopedTimer timer{ "block edit" };
+    chunk->EditBlock(localPosition, blockType, m_Device, m_PhysicalDevice, m_CommandPool);
+    std::vector<glm::ivec3> changedChunks = m_LightEngine.UpdateBlock(chunkPosition, localPosition, oldBlockType);
+    if (std::find(changedChunks.begin(), changedChunks.end(), chunkPosition) == changedChunks.end())
+    {
+        changedChunks.push_back(chunkPosition);
+    }
+
+    // The compute shader reads the blocks on the borders of the neighbors as well
+    std::vector<glm::ivec3> editedChunks{ chunkPosition };
+    if (localPosition.x == 0) editedChunks.push_back(chunkPosition + glm::ivec3{ -1, 0, 0 });
+    if (localPosition.x == Chunk::m_Width - 1) editedChunks.push_back(chunkPosition + glm::ivec3{ 1, 0, 0 });
+    if (localPosition.z == 0) editedChunks.push_back(chunkPosition + glm::ivec3{ 0, 0, -1 });
+    if (localPosition.z == Chunk::m_Depth - 1) editedChunks.push_back(chunkPosition + glm::ivec3{ 0, 0, 1 });
+
+    // The old buffers go through the DeletionQueue, the last frame may still be drawing them
+    for (const glm::ivec3& changedPosition : changedChunks)
+    {
+        GetChunkAtPosition(changedPosition)->RegenerateLandMesh(m_Device, m_PhysicalDevice, m_CommandPool, m_pPipelineLayout3D);
+    }
+    for (const glm::ivec3& editedPosition : editedChunks)
+    {
+        if (Chunk* editedChunk = GetChunkAtPosition(editedPosition))
+        {
+            editedChunk->DestroyGpuMesh(m_Device);
+        }
+    }
+    if (m_IsGpuMeshingEnabled)
+    {
+        MeshChunksOnGpu();
+    }
+    m_AreCullRecordsStale = true;
+    return true;
+}
+
+bool ChunkGenerator::PickBlock(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, glm::ivec3& hitBlock, glm::ivec3& previousBlock)
+{
+    // Steps from block to block along the ray, blocks are centered on their integer position
+    glm::ivec3 block{ glm::floor(origin + 0.5f) };
+    glm::ivec3 step{};
+    glm::vec3 nextDistance{};
+    glm::vec3 deltaDistance{};
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (direction[axis] == 0.f)
+        {
+            nextDistance[axis] = std::numeric_limits<float>::max();
+            deltaDistance[axis] = std::numeric_limits<float>::max();
+            continue;
+        }
+
+        step[axis] = direction[axis] > 0.f ? 1 : -1;
+        const float boundary = static_cast<float>(block[axis]) + 0.5f * static_cast<float>(step[axis]);
+        nextDistance[axis] = (boundary - origin[axis]) / direction[axis];
+        deltaDistance[axis] = 1.f / std::abs(direction[axis]);
+    }
+
+    previousBlock = block;
+    float distance = 0.f;
+    while (distance <= maxDistance)
+    {
+        if (block.y >= 0 && block.y < Chunk::m_Height)
+        {
+            const glm::ivec3 chunkPosition{ FloorDivide(block.x, Chunk::m_Width), 0, FloorDivide(block.z, Chunk::m_Depth) };
+            const Chunk* chunk = GetChunkAtPosition(chunkPosition);
+            if (chunk == nullptr)
+            {
+                return false;
+            }
+
+            const BlockType blockType = chunk->GetBlock(block - chunk->GetPosition());
+            if (blockType != BlockType::Air && blockType != BlockType::Water)
+            {
+                hitBlock = block;
+                return true;
+            }
+        }
+
+        const int axis = nextDistance.x < nextDistance.y ? (nextDistance.x < nextDistance.z ? 0 : 2) : (nextDistance.y < nextDistance.z ? 1 : 2);
+        previousBlock = block;
+        distance = nextDistance[axis];
+        block[axis] += step[axis];
+        nextDistance[axis] += deltaDistance[axis];
+    }
+    return false;
+}
+
+void ChunkGenerator::ToggleAmbientOcclusion()
+{
+    m_IsAmbientOcclusionEnabled = !m_IsAmbientOcclusionEnabled;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (auto& [position, chunk] : m_ChunkMap)
+    {
+        chunk->RegenerateLandMesh(m_Device, m_PhysicalDevice, m_CommandPool, m_pPipelineLayout3D);
+    }
+    const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Remeshed " << m_ChunkMap.size() << " chunks in " << milliseconds << " ms\n";
+
+    m_AreCullRecordsStale = true;
+}
+
+int ChunkGenerator::ChurnChunks(int chunkCount)
+{
+    // Loads the chunks that were destroyed by the previous churn
+    UpdateChunksAroundPlayer();
+
+    static std::mt19937 generator{ 1234 };
+    std::uniform_int_distribution<int> offset{ -m_LoadDistance, m_LoadDistance };
+    int churnedCount = 0;
+    for (int index = 0; index < chunkCount; ++index)
+    {
+        const glm::ivec3 chunkPosition{ m_PlayerChunkPosition.x + offset(generator), 0, m_PlayerChunkPosition.z + offset(generator) };
+        if (IsChunkLoaded(chunkPosition) && !GetChunkAtPosition(chunkPosition)->IsDeleted())
+        {
+            GetChunkAtPosition(chunkPosition)->SetIsDeleted(true);
+            ++churnedCount;
+        }
+    }
+    return churnedCount;
+}
+
+void ChunkGenerator::ToggleGpuCulling()
+{
+    // Without the count draws every section slot would need its own draw, the cpu culling is cheaper then
+    if (!m_GpuCuller.IsSupported())
+    {
+        m_IsGpuCullingEnabled = false;
+        return;
+    }
+
+    m_IsGpuCullingEnabled = !m_IsGpuCullingEnabled;
+    if (!m_IsGpuCullingEnabled)
+    {
+        return;
+    }
+
+    // The records might still be read by the last frame
+    vkDeviceWaitIdle(m_Device);
+    WriteCullRecords();
+    m_AreCullRecordsStale = false;
+
+    // Compare the compute shader against the cpu implementation once in debug builds
+#ifndef NDEBUG
+    if (!m_IsGpuCullingValidated)
+    {
+        m_IsGpuCullingValidated = true;
+        PrepareLandDraws();
+        m_GpuCuller.Validate(m_FrustumPlanes);
+    }
+#endif
+}
+
+void ChunkGenerator::WriteCullRecords()
+{
+    for (auto& [position, chunk] : m_ChunkMap)
+    {
+        if (chunk->GetCullSlot() == GpuCuller::m_InvalidSlot)
+        {
+            chunk->SetCullSlot(m_GpuCuller.AddChunk());
+            if (chunk->GetCullSlot() == GpuCuller::m_InvalidSlot)
+            {
+                // Drawn with the cpu culled path instead
+                continue;
+            }
+        }
+        m_GpuCuller.WriteChunk(chunk->GetCullSlot(), *chunk);
+    }
+}
+
+void ChunkGenerator::ToggleGpuMeshing()
+{
+    m_IsGpuMeshingEnabled = !m_IsGpuMeshingEnabled;
+    if (m_IsGpuMeshingEnabled)
+    {
+        MeshChunksOnGpu();
+        return;
+    }
+
+    vkDeviceWaitIdle(m_Device);
+    for (auto& [position, chunk] : m_ChunkMap)
+    {
+        chunk->DestroyGpuMesh(m_Device);
+    }
+}
+
+void ChunkGenerator::MeshChunksOnGpu()
+{
+    // Meshing waits for the queue, so no frame can still be using the replaced buffers
+    const auto start = std::chrono::high_resolution_clock::now();
+    int meshedChunks = 0;
+    uint64_t meshedFaces = 0;
+    for (auto& [position, chunk] : m_ChunkMap)
+    {
+        if (chunk->HasGpuMesh())
+        {
+            continue;
+        }
+
+        const ComputeMesher::PackedVoxels voxels = ComputeMesher::PackVoxels(
+            *chunk,
+            GetChunkAtPosition(position + glm::ivec3{ 1, 0, 0 }),
+            GetChunkAtPosition(position + glm::ivec3{ -1, 0, 0 }),
+            GetChunkAtPosition(position + glm::ivec3{ 0, 0, -1 }),
+            GetChunkAtPosition(position + glm::ivec3{ 0, 0, 1 }));
+
+        const GpuMesh gpuMesh = m_ComputeMesher.MeshChunk(voxels);
+        meshedFaces += gpuMesh.faceCount;
+        ++meshedChunks;
+
+        // Compare one chunk against the cpu implementation of the shader in debug builds
+#ifndef NDEBUG
+        if (!m_IsGpuMeshValidated)
+        {
+            m_IsGpuMeshValidated = true;
+            std::cout << "Gpu mesh validation " << (m_ComputeMesher.Validate(voxels, gpuMesh) ? "passed" : "failed") << '\n';
+        }
+#endif
+
+        chunk->SetGpuMesh(m_Device, gpuMesh);
+    }
+
+    if (meshedChunks > 0)
+    {
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "Meshed " << meshedChunks << " chunks (" << meshedFaces << " faces) on the gpu in " << milliseconds << " ms\n";
+    }
+}
+
+void ChunkGenerator::ToggleFaceRendering()
+{
+    if (m_pPipelineLayout3D == nullptr)
+    {
+        return;
+    }
+
+    m_IsFaceRenderingEnabled = !m_IsFaceRenderingEnabled;
+    if (m_IsFaceRenderingEnabled)
+    {
+        CreateFaceMeshes();
+        return;
+    }
+
+    vkDeviceWaitIdle(m_Device);
+    for (auto& [position, chunk] : m_ChunkMap)
+    {
+        chunk->DestroyFaceMesh(m_Device, m_pPipelineLayout3D);
+    }
+}
+
+void ChunkGenerator::CreateFaceMeshes()
+{
+    // Uploading waits for the queue, so no frame can still be using the replaced buffers
+    const auto start = std::chrono::high_resolution_clock::now();
+    int createdChunks = 0;
+    size_t uploadedBytes = 0;
+    for (auto& [position, chunk] : m_ChunkMap)
+    {
+        if (chunk->HasFaceMesh())
+        {
+            continue;
+        }
+
+        chunk->CreateFaceMesh(m_Device, m_PhysicalDevice, m_CommandPool, *m_pPipelineLayout3D);
+        uploadedBytes += chunk->GetFaceRecordByteSize();
+        ++createdChunks;
+    }
+
+    if (createdChunks == 0)
+    {
+        return;
+    }
+    const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    // Both paths upload exactly their gpu buffers, so the sizes are the upload bandwidth as well
+    uint64_t faceCount = 0;
+    size_t indexedBytes = 0;
+    size_t faceRecordBytes = 0;
+    size_t ownIndexBytes = 0;
+    for (const auto& [position, chunk] : m_ChunkMap)
+    {
+        faceCount += chunk->GetLandFaceCount();
+        indexedBytes += chunk->GetIndexedLandByteSize();
+        faceRecordBytes += chunk->GetFaceRecordByteSize();
+        ownIndexBytes += chunk->GetOwnIndexByteSize();
+    }
+
+    std::cout << "Uploaded the face records of " << createdChunks << " chunks (" << uploadedBytes / 1024 << " KB) in " << milliseconds << " ms\n";
+    std::cout << "Land of " << m_ChunkMap.size() << " chunks, " << faceCount << " faces: indexed quads " << indexedBytes / 1024
+        << " KB, face records " << faceRecordBytes / 1024 << " KB (" << (faceRecordBytes > 0 ? static_cast<double>(indexedBytes) / faceRecordBytes : 0.0) << "x smaller)\n";
+    // Every chunk used to upload 32 bit indices for its land and water quads, now they all share one 16 bit buffer
+    const size_t sharedIndexBytes = static_cast<size_t>(m_QuadIndexBuffer.GetByteSize());
+    std::cout << "Quad indices: " << ownIndexBytes / 1024 << " KB as 32 bit buffers per chunk, " << sharedIndexBytes / 1024 << " KB shared, "
+        << (ownIndexBytes > sharedIndexBytes ? (ownIndexBytes - sharedIndexBytes) / 1024 : 0) << " KB saved\n";
+}
+
+void ChunkGenerator::SortWaterDrawOrder()
+{
+    ScopedTimer timer{ "water sorting" };
+    m_WaterDrawOrder.Sort(Camera::GetInstance().m_Position, m_PlayerChunkPosition);
+}
+
+uint64_t ChunkGenerator::MarkReachableSections()
+{
+    struct SectionNode
+    {
+        Chunk* chunk;
+        glm::ivec3 chunkPosition;
+        glm::ivec3 section;
+        int entryFace;
+        uint8_t travelledFaces;
+    };
+
+    const glm::vec3& cameraPosition = Camera::GetInstance().m_Position;
+    const glm::ivec3 cameraBlock = glm::ivec3(glm::floor(cameraPosition + glm::vec3(0.5f)));
+    const glm::ivec3 cameraChunkPosition{ FloorDivide(cameraBlock.x, Chunk::m_Width), 0, FloorDivide(cameraBlock.z, Chunk::m_Depth) };
+
+    for (const auto& [position, chunk] : m_ChunkMap)
+    {
+        for (int section = 0; section < Chunk::m_SectionCount; ++section)
+        {
+            chunk->SetSectionVisible(section, false);
+        }
+    }
+
+    std::vector<SectionNode> queue;
+    const auto visit = [&queue](Chunk* chunk, const glm::ivec3& chunkPosition, const glm::ivec3& section, int entryFace, uint8_t travelledFaces)
+        {
+            chunk->SetSectionVisible(Chunk::GetSectionIndex(section.x, section.y, section.z), true);
+            queue.push_back({ chunk, chunkPosition, section, entryFace, travelledFaces });
+        };
+
+    Chunk* cameraChunk = GetChunkAtPosition(cameraChunkPosition);
+    if (cameraBlock.y >= 0 && cameraBlock.y < Chunk::m_Height)
+    {
+        if (cameraChunk == nullptr || cameraChunk->IsMarkedForDeletion())
+        {
+            // Nothing to start from, draw everything
+            for (const auto& [position, chunk] : m_ChunkMap)
+            {
+                for (int section = 0; section < Chunk::m_SectionCount; ++section)
+                {
+                    chunk->SetSectionVisible(section, true);
+                }
+            }
+            return 0;
+        }
+
+        const glm::ivec3 localBlock = cameraBlock - cameraChunk->GetPosition();
+        visit(cameraChunk, cameraChunkPosition, localBlock / Chunk::m_SectionSize, -1, 0);
+    }
+    else
+    {
+        // The camera is above or below the world, enter every section of the closest layer from outside
+        const bool isAbove = cameraBlock.y >= Chunk::m_Height;
+        const int sectionY = isAbove ? Chunk::m_SectionsY - 1 : 0;
+        const int entryFace = static_cast<int>(isAbove ? Direction::Up : Direction::Down);
+        const uint8_t travelledFaces = static_cast<uint8_t>(1 << SectionConnectivity::GetOppositeFace(entryFace));
+        for (const auto& [position, chunk] : m_ChunkMap)
+        {
+            if (chunk->IsMarkedForDeletion())
+            {
+                continue;
+            }
+
+            for (int sectionZ = 0; sectionZ < Chunk::m_SectionsZ; ++sectionZ)
+            {
+                for (int sectionX = 0; sectionX < Chunk::m_SectionsX; ++sectionX)
+                {
+                    glm::vec3 min, max;
+                    chunk->GetSectionBounds(Chunk::GetSectionIndex(sectionX, sectionY, sectionZ), min, max);
+                    if (m_OcclusionCuller.IsInFrustum(min, max))
+                    {
+                        visit(chunk.get(), position, { sectionX, sectionY, sectionZ }, entryFace, travelledFaces);
+                    }
+                }
+            }
+        }
+    }
+
+    const glm::ivec3 sectionCount{ Chunk::m_SectionsX, Chunk::m_SectionsY, Chunk::m_SectionsZ };
+    const auto getConnectivity = [](const SectionNode& node)
+        {
+            return node.chunk->GetSectionConnectivity(Chunk::GetSectionIndex(node.section.x, node.section.y, node.section.z));
+        };
+    const auto enter = [this, &sectionCount](const SectionNode& node, int face, SectionNode& neighbor)
+        {
+            const std::array<int, 3> offset = SectionConnectivity::GetFaceOffset(face);
+            glm::ivec3 section = node.section + glm::ivec3(offset[0], offset[1], offset[2]);
+            glm::ivec3 chunkPosition = node.chunkPosition;
+            if (section.y < 0 || section.y >= sectionCount.y)
+            {
+                return false;
+            }
+
+            // Step into the neighboring chunk when leaving the current one
+            if (section.x < 0 || section.x >= sectionCount.x)
+            {
+                chunkPosition.x += offset[0];
+                section.x -= offset[0] * sectionCount.x;
+            }
+            if (section.z < 0 || section.z >= sectionCount.z)
+            {
+                chunkPosition.z += offset[2];
+                section.z -= offset[2] * sectionCount.z;
+            }
+
+            Chunk* chunk = chunkPosition == node.chunkPosition ? node.chunk : GetChunkAtPosition(chunkPosition);
+            if (chunk == nullptr || chunk->IsMarkedForDeletion())
+            {
+                return false;
+            }
+
+            const int sectionIndex = Chunk::GetSectionIndex(section.x, section.y, section.z);
+            if (chunk->IsSectionVisible(sectionIndex))
+            {
+                return false;
+            }
+
+            glm::vec3 min, max;
+            chunk->GetSectionBounds(sectionIndex, min, max);
+            if (!m_OcclusionCuller.IsInFrustum(min, max))
+            {
+                return false;
+            }
+
+            chunk->SetSectionVisible(sectionIndex, true);
+            neighbor.chunk = chunk;
+            neighbor.chunkPosition = chunkPosition;
+            neighbor.section = section;
+            return true;
+        };
+    SectionConnectivity::Search(queue, getConnectivity, enter);
+
+    return queue.size();
+}
 
 // fractals, frequency, amplitude, lacunarity, persistence
 // 8, 0.005f, 1.f, 2.f, 0.25f
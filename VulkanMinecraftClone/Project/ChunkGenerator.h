@@ -9,6 +9,15 @@
 #include <thread>
 #include <mutex>
 #include "CommandPool.h"
+#include "OcclusionCuller.h"
+#include "ComputeMesher.h"
+#include "ChunkDrawOrder.h"
+#include "WaterDrawOrder.h"
+#include "GpuCuller.h"
+#include "ChunkPool.h"
+#include "FaceTable.h"
+#include "TerrainColumn.h"
+#include "Profiler.h"
 
 namespace std 
 {
@@ -32,10 +41,8 @@ private:
     static const int m_ViewDistance;
     static const int m_LoadDistance;
     static const int m_Padding; 
-    static const int m_NoiseFractals; 
     static const float m_ChunkDeletionTime; 
     std::unique_ptr<SimplexNoise> m_pSimplexNoise;
-    std::unordered_map<BlockType, BlockData> m_BlockData{};
     float m_WaterTimer{};
 
     struct Offset
@@ -63,58 +70,6 @@ public:
 public:
     void Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
 
-    void LoadBlockData(const std::string& jsonFilePath)
-    {
-        // Open the JSON file
-        std::ifstream jsonFile(jsonFilePath);
-        if (!jsonFile.is_open()) {
-            // Handle error: unable to open JSON file
-            return;
-        }
-
-        // Parse JSON data
-        nlohmann::json jsonData;
-        jsonFile >> jsonData;
-
-        // Check if "blocks" array exists
-        if (!jsonData.contains("blocks")) {
-            // Handle error: "blocks" array not found
-            return;
-        }
-
-        // Get the array of blocks
-        auto blocks = jsonData["blocks"];
-
-        // Iterate over each block type
-        for (size_t i = 0; i < blocks.size(); ++i) {
-            // Extract block data
-            BlockData blockData;
-            blockData.id = blocks[i]["id"];
-            auto texturesJson = blocks[i]["textures"];
-            int index = 0; // Counter for direction index
-            for (auto it = texturesJson.begin(); it != texturesJson.end(); ++it) {
-                Direction direction = static_cast<Direction>(index);
-                blockData.textures[direction] = { it.value()["row"], it.value()["col"] };
-                ++index; // Increment index for next direction
-            }
-
-            // Add block data to the map
-            m_BlockData[GetBlockType(i)] = blockData;
-        }
-    }
-
-    BlockType GetBlockType(size_t index) const
-    {
-        // Return the block type based on the index
-        // We assume that the block types are defined in the same order as in the JSON file
-        return static_cast<BlockType>(index);
-    }
-
-    const std::unordered_map<BlockType, BlockData>& GetBlockData() const
-    {
-        return m_BlockData;
-    }
-
     const std::unordered_map<Direction, Offset>& GetFaceOffsets() const
     {
         return m_FaceOffsets;
@@ -122,45 +77,84 @@ public:
 
     float GetWaterTimer() const { return m_WaterTimer; }
 
-    void RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+    // Decides what the land draws of this frame are, once per frame before RenderLand
+    void PrepareLandDraws();
+    // Culls the sections on the gpu when enabled, recorded before the render pass of the frame starts
+    void RecordLandCulling(VkCommandBuffer commandBuffer)
     {
-        for (const auto& chunk : m_ChunkMap)
+        if (IsGpuCullingActive())
         {
-            if (!chunk.second->IsMarkedForDeletion())
+            // The fence of the last frame was waited for, so no culling pass reads the records anymore
+            if (m_AreCullRecordsStale)
             {
-                chunk.second->RenderLand(commandBuffer, pipelineLayout);
+                WriteCullRecords();
+                m_AreCullRecordsStale = false;
             }
+            m_GpuCuller.Record(commandBuffer, m_FrustumPlanes);
         }
     }
 
-    void RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+    // Can be called more than once per frame, the depth pre-pass draws the same land twice
+    void RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
     {
-        // Retrieve the camera position
-        glm::vec3 cameraPosition = Camera::GetInstance().m_Position;
+        const auto renderChunk = [&](Chunk* chunk)
+            {
+                if (chunk->IsMarkedForDeletion())
+                {
+                    return;
+                }
 
-        // Vector to store chunks with their distances
-        std::vector<std::pair<float, Chunk*>> chunkDistances;
+                if (m_IsFaceRenderingEnabled)
+                {
+                    chunk->RenderFaces(commandBuffer, *m_pPipelineLayout3D);
+                }
+                else if (IsGpuCullingActive() && !chunk->HasGpuMesh() && chunk->GetCullSlot() != GpuCuller::m_InvalidSlot)
+                {
+                    chunk->RenderLandCulled(commandBuffer, pipelineLayout, m_QuadIndexBuffer, m_GpuCuller);
+                }
+                else
+                {
+                    chunk->RenderLand(commandBuffer, pipelineLayout, m_QuadIndexBuffer);
+                }
+            };
 
-        // Calculate the distance from the camera to the center of each chunk
-        for (const auto& chunk : m_ChunkMap)
+        if (m_IsFrontToBackEnabled)
         {
-            if (!chunk.second->IsMarkedForDeletion())
+            for (Chunk* chunk : m_LandDrawOrder.GetChunks())
             {
-                glm::vec3 chunkPosition = glm::vec3(chunk.second->GetPosition());
-                glm::vec3 chunkCenter = chunkPosition + glm::vec3(Chunk::m_Width / 2.0f, Chunk::m_Height / 2.0f, Chunk::m_Depth / 2.0f);
-                float distance = glm::distance(cameraPosition, chunkCenter);
-                chunkDistances.emplace_back(distance, chunk.second.get());
+                renderChunk(chunk);
             }
+            return;
         }
 
-        // Sort chunks by distance from the camera in ascending order
-        std::sort(chunkDistances.begin(), chunkDistances.end());
+        for (const auto& chunk : m_ChunkMap)
+        {
+            renderChunk(chunk.second.get());
+        }
+    }
+
+    void RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
+    {
+        // The order only changes noticeably when the player enters another chunk or chunks are added
+        if (!m_WaterDrawOrder.IsSorted(m_PlayerChunkPosition))
+        {
+            SortWaterDrawOrder();
+        }
 
-        // Render the water in the sorted order
-        for (const auto& [distance, chunk] : chunkDistances)
+        // Render the water in the sorted order, far away chunks use the merged surface
+        uint64_t drawnWaterFaces = 0;
+        for (const auto& [distance, center, chunk] : m_WaterDrawOrder.GetEntries())
         {
-            chunk->RenderWater(commandBuffer, pipelineLayout);
+            if (chunk->IsMarkedForDeletion())
+            {
+                continue;
+            }
+
+            const bool isLod = m_IsWaterLodEnabled && distance > m_WaterLodDistance;
+            chunk->RenderWater(commandBuffer, pipelineLayout, isLod, m_QuadIndexBuffer);
+            drawnWaterFaces += chunk->GetWaterQuadCount(isLod);
         }
+        Profiler::GetInstance().AddCount("water faces drawn", drawnWaterFaces);
     }
 
     void Update()
@@ -189,13 +183,7 @@ public:
 
     int GetHeight(const glm::ivec3& globalPosition)
     {
-        float noise = m_pSimplexNoise->fractal(m_NoiseFractals, globalPosition.x, globalPosition.z);
-        int terrainHeight = static_cast<int>(noise * (Chunk::m_Height * (Chunk::m_MaxHeight - Chunk::m_MinHeight)) + Chunk::m_Height * Chunk::m_MinHeight);
-
-        // Clamp terrainHeight to ensure it's within the range [0, m_Height]
-        terrainHeight = std::clamp(terrainHeight, 0, Chunk::m_Height);
-
-        return terrainHeight;
+        return GetTerrainHeight(*m_pSimplexNoise, globalPosition.x, globalPosition.z, Chunk::m_Height, Chunk::m_MinHeight, Chunk::m_MaxHeight);
     }
 
     void DestroyDeletedChunks()
@@ -205,7 +193,17 @@ public:
         {
             if ((*it).second->IsDeleted())
             {
+                (*it).second->DestroyFaceMesh(m_Device, m_pPipelineLayout3D);
                 (*it).second->Destroy(m_Device);
+                m_WaterDrawOrder.Remove((*it).second.get());
+                m_LandDrawOrder.Remove((*it).second.get());
+                if ((*it).second->GetCullSlot() != GpuCuller::m_InvalidSlot)
+                {
+                    // The slot can't be reused while the last frame is still culling it
+                    const uint32_t cullSlot = (*it).second->GetCullSlot();
+                    DeletionQueue::GetInstance().Enqueue([this, cullSlot]() { m_GpuCuller.RemoveChunk(cullSlot); });
+                }
+                m_ChunkPool.Release(std::move((*it).second));
                 it = m_ChunkMap.erase(it); // Erase the current element and get the iterator to the next element
                 std::cout << "Destroyed a chunk!\n";
             }
@@ -216,16 +214,79 @@ public:
         }
     }
 
+    // The pipeline layout is destroyed first, the face descriptor sets go with its pool
     void Destroy()
     {
         for (auto& chunk : m_ChunkMap)
         {
             chunk.second->Destroy(m_Device);
         }
+        // Also gives the cull slots back, so before the culler is destroyed
+        DeletionQueue::GetInstance().DestroyAll();
+        m_ComputeMesher.Destroy();
+        m_GpuCuller.Destroy();
+        m_QuadIndexBuffer.Destroy(m_Device);
     }
 
     float GetChunkDeletionTime() const { return m_ChunkDeletionTime; }
 
+    // Reuses the storage of unloaded chunks for the new ones instead of allocating it again
+    void ToggleChunkPooling() { m_ChunkPool.SetEnabled(!m_ChunkPool.IsEnabled()); }
+    const ChunkPool& GetChunkPool() const { return m_ChunkPool; }
+
+    // Destroys chunkCount random chunks inside the load distance and loads them again, to stress the chunk lifetime.
+    // The chunks are destroyed in this update and created in the next one, while the last frame may still draw them.
+    // Returns how many chunks were destroyed.
+    int ChurnChunks(int chunkCount);
+
+    void ToggleOcclusionCulling() { m_IsOcclusionCullingEnabled = !m_IsOcclusionCullingEnabled; }
+    bool IsOcclusionCullingEnabled() const { return m_IsOcclusionCullingEnabled; }
+
+    void ToggleWaterLod() { m_IsWaterLodEnabled = !m_IsWaterLodEnabled; }
+    bool IsWaterLodEnabled() const { return m_IsWaterLodEnabled; }
+
+    // Remeshes the land of all chunks with or without ambient occlusion, the land shader variant follows it as well
+    void ToggleAmbientOcclusion();
+    bool IsAmbientOcclusionEnabled() const { return m_IsAmbientOcclusionEnabled; }
+
+    // Picks the shader variant that fades distant chunks into the sky
+    void ToggleFog() { m_IsFogEnabled = !m_IsFogEnabled; }
+    bool IsFogEnabled() const { return m_IsFogEnabled; }
+    // Distance in blocks up to which chunks are loaded around the player
+    static float GetViewDistanceInBlocks() { return static_cast<float>(m_ViewDistance * Chunk::m_Width); }
+
+    // Frustum culls the sections of the indexed land in a compute shader instead of culling them on the cpu.
+    // Only frustum culling, the portal and occlusion culling of the cpu path are skipped.
+    void ToggleGpuCulling();
+    bool IsGpuCullingEnabled() const { return m_IsGpuCullingEnabled; }
+
+    // Draws the opaque land closest chunk first instead of in the order of the chunk map
+    void ToggleFrontToBack() { m_IsFrontToBackEnabled = !m_IsFrontToBackEnabled; }
+    void SetFrontToBackEnabled(bool isEnabled) { m_IsFrontToBackEnabled = isEnabled; }
+    bool IsFrontToBackEnabled() const { return m_IsFrontToBackEnabled; }
+
+    // Draws the land a first time with only depth, so the fragment shader only runs for the closest fragments.
+    // Only worth it when the fragment shader is heavier than drawing the land twice.
+    void ToggleDepthPrePass() { m_IsDepthPrePassEnabled = !m_IsDepthPrePassEnabled; }
+    bool IsDepthPrePassEnabled() const { return m_IsDepthPrePassEnabled; }
+
+    // Switches the land of all chunks between the cpu mesher and the compute shader mesher
+    void ToggleGpuMeshing();
+    bool IsGpuMeshingEnabled() const { return m_IsGpuMeshingEnabled; }
+
+    // Draws the land of all chunks from face records with the vertex pulling pipeline instead of indexed quads
+    void ToggleFaceRendering();
+    bool IsFaceRenderingEnabled() const { return m_IsFaceRenderingEnabled; }
+
+    // Owns the descriptor sets of the face records, set once the 3D pipelines exist
+    void SetPipelineLayout(PipelineLayout3D* pPipelineLayout) { m_pPipelineLayout3D = pPipelineLayout; }
+
+    // Replaces the block at a world block position and relights and remeshes the chunks around it.
+    // Returns false when the block isn't loaded or water is involved, the water isn't lit.
+    bool SetBlock(const glm::ivec3& blockPosition, BlockType blockType);
+    // Finds the first land block along the ray and the block the ray passed through right before it
+    bool PickBlock(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, glm::ivec3& hitBlock, glm::ivec3& previousBlock);
+
     Chunk* GetChunkAtPosition(const glm::ivec3& position)
     {
         auto it = m_ChunkMap.find(position);
@@ -245,6 +306,78 @@ private:
 
     glm::ivec3 m_PlayerChunkPosition;
 
+    OcclusionCuller m_OcclusionCuller{};
+    bool m_IsOcclusionCullingEnabled{ true };
+    // Distance from the camera to a chunk center after which the merged water surface is drawn
+    static constexpr float m_WaterLodDistance = 2.f * Chunk::m_Width;
+    bool m_IsWaterLodEnabled{ true };
+    bool m_IsAmbientOcclusionEnabled{ true };
+    bool m_IsFogEnabled{ false };
+
+    LightEngine m_LightEngine{ [this](const glm::ivec3& chunkPosition)
+        {
+            Chunk* chunk = GetChunkAtPosition(chunkPosition);
+            return chunk != nullptr ? LightEngine::ChunkView{ &chunk->GetBlocks(), &chunk->GetLight() } : LightEngine::ChunkView{ nullptr, nullptr };
+        } };
+    // Chunks created since the last lighting pass
+    std::vector<glm::ivec3> m_UnlitChunks;
+
+    // Lights the new chunks and meshes their land, the loaded chunks next to them are remeshed when their light changed
+    void LightNewChunks();
+
+    ComputeMesher m_ComputeMesher{};
+    // Indices of every land and water quad of every chunk
+    QuadIndexBuffer m_QuadIndexBuffer{};
+    bool m_IsGpuMeshingEnabled{};
+    bool m_IsGpuMeshValidated{};
+
+    // Meshes the land of every chunk that has no gpu mesh yet with the compute shader
+    void MeshChunksOnGpu();
+
+    PipelineLayout3D* m_pPipelineLayout3D{};
+    bool m_IsFaceRenderingEnabled{};
+
+    // Uploads the face records of every chunk that has none yet and compares the memory with the indexed quads
+    void CreateFaceMeshes();
+
+    ChunkPool m_ChunkPool{};
+    GpuCuller m_GpuCuller{};
+    GpuCuller::FrustumPlanes m_FrustumPlanes{};
+    bool m_IsGpuCullingEnabled{};
+    bool m_IsGpuCullingValidated{};
+
+    // The face records are still culled on the cpu
+    bool IsGpuCullingActive() const { return m_IsGpuCullingEnabled && !m_IsFaceRenderingEnabled; }
+    // Hands out the slots of the new chunks and rewrites the section records of every chunk after remeshing
+    void WriteCullRecords();
+    // Set after remeshing, the records are written in RecordLandCulling once the last frame is done with them
+    bool m_AreCullRecordsStale{};
+
+    ChunkDrawOrder m_LandDrawOrder{};
+    bool m_IsFrontToBackEnabled{ true };
+    bool m_IsDepthPrePassEnabled{};
+
+    WaterDrawOrder m_WaterDrawOrder{};
+
+    void AddToWaterDrawOrder(Chunk* chunk)
+    {
+        const glm::vec3 halfChunk{ Chunk::m_Width / 2.0f, Chunk::m_Height / 2.0f, Chunk::m_Depth / 2.0f };
+        m_WaterDrawOrder.Add(chunk, glm::vec3(chunk->GetPosition()) + halfChunk);
+    }
+
+    // Refreshes the distances and re-sorts the previous order, which is nearly sorted already
+    void SortWaterDrawOrder();
+
+    // Decides which sections of the loaded chunks are drawn this frame
+    void CullSections();
+    // Marks the sections that can be reached from the camera section as visible, returns the amount visited
+    uint64_t MarkReachableSections();
+
+    static int FloorDivide(int value, int divisor)
+    {
+        return (value >= 0) ? value / divisor : (value - divisor + 1) / divisor;
+    }
+
     glm::ivec3 CalculateChunkPosition(const glm::vec3& position) const
     {
         // Calculate the chunk position based on the player's position
@@ -300,7 +433,7 @@ private:
                     //    m_Device,
                     //    m_PhysicalDevice,
                     //    m_CommandPool));
-                    m_ChunkMap[chunkPosition] = std::make_unique<Chunk>(
+                    m_ChunkMap[chunkPosition] = m_ChunkPool.Acquire(
                         glm::ivec3(
                             chunkPosition.x * Chunk::m_Width,
                             chunkPosition.y * Chunk::m_Height,
@@ -310,12 +443,26 @@ private:
                         m_Device,
                         m_PhysicalDevice,
                         m_CommandPool);
+                    AddToWaterDrawOrder(m_ChunkMap[chunkPosition].get());
+                    m_UnlitChunks.push_back(chunkPosition);
 
                     // Load neighbor chunks based on padding
                     LoadNeighborChunks(chunkPosition);
                 }
             }
         }
+
+        // All neighbors exist now, so the borders of the new chunks can be lit and meshed
+        m_LandDrawOrder.Invalidate();
+        LightNewChunks();
+        if (m_IsGpuMeshingEnabled)
+        {
+            MeshChunksOnGpu();
+        }
+        if (m_IsFaceRenderingEnabled)
+        {
+            CreateFaceMeshes();
+        }
     }
 
     void LoadNeighborChunks(const glm::ivec3& chunkPosition)
@@ -328,7 +475,7 @@ private:
                 glm::ivec3 neighborChunkPosition = { chunkPosition.x + dx, 0, chunkPosition.z + dz };
                 if (!IsChunkLoaded(neighborChunkPosition))
                 {
-                    m_ChunkMap[neighborChunkPosition] = std::make_unique<Chunk>(
+                    m_ChunkMap[neighborChunkPosition] = m_ChunkPool.Acquire(
                         glm::ivec3(
                             neighborChunkPosition.x * Chunk::m_Width,
                             neighborChunkPosition.y * Chunk::m_Height,
@@ -338,6 +485,8 @@ private:
                         m_Device,
                         m_PhysicalDevice,
                         m_CommandPool);
+                    AddToWaterDrawOrder(m_ChunkMap[neighborChunkPosition].get());
+                    m_UnlitChunks.push_back(neighborChunkPosition);
                 }
             }
         }
@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "Chunk.h"
+
+// Recycles the chunks that were unloaded, a new chunk takes over the block, light and mesh storage of an old one
+// instead of allocating half a megabyte of blocks and growing its vertex vectors from nothing again.
+// The gpu buffers are not pooled, those go through the DeletionQueue.
+class ChunkPool final
+{
+public:
+    // Enough for the chunks unloaded while flying over a few chunk borders, about a megabyte each
+    static constexpr size_t m_MaxPooledChunks = 32;
+
+    // Loads a chunk at the position, in a pooled chunk if there is one. The land is meshed once the chunk is lit.
+    std::unique_ptr<Chunk> Acquire(const glm::ivec3& position, SimplexNoise* noise, VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
+    {
+        if (!m_IsEnabled || m_FreeChunks.empty())
+        {
+            ++m_CreatedCount;
+            return std::make_unique<Chunk>(position, noise, device, physicalDevice, commandPool);
+        }
+
+        std::unique_ptr<Chunk> chunk = std::move(m_FreeChunks.back());
+        m_FreeChunks.pop_back();
+        chunk->Load(position, device, physicalDevice, commandPool);
+        ++m_ReusedCount;
+        return chunk;
+    }
+
+    // Takes a chunk whose gpu resources were destroyed already
+    void Release(std::unique_ptr<Chunk> chunk)
+    {
+        if (!m_IsEnabled || m_FreeChunks.size() == m_MaxPooledChunks)
+        {
+            return;
+        }
+
+        chunk->Reset();
+        m_FreeChunks.push_back(std::move(chunk));
+    }
+
+    void SetEnabled(bool isEnabled)
+    {
+        m_IsEnabled = isEnabled;
+        if (!m_IsEnabled)
+        {
+            m_FreeChunks.clear();
+        }
+    }
+    bool IsEnabled() const { return m_IsEnabled; }
+
+    size_t GetPooledCount() const { return m_FreeChunks.size(); }
+    uint64_t GetCreatedCount() const { return m_CreatedCount; }
+    uint64_t GetReusedCount() const { return m_ReusedCount; }
+
+private:
+    std::vector<std::unique_ptr<Chunk>> m_FreeChunks;
+    bool m_IsEnabled{ true };
+    uint64_t m_CreatedCount{};
+    uint64_t m_ReusedCount{};
+};
@@ -0,0 +1,288 @@
+#include "ComputeMesher.h"
+#include "ChunkGenerator.h"
+#include "PipelineCache.h"
+#include "vulkanbase/VulkanUtil.h"
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+
+ComputeMesher::PackedVoxels ComputeMesher::PackVoxels(const Chunk& chunk, const Chunk* pEast, const Chunk* pWest, const Chunk* pNorth, const Chunk* pSouth)
+{
+	const auto getBlocks = [](const Chunk* pChunk) { return pChunk != nullptr ? &pChunk->GetBlocks() : nullptr; };
+	return PackedVoxelMesher::PackVoxels(chunk.GetBlocks(), getBlocks(pEast), getBlocks(pWest), getBlocks(pNorth), getBlocks(pSouth));
+}
+
+void ComputeMesher::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
+{
+	m_Device = device;
+	m_PhysicalDevice = physicalDevice;
+	m_CommandPool = commandPool;
+	m_FaceTextures = PackedVoxelMesher::CreateFaceTextures();
+
+	const VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	CreateBuffer(m_Device, m_PhysicalDevice, sizeof(uint32_t) * ((m_PaddedBlockCount + 3) / 4),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible, m_VoxelBuffer, m_VoxelBufferMemory, MemoryTag::Voxels);
+	CreateBuffer(m_Device, m_PhysicalDevice, sizeof(uint32_t) * m_FaceTextures.size(),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible, m_FaceTextureBuffer, m_FaceTextureBufferMemory);
+	CreateBuffer(m_Device, m_PhysicalDevice, sizeof(VkDrawIndexedIndirectCommand),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, hostVisible, m_CounterBuffer, m_CounterBufferMemory);
+
+	void* data;
+	vkMapMemory(m_Device, m_FaceTextureBufferMemory, 0, sizeof(uint32_t) * m_FaceTextures.size(), 0, &data);
+	memcpy(data, m_FaceTextures.data(), sizeof(uint32_t) * m_FaceTextures.size());
+	vkUnmapMemory(m_Device, m_FaceTextureBufferMemory);
+
+	CreateDescriptorSetLayout();
+	CreatePipeline();
+	CreateDescriptorSet();
+}
+
+void ComputeMesher::Destroy()
+{
+	vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
+	vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+	vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_Device, m_DescriptorSetLayout, nullptr);
+
+	vkDestroyBuffer(m_Device, m_VoxelBuffer, nullptr);
+	FreeMemory(m_Device, m_VoxelBufferMemory);
+	vkDestroyBuffer(m_Device, m_FaceTextureBuffer, nullptr);
+	FreeMemory(m_Device, m_FaceTextureBufferMemory);
+	vkDestroyBuffer(m_Device, m_CounterBuffer, nullptr);
+	FreeMemory(m_Device, m_CounterBufferMemory);
+}
+
+GpuMesh ComputeMesher::MeshChunk(const PackedVoxels& voxels)
+{
+	void* data;
+	vkMapMemory(m_Device, m_VoxelBufferMemory, 0, sizeof(uint32_t) * voxels.size(), 0, &data);
+	memcpy(data, voxels.data(), sizeof(uint32_t) * voxels.size());
+	vkUnmapMemory(m_Device, m_VoxelBufferMemory);
+
+	// Counting pass, the geometry bindings are never written so the counter buffer stands in for them
+	Dispatch(m_CounterBuffer, m_CounterBuffer, m_CounterBuffer, true, 0);
+
+	VkDrawIndexedIndirectCommand counted;
+	vkMapMemory(m_Device, m_CounterBufferMemory, 0, sizeof(counted), 0, &data);
+	memcpy(&counted, data, sizeof(counted));
+	vkUnmapMemory(m_Device, m_CounterBufferMemory);
+
+	GpuMesh gpuMesh{};
+	gpuMesh.faceCount = counted.indexCount / 6;
+
+	// Buffers can't be empty, a chunk without faces still gets room for one
+	const VkDeviceSize faceCapacity = std::max<VkDeviceSize>(gpuMesh.faceCount, 1);
+	CreateBuffer(m_Device, m_PhysicalDevice, faceCapacity * 4 * sizeof(Vertex),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, gpuMesh.vertexBuffer, gpuMesh.vertexBufferMemory, MemoryTag::Meshes);
+	CreateBuffer(m_Device, m_PhysicalDevice, faceCapacity * 6 * sizeof(uint32_t),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, gpuMesh.indexBuffer, gpuMesh.indexBufferMemory, MemoryTag::Meshes);
+	CreateBuffer(m_Device, m_PhysicalDevice, sizeof(VkDrawIndexedIndirectCommand),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, gpuMesh.drawCommandBuffer, gpuMesh.drawCommandBufferMemory, MemoryTag::Meshes);
+
+	Dispatch(gpuMesh.vertexBuffer, gpuMesh.indexBuffer, gpuMesh.drawCommandBuffer, false, gpuMesh.faceCount);
+
+	return gpuMesh;
+}
+
+bool ComputeMesher::Validate(const PackedVoxels& voxels, const GpuMesh& gpuMesh)
+{
+	std::vector<Vertex> expectedVertices;
+	std::vector<uint32_t> expectedIndices;
+	MeshOnCpu(voxels, m_FaceTextures, expectedVertices, expectedIndices);
+
+	if (expectedVertices.size() != static_cast<size_t>(gpuMesh.faceCount) * 4)
+	{
+		std::cout << "Gpu mesh validation failed: " << gpuMesh.faceCount << " faces instead of " << expectedVertices.size() / 4 << '\n';
+		return false;
+	}
+	if (expectedVertices.empty())
+	{
+		return true;
+	}
+
+	const VkDeviceSize bufferSize = sizeof(Vertex) * expectedVertices.size();
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	CreateBuffer(m_Device, m_PhysicalDevice, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
+	CopyBuffer(m_Device, m_CommandPool, gpuMesh.vertexBuffer, stagingBuffer, bufferSize);
+
+	std::vector<Vertex> gpuVertices(expectedVertices.size());
+	void* data;
+	vkMapMemory(m_Device, stagingBufferMemory, 0, bufferSize, 0, &data);
+	memcpy(gpuVertices.data(), data, static_cast<size_t>(bufferSize));
+	vkUnmapMemory(m_Device, stagingBufferMemory);
+	vkDestroyBuffer(m_Device, stagingBuffer, nullptr);
+	FreeMemory(m_Device, stagingBufferMemory);
+
+	// The faces are appended in a different order on the gpu, compare them as sorted quads
+	using Quad = std::array<float, 4 * sizeof(Vertex) / sizeof(float)>;
+	const auto toQuads = [](const std::vector<Vertex>& vertices)
+		{
+			std::vector<Quad> quads(vertices.size() / 4);
+			memcpy(quads.data(), vertices.data(), sizeof(Vertex) * vertices.size());
+			std::sort(quads.begin(), quads.end());
+			return quads;
+		};
+
+	if (toQuads(gpuVertices) != toQuads(expectedVertices))
+	{
+		std::cout << "Gpu mesh validation failed: the faces don't match the cpu mesher\n";
+		return false;
+	}
+	return true;
+}
+
+void ComputeMesher::CreateDescriptorSetLayout()
+{
+	// Voxels, face textures, vertices, indices and the draw command
+	std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+	for (uint32_t binding = 0; binding < bindings.size(); ++binding)
+	{
+		bindings[binding].binding = binding;
+		bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[binding].descriptorCount = 1;
+		bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create compute mesher descriptor set layout!");
+	}
+}
+
+void ComputeMesher::CreatePipeline()
+{
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PushConstants);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+	if (vkCreatePipelineLayout(m_Device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create compute mesher pipeline layout!");
+	}
+
+	const std::vector<char> shaderCode = readFile("shaders/meshChunk.comp.spv");
+	VkShaderModuleCreateInfo shaderModuleInfo{};
+	shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shaderModuleInfo.codeSize = shaderCode.size();
+	shaderModuleInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+
+	VkShaderModule shaderModule;
+	if (vkCreateShaderModule(m_Device, &shaderModuleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shader module!");
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shaderModule;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = m_PipelineLayout;
+
+	const VkResult result = vkCreateComputePipelines(m_Device, PipelineCache::GetInstance().GetHandle(), 1, &pipelineInfo, nullptr, &m_Pipeline);
+	vkDestroyShaderModule(m_Device, shaderModule, nullptr);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to create compute mesher pipeline!");
+	}
+}
+
+void ComputeMesher::CreateDescriptorSet()
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 5;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = 1;
+
+	if (vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create compute mesher descriptor pool!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_DescriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_DescriptorSetLayout;
+
+	if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_DescriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate compute mesher descriptor set!");
+	}
+}
+
+void ComputeMesher::Dispatch(VkBuffer vertexBuffer, VkBuffer indexBuffer, VkBuffer drawCommandBuffer, bool isCounting, uint32_t faceCapacity)
+{
+	// The queue is idle after every dispatch so the single descriptor set can be rewritten
+	const std::array<VkBuffer, 5> buffers{ m_VoxelBuffer, m_FaceTextureBuffer, vertexBuffer, indexBuffer, drawCommandBuffer };
+	std::array<VkDescriptorBufferInfo, 5> bufferInfos{};
+	std::array<VkWriteDescriptorSet, 5> descriptorWrites{};
+	for (uint32_t binding = 0; binding < buffers.size(); ++binding)
+	{
+		bufferInfos[binding].buffer = buffers[binding];
+		bufferInfos[binding].offset = 0;
+		bufferInfos[binding].range = VK_WHOLE_SIZE;
+
+		descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[binding].dstSet = m_DescriptorSet;
+		descriptorWrites[binding].dstBinding = binding;
+		descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[binding].descriptorCount = 1;
+		descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+	}
+	vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(m_Device, m_CommandPool);
+
+	// Reset the draw command, the index count is the face counter
+	const VkDrawIndexedIndirectCommand drawCommand{ 0, 1, 0, 0, 0 };
+	vkCmdUpdateBuffer(commandBuffer, drawCommandBuffer, 0, sizeof(drawCommand), &drawCommand);
+
+	VkMemoryBarrier resetBarrier{};
+	resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+
+	const BlockRegistry& blockRegistry = BlockRegistry::GetInstance();
+	const PushConstants pushConstants{ isCounting ? 1u : 0u, faceCapacity,
+		blockRegistry.GetOpaqueMask(), blockRegistry.GetLayerMask(RenderLayer::Land), blockRegistry.GetCullSameTypeMask() };
+	vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+
+	constexpr uint32_t blockCount = Chunk::m_Width * Chunk::m_Height * Chunk::m_Depth;
+	vkCmdDispatch(commandBuffer, (blockCount + m_WorkGroupSize - 1) / m_WorkGroupSize, 1, 1);
+
+	// Make the results visible to the host for the count and to the draws for the geometry
+	VkMemoryBarrier resultBarrier{};
+	resultBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	resultBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT | VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+		VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 1, &resultBarrier, 0, nullptr, 0, nullptr);
+
+	endSingleTimeCommands(m_Device, m_CommandPool, commandBuffer);
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "BlockMesh.h"
+#include "Chunk.h"
+#include "PackedVoxelMesher.h"
+
+// Alternative land mesher that generates the faces of a chunk in a compute shader (shaders/meshChunk.comp).
+// The blocks of a chunk plus a one block border of its neighbors are packed four to a word and uploaded to a
+// storage buffer, every invocation checks one block and appends its visible faces with an atomic counter.
+// The counter is the index count of the indirect draw command, so the faces are drawn without a readback.
+// A first counting pass sizes the geometry buffers of the chunk, the second pass fills them.
+class ComputeMesher final
+{
+public:
+	static constexpr int m_PaddedWidth = PackedVoxelMesher::m_PaddedWidth;
+	static constexpr int m_PaddedDepth = PackedVoxelMesher::m_PaddedDepth;
+	static constexpr int m_PaddedBlockCount = PackedVoxelMesher::m_PaddedBlockCount;
+	static constexpr int m_WorkGroupSize = 64;
+
+	using PackedVoxels = PackedVoxelMesher::PackedVoxels;
+
+	// Neighbors that aren't loaded are treated as air, same as the cpu mesher does at the chunk border
+	static PackedVoxels PackVoxels(const Chunk& chunk, const Chunk* pEast, const Chunk* pWest, const Chunk* pNorth, const Chunk* pSouth);
+
+	// Cpu implementation of the compute shader, emits the faces in block order
+	static void MeshOnCpu(const PackedVoxels& voxels, const std::vector<uint32_t>& faceTextures, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		PackedVoxelMesher::MeshOnCpu(voxels, faceTextures, vertices, indices);
+	}
+
+public:
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
+	void Destroy();
+
+	GpuMesh MeshChunk(const PackedVoxels& voxels);
+
+	// Reads the gpu mesh back and compares its faces with the cpu implementation, the order of the faces is ignored
+	bool Validate(const PackedVoxels& voxels, const GpuMesh& gpuMesh);
+
+private:
+	VkDevice m_Device{ VK_NULL_HANDLE };
+	VkPhysicalDevice m_PhysicalDevice{ VK_NULL_HANDLE };
+	VkCommandPool m_CommandPool{ VK_NULL_HANDLE };
+
+	VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+	VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+	VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+	VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+	VkPipeline m_Pipeline{ VK_NULL_HANDLE };
+
+	// Host visible input buffers, reused for every chunk
+	VkBuffer m_VoxelBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_VoxelBufferMemory{ VK_NULL_HANDLE };
+	VkBuffer m_FaceTextureBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_FaceTextureBufferMemory{ VK_NULL_HANDLE };
+	// Draw command the counting pass writes to, read back to size the geometry buffers
+	VkBuffer m_CounterBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_CounterBufferMemory{ VK_NULL_HANDLE };
+
+	std::vector<uint32_t> m_FaceTextures;
+
+	struct PushConstants
+	{
+		uint32_t isCounting;
+		uint32_t faceCapacity;
+		// One bit per block type, see BlockRegistry
+		uint32_t opaqueMask;
+		uint32_t landMask;
+		uint32_t cullSameTypeMask;
+	};
+
+	void CreateDescriptorSetLayout();
+	void CreatePipeline();
+	void CreateDescriptorSet();
+	void Dispatch(VkBuffer vertexBuffer, VkBuffer indexBuffer, VkBuffer drawCommandBuffer, bool isCounting, uint32_t faceCapacity);
+};
@@ -0,0 +1,20 @@
+#include "DeletionQueue.h"
+#include "Profiler.h"
+#include "vulkanbase/VulkanUtil.h"
+
+size_t DeletionQueue::Collect(size_t maxFrees)
+{
+	const size_t freedCount = Collect(maxFrees, [this](VkBuffer buffer, VkDeviceMemory memory)
+		{
+			vkDestroyBuffer(m_Device, buffer, nullptr);
+			FreeMemory(m_Device, memory);
+		});
+	Profiler::GetInstance().AddCount("resources freed", freedCount);
+	return freedCount;
+}
+
+void DeletionQueue::DestroyAll()
+{
+	m_CompletedFrameCount = m_SubmittedFrameCount;
+	Collect(SIZE_MAX);
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+
+// Destroys gpu resources once no submitted frame can use them anymore.
+// Every resource is tagged with the number of frames submitted when it was retired, the last of those frames
+// may still draw with it. Render marks the frames as completed after waiting on the fence and frees what became
+// safe after the next frame was submitted, so the frees overlap with the gpu instead of stalling the update.
+// At most m_MaxFreesPerFrame resources are freed per frame, the rest waits for the next one.
+class DeletionQueue final
+{
+public:
+	static constexpr size_t m_MaxFreesPerFrame = 256;
+
+	static DeletionQueue& GetInstance()
+	{
+		static DeletionQueue instance;
+		return instance;
+	}
+
+	DeletionQueue(const DeletionQueue&) = delete;
+	DeletionQueue(DeletionQueue&&) noexcept = delete;
+	DeletionQueue& operator=(const DeletionQueue&) = delete;
+	DeletionQueue& operator=(DeletionQueue&&) noexcept = delete;
+
+	void Initialize(VkDevice device) { m_Device = device; }
+
+	// Destroys the buffer and frees its memory once the frames submitted so far have finished
+	void DestroyBuffer(VkBuffer buffer, VkDeviceMemory memory)
+	{
+		if (buffer == VK_NULL_HANDLE && memory == VK_NULL_HANDLE)
+		{
+			return;
+		}
+		m_Buffers.push_back(PendingBuffer{ m_SubmittedFrameCount, buffer, memory });
+		UpdatePeak();
+	}
+	// For everything that isn't a buffer, destroy runs once the frames submitted so far have finished
+	void Enqueue(std::function<void()> destroy)
+	{
+		m_Functions.push_back(PendingFunction{ m_SubmittedFrameCount, std::move(destroy) });
+		UpdatePeak();
+	}
+
+	// Call after a frame was submitted
+	void OnFrameSubmitted() { ++m_SubmittedFrameCount; }
+	// Call after waiting on the fence of the last submitted frame, there is only one frame in flight
+	void OnFramesCompleted() { m_CompletedFrameCount = m_SubmittedFrameCount; }
+	// Frees what the completed frames were the last to use, returns how many resources were freed
+	size_t Collect(size_t maxFrees = m_MaxFreesPerFrame);
+	// Collect with the destruction of the buffers passed in as destroyBuffer(buffer, memory), so the
+	// frame tracking runs without a device
+	template<typename DestroyBufferFunction>
+	size_t Collect(size_t maxFrees, DestroyBufferFunction destroyBuffer);
+	// Frees everything, the device has to be idle
+	void DestroyAll();
+
+	size_t GetPendingCount() const { return m_Buffers.size() + m_Functions.size(); }
+	size_t GetPeakPendingCount() const { return m_PeakPendingCount; }
+	uint64_t GetFreedCount() const { return m_FreedCount; }
+	uint64_t GetSubmittedFrameCount() const { return m_SubmittedFrameCount; }
+
+private:
+	DeletionQueue() = default;
+	~DeletionQueue() = default;
+
+	struct PendingBuffer
+	{
+		// Safe to destroy once this many frames have completed
+		uint64_t frame;
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+	};
+
+	struct PendingFunction
+	{
+		uint64_t frame;
+		std::function<void()> destroy;
+	};
+
+	VkDevice m_Device{ VK_NULL_HANDLE };
+	uint64_t m_SubmittedFrameCount{};
+	uint64_t m_CompletedFrameCount{};
+
+	// Both are in frame order, so collecting stops at the first entry that is still in use
+	std::deque<PendingBuffer> m_Buffers{};
+	std::deque<PendingFunction> m_Functions{};
+
+	size_t m_PeakPendingCount{};
+	uint64_t m_FreedCount{};
+
+	void UpdatePeak() { m_PeakPendingCount = std::max(m_PeakPendingCount, GetPendingCount()); }
+};
+
+template<typename DestroyBufferFunction>
+size_t DeletionQueue::Collect(size_t maxFrees, DestroyBufferFunction destroyBuffer)
+{
+	size_t freedCount = 0;
+	while (freedCount < maxFrees && !m_Buffers.empty() && m_Buffers.front().frame <= m_CompletedFrameCount)
+	{
+		const PendingBuffer& pending = m_Buffers.front();
+		destroyBuffer(pending.buffer, pending.memory);
+		m_Buffers.pop_front();
+		++freedCount;
+	}
+	while (freedCount < maxFrees && !m_Functions.empty() && m_Functions.front().frame <= m_CompletedFrameCount)
+	{
+		m_Functions.front().destroy();
+		m_Functions.pop_front();
+		++freedCount;
+	}
+
+	m_FreedCount += freedCount;
+	return freedCount;
+}
@@ -0,0 +1,81 @@
+#include "FaceRecordBuilder.h"
+#include <array>
+
+static_assert(BlockRegistry::m_AtlasSize * BlockRegistry::m_AtlasSize <= FaceRecordBuilder::m_MaxLayer + 1, "every atlas tile has to fit in the layer bits");
+
+void FaceRecordBuilder::Build(const ChunkBlocks& blocks, int height, int depth, int sectionSize,
+    TaggedVector<FaceRecord, MemoryTag::Meshes>& records, std::vector<SectionRange>& sectionRanges)
+{
+    const int sectionsX = m_RowLength / sectionSize;
+    const int sectionsY = height / sectionSize;
+    const int sectionsZ = depth / sectionSize;
+
+    records.clear();
+    sectionRanges.assign(static_cast<size_t>(sectionsX) * sectionsY * sectionsZ, SectionRange{});
+    if (height > m_MaxHeight || depth > m_MaxDepth)
+    {
+        return;
+    }
+
+    FaceVisibility faceVisibility{ height, depth };
+    faceVisibility.Build(blocks);
+
+    // Layer of every face of every block type, looked up once instead of for every face
+    const BlockRegistry& blockRegistry = BlockRegistry::GetInstance();
+    std::array<uint32_t, BlockRegistry::m_BlockTypeCount * BlockRegistry::m_FaceCount> faceLayers{};
+    for (size_t blockType = 0; blockType < BlockRegistry::m_BlockTypeCount; ++blockType)
+    {
+        for (size_t face = 0; face < BlockRegistry::m_FaceCount; ++face)
+        {
+            faceLayers[blockType * BlockRegistry::m_FaceCount + face] = blockRegistry.GetFaceLayer(static_cast<BlockType>(blockType), static_cast<Direction>(face));
+        }
+    }
+
+    // Visible faces of every row of a slab of sections, indexed with (y - slabY) + (z - slabZ) * sectionSize
+    std::vector<FaceVisibility::FaceMasks> slabFaces(static_cast<size_t>(sectionSize) * sectionSize);
+    std::vector<FaceVisibility::RowMask> slabVisible(static_cast<size_t>(sectionSize) * sectionSize);
+
+    for (int sectionZ = 0; sectionZ < sectionsZ; ++sectionZ)
+    {
+        for (int sectionY = 0; sectionY < sectionsY; ++sectionY)
+        {
+            for (int z = 0; z < sectionSize; ++z)
+            {
+                for (int y = 0; y < sectionSize; ++y)
+                {
+                    const int row = y + z * sectionSize;
+                    slabVisible[row] = faceVisibility.GetVisibleFaces(sectionY * sectionSize + y, sectionZ * sectionSize + z, slabFaces[row]);
+                }
+            }
+
+            for (int sectionX = 0; sectionX < sectionsX; ++sectionX)
+            {
+                SectionRange& sectionRange = sectionRanges[sectionX + sectionY * sectionsX + sectionZ * sectionsX * sectionsY];
+                sectionRange.firstFace = static_cast<uint32_t>(records.size());
+
+                const int firstX = sectionX * sectionSize;
+                const FaceVisibility::RowMask sectionBits = ((FaceVisibility::RowMask{ 1 } << sectionSize) - 1) << firstX;
+                for (int row = 0; row < sectionSize * sectionSize; ++row)
+                {
+                    FaceVisibility::RowMask visibleBlocks = slabVisible[row] & sectionBits;
+                    while (visibleBlocks != 0)
+                    {
+                        const int x = FaceVisibility::PopLowestBit(visibleBlocks);
+                        const int y = sectionY * sectionSize + row % sectionSize;
+                        const int z = sectionZ * sectionSize + row / sectionSize;
+                        const size_t blockType = static_cast<size_t>(blocks.Get(x, y, z));
+                        for (int face = 0; face < FACE_COUNT; ++face)
+                        {
+                            if ((slabFaces[row][face] >> x) & 1)
+                            {
+                                records.push_back(Pack(x, y, z, static_cast<Direction>(face), faceLayers[blockType * BlockRegistry::m_FaceCount + face]));
+                            }
+                        }
+                    }
+                }
+
+                sectionRange.faceCount = static_cast<uint32_t>(records.size()) - sectionRange.firstFace;
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BlockRegistry.h"
+#include "FaceVisibility.h"
+
+// One visible block face packed in 32 bits: x in bits 0 - 5, y in bits 6 - 12, z in bits 13 - 18,
+// the Direction in bits 19 - 21 and the texture array layer in bits 22 - 29.
+// shaders/shaderFace.vert unpacks it and builds the corners from gl_VertexIndex, so a face is 4 bytes
+// instead of 4 Vertex structs and 6 indices. Like the compute mesher, the faces carry no ambient occlusion or light.
+using FaceRecord = uint32_t;
+
+// Turns the blocks of a chunk into face records, grouped per section in section order the same way the land
+// quads of a Chunk are, so every section is a single range of faces.
+// Nothing in here needs Vulkan, the records can be built and checked headless.
+class FaceRecordBuilder final
+{
+public:
+    static constexpr int m_RowLength = FaceVisibility::m_RowLength;
+    static constexpr int m_MaxHeight = 128;
+    static constexpr int m_MaxDepth = 64;
+    static constexpr uint32_t m_MaxLayer = 255;
+    // Every face is drawn as two triangles without an index buffer
+    static constexpr int m_VerticesPerFace = 6;
+
+    struct SectionRange
+    {
+        uint32_t firstFace;
+        uint32_t faceCount;
+    };
+
+    static FaceRecord Pack(int x, int y, int z, Direction direction, uint32_t layer)
+    {
+        return static_cast<uint32_t>(x)
+            | (static_cast<uint32_t>(y) << 6)
+            | (static_cast<uint32_t>(z) << 13)
+            | (static_cast<uint32_t>(direction) << 19)
+            | (layer << 22);
+    }
+
+    static void Unpack(FaceRecord record, int& x, int& y, int& z, Direction& direction, uint32_t& layer)
+    {
+        x = static_cast<int>(record & 0x3F);
+        y = static_cast<int>((record >> 6) & 0x7F);
+        z = static_cast<int>((record >> 13) & 0x3F);
+        direction = static_cast<Direction>((record >> 19) & 0x7);
+        layer = (record >> 22) & 0xFF;
+    }
+
+    // Replaces the contents of records and sectionRanges, sections are indexed like Chunk::GetSectionIndex.
+    static void Build(const ChunkBlocks& blocks, int height, int depth, int sectionSize,
+        TaggedVector<FaceRecord, MemoryTag::Meshes>& records, std::vector<SectionRange>& sectionRanges);
+};
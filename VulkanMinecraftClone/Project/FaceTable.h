@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Geometry of the six block faces, indexed with the Direction enum: Down, East, North, South, Up, West.
+// Shared by the cpu meshers; shaders/meshChunk.comp and shaders/shaderFace.vert hold the same table.
+struct FaceDefinition
+{
+    // Corners relative to the block center in units of half a block, counter clockwise seen from outside
+    std::array<std::array<int8_t, 3>, 4> corners;
+    std::array<int8_t, 3> normal;
+    // Texture corner of every corner, u is 0 for left and 1 for right, v is 0 for top and 1 for bottom
+    std::array<std::array<uint8_t, 2>, 4> texCorners;
+};
+
+inline constexpr int FACE_COUNT = 6;
+
+inline constexpr std::array<FaceDefinition, FACE_COUNT> FACE_TABLE{ {
+    // Down
+    { { { { -1, -1, -1 }, { 1, -1, -1 }, { 1, -1, 1 }, { -1, -1, 1 } } }, { 0, -1, 0 }, { { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } } } },
+    // East
+    { { { { 1, -1, 1 }, { 1, -1, -1 }, { 1, 1, -1 }, { 1, 1, 1 } } }, { 1, 0, 0 }, { { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } } } },
+    // North
+    { { { { -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 } } }, { 0, 0, -1 }, { { { 1, 1 }, { 1, 0 }, { 0, 0 }, { 0, 1 } } } },
+    // South
+    { { { { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 }, { -1, -1, 1 } } }, { 0, 0, 1 }, { { { 1, 1 }, { 1, 0 }, { 0, 0 }, { 0, 1 } } } },
+    // Up
+    { { { { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 }, { -1, 1, -1 } } }, { 0, 1, 0 }, { { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } } } },
+    // West
+    { { { { -1, -1, -1 }, { -1, -1, 1 }, { -1, 1, 1 }, { -1, 1, -1 } } }, { -1, 0, 0 }, { { { 0, 1 }, { 1, 1 }, { 1, 0 }, { 0, 0 } } } }
+} };
+
+// Writes the four vertices of a face of the block at position straight into the output, a vector of the Vertex of
+// BlockMesh.h. The ambient occlusion level of every corner goes from 0 for fully occluded to 3 for open.
+template<typename VertexVector>
+void WriteFaceVertices(VertexVector& vertices, int faceIndex, const glm::vec3& position, float textureLayer,
+    const std::array<uint8_t, 4>& ambientOcclusion, const glm::vec2& light)
+{
+    // Brightness of every ambient occlusion level, fully occluded corners keep some light
+    constexpr std::array<float, 4> ambientOcclusionBrightness{ 0.4f, 0.6f, 0.8f, 1.f };
+
+    const FaceDefinition& face = FACE_TABLE[faceIndex];
+    const glm::vec3 normal{ face.normal[0], face.normal[1], face.normal[2] };
+
+    // Split the quad along the darker diagonal, otherwise a single dark corner only shades one of the triangles.
+    // The shared quad indices always split from the first vertex, so the corners are rotated to start at the right one.
+    const size_t firstCorner = ambientOcclusion[0] + ambientOcclusion[2] > ambientOcclusion[1] + ambientOcclusion[3] ? 1 : 0;
+
+    const size_t vertexOffset = vertices.size();
+    vertices.resize(vertexOffset + 4);
+    auto* pVertex = &vertices[vertexOffset];
+    for (size_t vertex = 0; vertex < face.corners.size(); ++vertex, ++pVertex)
+    {
+        const size_t corner = (vertex + firstCorner) % face.corners.size();
+        const auto& offset = face.corners[corner];
+        const auto& texCorner = face.texCorners[corner];
+        pVertex->position = { position.x + offset[0] * 0.5f, position.y + offset[1] * 0.5f, position.z + offset[2] * 0.5f };
+        pVertex->normal = normal;
+        pVertex->texCoord = { texCorner[0], texCorner[1], textureLayer };
+        pVertex->ambientOcclusion = ambientOcclusionBrightness[ambientOcclusion[corner]];
+        pVertex->light = light;
+    }
+}
@@ -0,0 +1,133 @@
+#include "FaceVisibility.h"
+
+FaceVisibility::FaceVisibility(int height, int depth)
+    :
+    m_Height{ height },
+    m_Depth{ depth },
+    m_LandRows(static_cast<size_t>(height) * depth),
+    m_OpaqueRows(static_cast<size_t>(height) * depth),
+    m_SameTypeRows(static_cast<size_t>(height) * depth)
+{
+}
+
+void FaceVisibility::Build(const ChunkBlocks& blocks)
+{
+    m_pBlocks = &blocks;
+
+    const BlockRegistry& blockRegistry = BlockRegistry::GetInstance();
+    const uint32_t landMask = blockRegistry.GetLayerMask(RenderLayer::Land);
+    const uint32_t opaqueMask = blockRegistry.GetOpaqueMask();
+    const uint32_t sameTypeMask = landMask & blockRegistry.GetCullSameTypeMask() & ~opaqueMask;
+
+    // Land, opaque and same type bit of every block type
+    std::array<uint8_t, BlockRegistry::m_BlockTypeCount> typeFlags{};
+    for (uint32_t blockType = 0; blockType < typeFlags.size(); ++blockType)
+    {
+        typeFlags[blockType] = static_cast<uint8_t>(((landMask >> blockType) & 1) | (((opaqueMask >> blockType) & 1) << 1) | (((sameTypeMask >> blockType) & 1) << 2));
+    }
+
+    for (int z = 0; z < m_Depth; ++z)
+    {
+        for (int y = 0; y < m_Height; ++y)
+        {
+            RowMask land = 0;
+            RowMask opaque = 0;
+            RowMask sameType = 0;
+            const auto addBlock = [&](int x, BlockType blockType)
+                {
+                    const RowMask flags = typeFlags[static_cast<size_t>(blockType)];
+                    land |= (flags & 1) << x;
+                    opaque |= ((flags >> 1) & 1) << x;
+                    sameType |= (flags >> 2) << x;
+                };
+
+            if constexpr (ChunkBlocks::LayoutType::m_IsRowContiguous)
+            {
+                const BlockType* pRow = blocks.GetData() + ChunkBlocks::GetIndex(0, y, z);
+                for (int x = 0; x < m_RowLength; ++x)
+                {
+                    addBlock(x, pRow[x]);
+                }
+            }
+            else
+            {
+                for (int x = 0; x < m_RowLength; ++x)
+                {
+                    addBlock(x, blocks.Get(x, y, z));
+                }
+            }
+
+            const int row = y + z * m_Height;
+            m_LandRows[row] = land;
+            m_OpaqueRows[row] = opaque;
+            m_SameTypeRows[row] = sameType;
+        }
+    }
+}
+
+FaceVisibility::RowMask FaceVisibility::GetVisibleFaces(int y, int z, FaceMasks& faceMasks) const
+{
+    const int row = y + z * m_Height;
+    const RowMask land = m_LandRows[row];
+    if (land == 0)
+    {
+        return 0;
+    }
+
+    // Bit x of every mask holds the opacity of the neighbor of block x
+    const RowMask opaque = m_OpaqueRows[row];
+    faceMasks[static_cast<int>(Direction::Down)] = land & ~GetOpaqueRow(y - 1, z);
+    faceMasks[static_cast<int>(Direction::East)] = land & ~(opaque >> 1);
+    faceMasks[static_cast<int>(Direction::North)] = land & ~GetOpaqueRow(y, z - 1);
+    faceMasks[static_cast<int>(Direction::South)] = land & ~GetOpaqueRow(y, z + 1);
+    faceMasks[static_cast<int>(Direction::Up)] = land & ~GetOpaqueRow(y + 1, z);
+    faceMasks[static_cast<int>(Direction::West)] = land & ~(opaque << 1);
+
+    // Opaque blocks already hid their own type above, only the see through ones are left
+    const RowMask sameType = m_SameTypeRows[row];
+    RowMask visible = 0;
+    for (int face = 0; face < FACE_COUNT; ++face)
+    {
+        RowMask candidates = faceMasks[face] & sameType;
+        const auto& offset = FACE_TABLE[face].normal;
+        while (candidates != 0)
+        {
+            const int x = PopLowestBit(candidates);
+            if (GetBlock(x, y, z) == GetBlock(x + offset[0], y + offset[1], z + offset[2]))
+            {
+                faceMasks[face] &= ~(RowMask{ 1 } << x);
+            }
+        }
+        visible |= faceMasks[face];
+    }
+    return visible;
+}
+
+void FaceVisibility::GetAmbientOcclusion(int x, int y, int z, int face, std::array<uint8_t, 4>& levels) const
+{
+    const FaceDefinition& faceDefinition = FACE_TABLE[face];
+    const auto& normal = faceDefinition.normal;
+    // The two axes that lie in the plane of the face
+    const int normalAxis = normal[0] != 0 ? 0 : (normal[1] != 0 ? 1 : 2);
+    const int firstAxis = (normalAxis + 1) % 3;
+    const int secondAxis = (normalAxis + 2) % 3;
+
+    for (int corner = 0; corner < 4; ++corner)
+    {
+        // The corners are in half block units, on the normal axis that is the block in front of the face
+        std::array<int, 3> offset{ faceDefinition.corners[corner][0], faceDefinition.corners[corner][1], faceDefinition.corners[corner][2] };
+        const bool isCornerOpaque = IsOpaque(x + offset[0], y + offset[1], z + offset[2]);
+
+        const int secondOffset = offset[secondAxis];
+        offset[secondAxis] = 0;
+        const bool isFirstSideOpaque = IsOpaque(x + offset[0], y + offset[1], z + offset[2]);
+
+        offset[secondAxis] = secondOffset;
+        offset[firstAxis] = 0;
+        const bool isSecondSideOpaque = IsOpaque(x + offset[0], y + offset[1], z + offset[2]);
+
+        levels[corner] = isFirstSideOpaque && isSecondSideOpaque
+            ? 0
+            : static_cast<uint8_t>(3 - isFirstSideOpaque - isSecondSideOpaque - isCornerOpaque);
+    }
+}
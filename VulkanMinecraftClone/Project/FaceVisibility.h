@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "BlockRegistry.h"
+#include "VoxelStorage.h"
+#include "FaceTable.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Finds the visible faces of a chunk a whole row of blocks at a time.
+// Every (y, z) row along x is stored as a 64 bit mask, one bit per block, so the six neighbor tests of a row
+// are a few shifts and ands instead of 6 * 64 block lookups. Blocks outside of the chunk count as air.
+class FaceVisibility final
+{
+public:
+    static constexpr int m_RowLength = 64;
+
+    using RowMask = uint64_t;
+    // One mask per face in Direction order, a set bit means the face of that block is visible
+    using FaceMasks = std::array<RowMask, FACE_COUNT>;
+
+    FaceVisibility(int height, int depth);
+
+    void Build(const ChunkBlocks& blocks);
+
+    // Returns the blocks of the row that have at least one visible face
+    RowMask GetVisibleFaces(int y, int z, FaceMasks& faceMasks) const;
+
+    bool IsOpaque(int x, int y, int z) const
+    {
+        if (x < 0 || x >= m_RowLength)
+        {
+            return false;
+        }
+        return (GetOpaqueRow(y, z) >> x) & 1;
+    }
+
+    // Ambient occlusion level of the four corners of a face, in the corner order of FACE_TABLE.
+    // 3 is unoccluded, every opaque block touching the corner in front of the face lowers it, two sides make it 0.
+    void GetAmbientOcclusion(int x, int y, int z, int face, std::array<uint8_t, 4>& levels) const;
+
+    static int PopLowestBit(RowMask& mask)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, mask);
+#else
+        const int index = __builtin_ctzll(mask);
+#endif
+        mask &= mask - 1;
+        return static_cast<int>(index);
+    }
+
+private:
+    int m_Height;
+    int m_Depth;
+    const ChunkBlocks* m_pBlocks{};
+
+    // Indexed with y + z * height
+    std::vector<RowMask> m_LandRows;
+    std::vector<RowMask> m_OpaqueRows;
+    // Land blocks that hide faces towards their own type without being opaque, these need a per block type check
+    std::vector<RowMask> m_SameTypeRows;
+
+    RowMask GetOpaqueRow(int y, int z) const
+    {
+        if (y < 0 || y >= m_Height || z < 0 || z >= m_Depth)
+        {
+            return 0;
+        }
+        return m_OpaqueRows[y + z * m_Height];
+    }
+
+    BlockType GetBlock(int x, int y, int z) const
+    {
+        if (x < 0 || x >= m_RowLength || y < 0 || y >= m_Height || z < 0 || z >= m_Depth)
+        {
+            return BlockType::Air;
+        }
+        return m_pBlocks->Get(x, y, z);
+    }
+};
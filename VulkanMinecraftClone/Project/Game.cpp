@@ -4,6 +4,8 @@
 #include <InputManager.h>
 #include <iostream>
 #include <ChunkGenerator.h>
+#include <Profiler.h>
+#include <MemoryTracker.h>
 
 void Game::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
 {
@@ -43,7 +45,10 @@ void Game::Update()
 	{
 		m_PrintTimer = 0.f;
 		std::cout << "dFPS: " << Timer::GetInstance().GetdFPS() << std::endl;
+		Profiler::GetInstance().Print();
 	}
+	MemoryTracker::GetInstance().EndFrame();
+	Profiler::GetInstance().EndFrame();
 
 	ChunkGenerator::GetInstance().Update();
 	Camera::GetInstance().Update(Timer::GetInstance().GetElapsed());
@@ -51,6 +56,72 @@ void Game::Update()
 	{
 		InputManager::GetInstance().ToggleFPSMode();
 	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_O))
+	{
+		ChunkGenerator::GetInstance().ToggleOcclusionCulling();
+		std::cout << "Occlusion culling " << (ChunkGenerator::GetInstance().IsOcclusionCullingEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_L))
+	{
+		ChunkGenerator::GetInstance().ToggleWaterLod();
+		std::cout << "Water lod " << (ChunkGenerator::GetInstance().IsWaterLodEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_K))
+	{
+		ChunkGenerator::GetInstance().ToggleAmbientOcclusion();
+		std::cout << "Ambient occlusion " << (ChunkGenerator::GetInstance().IsAmbientOcclusionEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_V))
+	{
+		ChunkGenerator::GetInstance().ToggleFog();
+		std::cout << "Fog " << (ChunkGenerator::GetInstance().IsFogEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_P))
+	{
+		ChunkGenerator::GetInstance().ToggleFaceRendering();
+		std::cout << "Face record rendering " << (ChunkGenerator::GetInstance().IsFaceRenderingEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_N))
+	{
+		ChunkGenerator::GetInstance().ToggleGpuMeshing();
+		std::cout << "Gpu meshing " << (ChunkGenerator::GetInstance().IsGpuMeshingEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_B))
+	{
+		ChunkGenerator::GetInstance().ToggleFrontToBack();
+		std::cout << "Front to back land " << (ChunkGenerator::GetInstance().IsFrontToBackEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_U))
+	{
+		ChunkGenerator::GetInstance().ToggleGpuCulling();
+		std::cout << "Gpu culling " << (ChunkGenerator::GetInstance().IsGpuCullingEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_R))
+	{
+		ChunkGenerator::GetInstance().ToggleChunkPooling();
+		std::cout << "Chunk pooling " << (ChunkGenerator::GetInstance().GetChunkPool().IsEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_Z))
+	{
+		ChunkGenerator::GetInstance().ToggleDepthPrePass();
+		std::cout << "Depth pre-pass " << (ChunkGenerator::GetInstance().IsDepthPrePassEnabled() ? "enabled" : "disabled") << std::endl;
+	}
+
+	// Removes the block in front of the camera or places stone against it
+	if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_H) || InputManager::GetInstance().IsKeyPressed(GLFW_KEY_J))
+	{
+		const bool isPlacing = InputManager::GetInstance().IsKeyPressed(GLFW_KEY_J);
+		glm::ivec3 hitBlock{};
+		glm::ivec3 previousBlock{};
+		ChunkGenerator& chunkGenerator = ChunkGenerator::GetInstance();
+		if (chunkGenerator.PickBlock(Camera::GetInstance().m_Position, Camera::GetInstance().m_Front, m_BlockReach, hitBlock, previousBlock))
+		{
+			chunkGenerator.SetBlock(isPlacing ? previousBlock : hitBlock, isPlacing ? BlockType::Stone : BlockType::Air);
+		}
+	}
+
+	// Culls and orders the land for the camera of this frame
+	ChunkGenerator::GetInstance().PrepareLandDraws();
 
 	// Do game update stuff
 	m_pScene2D->Update();
@@ -64,6 +135,11 @@ void Game::RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLa
 	ChunkGenerator::GetInstance().RenderLand(commandBuffer, pipelineLayout);
 }
 
+void Game::CullLand(VkCommandBuffer commandBuffer)
+{
+	ChunkGenerator::GetInstance().RecordLandCulling(commandBuffer);
+}
+
 void Game::RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout)
 {
 	ChunkGenerator::GetInstance().RenderWater(commandBuffer, pipelineLayout);
@@ -18,6 +18,7 @@ public:
 public:
 	void Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
 	void Update();
+	void CullLand(VkCommandBuffer commandBuffer);
 	void RenderLand(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
 	void RenderWater(VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout);
 	void Render2D(VkCommandBuffer commandBuffer);
@@ -30,4 +31,6 @@ private:
 	//std::vector<Texture> m_pTextures{};
 	float m_PrintTimer{};
 	const float m_PrintDelay{ 1.f };
+	// Distance in blocks up to which blocks can be removed and placed
+	const float m_BlockReach{ 8.f };
 };
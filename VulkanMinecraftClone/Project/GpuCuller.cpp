@@ -0,0 +1,331 @@
+#include "GpuCuller.h"
+#include "PipelineCache.h"
+#include "vulkanbase/VulkanUtil.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+
+static_assert(sizeof(VkDrawIndexedIndirectCommand) == 20, "The shader writes the draw commands as five words");
+static_assert(GpuCuller::m_SectionsPerChunk == Chunk::m_SectionCount, "a slot holds the records of every section of a chunk");
+// A section never has more quads than fit in a single draw of the QuadIndexBuffer
+static_assert(Chunk::m_SectionSize * Chunk::m_SectionSize * Chunk::m_SectionSize * 3 <= QuadIndexBuffer::m_MaxQuadsPerDraw, "a section has to fit in one draw");
+
+void GpuCuller::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
+{
+	m_Device = device;
+	m_PhysicalDevice = physicalDevice;
+	m_CommandPool = commandPool;
+
+	// Only there when the device was created with VK_KHR_draw_indirect_count
+	m_pCmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+	if (!IsSupported())
+	{
+		std::cout << "Gpu culling is unavailable, VK_KHR_draw_indirect_count is missing\n";
+		return;
+	}
+
+	const VkDeviceSize recordBufferSize = sizeof(SectionRecord) * m_MaxChunks * m_SectionsPerChunk;
+	CreateBuffer(m_Device, m_PhysicalDevice, recordBufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, m_RecordBuffer, m_RecordBufferMemory);
+	void* data;
+	vkMapMemory(m_Device, m_RecordBufferMemory, 0, recordBufferSize, 0, &data);
+	m_pRecords = static_cast<SectionRecord*>(data);
+	std::fill(m_pRecords, m_pRecords + m_MaxChunks * m_SectionsPerChunk, SectionRecord{});
+
+	const VkBufferUsageFlags resultUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT
+		| VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	CreateBuffer(m_Device, m_PhysicalDevice, sizeof(VkDrawIndexedIndirectCommand) * m_MaxChunks * m_SectionsPerChunk, resultUsage,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_DrawCommandBuffer, m_DrawCommandBufferMemory);
+	CreateBuffer(m_Device, m_PhysicalDevice, sizeof(uint32_t) * m_MaxChunks, resultUsage,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_DrawCountBuffer, m_DrawCountBufferMemory);
+
+	m_FreeSlots.clear();
+	m_UsedSlotCount = 0;
+
+	CreateDescriptorSetLayout();
+	CreatePipeline();
+	CreateDescriptorSet();
+}
+
+void GpuCuller::Destroy()
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
+	vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+	vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(m_Device, m_DescriptorSetLayout, nullptr);
+
+	vkUnmapMemory(m_Device, m_RecordBufferMemory);
+	m_pRecords = nullptr;
+	vkDestroyBuffer(m_Device, m_RecordBuffer, nullptr);
+	FreeMemory(m_Device, m_RecordBufferMemory);
+	vkDestroyBuffer(m_Device, m_DrawCommandBuffer, nullptr);
+	FreeMemory(m_Device, m_DrawCommandBufferMemory);
+	vkDestroyBuffer(m_Device, m_DrawCountBuffer, nullptr);
+	FreeMemory(m_Device, m_DrawCountBufferMemory);
+}
+
+uint32_t GpuCuller::AddChunk()
+{
+	if (!m_FreeSlots.empty())
+	{
+		const uint32_t slot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+		return slot;
+	}
+	if (m_UsedSlotCount == m_MaxChunks)
+	{
+		return m_InvalidSlot;
+	}
+	return m_UsedSlotCount++;
+}
+
+void GpuCuller::RemoveChunk(uint32_t slot)
+{
+	// Empty records are skipped by the shader
+	std::fill(m_pRecords + slot * m_SectionsPerChunk, m_pRecords + (slot + 1) * m_SectionsPerChunk, SectionRecord{});
+	m_FreeSlots.push_back(slot);
+}
+
+void GpuCuller::WriteChunk(uint32_t slot, const Chunk& chunk)
+{
+	SectionRecord* pRecords = m_pRecords + slot * m_SectionsPerChunk;
+	for (int section = 0; section < Chunk::m_SectionCount; ++section)
+	{
+		SectionRecord& record = pRecords[section];
+		chunk.GetSectionBounds(section, record.min, record.max);
+		chunk.GetSectionQuads(section, record.firstQuad, record.quadCount);
+	}
+}
+
+void GpuCuller::Record(VkCommandBuffer commandBuffer, const FrustumPlanes& planes)
+{
+	if (m_UsedSlotCount == 0)
+	{
+		return;
+	}
+
+	// Only the counts are reset, the commands past the count of a slot are never read
+	vkCmdFillBuffer(commandBuffer, m_DrawCountBuffer, 0, sizeof(uint32_t) * m_UsedSlotCount, 0);
+
+	VkMemoryBarrier resetBarrier{};
+	resetBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	resetBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	resetBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &resetBarrier, 0, nullptr, 0, nullptr);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &m_DescriptorSet, 0, nullptr);
+
+	PushConstants pushConstants{};
+	std::copy(planes.begin(), planes.end(), pushConstants.planes);
+	pushConstants.recordCount = m_UsedSlotCount * m_SectionsPerChunk;
+	vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &pushConstants);
+
+	vkCmdDispatch(commandBuffer, (pushConstants.recordCount + m_WorkGroupSize - 1) / m_WorkGroupSize, 1, 1);
+
+	VkMemoryBarrier resultBarrier{};
+	resultBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	resultBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	resultBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 1, &resultBarrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuCuller::DrawChunk(VkCommandBuffer commandBuffer, uint32_t slot) const
+{
+	constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+	const VkDeviceSize offset = static_cast<VkDeviceSize>(slot) * m_SectionsPerChunk * stride;
+	m_pCmdDrawIndexedIndirectCount(commandBuffer, m_DrawCommandBuffer, offset, m_DrawCountBuffer, sizeof(uint32_t) * slot, m_SectionsPerChunk, stride);
+}
+
+bool GpuCuller::Validate(const FrustumPlanes& planes)
+{
+	if (m_UsedSlotCount == 0)
+	{
+		return true;
+	}
+
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(m_Device, m_CommandPool);
+	// The unused commands are compared as well, so they are always cleared here
+	vkCmdFillBuffer(commandBuffer, m_DrawCommandBuffer, 0, sizeof(VkDrawIndexedIndirectCommand) * m_UsedSlotCount * m_SectionsPerChunk, 0);
+	Record(commandBuffer, planes);
+	endSingleTimeCommands(m_Device, m_CommandPool, commandBuffer);
+
+	const VkDeviceSize countSize = sizeof(uint32_t) * m_UsedSlotCount;
+	const VkDeviceSize commandSize = sizeof(VkDrawIndexedIndirectCommand) * m_UsedSlotCount * m_SectionsPerChunk;
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	CreateBuffer(m_Device, m_PhysicalDevice, countSize + commandSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
+
+	commandBuffer = beginSingleTimeCommands(m_Device, m_CommandPool);
+	VkBufferCopy countRegion{ 0, 0, countSize };
+	vkCmdCopyBuffer(commandBuffer, m_DrawCountBuffer, stagingBuffer, 1, &countRegion);
+	VkBufferCopy commandRegion{ 0, countSize, commandSize };
+	vkCmdCopyBuffer(commandBuffer, m_DrawCommandBuffer, stagingBuffer, 1, &commandRegion);
+	endSingleTimeCommands(m_Device, m_CommandPool, commandBuffer);
+
+	std::vector<uint32_t> gpuCounts(m_UsedSlotCount);
+	std::vector<VkDrawIndexedIndirectCommand> gpuCommands(static_cast<size_t>(m_UsedSlotCount) * m_SectionsPerChunk);
+	void* data;
+	vkMapMemory(m_Device, stagingBufferMemory, 0, countSize + commandSize, 0, &data);
+	memcpy(gpuCounts.data(), data, static_cast<size_t>(countSize));
+	memcpy(gpuCommands.data(), static_cast<const uint8_t*>(data) + countSize, static_cast<size_t>(commandSize));
+	vkUnmapMemory(m_Device, stagingBufferMemory);
+	vkDestroyBuffer(m_Device, stagingBuffer, nullptr);
+	FreeMemory(m_Device, stagingBufferMemory);
+
+	std::vector<uint32_t> expectedCounts;
+	std::vector<VkDrawIndexedIndirectCommand> expectedCommands;
+	SectionCuller::Cull(std::vector<SectionRecord>(m_pRecords, m_pRecords + gpuCommands.size()), planes, expectedCounts, expectedCommands);
+
+	// The sections of a slot are appended in any order on the gpu, compare them sorted on their first vertex
+	const auto byVertexOffset = [](const VkDrawIndexedIndirectCommand& a, const VkDrawIndexedIndirectCommand& b) { return a.vertexOffset < b.vertexOffset; };
+	const auto isSame = [](const VkDrawIndexedIndirectCommand& a, const VkDrawIndexedIndirectCommand& b)
+		{
+			return a.indexCount == b.indexCount && a.instanceCount == b.instanceCount && a.firstIndex == b.firstIndex
+				&& a.vertexOffset == b.vertexOffset && a.firstInstance == b.firstInstance;
+		};
+
+	uint64_t drawCount = 0;
+	for (uint32_t slot = 0; slot < m_UsedSlotCount; ++slot)
+	{
+		if (gpuCounts[slot] != expectedCounts[slot])
+		{
+			std::cout << "Gpu culling validation failed: slot " << slot << " draws " << gpuCounts[slot] << " sections instead of " << expectedCounts[slot] << '\n';
+			return false;
+		}
+
+		const auto gpuFirst = gpuCommands.begin() + static_cast<size_t>(slot) * m_SectionsPerChunk;
+		const auto expectedFirst = expectedCommands.begin() + static_cast<size_t>(slot) * m_SectionsPerChunk;
+		std::sort(gpuFirst, gpuFirst + gpuCounts[slot], byVertexOffset);
+		if (!std::equal(gpuFirst, gpuFirst + m_SectionsPerChunk, expectedFirst, isSame))
+		{
+			std::cout << "Gpu culling validation failed: the draw commands of slot " << slot << " don't match the cpu culling\n";
+			return false;
+		}
+		drawCount += gpuCounts[slot];
+	}
+
+	std::cout << "Gpu culling validation passed, " << drawCount << " sections of " << m_UsedSlotCount << " chunks drawn\n";
+	return true;
+}
+
+void GpuCuller::CreateDescriptorSetLayout()
+{
+	// Section records, draw commands and draw counts
+	std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+	for (uint32_t binding = 0; binding < bindings.size(); ++binding)
+	{
+		bindings[binding].binding = binding;
+		bindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[binding].descriptorCount = 1;
+		bindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+	layoutInfo.pBindings = bindings.data();
+
+	if (vkCreateDescriptorSetLayout(m_Device, &layoutInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create gpu culler descriptor set layout!");
+	}
+}
+
+void GpuCuller::CreatePipeline()
+{
+	VkPushConstantRange pushConstantRange{};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(PushConstants);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+	if (vkCreatePipelineLayout(m_Device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create gpu culler pipeline layout!");
+	}
+
+	const std::vector<char> shaderCode = readFile("shaders/cullSections.comp.spv");
+	VkShaderModuleCreateInfo shaderModuleInfo{};
+	shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shaderModuleInfo.codeSize = shaderCode.size();
+	shaderModuleInfo.pCode = reinterpret_cast<const uint32_t*>(shaderCode.data());
+
+	VkShaderModule shaderModule;
+	if (vkCreateShaderModule(m_Device, &shaderModuleInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shader module!");
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shaderModule;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = m_PipelineLayout;
+
+	const VkResult result = vkCreateComputePipelines(m_Device, PipelineCache::GetInstance().GetHandle(), 1, &pipelineInfo, nullptr, &m_Pipeline);
+	vkDestroyShaderModule(m_Device, shaderModule, nullptr);
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to create gpu culler pipeline!");
+	}
+}
+
+void GpuCuller::CreateDescriptorSet()
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 3;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+	poolInfo.maxSets = 1;
+
+	if (vkCreateDescriptorPool(m_Device, &poolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create gpu culler descriptor pool!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_DescriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_DescriptorSetLayout;
+
+	if (vkAllocateDescriptorSets(m_Device, &allocInfo, &m_DescriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate gpu culler descriptor set!");
+	}
+
+	// The buffers never change, so the set is written once
+	const std::array<VkBuffer, 3> buffers{ m_RecordBuffer, m_DrawCommandBuffer, m_DrawCountBuffer };
+	std::array<VkDescriptorBufferInfo, 3> bufferInfos{};
+	std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+	for (uint32_t binding = 0; binding < buffers.size(); ++binding)
+	{
+		bufferInfos[binding].buffer = buffers[binding];
+		bufferInfos[binding].offset = 0;
+		bufferInfos[binding].range = VK_WHOLE_SIZE;
+
+		descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrites[binding].dstSet = m_DescriptorSet;
+		descriptorWrites[binding].dstBinding = binding;
+		descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrites[binding].descriptorCount = 1;
+		descriptorWrites[binding].pBufferInfo = &bufferInfos[binding];
+	}
+	vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+}
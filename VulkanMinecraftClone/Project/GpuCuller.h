@@ -0,0 +1,85 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Chunk.h"
+#include "SectionCuller.h"
+
+// Frustum culls the land sections of every chunk in a compute shader (shaders/cullSections.comp).
+// Every chunk owns a slot with one record per section: its bounds and its range in the land vertex buffer.
+// The records stay in a persistently mapped buffer and are only rewritten when the land is remeshed.
+// Every frame the shader tests all records and appends the visible sections to the draw commands of their slot,
+// counting them with an atomic. A chunk is then drawn with one vkCmdDrawIndexedIndirectCountKHR, so the cpu
+// never looks at the sections. Without VK_KHR_draw_indirect_count nothing is created and the cpu culling is used.
+class GpuCuller final
+{
+public:
+	static constexpr uint32_t m_MaxChunks = 1024;
+	static constexpr uint32_t m_SectionsPerChunk = SectionCuller::m_SectionsPerChunk;
+	static constexpr uint32_t m_InvalidSlot = UINT32_MAX;
+	static constexpr uint32_t m_WorkGroupSize = 64;
+
+	using SectionRecord = SectionCuller::SectionRecord;
+	using FrustumPlanes = SectionCuller::FrustumPlanes;
+
+public:
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
+	void Destroy();
+
+	// Returns m_InvalidSlot when every slot is taken
+	uint32_t AddChunk();
+	void RemoveChunk(uint32_t slot);
+	// Copies the section bounds and quad ranges of the chunk, the gpu must not be culling meanwhile
+	void WriteChunk(uint32_t slot, const Chunk& chunk);
+
+	// Culls all slots, has to be recorded outside of a render pass before the chunks are drawn
+	void Record(VkCommandBuffer commandBuffer, const FrustumPlanes& planes);
+	// Draws the visible sections of the slot, the vertex and index buffer of the chunk have to be bound
+	void DrawChunk(VkCommandBuffer commandBuffer, uint32_t slot) const;
+
+	// Culls once, reads the draw commands back and compares them with SectionCuller::Cull, the order inside a slot is ignored
+	bool Validate(const FrustumPlanes& planes);
+
+	// Only true when the device has VK_KHR_draw_indirect_count, otherwise nothing but Init and Destroy may be called
+	bool IsSupported() const { return m_pCmdDrawIndexedIndirectCount != nullptr; }
+
+private:
+	VkDevice m_Device{ VK_NULL_HANDLE };
+	VkPhysicalDevice m_PhysicalDevice{ VK_NULL_HANDLE };
+	VkCommandPool m_CommandPool{ VK_NULL_HANDLE };
+
+	VkDescriptorSetLayout m_DescriptorSetLayout{ VK_NULL_HANDLE };
+	VkDescriptorPool m_DescriptorPool{ VK_NULL_HANDLE };
+	VkDescriptorSet m_DescriptorSet{ VK_NULL_HANDLE };
+	VkPipelineLayout m_PipelineLayout{ VK_NULL_HANDLE };
+	VkPipeline m_Pipeline{ VK_NULL_HANDLE };
+
+	// Host visible and mapped, m_SectionsPerChunk records per slot
+	VkBuffer m_RecordBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_RecordBufferMemory{ VK_NULL_HANDLE };
+	SectionRecord* m_pRecords{};
+	// m_SectionsPerChunk draw commands per slot, the visible ones first
+	VkBuffer m_DrawCommandBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_DrawCommandBufferMemory{ VK_NULL_HANDLE };
+	// One draw count per slot
+	VkBuffer m_DrawCountBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_DrawCountBufferMemory{ VK_NULL_HANDLE };
+
+	PFN_vkCmdDrawIndexedIndirectCountKHR m_pCmdDrawIndexedIndirectCount{};
+
+	std::vector<uint32_t> m_FreeSlots;
+	// Slots below this have been handed out at least once, only those are dispatched
+	uint32_t m_UsedSlotCount{};
+
+	struct PushConstants
+	{
+		glm::vec4 planes[6];
+		uint32_t recordCount;
+	};
+
+	void CreateDescriptorSetLayout();
+	void CreatePipeline();
+	void CreateDescriptorSet();
+};
@@ -23,6 +23,7 @@ public:
     virtual void BindPipeline(VkCommandBuffer commandBuffer) = 0;
 
     VkPipelineLayout GetPipelineLayout() { return m_PipelineLayout; }
+    bool UsesShader(const std::string& shaderFile) const { return m_Shaders.UsesFile(shaderFile); }
 protected:
     VkPipelineLayout m_PipelineLayout;
     VkPipeline m_GraphicsPipeline;
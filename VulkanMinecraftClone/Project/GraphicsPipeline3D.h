@@ -6,49 +6,214 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <Camera.h>
 #include "BlockMesh.h"
 #include "Texture.h"
-#include <BlockMeshGenerator.h>
+#include "PipelineLayout3D.h"
+#include "PipelineCache.h"
+#include "Profiler.h"
 
-struct UniformBufferObject
+class Camera;
+class Texture;
+
+// Vertex format consumed by the pipeline
+enum class VertexLayout
 {
-	alignas(16)	glm::mat4 view;
-	glm::mat4 proj;
+	Block,
+	Water,
+	// Face records pulled from a storage buffer, see FaceRecordBuilder
+	Face
 };
 
-struct PushConstants
+// How the fragments end up in the attachments
+enum class BlendMode
 {
-	glm::ivec3 translation;
-	float time;
+	// Transparent fragments are mixed with what is behind them
+	Alpha,
+	// Every fragment adds its color, used to count fragments
+	Additive
 };
 
-class Camera;
-class Texture;
+// Part of the depth pre-pass a pipeline draws, see ChunkGenerator::ToggleDepthPrePass
+enum class DepthPass : uint32_t
+{
+	// Tests and writes depth like any other draw
+	None,
+	// Only writes depth, there is no fragment shader
+	DepthOnly,
+	// Shades the fragments that survived the depth only pass, without writing depth again
+	Shade
+};
+
+// Feature switches of the 3D shaders, every combination is compiled into its own pipeline from the same shader source
+struct ShaderVariant
+{
+	bool isAmbientOcclusionEnabled{ true };
+	bool isFogEnabled{ false };
+	DepthPass depthPass{ DepthPass::None };
+
+	static constexpr uint32_t m_VariantCount = 12;
+
+	uint32_t GetKey() const { return (isAmbientOcclusionEnabled ? 1u : 0u) | (isFogEnabled ? 2u : 0u) | (static_cast<uint32_t>(depthPass) << 2); }
+	static ShaderVariant FromKey(uint32_t key) { return ShaderVariant{ (key & 1u) != 0, (key & 2u) != 0, static_cast<DepthPass>(key >> 2) }; }
+};
 
+// Values of the specialization constants of the 3D shaders, the constant_id of every member is its index.
+// The defaults match the values the shaders fall back to.
+struct ShaderConstants
+{
+	float lightDirection[3]{ 0.5f, 1.f, 0.5f };
+	float ambientColor[3]{ 0.5f, 0.4f, 0.3f };
+	// Lowers the water surface below the top of the block
+	float waterOffset{ -0.15f };
+	float waveSpeed{ 2.f };
+	float waveFrequency{ 0.5f };
+	float waveAmplitude{ 0.1f };
+	// Filled in from the ShaderVariant
+	VkBool32 isAmbientOcclusionEnabled{ VK_TRUE };
+	VkBool32 isFogEnabled{ VK_FALSE };
+	float fogStart{ 0.f };
+	float fogEnd{ 0.f };
+	// Same as the clear color of the RenderPass, so the terrain fades into the sky
+	float fogColor[3]{ 135 / 255.f, 206 / 255.f, 235 / 255.f };
+};
+static_assert(sizeof(ShaderConstants) % 4 == 0, "Every specialization constant is 4 bytes");
+static_assert(offsetof(ShaderConstants, waterOffset) == 6 * 4 && offsetof(ShaderConstants, isAmbientOcclusionEnabled) == 10 * 4
+	&& offsetof(ShaderConstants, fogColor) == 14 * 4, "The constant_ids in the shaders depend on this layout");
+
+// A variant of the shared PipelineLayout3D, it owns one VkPipeline per ShaderVariant.
+// The variant the game starts with is created right away, the others are prewarmed on a background thread
+// and created on first use if they aren't ready yet.
 class GraphicsPipeline3D final : public GraphicsPipeline
 {
 public:
-	GraphicsPipeline3D(VkDevice device, VkPhysicalDevice physicalDevice, VkRenderPass renderPass, const std::string& vertexShaderFile,
-		const std::string& fragmentShaderFile)
+	GraphicsPipeline3D(VkDevice device, const PipelineLayout3D& pipelineLayout, VkRenderPass renderPass, const std::string& vertexShaderFile,
+		const std::string& fragmentShaderFile, VertexLayout vertexLayout = VertexLayout::Block, const ShaderConstants& constants = {},
+		const ShaderVariant& initialVariant = {}, BlendMode blendMode = BlendMode::Alpha)
 		:
 		GraphicsPipeline{ vertexShaderFile , fragmentShaderFile },
-		m_DescriptorSetLayout{ VK_NULL_HANDLE }
+		m_VertexLayout{ vertexLayout },
+		m_BlendMode{ blendMode },
+		m_Constants{ constants },
+		m_Name{ vertexShaderFile }
 	{
+		m_PipelineLayout = pipelineLayout.GetHandle();
 		m_Shaders.Initialize(device);
 
-		CreateDescriptorSetLayout(device, m_DescriptorSetLayout);
-		CreateUniformBuffers(device, physicalDevice);
+		CreatePipeline(device, renderPass);
+		m_GraphicsPipeline = GetPipeline(initialVariant);
 
-		CreateDescriptorPool(device);
-		CreateDescriptorSets(device);
+		m_PrewarmThread = std::thread([this]()
+			{
+				for (uint32_t key = 0; key < ShaderVariant::m_VariantCount && !m_IsDestroyed; ++key)
+				{
+					GetPipeline(ShaderVariant::FromKey(key));
+				}
+			});
+	}
 
-		CreatePipeline(device, renderPass);
+	~GraphicsPipeline3D()
+	{
+		m_IsDestroyed = true;
+		if (m_PrewarmThread.joinable())
+		{
+			m_PrewarmThread.join();
+		}
 	}
 
+	// Only remembers where the variants are created, they are made by GetPipeline
 	void CreatePipeline(VkDevice device, VkRenderPass renderPass) override
 	{
+		m_Device = device;
+		m_RenderPass = renderPass;
+	}
+
+	// Returns the pipeline of the variant, creating it when it doesn't exist yet. Safe to call from several threads.
+	VkPipeline GetPipeline(const ShaderVariant& variant)
+	{
+		const uint32_t key = Normalize(variant).GetKey();
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			auto found = m_Variants.find(key);
+			if (found != m_Variants.end())
+			{
+				return found->second;
+			}
+		}
+
+		const auto startTime = std::chrono::high_resolution_clock::now();
+		VkPipeline pipeline = CreateVariant(ShaderVariant::FromKey(key));
+		const std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - startTime;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto [found, isInserted] = m_Variants.emplace(key, pipeline);
+		if (!isInserted)
+		{
+			// Another thread finished the same variant first
+			vkDestroyPipeline(m_Device, pipeline, nullptr);
+		}
+		else
+		{
+			std::cout << "Created variant " << key << " of " << m_Name << " in " << duration.count() << " ms\n";
+		}
+		return found->second;
+	}
+
+private:
+	// Variants that the shaders can't tell apart share one pipeline
+	ShaderVariant Normalize(ShaderVariant variant) const
+	{
+		if (m_VertexLayout == VertexLayout::Water || m_VertexLayout == VertexLayout::Face)
+		{
+			// Water and face records have no ambient occlusion
+			variant.isAmbientOcclusionEnabled = false;
+		}
+		if (m_VertexLayout == VertexLayout::Water)
+		{
+			// Water is transparent, it is never part of the depth pre-pass
+			variant.depthPass = DepthPass::None;
+		}
+		if (variant.depthPass == DepthPass::DepthOnly || m_BlendMode == BlendMode::Additive)
+		{
+			// Without a fragment shader or when only counting fragments the colors don't matter
+			variant.isAmbientOcclusionEnabled = false;
+			variant.isFogEnabled = false;
+		}
+		return variant;
+	}
+
+	VkPipeline CreateVariant(const ShaderVariant& variant)
+	{
+		VkDevice device = m_Device;
+		VkRenderPass renderPass = m_RenderPass;
+
+		ShaderConstants constants = m_Constants;
+		constants.isAmbientOcclusionEnabled = variant.isAmbientOcclusionEnabled ? VK_TRUE : VK_FALSE;
+		constants.isFogEnabled = variant.isFogEnabled ? VK_TRUE : VK_FALSE;
+
+		std::array<VkSpecializationMapEntry, sizeof(ShaderConstants) / 4> mapEntries{};
+		for (uint32_t i = 0; i < mapEntries.size(); ++i)
+		{
+			mapEntries[i].constantID = i;
+			mapEntries[i].offset = i * 4;
+			mapEntries[i].size = 4;
+		}
+
+		// Both stages get every constant, the ones a stage doesn't declare are ignored
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+		specializationInfo.pMapEntries = mapEntries.data();
+		specializationInfo.dataSize = sizeof(constants);
+		specializationInfo.pData = &constants;
+
 		VkPipelineViewportStateCreateInfo viewportState{};
 		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
 		viewportState.viewportCount = 1;
@@ -85,6 +250,17 @@ public:
 		colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 		colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
 		colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		if (m_BlendMode == BlendMode::Additive)
+		{
+			colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		}
+		if (variant.depthPass == DepthPass::DepthOnly)
+		{
+			colorBlendAttachment.colorWriteMask = 0;
+		}
 
 		VkPipelineColorBlendStateCreateInfo colorBlending{};
 		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -118,36 +294,35 @@ public:
 		depthStencil.stencilTestEnable = VK_FALSE;
 		depthStencil.front = {}; // Optional
 		depthStencil.back = {}; // Optional
-
-		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 1;
-		pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
-		//pipelineLayoutInfo.pushConstantRangeCount = 0;
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		VkPushConstantRange pushConstantRange = {};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // Stage the push constant is accessible from
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(PushConstants);
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-
-		pipelineLayoutInfo.flags = 0;
-
-		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS) {
-			throw std::runtime_error("failed to create pipeline layout!");
+		if (variant.depthPass == DepthPass::Shade)
+		{
+			// The depth only pass already wrote the closest depth, only the fragments at that depth pass.
+			// Both passes use the same vertex shader with an invariant gl_Position, so the depths are identical.
+			depthStencil.depthWriteEnable = VK_FALSE;
+			depthStencil.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 		}
 
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
 
 		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 
-		std::vector<VkPipelineShaderStageCreateInfo>& shaderStages =
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
 			m_Shaders.GetShaderStages();
-
+		for (VkPipelineShaderStageCreateInfo& shaderStage : shaderStages)
+		{
+			shaderStage.pSpecializationInfo = &specializationInfo;
+		}
+		if (variant.depthPass == DepthPass::DepthOnly)
+		{
+			// Nothing is shaded, the rasterizer only writes depth
+			shaderStages.erase(std::remove_if(shaderStages.begin(), shaderStages.end(),
+				[](const VkPipelineShaderStageCreateInfo& shaderStage) { return shaderStage.stage == VK_SHADER_STAGE_FRAGMENT_BIT; }),
+				shaderStages.end());
+		}
 
 		pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
 		pipelineInfo.pStages = shaderStages.data();
-		auto pvisci = m_Shaders.CreateVertexInputStateInfo();
+		auto pvisci = CreateVertexInputStateInfo();
 		pipelineInfo.pVertexInputState = pvisci.get();
 
 		auto& piasci = m_Shaders.CreateInputAssemblyStateInfo();
@@ -164,137 +339,27 @@ public:
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS) {
+		VkPipeline pipeline;
+		if (vkCreateGraphicsPipelines(device, PipelineCache::GetInstance().GetHandle(), 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create graphics pipeline!");
 		}
-
-		m_Shaders.DestroyShaderModules(device);
-	}
-
-	void CreateUniformBuffers(VkDevice device, VkPhysicalDevice physicalDevice)
-	{
-		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-
-		m_UniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-		m_UniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-		m_UniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) 
-		{
-			CreateBuffer(
-				device, 
-				physicalDevice, 
-				bufferSize, 
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-				m_UniformBuffers[i], m_UniformBuffersMemory[i]);
-
-			vkMapMemory(device, m_UniformBuffersMemory[i], 0, bufferSize, 0, &m_UniformBuffersMapped[i]);
-		}
-	}
-
-	void UpdateUniformBuffer(VkDevice device, uint32_t currentImage)
-	{
-		UniformBufferObject ubo{};
-
-		// Update view matrix using camera's view matrix
-		ubo.view = Camera::GetInstance().GetViewMatrix();
-
-		// Update projection matrix using camera's projection matrix
-		//ubo.proj = Camera::GetInstance().projectionMatrix;
-		glm::mat4 projection = glm::mat4(1.f);
-		projection = glm::perspective(
-			glm::radians(Camera::GetInstance().m_Zoom),
-			static_cast<float>(WIDTH) / HEIGHT,
-			0.1f,
-			2000.f);
-		ubo.proj = projection;
-		// Ensure correct aspect ratio
-		ubo.proj[1][1] *= -1;		
-
-		// Copy data to uniform buffer
-		memcpy(m_UniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+		return pipeline;
 	}
 
-	void CreateDescriptorPool(VkDevice device)
+	std::unique_ptr<VkPipelineVertexInputStateCreateInfo> CreateVertexInputStateInfo()
 	{
-		std::array<VkDescriptorPoolSize, 2> poolSizes{};
-		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-
-		VkDescriptorPoolCreateInfo poolInfo{};
-		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-
-		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
+		switch (m_VertexLayout)
 		{
-			throw std::runtime_error("failed to create descriptor pool!");
+		case VertexLayout::Water:
+			return m_Shaders.CreateWaterVertexInputStateInfo();
+		case VertexLayout::Face:
+			return m_Shaders.CreatePulledVertexInputStateInfo();
+		default:
+			return m_Shaders.CreateVertexInputStateInfo();
 		}
 	}
 
-	void CreateDescriptorSets(VkDevice device)
-	{
-		std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_DescriptorSetLayout);
-		VkDescriptorSetAllocateInfo allocInfo{};
-		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		allocInfo.descriptorPool = m_DescriptorPool;
-		allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-		allocInfo.pSetLayouts = layouts.data();
-
-		m_DescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
-		if (vkAllocateDescriptorSets(device, &allocInfo, m_DescriptorSets.data()) != VK_SUCCESS)
-		{
-			throw std::runtime_error("failed to allocate descriptor sets!");
-		}
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
-		{
-			VkDescriptorBufferInfo bufferInfo{};
-			bufferInfo.buffer = m_UniformBuffers[i];
-			bufferInfo.offset = 0;
-			bufferInfo.range = sizeof(UniformBufferObject);
-
-			VkWriteDescriptorSet descriptorWrite{};
-			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			descriptorWrite.dstSet = m_DescriptorSets[i];
-			descriptorWrite.dstBinding = 0;
-			descriptorWrite.dstArrayElement = 0;
-			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			descriptorWrite.descriptorCount = 1;
-			descriptorWrite.pBufferInfo = &bufferInfo;
-			descriptorWrite.pImageInfo = nullptr; // Optional
-			descriptorWrite.pTexelBufferView = nullptr; // Optional
-
-			vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
-
-			// Iterate over each texture and sampler
-			for (size_t j = 0; j < BlockMeshGenerator::GetInstance().GetTextures().size(); j++)
-			{
-				VkDescriptorImageInfo imageInfo{};
-				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-				imageInfo.imageView = BlockMeshGenerator::GetInstance().GetTextures()[j].GetImageView();  // Assuming Texture class has a method to get ImageView
-				imageInfo.sampler = BlockMeshGenerator::GetInstance().GetTextures()[j].GetSampler();
-
-				// Update descriptor write with image info
-				descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				descriptorWrite.dstSet = m_DescriptorSets[i];
-				descriptorWrite.dstBinding = static_cast<uint32_t>(j + 1);  // Assuming the first binding is used for the uniform buffer
-				descriptorWrite.dstArrayElement = 0;
-				descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-				descriptorWrite.descriptorCount = 1;
-				descriptorWrite.pBufferInfo = nullptr;
-				descriptorWrite.pImageInfo = &imageInfo;
-				descriptorWrite.pTexelBufferView = nullptr;
-
-				// Update descriptor sets
-				vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
-			}
-		}
-	}
+public:
 
 	void ConfigurePipeline() override
 	{
@@ -304,41 +369,45 @@ public:
 
 	void DestroyPipeline(VkDevice device) override
 	{
-		// Destroy the pipeline
-		vkDestroyPipeline(device, m_GraphicsPipeline, nullptr);
-		vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
-
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-			vkDestroyBuffer(device, m_UniformBuffers[i], nullptr);
-			vkFreeMemory(device, m_UniformBuffersMemory[i], nullptr);
+		m_IsDestroyed = true;
+		if (m_PrewarmThread.joinable())
+		{
+			m_PrewarmThread.join();
 		}
 
-
-		vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
-
-		vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+		// Destroy the pipelines, the layout belongs to the PipelineLayout3D
+		for (auto& [key, pipeline] : m_Variants)
+		{
+			vkDestroyPipeline(device, pipeline, nullptr);
+		}
+		m_Variants.clear();
+		m_Shaders.DestroyShaderModules(device);
 	}
 
+	// Binds the variant the pipeline was created with
 	void BindPipeline(VkCommandBuffer commandBuffer) override
 	{
 		// Bind the pipeline
 		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+		Profiler::GetInstance().AddCount("Pipeline binds", 1);
 	}
 
-	void BindDescriptorSets(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+	void BindPipeline(VkCommandBuffer commandBuffer, const ShaderVariant& variant)
 	{
-		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_DescriptorSets[imageIndex], 0, nullptr);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, GetPipeline(variant));
+		Profiler::GetInstance().AddCount("Pipeline binds", 1);
 	}
 
 private:
-	VkDescriptorSetLayout m_DescriptorSetLayout;
-
-	std::vector<VkBuffer> m_UniformBuffers;
-	std::vector<VkDeviceMemory> m_UniformBuffersMemory;
-	std::vector<void*> m_UniformBuffersMapped;
-	const size_t MAX_FRAMES_IN_FLIGHT{ 3 };
-
-	VkDescriptorPool m_DescriptorPool;
-	std::vector<VkDescriptorSet> m_DescriptorSets;
-	//std::vector<Texture> m_pTextures;
+	VertexLayout m_VertexLayout;
+	BlendMode m_BlendMode;
+	ShaderConstants m_Constants;
+	std::string m_Name;
+	VkDevice m_Device{ VK_NULL_HANDLE };
+	VkRenderPass m_RenderPass{ VK_NULL_HANDLE };
+
+	std::mutex m_Mutex;
+	std::unordered_map<uint32_t, VkPipeline> m_Variants;
+	std::thread m_PrewarmThread;
+	std::atomic<bool> m_IsDestroyed{ false };
 };
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a, used to key the caches on disk by the content they were made from
+inline uint64_t HashBytes(const void* pData, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+	const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ pBytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
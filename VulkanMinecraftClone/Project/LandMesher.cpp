@@ -0,0 +1,75 @@
+#include "LandMesher.h"
+#include "FaceTable.h"
+#include "QuadIndexBuffer.h"
+
+static_assert(ChunkBlocks::m_Width == FaceVisibility::m_RowLength, "the face visibility masks hold one row of the chunk");
+
+void LandMesher::Build(const ChunkBlocks& blocks, FaceVisibility& faceVisibility, bool isAmbientOcclusionEnabled, const LightLookup& getLight,
+    TaggedVector<Vertex, MemoryTag::Transient>& vertices, SectionRanges& sectionRanges)
+{
+    vertices.clear();
+
+    // Room for about four exposed faces per column, which covers most terrain without growing
+    vertices.reserve(ChunkBlocks::m_Width * ChunkBlocks::m_Depth * 4 * 4);
+    const auto getQuadCount = [&vertices]() { return static_cast<uint32_t>(vertices.size() / QuadIndexBuffer::m_VerticesPerQuad); };
+
+    faceVisibility.Build(blocks);
+
+    const BlockRegistry& registry = BlockRegistry::GetInstance();
+    std::array<uint8_t, 4> ambientOcclusion{ 3, 3, 3, 3 };
+
+    // Visible faces of every row of a slab of sections, indexed with (y - slabY) + (z - slabZ) * sectionSize
+    std::array<FaceVisibility::FaceMasks, m_SectionSize * m_SectionSize> slabFaces{};
+    std::array<FaceVisibility::RowMask, m_SectionSize * m_SectionSize> slabVisible{};
+
+    for (int sectionZ = 0; sectionZ < m_SectionsZ; ++sectionZ)
+    {
+        for (int sectionY = 0; sectionY < m_SectionsY; ++sectionY)
+        {
+            for (int z = 0; z < m_SectionSize; ++z)
+            {
+                for (int y = 0; y < m_SectionSize; ++y)
+                {
+                    const int row = y + z * m_SectionSize;
+                    slabVisible[row] = faceVisibility.GetVisibleFaces(sectionY * m_SectionSize + y, sectionZ * m_SectionSize + z, slabFaces[row]);
+                }
+            }
+
+            for (int sectionX = 0; sectionX < m_SectionsX; ++sectionX)
+            {
+                SectionRange& sectionRange = sectionRanges[sectionX + sectionY * m_SectionsX + sectionZ * m_SectionsX * m_SectionsY];
+                sectionRange.firstQuad = getQuadCount();
+
+                const int firstX = sectionX * m_SectionSize;
+                const FaceVisibility::RowMask sectionBits = ((FaceVisibility::RowMask{ 1 } << m_SectionSize) - 1) << firstX;
+                for (int row = 0; row < m_SectionSize * m_SectionSize; ++row)
+                {
+                    FaceVisibility::RowMask visibleBlocks = slabVisible[row] & sectionBits;
+                    while (visibleBlocks != 0)
+                    {
+                        const int x = FaceVisibility::PopLowestBit(visibleBlocks);
+                        const int y = sectionY * m_SectionSize + row % m_SectionSize;
+                        const int z = sectionZ * m_SectionSize + row / m_SectionSize;
+                        const BlockType blockType = blocks.Get(x, y, z);
+                        for (int face = 0; face < FACE_COUNT; ++face)
+                        {
+                            if ((slabFaces[row][face] >> x) & 1)
+                            {
+                                if (isAmbientOcclusionEnabled)
+                                {
+                                    faceVisibility.GetAmbientOcclusion(x, y, z, face, ambientOcclusion);
+                                }
+                                const auto& normal = FACE_TABLE[face].normal;
+                                const glm::vec2 light = getLight(x + normal[0], y + normal[1], z + normal[2]);
+                                const float textureLayer = static_cast<float>(registry.GetFaceLayer(blockType, static_cast<Direction>(face)));
+                                WriteFaceVertices(vertices, face, glm::vec3(x, y, z), textureLayer, ambientOcclusion, light);
+                            }
+                        }
+                    }
+                }
+
+                sectionRange.quadCount = getQuadCount() - sectionRange.firstQuad;
+            }
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include "BlockMesh.h"
+#include "FaceVisibility.h"
+#include "MemoryTracker.h"
+#include "SectionConnectivity.h"
+
+// Turns the blocks of a chunk into its land quads, four vertices per quad in the corner order of the QuadIndexBuffer.
+// The quads are grouped per section in section order, so every section is a single quad range.
+// The light comes in through a lookup, nothing in here needs Vulkan or the ChunkGenerator.
+class LandMesher final
+{
+public:
+    static constexpr int m_SectionSize = SectionConnectivity::m_SectionSize;
+    static constexpr int m_SectionsX = ChunkBlocks::m_Width / m_SectionSize;
+    static constexpr int m_SectionsY = ChunkBlocks::m_Height / m_SectionSize;
+    static constexpr int m_SectionsZ = ChunkBlocks::m_Depth / m_SectionSize;
+    static constexpr int m_SectionCount = m_SectionsX * m_SectionsY * m_SectionsZ;
+
+    struct SectionRange
+    {
+        uint32_t firstQuad;
+        uint32_t quadCount;
+    };
+    using SectionRanges = std::array<SectionRange, m_SectionCount>;
+
+    // Sky and block light of the block in front of a face, the position can lie in a neighbor chunk
+    using LightLookup = std::function<glm::vec2(int x, int y, int z)>;
+
+    // Replaces the vertices and section ranges, faceVisibility is scratch storage for the size of the chunk
+    static void Build(const ChunkBlocks& blocks, FaceVisibility& faceVisibility, bool isAmbientOcclusionEnabled, const LightLookup& getLight,
+        TaggedVector<Vertex, MemoryTag::Transient>& vertices, SectionRanges& sectionRanges);
+};
@@ -0,0 +1,544 @@
+#include "LightEngine.h"
+#include "FaceTable.h"
+
+namespace
+{
+    constexpr int g_DownFace = static_cast<int>(Direction::Down);
+
+    // Per block type lookups, filled from the BlockRegistry
+    struct BlockLightProperties
+    {
+        std::array<bool, BlockRegistry::m_BlockTypeCount> isOpaque;
+        std::array<uint8_t, BlockRegistry::m_BlockTypeCount> emissiveLevels;
+    };
+
+    BlockLightProperties GetBlockLightProperties()
+    {
+        const BlockRegistry& blockRegistry = BlockRegistry::GetInstance();
+        BlockLightProperties properties{};
+        for (size_t blockType = 0; blockType < BlockRegistry::m_BlockTypeCount; ++blockType)
+        {
+            properties.isOpaque[blockType] = blockRegistry.IsOpaque(static_cast<BlockType>(blockType));
+            properties.emissiveLevels[blockType] = blockRegistry.GetEmissiveLevel(static_cast<BlockType>(blockType));
+        }
+        return properties;
+    }
+
+    // Level a neighbor gets from a block with the given level
+    uint8_t GetSpreadLevel(bool isSkyLight, int face, uint8_t level)
+    {
+        return isSkyLight && face == g_DownFace && level == LightData::m_MaxLevel ? level : static_cast<uint8_t>(level - 1);
+    }
+}
+
+LightEngine::LightEngine(ChunkLookup chunkLookup)
+    : m_ChunkLookup{ std::move(chunkLookup) }
+{
+    // The calling thread lights chunks as well
+    const unsigned int workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    for (unsigned int worker = 0; worker < workerCount; ++worker)
+    {
+        m_Workers.emplace_back(&LightEngine::Work, this);
+    }
+}
+
+LightEngine::~LightEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_WorkMutex);
+        m_IsStopping = true;
+    }
+    m_WorkCondition.notify_all();
+    for (std::thread& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+void LightEngine::LightChunk(const ChunkBlocks& blocks, LightData& light)
+{
+    const BlockLightProperties properties = GetBlockLightProperties();
+    const auto isOpaque = [&](size_t index) { return properties.isOpaque[static_cast<size_t>(blocks[index])]; };
+
+    light.Fill(0, 0);
+    std::vector<uint32_t> queue;
+
+    // Sky light falls straight down until it hits an opaque block
+    for (int z = 0; z < m_Depth; ++z)
+    {
+        for (int x = 0; x < m_Width; ++x)
+        {
+            for (int y = m_Height - 1; y >= 0 && !isOpaque(GetIndex(x, y, z)); --y)
+            {
+                light.SetSkyLight(GetIndex(x, y, z), LightData::m_MaxLevel);
+            }
+        }
+    }
+
+    // Only the lit blocks next to an unlit one have to spread sideways
+    for (int z = 0; z < m_Depth; ++z)
+    {
+        for (int x = 0; x < m_Width; ++x)
+        {
+            for (int y = m_Height - 1; y >= 0 && light.GetSkyLight(GetIndex(x, y, z)) == LightData::m_MaxLevel; --y)
+            {
+                const auto isDark = [&](int neighborX, int neighborZ)
+                    {
+                        if (neighborX < 0 || neighborX >= m_Width || neighborZ < 0 || neighborZ >= m_Depth)
+                        {
+                            return false;
+                        }
+                        const size_t neighbor = GetIndex(neighborX, y, neighborZ);
+                        return !isOpaque(neighbor) && light.GetSkyLight(neighbor) < LightData::m_MaxLevel;
+                    };
+
+                if (isDark(x + 1, z) || isDark(x - 1, z) || isDark(x, z + 1) || isDark(x, z - 1))
+                {
+                    queue.push_back(static_cast<uint32_t>(GetIndex(x, y, z)));
+                }
+            }
+        }
+    }
+
+    const auto propagate = [&](bool isSkyLight)
+        {
+            for (size_t head = 0; head < queue.size(); ++head)
+            {
+                const uint32_t index = queue[head];
+                const uint8_t level = isSkyLight ? light.GetSkyLight(index) : light.GetBlockLight(index);
+                if (level <= 1)
+                {
+                    continue;
+                }
+
+                const glm::ivec3 position = ChunkBlocks::GetPosition(index);
+                const int x = position.x;
+                const int y = position.y;
+                const int z = position.z;
+                for (int face = 0; face < FACE_COUNT; ++face)
+                {
+                    const auto& offset = FACE_TABLE[face].normal;
+                    const int neighborX = x + offset[0];
+                    const int neighborY = y + offset[1];
+                    const int neighborZ = z + offset[2];
+                    if (neighborX < 0 || neighborX >= m_Width || neighborY < 0 || neighborY >= m_Height || neighborZ < 0 || neighborZ >= m_Depth)
+                    {
+                        continue;
+                    }
+
+                    const size_t neighbor = GetIndex(neighborX, neighborY, neighborZ);
+                    if (isOpaque(neighbor))
+                    {
+                        continue;
+                    }
+
+                    const uint8_t spreadLevel = GetSpreadLevel(isSkyLight, face, level);
+                    if (isSkyLight && light.GetSkyLight(neighbor) < spreadLevel)
+                    {
+                        light.SetSkyLight(neighbor, spreadLevel);
+                        queue.push_back(static_cast<uint32_t>(neighbor));
+                    }
+                    else if (!isSkyLight && light.GetBlockLight(neighbor) < spreadLevel)
+                    {
+                        light.SetBlockLight(neighbor, spreadLevel);
+                        queue.push_back(static_cast<uint32_t>(neighbor));
+                    }
+                }
+            }
+            queue.clear();
+        };
+    propagate(true);
+
+    for (size_t index = 0; index < ChunkBlocks::m_BlockCount; ++index)
+    {
+        const uint8_t emissiveLevel = properties.emissiveLevels[static_cast<size_t>(blocks[index])];
+        if (emissiveLevel > 0)
+        {
+            light.SetBlockLight(index, emissiveLevel);
+            queue.push_back(static_cast<uint32_t>(index));
+        }
+    }
+    propagate(false);
+}
+
+std::vector<glm::ivec3> LightEngine::LightChunks(const std::vector<glm::ivec3>& chunkPositions)
+{
+    std::vector<CachedChunk*> newChunks;
+    for (const glm::ivec3& chunkPosition : chunkPositions)
+    {
+        CachedChunk* pChunk = GetChunk(chunkPosition);
+        if (pChunk->view.pBlocks != nullptr)
+        {
+            // The neighbors never read the light of the chunk before
+            pChunk->isChanged = true;
+            pChunk->changedSides = m_AllSides;
+            newChunks.push_back(pChunk);
+        }
+    }
+
+    // The chunks are lit on their own first, every worker only writes to the light of its own chunks
+    LightOnWorkers(newChunks);
+
+    // Afterwards the light of the new chunks and their neighbors is spread over the borders
+    std::vector<CachedChunk*> borderChunks;
+    for (CachedChunk* pChunk : newChunks)
+    {
+        borderChunks.push_back(pChunk);
+        for (const auto& offset : m_SideOffsets)
+        {
+            CachedChunk* pNeighbor = GetChunk(pChunk->position + glm::ivec3{ offset[0], 0, offset[1] });
+            if (pNeighbor->view.pBlocks != nullptr && std::find(borderChunks.begin(), borderChunks.end(), pNeighbor) == borderChunks.end())
+            {
+                borderChunks.push_back(pNeighbor);
+            }
+        }
+    }
+
+    for (Channel channel : { Channel::Sky, Channel::Block })
+    {
+        for (CachedChunk* pChunk : borderChunks)
+        {
+            QueueBorders(*pChunk, channel);
+        }
+        Propagate(channel);
+    }
+
+    return TakeChangedChunks();
+}
+
+std::vector<glm::ivec3> LightEngine::UpdateBlock(const glm::ivec3& chunkPosition, const glm::ivec3& blockPosition, BlockType oldBlockType)
+{
+    CachedChunk* pChunk = GetChunk(chunkPosition);
+    if (pChunk->view.pBlocks == nullptr)
+    {
+        m_Chunks.clear();
+        return {};
+    }
+
+    const BlockLightProperties properties = GetBlockLightProperties();
+    const size_t index = GetIndex(blockPosition.x, blockPosition.y, blockPosition.z);
+    const BlockType blockType = (*pChunk->view.pBlocks)[index];
+    if (blockType == oldBlockType)
+    {
+        m_Chunks.clear();
+        return {};
+    }
+
+    for (Channel channel : { Channel::Sky, Channel::Block })
+    {
+        // Remove the light that went through or came from the old block, the queue collects the light around the gap
+        const uint8_t oldLevel = GetLevel(*pChunk, channel, index);
+        if (oldLevel > 0)
+        {
+            SetLevel(*pChunk, channel, blockPosition.x, blockPosition.y, blockPosition.z, 0);
+            m_RemoveQueue.push_back({ pChunk, blockPosition.x, blockPosition.y, blockPosition.z, oldLevel });
+            Unpropagate(channel);
+        }
+
+        // Add the light of the new block
+        const uint8_t emissiveLevel = properties.emissiveLevels[static_cast<size_t>(blockType)];
+        if (channel == Channel::Block && emissiveLevel > 0)
+        {
+            SetLevel(*pChunk, channel, blockPosition.x, blockPosition.y, blockPosition.z, emissiveLevel);
+            m_AddQueue.push_back({ pChunk, blockPosition.x, blockPosition.y, blockPosition.z, emissiveLevel });
+        }
+
+        // Let the light around a see through block flow in again
+        if (!properties.isOpaque[static_cast<size_t>(blockType)])
+        {
+            if (channel == Channel::Sky && blockPosition.y == m_Height - 1)
+            {
+                SetLevel(*pChunk, channel, blockPosition.x, blockPosition.y, blockPosition.z, LightData::m_MaxLevel);
+                m_AddQueue.push_back({ pChunk, blockPosition.x, blockPosition.y, blockPosition.z, LightData::m_MaxLevel });
+            }
+
+            for (int face = 0; face < FACE_COUNT; ++face)
+            {
+                const auto& offset = FACE_TABLE[face].normal;
+                LightNode neighbor{ pChunk, blockPosition.x + offset[0], blockPosition.y + offset[1], blockPosition.z + offset[2], 0 };
+                if (ResolveNeighbor(neighbor))
+                {
+                    m_AddQueue.push_back(neighbor);
+                }
+            }
+        }
+
+        Propagate(channel);
+    }
+
+    return TakeChangedChunks();
+}
+
+LightEngine::CachedChunk* LightEngine::GetChunk(const glm::ivec3& chunkPosition)
+{
+    auto it = m_Chunks.find(chunkPosition);
+    if (it == m_Chunks.end())
+    {
+        it = m_Chunks.emplace(chunkPosition, CachedChunk{ chunkPosition, m_ChunkLookup(chunkPosition), false, 0 }).first;
+    }
+    return &it->second;
+}
+
+bool LightEngine::ResolveNeighbor(LightNode& node)
+{
+    if (node.y < 0 || node.y >= m_Height)
+    {
+        return false;
+    }
+
+    if (node.x >= 0 && node.x < m_Width && node.z >= 0 && node.z < m_Depth)
+    {
+        return true;
+    }
+
+    glm::ivec3 chunkPosition = node.pChunk->position;
+    if (node.x < 0) { node.x += m_Width; --chunkPosition.x; }
+    else if (node.x >= m_Width) { node.x -= m_Width; ++chunkPosition.x; }
+    if (node.z < 0) { node.z += m_Depth; --chunkPosition.z; }
+    else if (node.z >= m_Depth) { node.z -= m_Depth; ++chunkPosition.z; }
+
+    node.pChunk = GetChunk(chunkPosition);
+    return node.pChunk->view.pBlocks != nullptr;
+}
+
+std::vector<glm::ivec3> LightEngine::TakeChangedChunks()
+{
+    std::vector<glm::ivec3> changedChunks;
+    for (const auto& [position, chunk] : m_Chunks)
+    {
+        if (chunk.isChanged)
+        {
+            changedChunks.push_back(position);
+        }
+    }
+
+    // The meshes of the neighbors show the light of the changed border
+    const size_t changedCount = changedChunks.size();
+    for (size_t changed = 0; changed < changedCount; ++changed)
+    {
+        const CachedChunk& chunk = m_Chunks.at(changedChunks[changed]);
+        for (size_t side = 0; side < m_SideOffsets.size(); ++side)
+        {
+            const glm::ivec3 neighborPosition = chunk.position + glm::ivec3{ m_SideOffsets[side][0], 0, m_SideOffsets[side][1] };
+            if (((chunk.changedSides >> side) & 1) == 0 || std::find(changedChunks.begin(), changedChunks.end(), neighborPosition) != changedChunks.end())
+            {
+                continue;
+            }
+
+            const auto found = m_Chunks.find(neighborPosition);
+            const ChunkView neighbor = found != m_Chunks.end() ? found->second.view : m_ChunkLookup(neighborPosition);
+            if (neighbor.pBlocks != nullptr)
+            {
+                changedChunks.push_back(neighborPosition);
+            }
+        }
+    }
+
+    m_Chunks.clear();
+    return changedChunks;
+}
+
+uint8_t LightEngine::GetLevel(const CachedChunk& chunk, Channel channel, size_t index)
+{
+    return channel == Channel::Sky ? chunk.view.pLight->GetSkyLight(index) : chunk.view.pLight->GetBlockLight(index);
+}
+
+void LightEngine::SetLevel(CachedChunk& chunk, Channel channel, int x, int y, int z, uint8_t level)
+{
+    const size_t index = GetIndex(x, y, z);
+    if (channel == Channel::Sky)
+    {
+        chunk.view.pLight->SetSkyLight(index, level);
+    }
+    else
+    {
+        chunk.view.pLight->SetBlockLight(index, level);
+    }
+    chunk.isChanged = true;
+    chunk.changedSides |= static_cast<uint8_t>((x == m_Width - 1) | (x == 0) << 1 | (z == m_Depth - 1) << 2 | (z == 0) << 3);
+}
+
+void LightEngine::QueueBorders(CachedChunk& chunk, Channel channel)
+{
+    const BlockLightProperties properties = GetBlockLightProperties();
+
+    // Only the border blocks that can brighten the block on the other side are queued
+    const auto queueSide = [&](const glm::ivec3& offset)
+        {
+            const CachedChunk* pNeighbor = GetChunk(chunk.position + offset);
+            if (pNeighbor->view.pBlocks == nullptr)
+            {
+                return;
+            }
+
+            const int sideLength = offset.x != 0 ? m_Depth : m_Width;
+            for (int y = 0; y < m_Height; ++y)
+            {
+                for (int i = 0; i < sideLength; ++i)
+                {
+                    const int x = offset.x != 0 ? (offset.x > 0 ? m_Width - 1 : 0) : i;
+                    const int z = offset.x != 0 ? i : (offset.z > 0 ? m_Depth - 1 : 0);
+                    const uint8_t level = GetLevel(chunk, channel, GetIndex(x, y, z));
+                    if (level <= 1)
+                    {
+                        continue;
+                    }
+
+                    const size_t neighborIndex = GetIndex((x + offset.x + m_Width) % m_Width, y, (z + offset.z + m_Depth) % m_Depth);
+                    if (!properties.isOpaque[static_cast<size_t>((*pNeighbor->view.pBlocks)[neighborIndex])]
+                        && GetLevel(*pNeighbor, channel, neighborIndex) < level - 1)
+                    {
+                        m_AddQueue.push_back({ &chunk, x, y, z, level });
+                    }
+                }
+            }
+        };
+
+    for (const auto& offset : m_SideOffsets)
+    {
+        queueSide({ offset[0], 0, offset[1] });
+    }
+}
+
+void LightEngine::Propagate(Channel channel)
+{
+    const BlockLightProperties properties = GetBlockLightProperties();
+    const bool isSkyLight = channel == Channel::Sky;
+
+    for (size_t head = 0; head < m_AddQueue.size(); ++head)
+    {
+        const LightNode node = m_AddQueue[head];
+        // The level can have grown since the block was queued
+        const uint8_t level = GetLevel(*node.pChunk, channel, GetIndex(node.x, node.y, node.z));
+        if (level <= 1)
+        {
+            continue;
+        }
+
+        for (int face = 0; face < FACE_COUNT; ++face)
+        {
+            const auto& offset = FACE_TABLE[face].normal;
+            LightNode neighbor{ node.pChunk, node.x + offset[0], node.y + offset[1], node.z + offset[2], 0 };
+            if (!ResolveNeighbor(neighbor))
+            {
+                continue;
+            }
+
+            const size_t neighborIndex = GetIndex(neighbor.x, neighbor.y, neighbor.z);
+            if (properties.isOpaque[static_cast<size_t>((*neighbor.pChunk->view.pBlocks)[neighborIndex])])
+            {
+                continue;
+            }
+
+            neighbor.level = GetSpreadLevel(isSkyLight, face, level);
+            if (GetLevel(*neighbor.pChunk, channel, neighborIndex) < neighbor.level)
+            {
+                SetLevel(*neighbor.pChunk, channel, neighbor.x, neighbor.y, neighbor.z, neighbor.level);
+                m_AddQueue.push_back(neighbor);
+            }
+        }
+    }
+    m_AddQueue.clear();
+}
+
+void LightEngine::Unpropagate(Channel channel)
+{
+    const BlockLightProperties properties = GetBlockLightProperties();
+    const bool isSkyLight = channel == Channel::Sky;
+
+    for (size_t head = 0; head < m_RemoveQueue.size(); ++head)
+    {
+        const LightNode node = m_RemoveQueue[head];
+        for (int face = 0; face < FACE_COUNT; ++face)
+        {
+            const auto& offset = FACE_TABLE[face].normal;
+            LightNode neighbor{ node.pChunk, node.x + offset[0], node.y + offset[1], node.z + offset[2], 0 };
+            if (!ResolveNeighbor(neighbor))
+            {
+                continue;
+            }
+
+            const size_t neighborIndex = GetIndex(neighbor.x, neighbor.y, neighbor.z);
+            neighbor.level = GetLevel(*neighbor.pChunk, channel, neighborIndex);
+            if (neighbor.level == 0)
+            {
+                continue;
+            }
+
+            // Light sources keep their own level, everything that got its light through the removed block goes dark
+            const BlockType neighborBlockType = (*neighbor.pChunk->view.pBlocks)[neighborIndex];
+            const bool isSource = !isSkyLight && properties.emissiveLevels[static_cast<size_t>(neighborBlockType)] >= neighbor.level;
+            const bool isDependent = neighbor.level < node.level
+                || (isSkyLight && face == g_DownFace && node.level == LightData::m_MaxLevel && neighbor.level == LightData::m_MaxLevel);
+            if (isDependent && !isSource)
+            {
+                SetLevel(*neighbor.pChunk, channel, neighbor.x, neighbor.y, neighbor.z, 0);
+                m_RemoveQueue.push_back(neighbor);
+            }
+            else
+            {
+                // Lights the removed area again from the outside
+                m_AddQueue.push_back(neighbor);
+            }
+        }
+    }
+    m_RemoveQueue.clear();
+}
+
+void LightEngine::Work()
+{
+    uint64_t generation = 0;
+    std::unique_lock<std::mutex> lock(m_WorkMutex);
+    while (true)
+    {
+        m_WorkCondition.wait(lock, [this, &generation]() { return m_IsStopping || (m_pJobs != nullptr && m_JobGeneration != generation); });
+        if (m_IsStopping)
+        {
+            return;
+        }
+
+        // Counted as busy before the jobs are touched, LightOnWorkers doesn't return before the count is back at zero
+        generation = m_JobGeneration;
+        const std::vector<CachedChunk*>& jobs = *m_pJobs;
+        ++m_BusyWorkerCount;
+        lock.unlock();
+        LightJobs(jobs);
+        lock.lock();
+        if (--m_BusyWorkerCount == 0)
+        {
+            m_DoneCondition.notify_all();
+        }
+    }
+}
+
+void LightEngine::LightJobs(const std::vector<CachedChunk*>& jobs)
+{
+    for (size_t job = m_NextJob++; job < jobs.size(); job = m_NextJob++)
+    {
+        LightChunk(*jobs[job]->view.pBlocks, *jobs[job]->view.pLight);
+    }
+}
+
+void LightEngine::LightOnWorkers(const std::vector<CachedChunk*>& chunks)
+{
+    if (chunks.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_WorkMutex);
+        m_pJobs = &chunks;
+        m_NextJob = 0;
+        ++m_JobGeneration;
+    }
+    m_WorkCondition.notify_all();
+
+    // Once this returns every chunk has been taken, the workers may still be lighting theirs
+    LightJobs(chunks);
+
+    std::unique_lock<std::mutex> lock(m_WorkMutex);
+    m_DoneCondition.wait(lock, [this]() { return m_BusyWorkerCount == 0; });
+    // Workers that wake up late find nothing to do
+    m_pJobs = nullptr;
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "BlockRegistry.h"
+#include "VoxelStorage.h"
+
+// Sky and block light of every block of a chunk, both 0 - 15 and packed in one byte with the sky light in the high half.
+// Indexed the same way as the blocks of a chunk, with ChunkBlocks::GetIndex.
+class LightData final
+{
+public:
+    static constexpr uint8_t m_MaxLevel = 15;
+
+    explicit LightData(size_t blockCount, uint8_t skyLight = m_MaxLevel)
+        : m_Levels(blockCount, static_cast<uint8_t>(skyLight << 4))
+    {
+    }
+
+    uint8_t GetSkyLight(size_t index) const { return m_Levels[index] >> 4; }
+    uint8_t GetBlockLight(size_t index) const { return m_Levels[index] & 0xF; }
+    void SetSkyLight(size_t index, uint8_t level) { m_Levels[index] = static_cast<uint8_t>((m_Levels[index] & 0xF) | (level << 4)); }
+    void SetBlockLight(size_t index, uint8_t level) { m_Levels[index] = static_cast<uint8_t>((m_Levels[index] & 0xF0) | level); }
+
+    void Fill(uint8_t skyLight, uint8_t blockLight) { std::fill(m_Levels.begin(), m_Levels.end(), static_cast<uint8_t>((skyLight << 4) | blockLight)); }
+
+private:
+    TaggedVector<uint8_t, MemoryTag::Voxels> m_Levels;
+};
+
+// Flood fill light propagation over the loaded chunks.
+// Sky light enters at the top of every column and goes straight down at full strength through non opaque blocks,
+// block light starts at the emissive blocks of the BlockRegistry. Both lose one level for every other step.
+// New chunks are first lit on their own by a pool of worker threads, afterwards the light is spread over the chunk borders.
+// Block edits are handled incrementally: the light that depended on the old block is removed and the gap is filled again.
+// The class has no Vulkan dependencies so it can be run headless on handcrafted chunks.
+class LightEngine final
+{
+public:
+    static constexpr int m_Width = CHUNK_WIDTH;
+    static constexpr int m_Height = CHUNK_HEIGHT;
+    static constexpr int m_Depth = CHUNK_DEPTH;
+    static constexpr int m_BlockCount = m_Width * m_Height * m_Depth;
+
+    // What the light engine needs of a chunk, both are null when the chunk isn't loaded
+    struct ChunkView
+    {
+        const ChunkBlocks* pBlocks;
+        LightData* pLight;
+    };
+
+    // Finds a chunk by its position in chunks
+    using ChunkLookup = std::function<ChunkView(const glm::ivec3& chunkPosition)>;
+
+    // Starts the worker threads, they sleep until chunks have to be lit
+    explicit LightEngine(ChunkLookup chunkLookup);
+    ~LightEngine();
+
+    LightEngine(const LightEngine&) = delete;
+    LightEngine(LightEngine&&) noexcept = delete;
+    LightEngine& operator=(const LightEngine&) = delete;
+    LightEngine& operator=(LightEngine&&) noexcept = delete;
+
+    // Both return the chunks whose mesh has to be rebuilt: every chunk whose light changed and the loaded neighbors
+    // of every border whose light changed, a mesh reads the light of the blocks across its borders
+
+    // Lights the new chunks and spreads light between them and their loaded neighbors, the new chunks are always returned
+    std::vector<glm::ivec3> LightChunks(const std::vector<glm::ivec3>& chunkPositions);
+
+    // Call after the block was changed
+    std::vector<glm::ivec3> UpdateBlock(const glm::ivec3& chunkPosition, const glm::ivec3& blockPosition, BlockType oldBlockType);
+
+    // Lights a chunk without looking at its neighbors
+    static void LightChunk(const ChunkBlocks& blocks, LightData& light);
+
+    static size_t GetIndex(int x, int y, int z)
+    {
+        return ChunkBlocks::GetIndex(x, y, z);
+    }
+
+private:
+    enum class Channel : unsigned char
+    {
+        Sky,
+        Block
+    };
+
+    struct ChunkPositionHash
+    {
+        size_t operator()(const glm::ivec3& position) const
+        {
+            return std::hash<int>()(position.x) * 73856093u ^ std::hash<int>()(position.z) * 83492791u;
+        }
+    };
+
+    struct CachedChunk
+    {
+        glm::ivec3 position;
+        ChunkView view;
+        bool isChanged;
+        // One bit per side in the order of m_SideOffsets, set when the light of a block on that side changed
+        uint8_t changedSides;
+    };
+
+    // +x, -x, +z and -z, the sides a chunk shares with its neighbors
+    static constexpr std::array<std::array<int, 2>, 4> m_SideOffsets{ { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } } };
+    static constexpr uint8_t m_AllSides = 0xF;
+
+    struct LightNode
+    {
+        CachedChunk* pChunk;
+        int x;
+        int y;
+        int z;
+        uint8_t level;
+    };
+
+    ChunkLookup m_ChunkLookup;
+    // Chunks looked up during one update
+    std::unordered_map<glm::ivec3, CachedChunk, ChunkPositionHash> m_Chunks;
+    std::vector<LightNode> m_AddQueue;
+    std::vector<LightNode> m_RemoveQueue;
+
+    // The workers light the chunks m_pJobs points to, the thread that called LightChunks helps
+    std::vector<std::thread> m_Workers;
+    std::mutex m_WorkMutex;
+    std::condition_variable m_WorkCondition;
+    std::condition_variable m_DoneCondition;
+    const std::vector<CachedChunk*>* m_pJobs{};
+    std::atomic<size_t> m_NextJob{};
+    // Bumped for every LightChunks, so a worker doesn't take the same jobs twice
+    uint64_t m_JobGeneration{};
+    // Workers that may still be lighting one of the jobs
+    size_t m_BusyWorkerCount{};
+    bool m_IsStopping{};
+
+    void Work();
+    void LightJobs(const std::vector<CachedChunk*>& jobs);
+    // Lights every chunk on its own, returns once all of them are done
+    void LightOnWorkers(const std::vector<CachedChunk*>& chunks);
+
+    CachedChunk* GetChunk(const glm::ivec3& chunkPosition);
+    // Moves a block position that left its chunk into the neighboring chunk, false if that one isn't loaded
+    bool ResolveNeighbor(LightNode& node);
+    std::vector<glm::ivec3> TakeChangedChunks();
+
+    static uint8_t GetLevel(const CachedChunk& chunk, Channel channel, size_t index);
+    static void SetLevel(CachedChunk& chunk, Channel channel, int x, int y, int z, uint8_t level);
+
+    void QueueBorders(CachedChunk& chunk, Channel channel);
+    void Propagate(Channel channel);
+    void Unpropagate(Channel channel);
+};
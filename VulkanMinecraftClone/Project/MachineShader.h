@@ -26,6 +26,7 @@ public:
 		m_ShaderStages.emplace_back(CreateFragmentShaderInfo(device));
 	}
 	inline std::vector<VkPipelineShaderStageCreateInfo>& GetShaderStages(){	return m_ShaderStages; }
+	bool UsesFile(const std::string& shaderFile) const { return shaderFile == m_VertexShaderFile || shaderFile == m_FragmentShaderFile; }
 
 	//"shaders/shader.frag.spv"
 	VkPipelineShaderStageCreateInfo CreateFragmentShaderInfo(const VkDevice& device) {
@@ -79,7 +80,7 @@ public:
 		auto attributeDescriptions = Vertex::getAttributeDescriptions();
 
 		vertexInputInfo->vertexBindingDescriptionCount = 1;
-		vertexInputInfo->vertexAttributeDescriptionCount = static_cast<uint32_t>(3);
+		vertexInputInfo->vertexAttributeDescriptionCount = static_cast<uint32_t>(5);
 		vertexInputInfo->pVertexBindingDescriptions = bindingDescription.release();
 		vertexInputInfo->pVertexAttributeDescriptions = attributeDescriptions.release();
 		vertexInputInfo->flags = 0;
@@ -87,6 +88,36 @@ public:
 		return vertexInputInfo;
 	}
 
+	std::unique_ptr<VkPipelineVertexInputStateCreateInfo> CreateWaterVertexInputStateInfo()
+	{
+		auto vertexInputInfo = std::make_unique<VkPipelineVertexInputStateCreateInfo>();
+		vertexInputInfo->sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		auto bindingDescription = WaterVertex::getBindingDescription();
+		auto attributeDescriptions = WaterVertex::getAttributeDescriptions();
+
+		vertexInputInfo->vertexBindingDescriptionCount = 1;
+		vertexInputInfo->vertexAttributeDescriptionCount = static_cast<uint32_t>(1);
+		vertexInputInfo->pVertexBindingDescriptions = bindingDescription.release();
+		vertexInputInfo->pVertexAttributeDescriptions = attributeDescriptions.release();
+		vertexInputInfo->flags = 0;
+
+		return vertexInputInfo;
+	}
+
+	// No bindings, the vertex shader reads its data from a storage buffer with gl_VertexIndex
+	std::unique_ptr<VkPipelineVertexInputStateCreateInfo> CreatePulledVertexInputStateInfo()
+	{
+		auto vertexInputInfo = std::make_unique<VkPipelineVertexInputStateCreateInfo>();
+		vertexInputInfo->sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo->vertexBindingDescriptionCount = 0;
+		vertexInputInfo->vertexAttributeDescriptionCount = 0;
+		vertexInputInfo->pVertexBindingDescriptions = nullptr;
+		vertexInputInfo->pVertexAttributeDescriptions = nullptr;
+		vertexInputInfo->flags = 0;
+
+		return vertexInputInfo;
+	}
+
 	VkPipelineInputAssemblyStateCreateInfo CreateInputAssemblyStateInfo()
 	{
 		VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
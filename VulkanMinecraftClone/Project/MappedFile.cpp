@@ -0,0 +1,101 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& path)
+{
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	m_FileHandle = file;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return;
+	}
+
+	m_MappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_MappingHandle == nullptr)
+	{
+		Close();
+		return;
+	}
+
+	m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	m_Size = m_pData ? static_cast<size_t>(size.QuadPart) : 0;
+	if (m_pData == nullptr)
+	{
+		Close();
+	}
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (m_MappingHandle)
+	{
+		CloseHandle(m_MappingHandle);
+	}
+	if (m_FileHandle)
+	{
+		CloseHandle(m_FileHandle);
+	}
+	m_pData = nullptr;
+	m_Size = 0;
+	m_MappingHandle = nullptr;
+	m_FileHandle = nullptr;
+}
+#else
+MappedFile::MappedFile(const std::string& path)
+{
+	const int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return;
+	}
+
+	struct stat status {};
+	if (fstat(file, &status) == 0 && status.st_size > 0)
+	{
+		void* pData = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		if (pData != MAP_FAILED)
+		{
+			m_pData = static_cast<const uint8_t*>(pData);
+			m_Size = static_cast<size_t>(status.st_size);
+		}
+	}
+	// The mapping stays valid after closing the descriptor
+	close(file);
+}
+
+void MappedFile::Close()
+{
+	if (m_pData)
+	{
+		munmap(const_cast<uint8_t*>(m_pData), m_Size);
+	}
+	m_pData = nullptr;
+	m_Size = 0;
+}
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
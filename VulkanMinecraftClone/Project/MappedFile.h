@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read only view of a whole file through the virtual memory system, so large assets can be used without copying them into a buffer first.
+// A missing or empty file gives a closed MappedFile instead of an exception, callers decide whether that is an error.
+class MappedFile final
+{
+public:
+	explicit MappedFile(const std::string& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&&) noexcept = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&&) noexcept = delete;
+
+	bool IsOpen() const { return m_pData != nullptr; }
+	const uint8_t* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_Size; }
+
+	// Unmaps early, a mapped file can't be overwritten on Windows
+	void Close();
+
+private:
+	const uint8_t* m_pData{};
+	size_t m_Size{};
+#ifdef _WIN32
+	void* m_FileHandle{};
+	void* m_MappingHandle{};
+#endif
+};
@@ -0,0 +1,133 @@
+#include "MemoryTracker.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace
+{
+	double ToMegabytes(uint64_t bytes)
+	{
+		return static_cast<double>(bytes) / (1024.0 * 1024.0);
+	}
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MemoryTag::Voxels: return "voxels";
+	case MemoryTag::Meshes: return "meshes";
+	case MemoryTag::Textures: return "textures";
+	case MemoryTag::Pipelines: return "pipelines";
+	case MemoryTag::Transient: return "transient";
+	case MemoryTag::Other: return "other";
+	default: return "unknown";
+	}
+}
+
+void MemoryTracker::Initialize(VkPhysicalDevice physicalDevice)
+{
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+}
+
+void MemoryTracker::AddDevice(VkDeviceMemory memory, MemoryTag tag, VkDeviceSize size, uint32_t memoryTypeIndex)
+{
+	const uint32_t heapIndex = m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+	std::lock_guard<std::mutex> lock{ m_DeviceMutex };
+	m_DeviceAllocations[memory] = DeviceAllocation{ tag, size, heapIndex };
+	for (DeviceCounter* pCounter : { &m_DeviceCounters[static_cast<size_t>(tag)], &m_HeapCounters[heapIndex] })
+	{
+		pCounter->current += size;
+		pCounter->peak = std::max(pCounter->peak, pCounter->current);
+		++pCounter->allocationCount;
+	}
+}
+
+void MemoryTracker::RemoveDevice(VkDeviceMemory memory)
+{
+	std::lock_guard<std::mutex> lock{ m_DeviceMutex };
+	const auto it = m_DeviceAllocations.find(memory);
+	if (it == m_DeviceAllocations.end())
+	{
+		return;
+	}
+
+	const DeviceAllocation& allocation = it->second;
+	m_DeviceCounters[static_cast<size_t>(allocation.tag)].current -= allocation.size;
+	--m_DeviceCounters[static_cast<size_t>(allocation.tag)].allocationCount;
+	m_HeapCounters[allocation.heapIndex].current -= allocation.size;
+	--m_HeapCounters[allocation.heapIndex].allocationCount;
+	m_DeviceAllocations.erase(it);
+}
+
+uint64_t MemoryTracker::GetDeviceBytes(MemoryTag tag) const
+{
+	std::lock_guard<std::mutex> lock{ m_DeviceMutex };
+	return m_DeviceCounters[static_cast<size_t>(tag)].current;
+}
+
+void MemoryTracker::EndFrame()
+{
+	// Built once, so the frames don't allocate the names
+	static const std::array<std::string, m_TagCount> profilerNames = []()
+		{
+			std::array<std::string, m_TagCount> names{};
+			for (size_t tag = 0; tag < m_TagCount; ++tag)
+			{
+				names[tag] = std::string("memory ") + GetTagName(static_cast<MemoryTag>(tag)) + " KB";
+			}
+			return names;
+		}();
+
+	Profiler& profiler = Profiler::GetInstance();
+	for (size_t tag = 0; tag < m_TagCount; ++tag)
+	{
+		const uint64_t bytes = GetHostBytes(static_cast<MemoryTag>(tag)) + GetDeviceBytes(static_cast<MemoryTag>(tag));
+		profiler.AddCount(profilerNames[tag], bytes / 1024);
+	}
+
+	if (AllocationCounter::IsEnabled())
+	{
+		const uint64_t allocationCount = AllocationCounter::GetSnapshot().allocationCount;
+		profiler.AddCount("heap allocations", allocationCount - m_LastAllocationCount);
+		m_LastAllocationCount = allocationCount;
+	}
+}
+
+void MemoryTracker::PrintReport() const
+{
+	std::lock_guard<std::mutex> lock{ m_DeviceMutex };
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Memory per tag, current and peak in MB:\n";
+	for (size_t tag = 0; tag < m_TagCount; ++tag)
+	{
+		const Counter& host = m_HostCounters[tag];
+		const DeviceCounter& device = m_DeviceCounters[tag];
+		std::cout << "  " << std::setw(10) << std::left << GetTagName(static_cast<MemoryTag>(tag)) << std::right
+			<< " host " << ToMegabytes(host.current.load(std::memory_order_relaxed)) << " (" << ToMegabytes(host.peak.load(std::memory_order_relaxed)) << ")"
+			<< ", device " << ToMegabytes(device.current) << " (" << ToMegabytes(device.peak) << ") in " << device.allocationCount << " allocations\n";
+	}
+
+	std::cout << "Device memory per heap:\n";
+	for (uint32_t heapIndex = 0; heapIndex < m_MemoryProperties.memoryHeapCount; ++heapIndex)
+	{
+		const VkMemoryHeap& heap = m_MemoryProperties.memoryHeaps[heapIndex];
+		const DeviceCounter& counter = m_HeapCounters[heapIndex];
+		std::cout << "  heap " << heapIndex << ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " device local" : " host")
+			<< ": " << ToMegabytes(counter.current) << " (" << ToMegabytes(counter.peak) << ") of " << ToMegabytes(heap.size)
+			<< " MB in " << counter.allocationCount << " allocations\n";
+	}
+
+	if (AllocationCounter::IsEnabled())
+	{
+		const AllocationCounter::Snapshot snapshot = AllocationCounter::GetSnapshot();
+		std::cout << "Heap allocations: " << snapshot.allocationCount << ", " << ToMegabytes(snapshot.allocatedBytes) << " MB in total\n";
+	}
+	std::cout << "Peak resident: " << ToMegabytes(AllocationCounter::GetPeakResidentBytes()) << " MB\n";
+	std::cout << std::defaultfloat;
+}
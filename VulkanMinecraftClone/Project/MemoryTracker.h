@@ -0,0 +1,143 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+// What a piece of memory is used for, both on the heap and on the device
+enum class MemoryTag : uint8_t
+{
+	Voxels,
+	Meshes,
+	Textures,
+	Pipelines,
+	// Staging buffers and scratch storage
+	Transient,
+	Other,
+	Count
+};
+
+// Accounts the memory of every subsystem: the heap memory of the containers that use a TaggedAllocator,
+// and every device allocation made through AllocateMemory in VulkanUtil, per tag and per memory heap.
+// PrintReport dumps it all, EndFrame hands the totals to the Profiler.
+class MemoryTracker final
+{
+public:
+	static constexpr size_t m_TagCount = static_cast<size_t>(MemoryTag::Count);
+
+	static MemoryTracker& GetInstance()
+	{
+		static MemoryTracker instance;
+		return instance;
+	}
+
+	MemoryTracker(const MemoryTracker&) = delete;
+	MemoryTracker(MemoryTracker&&) noexcept = delete;
+	MemoryTracker& operator=(const MemoryTracker&) = delete;
+	MemoryTracker& operator=(MemoryTracker&&) noexcept = delete;
+
+	static const char* GetTagName(MemoryTag tag);
+
+	// Needed to know the heap of every memory type
+	void Initialize(VkPhysicalDevice physicalDevice);
+
+	// Thread safe, the LightEngine workers light into tagged storage
+	void AddHost(MemoryTag tag, size_t bytes)
+	{
+		Counter& counter = m_HostCounters[static_cast<size_t>(tag)];
+		const uint64_t current = counter.current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		uint64_t peak = counter.peak.load(std::memory_order_relaxed);
+		while (current > peak && !counter.peak.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+		{
+		}
+	}
+	void RemoveHost(MemoryTag tag, size_t bytes) { m_HostCounters[static_cast<size_t>(tag)].current.fetch_sub(bytes, std::memory_order_relaxed); }
+
+	void AddDevice(VkDeviceMemory memory, MemoryTag tag, VkDeviceSize size, uint32_t memoryTypeIndex);
+	void RemoveDevice(VkDeviceMemory memory);
+
+	uint64_t GetHostBytes(MemoryTag tag) const { return m_HostCounters[static_cast<size_t>(tag)].current.load(std::memory_order_relaxed); }
+	uint64_t GetDeviceBytes(MemoryTag tag) const;
+
+	// Adds the memory of every tag and the heap allocations of this frame to the Profiler
+	void EndFrame();
+	void PrintReport() const;
+
+private:
+	MemoryTracker() = default;
+	~MemoryTracker() = default;
+
+	struct Counter
+	{
+		std::atomic<uint64_t> current{};
+		std::atomic<uint64_t> peak{};
+	};
+
+	struct DeviceAllocation
+	{
+		MemoryTag tag;
+		VkDeviceSize size;
+		uint32_t heapIndex;
+	};
+
+	struct DeviceCounter
+	{
+		uint64_t current;
+		uint64_t peak;
+		uint64_t allocationCount;
+	};
+
+	std::array<Counter, m_TagCount> m_HostCounters{};
+
+	VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+	mutable std::mutex m_DeviceMutex;
+	std::unordered_map<VkDeviceMemory, DeviceAllocation> m_DeviceAllocations;
+	std::array<DeviceCounter, m_TagCount> m_DeviceCounters{};
+	std::array<DeviceCounter, VK_MAX_MEMORY_HEAPS> m_HeapCounters{};
+
+	uint64_t m_LastAllocationCount{};
+};
+
+// Standard allocator that counts what it holds under Tag in the MemoryTracker
+template<typename T, MemoryTag Tag>
+class TaggedAllocator
+{
+public:
+	using value_type = T;
+
+	// The tag is a template argument, so the containers have to be told how to rebind
+	template<typename U>
+	struct rebind
+	{
+		using other = TaggedAllocator<U, Tag>;
+	};
+
+	TaggedAllocator() = default;
+	template<typename U>
+	TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {}
+
+	T* allocate(size_t count)
+	{
+		T* pMemory = static_cast<T*>(::operator new(count * sizeof(T)));
+		MemoryTracker::GetInstance().AddHost(Tag, count * sizeof(T));
+		return pMemory;
+	}
+
+	void deallocate(T* pMemory, size_t count) noexcept
+	{
+		MemoryTracker::GetInstance().RemoveHost(Tag, count * sizeof(T));
+		::operator delete(pMemory);
+	}
+
+	template<typename U>
+	bool operator==(const TaggedAllocator<U, Tag>&) const noexcept { return true; }
+	template<typename U>
+	bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+template<typename T, MemoryTag Tag>
+using TaggedVector = std::vector<T, TaggedAllocator<T, Tag>>;
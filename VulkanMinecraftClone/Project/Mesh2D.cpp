@@ -33,7 +33,7 @@ void Mesh2D::CreateVertexBuffer(VkDevice device, VkPhysicalDevice physicalDevice
         bufferSize, 
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-        stagingBuffer, stagingBufferMemory);
+        stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
 
     void* data;
     vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
@@ -46,12 +46,12 @@ void Mesh2D::CreateVertexBuffer(VkDevice device, VkPhysicalDevice physicalDevice
         bufferSize, 
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-        m_VkVertexBuffer, m_VkVertexBufferMemory);
+        m_VkVertexBuffer, m_VkVertexBufferMemory, MemoryTag::Meshes);
 
     CopyBuffer(device, commandPool, stagingBuffer, m_VkVertexBuffer, bufferSize);
 
     vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    FreeMemory(device, stagingBufferMemory);
 }
 
 void Mesh2D::CreateIndexBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
@@ -66,7 +66,7 @@ void Mesh2D::CreateIndexBuffer(VkDevice device, VkPhysicalDevice physicalDevice,
         bufferSize,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        stagingBuffer, stagingBufferMemory);
+        stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
 
     void* data;
     vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
@@ -79,12 +79,12 @@ void Mesh2D::CreateIndexBuffer(VkDevice device, VkPhysicalDevice physicalDevice,
         bufferSize,
         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        m_VkIndexBuffer, m_VkIndexBufferMemory);
+        m_VkIndexBuffer, m_VkIndexBufferMemory, MemoryTag::Meshes);
 
     CopyBuffer(device, commandPool, stagingBuffer, m_VkIndexBuffer, bufferSize);
 
     vkDestroyBuffer(device, stagingBuffer, nullptr);
-    vkFreeMemory(device, stagingBufferMemory, nullptr);
+    FreeMemory(device, stagingBufferMemory);
 }
 
 void Mesh2D::Draw(VkCommandBuffer buffer)
@@ -102,7 +102,7 @@ void Mesh2D::Draw(VkCommandBuffer buffer)
 void Mesh2D::DestroyMesh(VkDevice device)
 {
     vkDestroyBuffer(device, m_VkVertexBuffer, nullptr);
-    vkFreeMemory(device, m_VkVertexBufferMemory, nullptr);
+    FreeMemory(device, m_VkVertexBufferMemory);
     vkDestroyBuffer(device, m_VkIndexBuffer, nullptr);
-    vkFreeMemory(device, m_VkIndexBufferMemory, nullptr);
+    FreeMemory(device, m_VkIndexBufferMemory);
 }
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OCCLUSION_CULLER_SSE2
+#include <emmintrin.h>
+#endif
+
+OcclusionCuller::OcclusionCuller()
+    : m_DepthBuffer(m_BufferWidth * m_BufferHeight, 0.f)
+{
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPosition)
+{
+    m_ViewProjection = viewProjection;
+    m_CameraPosition = cameraPosition;
+    std::fill(m_DepthBuffer.begin(), m_DepthBuffer.end(), 0.f);
+    m_TileDepth.fill(0.f);
+}
+
+void OcclusionCuller::AddOccluder(const glm::vec3& min, const glm::vec3& max)
+{
+    // Only the faces pointing towards the camera can be the closest surface, so the back faces are skipped
+    if (m_CameraPosition.x < min.x)
+    {
+        RasterizeQuad({ glm::vec3{ min.x, min.y, min.z }, { min.x, max.y, min.z }, { min.x, max.y, max.z }, { min.x, min.y, max.z } });
+    }
+    else if (m_CameraPosition.x > max.x)
+    {
+        RasterizeQuad({ glm::vec3{ max.x, min.y, min.z }, { max.x, max.y, min.z }, { max.x, max.y, max.z }, { max.x, min.y, max.z } });
+    }
+
+    if (m_CameraPosition.y < min.y)
+    {
+        RasterizeQuad({ glm::vec3{ min.x, min.y, min.z }, { max.x, min.y, min.z }, { max.x, min.y, max.z }, { min.x, min.y, max.z } });
+    }
+    else if (m_CameraPosition.y > max.y)
+    {
+        RasterizeQuad({ glm::vec3{ min.x, max.y, min.z }, { max.x, max.y, min.z }, { max.x, max.y, max.z }, { min.x, max.y, max.z } });
+    }
+
+    if (m_CameraPosition.z < min.z)
+    {
+        RasterizeQuad({ glm::vec3{ min.x, min.y, min.z }, { max.x, min.y, min.z }, { max.x, max.y, min.z }, { min.x, max.y, min.z } });
+    }
+    else if (m_CameraPosition.z > max.z)
+    {
+        RasterizeQuad({ glm::vec3{ min.x, min.y, max.z }, { max.x, min.y, max.z }, { max.x, max.y, max.z }, { min.x, max.y, max.z } });
+    }
+}
+
+void OcclusionCuller::EndOccluders()
+{
+    for (int tileY = 0; tileY < m_TilesY; ++tileY)
+    {
+        for (int tileX = 0; tileX < m_TilesX; ++tileX)
+        {
+            float farthest = std::numeric_limits<float>::max();
+            for (int y = tileY * m_TileSize; y < (tileY + 1) * m_TileSize; ++y)
+            {
+                const float* row = &m_DepthBuffer[y * m_BufferWidth + tileX * m_TileSize];
+                farthest = std::min(farthest, *std::min_element(row, row + m_TileSize));
+            }
+            m_TileDepth[tileX + tileY * m_TilesX] = farthest;
+        }
+    }
+}
+
+OcclusionCuller::Result OcclusionCuller::TestBox(const glm::vec3& min, const glm::vec3& max) const
+{
+    ScreenBox screenBox;
+    const Result projection = ProjectBox(min, max, screenBox);
+    if (projection != Result::Occluded)
+    {
+        return projection;
+    }
+
+    const float closest = screenBox.closest;
+    const int pixelMinX = std::max(0, static_cast<int>(screenBox.minX));
+    const int pixelMinY = std::max(0, static_cast<int>(screenBox.minY));
+    const int pixelMaxX = std::min(m_BufferWidth - 1, static_cast<int>(screenBox.maxX));
+    const int pixelMaxY = std::min(m_BufferHeight - 1, static_cast<int>(screenBox.maxY));
+
+    for (int tileY = pixelMinY / m_TileSize; tileY <= pixelMaxY / m_TileSize; ++tileY)
+    {
+        for (int tileX = pixelMinX / m_TileSize; tileX <= pixelMaxX / m_TileSize; ++tileX)
+        {
+            // Every occluder inside the tile is closer, no need to look at the pixels
+            if (m_TileDepth[tileX + tileY * m_TilesX] > closest)
+            {
+                continue;
+            }
+
+            const int startX = std::max(pixelMinX, tileX * m_TileSize);
+            const int endX = std::min(pixelMaxX, (tileX + 1) * m_TileSize - 1);
+            const int startY = std::max(pixelMinY, tileY * m_TileSize);
+            const int endY = std::min(pixelMaxY, (tileY + 1) * m_TileSize - 1);
+            for (int y = startY; y <= endY; ++y)
+            {
+                if (!IsRowOccluded(&m_DepthBuffer[y * m_BufferWidth], startX, endX, closest))
+                {
+                    return Result::Visible;
+                }
+            }
+        }
+    }
+
+    return Result::Occluded;
+}
+
+bool OcclusionCuller::IsInFrustum(const glm::vec3& min, const glm::vec3& max) const
+{
+    ScreenBox screenBox;
+    return ProjectBox(min, max, screenBox) != Result::FrustumCulled;
+}
+
+OcclusionCuller::Result OcclusionCuller::ProjectBox(const glm::vec3& min, const glm::vec3& max, ScreenBox& screenBox) const
+{
+    screenBox.minX = std::numeric_limits<float>::max();
+    screenBox.minY = std::numeric_limits<float>::max();
+    screenBox.maxX = std::numeric_limits<float>::lowest();
+    screenBox.maxY = std::numeric_limits<float>::lowest();
+    screenBox.closest = 0.f;
+    int cornersBehind = 0;
+
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 position{
+            (corner & 1) ? max.x : min.x,
+            (corner & 2) ? max.y : min.y,
+            (corner & 4) ? max.z : min.z };
+
+        ScreenVertex vertex;
+        if (!ProjectPoint(position, vertex))
+        {
+            ++cornersBehind;
+            continue;
+        }
+
+        screenBox.minX = std::min(screenBox.minX, vertex.x);
+        screenBox.minY = std::min(screenBox.minY, vertex.y);
+        screenBox.maxX = std::max(screenBox.maxX, vertex.x);
+        screenBox.maxY = std::max(screenBox.maxY, vertex.y);
+        // The depth is affine in world space so the closest point of the box is always one of the corners
+        screenBox.closest = std::max(screenBox.closest, vertex.invW);
+    }
+
+    if (cornersBehind == 8)
+    {
+        return Result::FrustumCulled;
+    }
+    if (cornersBehind > 0)
+    {
+        // The box crosses the near plane, it can't be rejected
+        return Result::Visible;
+    }
+
+    if (screenBox.maxX < 0.f || screenBox.maxY < 0.f || screenBox.minX >= m_BufferWidth || screenBox.minY >= m_BufferHeight)
+    {
+        return Result::FrustumCulled;
+    }
+
+    return Result::Occluded;
+}
+
+bool OcclusionCuller::ProjectPoint(const glm::vec3& position, ScreenVertex& vertex) const
+{
+    const glm::vec4 clip = m_ViewProjection * glm::vec4(position, 1.f);
+    if (clip.w < m_NearW)
+    {
+        return false;
+    }
+
+    vertex.invW = 1.f / clip.w;
+    vertex.x = (clip.x * vertex.invW * 0.5f + 0.5f) * m_BufferWidth;
+    vertex.y = (clip.y * vertex.invW * 0.5f + 0.5f) * m_BufferHeight;
+    return true;
+}
+
+void OcclusionCuller::RasterizeQuad(const std::array<glm::vec3, 4>& corners)
+{
+    std::array<ScreenVertex, 4> vertices;
+    for (size_t i = 0; i < corners.size(); ++i)
+    {
+        // Occluders crossing the near plane are skipped instead of clipped
+        if (!ProjectPoint(corners[i], vertices[i]))
+        {
+            return;
+        }
+    }
+
+    float area = 0.f;
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const ScreenVertex& current = vertices[i];
+        const ScreenVertex& next = vertices[(i + 1) % vertices.size()];
+        area += current.x * next.y - next.x * current.y;
+        minX = std::min(minX, current.x);
+        minY = std::min(minY, current.y);
+        maxX = std::max(maxX, current.x);
+        maxY = std::max(maxY, current.y);
+    }
+
+    if (std::abs(area) < 1e-6f)
+    {
+        return;
+    }
+
+    // Edge functions, positive on the inside regardless of the winding on screen
+    const float winding = area > 0.f ? 1.f : -1.f;
+    std::array<glm::vec3, 4> edges;
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const ScreenVertex& current = vertices[i];
+        const ScreenVertex& next = vertices[(i + 1) % vertices.size()];
+        edges[i] = winding * glm::vec3{
+            current.y - next.y,
+            next.x - current.x,
+            current.x * next.y - next.x * current.y };
+    }
+
+    // The quad is planar so 1/w is a plane in screen space
+    const ScreenVertex& v0 = vertices[0];
+    const float dx1 = vertices[1].x - v0.x;
+    const float dy1 = vertices[1].y - v0.y;
+    const float dz1 = vertices[1].invW - v0.invW;
+    const float dx2 = vertices[2].x - v0.x;
+    const float dy2 = vertices[2].y - v0.y;
+    const float dz2 = vertices[2].invW - v0.invW;
+    const float determinant = dx1 * dy2 - dx2 * dy1;
+    if (std::abs(determinant) < 1e-6f)
+    {
+        return;
+    }
+    const float depthStepX = (dz1 * dy2 - dz2 * dy1) / determinant;
+    const float depthStepY = (dx1 * dz2 - dx2 * dz1) / determinant;
+
+    // Pixels are covered when their center is inside the quad
+    const int startX = std::max(0, static_cast<int>(std::ceil(minX - 0.5f)));
+    const int startY = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+    const int endX = std::min(m_BufferWidth - 1, static_cast<int>(std::floor(maxX - 0.5f)));
+    const int endY = std::min(m_BufferHeight - 1, static_cast<int>(std::floor(maxY - 0.5f)));
+
+    for (int y = startY; y <= endY; ++y)
+    {
+        const float centerY = y + 0.5f;
+        float* row = &m_DepthBuffer[y * m_BufferWidth];
+        for (int x = startX; x <= endX; ++x)
+        {
+            const float centerX = x + 0.5f;
+            bool isInside = true;
+            for (const glm::vec3& edge : edges)
+            {
+                if (edge.x * centerX + edge.y * centerY + edge.z < 0.f)
+                {
+                    isInside = false;
+                    break;
+                }
+            }
+
+            if (isInside)
+            {
+                const float depth = v0.invW + (centerX - v0.x) * depthStepX + (centerY - v0.y) * depthStepY;
+                row[x] = std::max(row[x], depth);
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::IsRowOccluded(const float* row, int minX, int maxX, float invW) const
+{
+    // A pixel only hides the box if the occluder in it is closer than the closest point of the box
+    int x = minX;
+#ifdef OCCLUSION_CULLER_SSE2
+    const __m128 boxDepth = _mm_set1_ps(invW);
+    for (; x + 3 <= maxX; x += 4)
+    {
+        const __m128 notHidden = _mm_cmple_ps(_mm_loadu_ps(row + x), boxDepth);
+        if (_mm_movemask_ps(notHidden) != 0)
+        {
+            return false;
+        }
+    }
+#endif
+    for (; x <= maxX; ++x)
+    {
+        if (row[x] <= invW)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+
+// CPU software occlusion culler
+// Coarse occluders (boxes that are known to be completely solid) are rasterized into a small depth buffer,
+// afterwards the bounding boxes of the chunk sections are tested against it.
+// Depth is stored as 1/w so it can be interpolated linearly in screen space: 0 means nothing was rasterized
+// and a bigger value is closer to the camera.
+// The class has no Vulkan dependencies so it can be run headless on synthetic scenes.
+class OcclusionCuller final
+{
+public:
+    static constexpr int m_BufferWidth = 256;
+    static constexpr int m_BufferHeight = 128;
+    static constexpr int m_TileSize = 8;
+    static constexpr int m_TilesX = m_BufferWidth / m_TileSize;
+    static constexpr int m_TilesY = m_BufferHeight / m_TileSize;
+    static constexpr float m_NearW = 0.1f;
+
+    enum class Result : unsigned char
+    {
+        Visible,
+        FrustumCulled,
+        Occluded
+    };
+
+public:
+    OcclusionCuller();
+
+    // Clears the depth buffer, must be called before adding the occluders of a frame
+    void BeginFrame(const glm::mat4& viewProjection, const glm::vec3& cameraPosition);
+
+    // Rasterizes the faces of a solid box that are facing the camera
+    void AddOccluder(const glm::vec3& min, const glm::vec3& max);
+
+    // Builds the per tile depth after all occluders are rasterized, must be called before testing
+    void EndOccluders();
+
+    Result TestBox(const glm::vec3& min, const glm::vec3& max) const;
+
+    // Only tests the box against the view, can be used before the occluders are rasterized
+    bool IsInFrustum(const glm::vec3& min, const glm::vec3& max) const;
+
+    float GetDepth(int x, int y) const { return m_DepthBuffer[x + y * m_BufferWidth]; }
+
+private:
+    struct ScreenVertex
+    {
+        float x;
+        float y;
+        float invW;
+    };
+
+    glm::mat4 m_ViewProjection{ 1.f };
+    glm::vec3 m_CameraPosition{};
+    std::vector<float> m_DepthBuffer;
+    // Farthest depth inside every tile, lets whole tiles be accepted without touching the pixels
+    std::array<float, m_TilesX * m_TilesY> m_TileDepth{};
+
+private:
+    struct ScreenBox
+    {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        float closest;
+    };
+
+    bool ProjectPoint(const glm::vec3& position, ScreenVertex& vertex) const;
+    // Returns FrustumCulled when the box is out of view, Occluded when it can be tested against the depth buffer
+    Result ProjectBox(const glm::vec3& min, const glm::vec3& max, ScreenBox& screenBox) const;
+    void RasterizeQuad(const std::array<glm::vec3, 4>& corners);
+    bool IsRowOccluded(const float* row, int minX, int maxX, float invW) const;
+};
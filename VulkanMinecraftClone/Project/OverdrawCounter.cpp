@@ -0,0 +1,243 @@
+#include "OverdrawCounter.h"
+#include "SwapchainManager.h"
+#include "vulkanbase/VulkanUtil.h"
+#include <glm/gtc/packing.hpp>
+#include <array>
+#include <stdexcept>
+
+OverdrawCounter::Result OverdrawCounter::CountFragments(const uint16_t* pCounts, size_t pixelCount)
+{
+	Result result{ 0, 0, pixelCount };
+	for (size_t pixel = 0; pixel < pixelCount; ++pixel)
+	{
+		const uint64_t count = static_cast<uint64_t>(glm::unpackHalf1x16(pCounts[pixel]) + 0.5f);
+		result.fragmentCount += count;
+		result.coveredPixelCount += count > 0 ? 1 : 0;
+	}
+	return result;
+}
+
+void OverdrawCounter::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, PipelineLayout3D& pipelineLayout)
+{
+	m_Device = device;
+	m_PhysicalDevice = physicalDevice;
+	m_CommandPool = commandPool;
+	m_pPipelineLayout = &pipelineLayout;
+	m_Extent = SwapchainManager::GetInstance().GetSwapchainExtent();
+
+	const VkFormat depthFormat = FindDepthFormat(device, physicalDevice);
+	CreateRenderPass(depthFormat);
+	CreateImage(m_CountFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_IMAGE_ASPECT_COLOR_BIT,
+		m_CountImage, m_CountImageMemory, m_CountImageView);
+	CreateImage(depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
+		m_DepthImage, m_DepthImageMemory, m_DepthImageView);
+	CreateFramebuffer();
+
+	CreateBuffer(device, physicalDevice, static_cast<VkDeviceSize>(m_Extent.width) * m_Extent.height * sizeof(uint16_t),
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_ReadbackBuffer, m_ReadbackBufferMemory);
+
+	m_BlockPipeline = std::make_unique<GraphicsPipeline3D>(device, pipelineLayout, m_RenderPass, "shaders/shaderLand.vert.spv",
+		"shaders/shaderOverdraw.frag.spv", VertexLayout::Block, ShaderConstants{}, ShaderVariant{}, BlendMode::Additive);
+	m_FacePipeline = std::make_unique<GraphicsPipeline3D>(device, pipelineLayout, m_RenderPass, "shaders/shaderFace.vert.spv",
+		"shaders/shaderOverdraw.frag.spv", VertexLayout::Face, ShaderConstants{}, ShaderVariant{}, BlendMode::Additive);
+}
+
+void OverdrawCounter::Destroy()
+{
+	m_BlockPipeline->DestroyPipeline(m_Device);
+	m_FacePipeline->DestroyPipeline(m_Device);
+
+	vkDestroyBuffer(m_Device, m_ReadbackBuffer, nullptr);
+	FreeMemory(m_Device, m_ReadbackBufferMemory);
+
+	vkDestroyFramebuffer(m_Device, m_Framebuffer, nullptr);
+	vkDestroyImageView(m_Device, m_CountImageView, nullptr);
+	vkDestroyImage(m_Device, m_CountImage, nullptr);
+	FreeMemory(m_Device, m_CountImageMemory);
+	vkDestroyImageView(m_Device, m_DepthImageView, nullptr);
+	vkDestroyImage(m_Device, m_DepthImage, nullptr);
+	FreeMemory(m_Device, m_DepthImageMemory);
+	vkDestroyRenderPass(m_Device, m_RenderPass, nullptr);
+}
+
+OverdrawCounter::Result OverdrawCounter::Measure(const DrawFunction& drawLand, bool isFaceRendering, bool isDepthPrePass)
+{
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(m_Device, m_CommandPool);
+
+	std::array<VkClearValue, 2> clearValues{};
+	clearValues[0].color = { { 0.f, 0.f, 0.f, 0.f } };
+	clearValues[1].depthStencil = { 1.0f, 0 };
+
+	VkRenderPassBeginInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = m_RenderPass;
+	renderPassInfo.framebuffer = m_Framebuffer;
+	renderPassInfo.renderArea.extent = m_Extent;
+	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+	renderPassInfo.pClearValues = clearValues.data();
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	VkViewport viewport{ 0.f, 0.f, static_cast<float>(m_Extent.width), static_cast<float>(m_Extent.height), 0.f, 1.f };
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+	VkRect2D scissor{ { 0, 0 }, m_Extent };
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+	// No frame is in flight, so the uniform buffer of the first image can be overwritten
+	m_pPipelineLayout->UpdateUniformBuffer(m_Device, 0);
+	m_pPipelineLayout->BindDescriptorSets(commandBuffer, 0);
+
+	GraphicsPipeline3D& pipeline = isFaceRendering ? *m_FacePipeline : *m_BlockPipeline;
+	ShaderVariant variant{};
+	if (isDepthPrePass)
+	{
+		variant.depthPass = DepthPass::DepthOnly;
+		pipeline.BindPipeline(commandBuffer, variant);
+		drawLand(commandBuffer, m_pPipelineLayout->GetHandle());
+		variant.depthPass = DepthPass::Shade;
+	}
+	pipeline.BindPipeline(commandBuffer, variant);
+	drawLand(commandBuffer, m_pPipelineLayout->GetHandle());
+
+	vkCmdEndRenderPass(commandBuffer);
+
+	// The render pass leaves the counts in transfer source layout
+	VkBufferImageCopy region{};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { m_Extent.width, m_Extent.height, 1 };
+	vkCmdCopyImageToBuffer(commandBuffer, m_CountImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_ReadbackBuffer, 1, &region);
+
+	endSingleTimeCommands(m_Device, m_CommandPool, commandBuffer);
+
+	const size_t pixelCount = static_cast<size_t>(m_Extent.width) * m_Extent.height;
+	void* pData;
+	vkMapMemory(m_Device, m_ReadbackBufferMemory, 0, pixelCount * sizeof(uint16_t), 0, &pData);
+	const Result result = CountFragments(static_cast<const uint16_t*>(pData), pixelCount);
+	vkUnmapMemory(m_Device, m_ReadbackBufferMemory);
+	return result;
+}
+
+void OverdrawCounter::CreateRenderPass(VkFormat depthFormat)
+{
+	VkAttachmentDescription countAttachment{};
+	countAttachment.format = m_CountFormat;
+	countAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	countAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	countAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	countAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	countAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	countAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	countAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+	VkAttachmentDescription depthAttachment{};
+	depthAttachment.format = depthFormat;
+	depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+	depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference countAttachmentRef{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	VkAttachmentReference depthAttachmentRef{ 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+	VkSubpassDescription subpass{};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &countAttachmentRef;
+	subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+	// The copy to the readback buffer waits for the blending to finish
+	VkSubpassDependency dependency{};
+	dependency.srcSubpass = 0;
+	dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+	dependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+	const std::array<VkAttachmentDescription, 2> attachments{ countAttachment, depthAttachment };
+	VkRenderPassCreateInfo renderPassInfo{};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	renderPassInfo.pAttachments = attachments.data();
+	renderPassInfo.subpassCount = 1;
+	renderPassInfo.pSubpasses = &subpass;
+	renderPassInfo.dependencyCount = 1;
+	renderPassInfo.pDependencies = &dependency;
+
+	if (vkCreateRenderPass(m_Device, &renderPassInfo, nullptr, &m_RenderPass) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create overdraw render pass!");
+	}
+}
+
+void OverdrawCounter::CreateImage(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, VkImage& image, VkDeviceMemory& imageMemory, VkImageView& imageView)
+{
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.extent = { m_Extent.width, m_Extent.height, 1 };
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.format = format;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageInfo.usage = usage;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateImage(m_Device, &imageInfo, nullptr, &image) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create overdraw image!");
+	}
+
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(m_Device, image, &memRequirements);
+
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = memRequirements.size;
+	allocInfo.memoryTypeIndex = FindMemoryType(m_PhysicalDevice, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	if (AllocateMemory(m_Device, allocInfo, MemoryTag::Other, imageMemory) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to allocate overdraw image memory!");
+	}
+	vkBindImageMemory(m_Device, image, imageMemory, 0);
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.subresourceRange.aspectMask = aspect;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(m_Device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create overdraw image view!");
+	}
+}
+
+void OverdrawCounter::CreateFramebuffer()
+{
+	const std::array<VkImageView, 2> attachments{ m_CountImageView, m_DepthImageView };
+
+	VkFramebufferCreateInfo framebufferInfo{};
+	framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+	framebufferInfo.renderPass = m_RenderPass;
+	framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+	framebufferInfo.pAttachments = attachments.data();
+	framebufferInfo.width = m_Extent.width;
+	framebufferInfo.height = m_Extent.height;
+	framebufferInfo.layers = 1;
+
+	if (vkCreateFramebuffer(m_Device, &framebufferInfo, nullptr, &m_Framebuffer) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create overdraw framebuffer!");
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "GraphicsPipeline3D.h"
+
+// Measures how many fragments the land costs: the land is drawn into an offscreen R16_SFLOAT target with additive
+// blending and shaders/shaderOverdraw.frag, so every fragment that passes the depth test adds one to its pixel.
+// The target is read back and summed on the cpu. Only uses core Vulkan 1.0, so it also runs on software drivers
+// like lavapipe or SwiftShader where there is nothing else to profile the fragment work with.
+class OverdrawCounter final
+{
+public:
+	// Half floats count exactly up to 2048 fragments per pixel, and blending into them is required by the spec
+	static constexpr VkFormat m_CountFormat = VK_FORMAT_R16_SFLOAT;
+
+	struct Result
+	{
+		uint64_t fragmentCount;
+		// Pixels with at least one fragment
+		uint64_t coveredPixelCount;
+		uint64_t pixelCount;
+
+		// Fragments shaded per pixel that shows land, 1 means nothing was shaded twice
+		double GetOverdraw() const { return coveredPixelCount > 0 ? static_cast<double>(fragmentCount) / coveredPixelCount : 0.0; }
+	};
+
+	// Records the land draws of the game, gets the command buffer and the layout the pipeline is bound with
+	using DrawFunction = std::function<void(VkCommandBuffer, VkPipelineLayout)>;
+
+	// Sums the half float counts the gpu wrote
+	static Result CountFragments(const uint16_t* pCounts, size_t pixelCount);
+
+public:
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool, PipelineLayout3D& pipelineLayout);
+	void Destroy();
+
+	// Draws the land once and waits for the gpu, the caller makes sure no frame is in flight.
+	// With the depth pre-pass the land is drawn twice and only the second pass is counted.
+	Result Measure(const DrawFunction& drawLand, bool isFaceRendering, bool isDepthPrePass);
+
+private:
+	VkDevice m_Device{ VK_NULL_HANDLE };
+	VkPhysicalDevice m_PhysicalDevice{ VK_NULL_HANDLE };
+	VkCommandPool m_CommandPool{ VK_NULL_HANDLE };
+	PipelineLayout3D* m_pPipelineLayout{};
+	VkExtent2D m_Extent{};
+
+	VkRenderPass m_RenderPass{ VK_NULL_HANDLE };
+	VkFramebuffer m_Framebuffer{ VK_NULL_HANDLE };
+	VkImage m_CountImage{ VK_NULL_HANDLE };
+	VkDeviceMemory m_CountImageMemory{ VK_NULL_HANDLE };
+	VkImageView m_CountImageView{ VK_NULL_HANDLE };
+	VkImage m_DepthImage{ VK_NULL_HANDLE };
+	VkDeviceMemory m_DepthImageMemory{ VK_NULL_HANDLE };
+	VkImageView m_DepthImageView{ VK_NULL_HANDLE };
+	// Host visible copy of the count image
+	VkBuffer m_ReadbackBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_ReadbackBufferMemory{ VK_NULL_HANDLE };
+
+	// Same vertex shaders as the land pipelines, so the depth test behaves the same
+	std::unique_ptr<GraphicsPipeline3D> m_BlockPipeline;
+	std::unique_ptr<GraphicsPipeline3D> m_FacePipeline;
+
+	void CreateRenderPass(VkFormat depthFormat);
+	void CreateImage(VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, VkImage& image, VkDeviceMemory& imageMemory, VkImageView& imageView);
+	void CreateFramebuffer();
+};
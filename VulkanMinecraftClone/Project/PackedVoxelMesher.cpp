@@ -0,0 +1,147 @@
+#include "PackedVoxelMesher.h"
+#include "FaceTable.h"
+
+namespace
+{
+	int GetPaddedIndex(int x, int y, int z)
+	{
+		return (x + 1) + y * PackedVoxelMesher::m_PaddedWidth + (z + 1) * PackedVoxelMesher::m_PaddedWidth * ChunkBlocks::m_Height;
+	}
+
+	BlockType GetPackedBlock(const PackedVoxelMesher::PackedVoxels& voxels, int x, int y, int z)
+	{
+		if (y < 0 || y >= ChunkBlocks::m_Height)
+		{
+			return BlockType::Air;
+		}
+
+		const int index = GetPaddedIndex(x, y, z);
+		return static_cast<BlockType>((voxels[index >> 2] >> ((index & 3) * 8)) & 0xFF);
+	}
+
+	bool HasBit(uint32_t mask, BlockType blockType)
+	{
+		return (mask >> static_cast<uint32_t>(blockType)) & 1;
+	}
+}
+
+PackedVoxelMesher::PackedVoxels PackedVoxelMesher::PackVoxels(const ChunkBlocks& blocks, const ChunkBlocks* pEast, const ChunkBlocks* pWest, const ChunkBlocks* pNorth, const ChunkBlocks* pSouth)
+{
+	PackedVoxels voxels((m_PaddedBlockCount + 3) / 4, 0);
+	const auto setBlock = [&voxels](int x, int y, int z, BlockType blockType)
+		{
+			const int index = GetPaddedIndex(x, y, z);
+			voxels[index >> 2] |= static_cast<uint32_t>(blockType) << ((index & 3) * 8);
+		};
+
+	for (int z = -1; z <= ChunkBlocks::m_Depth; ++z)
+	{
+		for (int y = 0; y < ChunkBlocks::m_Height; ++y)
+		{
+			for (int x = -1; x <= ChunkBlocks::m_Width; ++x)
+			{
+				const bool isBorderX = x < 0 || x >= ChunkBlocks::m_Width;
+				const bool isBorderZ = z < 0 || z >= ChunkBlocks::m_Depth;
+
+				// The corners of the border are never looked at
+				BlockType blockType = BlockType::Air;
+				if (!isBorderX && !isBorderZ)
+				{
+					blockType = blocks.Get(x, y, z);
+				}
+				else if (isBorderX && !isBorderZ)
+				{
+					const ChunkBlocks* pNeighbor = x < 0 ? pWest : pEast;
+					if (pNeighbor != nullptr)
+					{
+						blockType = pNeighbor->Get(x < 0 ? ChunkBlocks::m_Width - 1 : 0, y, z);
+					}
+				}
+				else if (!isBorderX && isBorderZ)
+				{
+					const ChunkBlocks* pNeighbor = z < 0 ? pNorth : pSouth;
+					if (pNeighbor != nullptr)
+					{
+						blockType = pNeighbor->Get(x, y, z < 0 ? ChunkBlocks::m_Depth - 1 : 0);
+					}
+				}
+
+				setBlock(x, y, z, blockType);
+			}
+		}
+	}
+
+	return voxels;
+}
+
+void PackedVoxelMesher::MeshOnCpu(const PackedVoxels& voxels, const std::vector<uint32_t>& faceTextures, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	vertices.clear();
+	indices.clear();
+
+	const BlockRegistry& blockRegistry = BlockRegistry::GetInstance();
+	const uint32_t opaqueMask = blockRegistry.GetOpaqueMask();
+	const uint32_t landMask = blockRegistry.GetLayerMask(RenderLayer::Land);
+	const uint32_t cullSameTypeMask = blockRegistry.GetCullSameTypeMask();
+
+	for (int z = 0; z < ChunkBlocks::m_Depth; ++z)
+	{
+		for (int y = 0; y < ChunkBlocks::m_Height; ++y)
+		{
+			for (int x = 0; x < ChunkBlocks::m_Width; ++x)
+			{
+				const BlockType blockType = GetPackedBlock(voxels, x, y, z);
+				if (!HasBit(landMask, blockType))
+				{
+					continue;
+				}
+				const bool cullsSameType = HasBit(cullSameTypeMask, blockType);
+
+				for (int direction = 0; direction < FACE_COUNT; ++direction)
+				{
+					const FaceDefinition& face = FACE_TABLE[direction];
+					const glm::ivec3 normal{ face.normal[0], face.normal[1], face.normal[2] };
+					const BlockType neighborBlockType = GetPackedBlock(voxels, x + normal.x, y + normal.y, z + normal.z);
+					if (HasBit(opaqueMask, neighborBlockType) || (cullsSameType && neighborBlockType == blockType))
+					{
+						continue;
+					}
+
+					const float textureLayer = static_cast<float>(faceTextures[static_cast<size_t>(blockType) * FACE_COUNT + direction]);
+
+					const uint32_t firstVertex = static_cast<uint32_t>(vertices.size());
+					for (int corner = 0; corner < 4; ++corner)
+					{
+						const auto& offset = face.corners[corner];
+						const auto& texCorner = face.texCorners[corner];
+						vertices.emplace_back(Vertex{
+							glm::vec3(x, y, z) + glm::vec3(offset[0], offset[1], offset[2]) * 0.5f,
+							glm::vec3(normal),
+							glm::vec3(texCorner[0], texCorner[1], textureLayer) });
+					}
+
+					indices.emplace_back(firstVertex);
+					indices.emplace_back(firstVertex + 1);
+					indices.emplace_back(firstVertex + 2);
+					indices.emplace_back(firstVertex + 2);
+					indices.emplace_back(firstVertex + 3);
+					indices.emplace_back(firstVertex);
+				}
+			}
+		}
+	}
+}
+
+std::vector<uint32_t> PackedVoxelMesher::CreateFaceTextures()
+{
+	const size_t blockTypeCount = BlockRegistry::m_BlockTypeCount;
+	std::vector<uint32_t> faceTextures(blockTypeCount * FACE_COUNT, 0);
+	for (size_t blockType = 0; blockType < blockTypeCount; ++blockType)
+	{
+		for (int direction = 0; direction < FACE_COUNT; ++direction)
+		{
+			faceTextures[blockType * FACE_COUNT + direction] = BlockRegistry::GetInstance().GetFaceLayer(static_cast<BlockType>(blockType), static_cast<Direction>(direction));
+		}
+	}
+	return faceTextures;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "BlockMesh.h"
+#include "BlockRegistry.h"
+#include "VoxelStorage.h"
+
+// The blocks of a chunk plus a one block border of its neighbors packed four to a word, the input of
+// shaders/meshChunk.comp, and the cpu reference of that shader. Nothing in here needs Vulkan, so the
+// reference can be run headless against the LandMesher.
+class PackedVoxelMesher final
+{
+public:
+	static constexpr int m_PaddedWidth = ChunkBlocks::m_Width + 2;
+	static constexpr int m_PaddedDepth = ChunkBlocks::m_Depth + 2;
+	static constexpr int m_PaddedBlockCount = m_PaddedWidth * ChunkBlocks::m_Height * m_PaddedDepth;
+
+	// Block types of a chunk and its border, one byte per block,
+	// indexed with (x + 1) + y * paddedWidth + (z + 1) * paddedWidth * height
+	using PackedVoxels = std::vector<uint32_t>;
+
+	// Neighbors that aren't loaded are treated as air, same as the cpu mesher does at the chunk border
+	static PackedVoxels PackVoxels(const ChunkBlocks& blocks, const ChunkBlocks* pEast, const ChunkBlocks* pWest, const ChunkBlocks* pNorth, const ChunkBlocks* pSouth);
+
+	// Texture array layer of every face of every block type, indexed with blockType * FACE_COUNT + direction
+	static std::vector<uint32_t> CreateFaceTextures();
+
+	// Same as the compute shader, emits the faces in block order
+	static void MeshOnCpu(const PackedVoxels& voxels, const std::vector<uint32_t>& faceTextures, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+};
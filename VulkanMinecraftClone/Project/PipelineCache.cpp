@@ -0,0 +1,131 @@
+#include "PipelineCache.h"
+#include "Hash.h"
+#include "MemoryTracker.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+namespace
+{
+	constexpr uint32_t g_FileMagic = 0x43504B56; // "VKPC"
+	constexpr uint32_t g_FileVersion = 1;
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t driverVersion;
+		uint32_t dataSize;
+		uint64_t dataHash;
+	};
+}
+
+void PipelineCache::Initialize(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath)
+{
+	m_FilePath = filePath;
+	vkGetPhysicalDeviceProperties(physicalDevice, &m_Properties);
+
+	std::vector<char> file;
+	std::ifstream stream(filePath, std::ios::binary);
+	if (stream.is_open())
+	{
+		file.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+
+	const size_t dataOffset = ValidateFile(file, m_Properties);
+	if (dataOffset == 0 && !file.empty())
+	{
+		std::cout << "Pipeline cache " << filePath << " is stale or damaged, starting with an empty cache\n";
+	}
+	m_LoadedSize = dataOffset == 0 ? 0 : file.size() - dataOffset;
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = m_LoadedSize;
+	createInfo.pInitialData = m_LoadedSize == 0 ? nullptr : file.data() + dataOffset;
+
+	if (vkCreatePipelineCache(device, &createInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create pipeline cache!");
+	}
+	// The driver owns the pipelines and the cache, the size of the cache is the closest thing to their memory we can see
+	MemoryTracker::GetInstance().AddHost(MemoryTag::Pipelines, m_LoadedSize);
+}
+
+void PipelineCache::Destroy(VkDevice device)
+{
+	size_t size{};
+	std::vector<char> cacheData;
+	if (vkGetPipelineCacheData(device, m_PipelineCache, &size, nullptr) == VK_SUCCESS && size > 0)
+	{
+		cacheData.resize(size);
+		if (vkGetPipelineCacheData(device, m_PipelineCache, &size, cacheData.data()) != VK_SUCCESS)
+		{
+			cacheData.clear();
+		}
+		cacheData.resize(size);
+	}
+
+	if (!cacheData.empty())
+	{
+		const std::vector<char> file = BuildFile(cacheData, m_Properties);
+		std::ofstream stream(m_FilePath, std::ios::binary | std::ios::trunc);
+		if (!stream.write(file.data(), file.size()))
+		{
+			std::cout << "Failed to write the pipeline cache\n";
+		}
+	}
+
+	vkDestroyPipelineCache(device, m_PipelineCache, nullptr);
+	m_PipelineCache = VK_NULL_HANDLE;
+	MemoryTracker::GetInstance().RemoveHost(MemoryTag::Pipelines, m_LoadedSize);
+}
+
+size_t PipelineCache::ValidateFile(const std::vector<char>& file, const VkPhysicalDeviceProperties& properties)
+{
+	FileHeader header{};
+	if (file.size() < sizeof(header))
+	{
+		return 0;
+	}
+	memcpy(&header, file.data(), sizeof(header));
+	if (header.magic != g_FileMagic || header.version != g_FileVersion || header.driverVersion != properties.driverVersion
+		|| header.dataSize != file.size() - sizeof(header))
+	{
+		return 0;
+	}
+
+	const char* pData = file.data() + sizeof(header);
+	if (HashBytes(pData, header.dataSize) != header.dataHash)
+	{
+		return 0;
+	}
+
+	// The header Vulkan puts in front of its own data
+	VkPipelineCacheHeaderVersionOne cacheHeader{};
+	if (header.dataSize < sizeof(cacheHeader))
+	{
+		return 0;
+	}
+	memcpy(&cacheHeader, pData, sizeof(cacheHeader));
+	if (cacheHeader.headerSize < sizeof(cacheHeader) || cacheHeader.headerSize > header.dataSize
+		|| cacheHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		|| cacheHeader.vendorID != properties.vendorID || cacheHeader.deviceID != properties.deviceID
+		|| memcmp(cacheHeader.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+	{
+		return 0;
+	}
+	return sizeof(header);
+}
+
+std::vector<char> PipelineCache::BuildFile(const std::vector<char>& cacheData, const VkPhysicalDeviceProperties& properties)
+{
+	const FileHeader header{ g_FileMagic, g_FileVersion, properties.driverVersion, static_cast<uint32_t>(cacheData.size()), HashBytes(cacheData.data(), cacheData.size()) };
+
+	std::vector<char> file(sizeof(header) + cacheData.size());
+	memcpy(file.data(), &header, sizeof(header));
+	memcpy(file.data() + sizeof(header), cacheData.data(), cacheData.size());
+	return file;
+}
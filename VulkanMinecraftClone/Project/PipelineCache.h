@@ -0,0 +1,44 @@
+#pragma once
+#include <vulkan/vulkan_core.h>
+#include <string>
+#include <vector>
+
+// VkPipelineCache shared by every pipeline, loaded from disk at startup and written back at shutdown.
+// The file starts with a header of our own (size, checksum and driver version) followed by the data Vulkan returned,
+// data that was made by another device or driver is dropped and the cache starts empty.
+class PipelineCache final
+{
+public:
+	static PipelineCache& GetInstance()
+	{
+		static PipelineCache instance;
+		return instance;
+	}
+
+	PipelineCache(const PipelineCache&) = delete;
+	PipelineCache(PipelineCache&&) noexcept = delete;
+	PipelineCache& operator=(const PipelineCache&) = delete;
+	PipelineCache& operator=(PipelineCache&&) noexcept = delete;
+
+	void Initialize(VkDevice device, VkPhysicalDevice physicalDevice, const std::string& filePath);
+	// Writes the cache to disk and destroys it, call before the device is destroyed
+	void Destroy(VkDevice device);
+
+	VkPipelineCache GetHandle() const { return m_PipelineCache; }
+	// Bytes of valid cache data found on disk, 0 on a cold start
+	size_t GetLoadedSize() const { return m_LoadedSize; }
+
+	// Checks our header and the VkPipelineCacheHeaderVersionOne inside it against the device.
+	// Returns the offset of the Vulkan data on success and 0 otherwise, needs no device so it can be tested headless.
+	static size_t ValidateFile(const std::vector<char>& file, const VkPhysicalDeviceProperties& properties);
+	static std::vector<char> BuildFile(const std::vector<char>& cacheData, const VkPhysicalDeviceProperties& properties);
+
+private:
+	PipelineCache() = default;
+	~PipelineCache() = default;
+
+	VkPipelineCache m_PipelineCache{ VK_NULL_HANDLE };
+	VkPhysicalDeviceProperties m_Properties{};
+	std::string m_FilePath;
+	size_t m_LoadedSize{};
+};
@@ -0,0 +1,325 @@
+#pragma once
+#include "vulkanbase\VulkanUtil.h"
+#include <array>
+#include <stdexcept>
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE 
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <Camera.h>
+#include <BlockMeshGenerator.h>
+
+struct UniformBufferObject
+{
+	alignas(16)	glm::mat4 view;
+	glm::mat4 proj;
+};
+
+struct PushConstants
+{
+	glm::ivec3 translation;
+	float time;
+};
+
+// Descriptor set layout, uniform buffers, descriptor sets and pipeline layout shared by every 3D pipeline.
+// The land and water pipelines only differ in shaders and vertex layout, so they are variants on top of this one layout:
+// the camera is uploaded once per frame and the descriptor sets stay bound when switching between them.
+// Set 1 holds the face records of one chunk for the vertex pulling pipeline, every chunk that has them gets its own set.
+class PipelineLayout3D final
+{
+public:
+	// Enough for every chunk inside the view distance plus the ones waiting to be deleted
+	static constexpr uint32_t m_MaxFaceDescriptorSets = 1024;
+
+	PipelineLayout3D(VkDevice device, VkPhysicalDevice physicalDevice)
+		:
+		m_DescriptorSetLayout{ VK_NULL_HANDLE },
+		m_PipelineLayout{ VK_NULL_HANDLE },
+		m_DescriptorPool{ VK_NULL_HANDLE }
+	{
+		CreateDescriptorSetLayout(device, m_DescriptorSetLayout);
+		CreateFaceDescriptorSetLayout(device);
+		CreateUniformBuffers(device, physicalDevice);
+
+		CreateDescriptorPool(device);
+		CreateDescriptorSets(device);
+		CreateFaceDescriptorPool(device);
+
+		CreatePipelineLayout(device);
+	}
+
+	void CreatePipelineLayout(VkDevice device)
+	{
+		const std::array<VkDescriptorSetLayout, 2> setLayouts{ m_DescriptorSetLayout, m_FaceDescriptorSetLayout };
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+		//pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		VkPushConstantRange pushConstantRange = {};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; // Stage the push constant is accessible from
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(PushConstants);
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		pipelineLayoutInfo.flags = 0;
+
+		if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+		}
+	}
+
+	void CreateUniformBuffers(VkDevice device, VkPhysicalDevice physicalDevice)
+	{
+		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+
+		m_UniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		m_UniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
+		m_UniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+
+		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) 
+		{
+			CreateBuffer(
+				device, 
+				physicalDevice, 
+				bufferSize, 
+				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
+				m_UniformBuffers[i], m_UniformBuffersMemory[i]);
+
+			vkMapMemory(device, m_UniformBuffersMemory[i], 0, bufferSize, 0, &m_UniformBuffersMapped[i]);
+		}
+	}
+
+	void UpdateUniformBuffer(VkDevice device, uint32_t currentImage)
+	{
+		UniformBufferObject ubo{};
+
+		// Update view matrix using camera's view matrix
+		ubo.view = Camera::GetInstance().GetViewMatrix();
+
+		// Update projection matrix using camera's projection matrix
+		//ubo.proj = Camera::GetInstance().projectionMatrix;
+		glm::mat4 projection = glm::mat4(1.f);
+		projection = glm::perspective(
+			glm::radians(Camera::GetInstance().m_Zoom),
+			static_cast<float>(WIDTH) / HEIGHT,
+			NEAR_PLANE,
+			FAR_PLANE);
+		ubo.proj = projection;
+		// Ensure correct aspect ratio
+		ubo.proj[1][1] *= -1;		
+
+		// Copy data to uniform buffer
+		memcpy(m_UniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+	}
+
+	void CreateDescriptorPool(VkDevice device)
+	{
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create descriptor pool!");
+		}
+	}
+
+	void CreateDescriptorSets(VkDevice device)
+	{
+		std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_DescriptorSetLayout);
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = m_DescriptorPool;
+		allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		allocInfo.pSetLayouts = layouts.data();
+
+		m_DescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+		if (vkAllocateDescriptorSets(device, &allocInfo, m_DescriptorSets.data()) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate descriptor sets!");
+		}
+
+		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+		{
+			VkDescriptorBufferInfo bufferInfo{};
+			bufferInfo.buffer = m_UniformBuffers[i];
+			bufferInfo.offset = 0;
+			bufferInfo.range = sizeof(UniformBufferObject);
+
+			VkWriteDescriptorSet descriptorWrite{};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = m_DescriptorSets[i];
+			descriptorWrite.dstBinding = 0;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.pBufferInfo = &bufferInfo;
+			descriptorWrite.pImageInfo = nullptr; // Optional
+			descriptorWrite.pTexelBufferView = nullptr; // Optional
+
+			vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+
+			// Iterate over each texture and sampler
+			for (size_t j = 0; j < BlockMeshGenerator::GetInstance().GetTextures().size(); j++)
+			{
+				VkDescriptorImageInfo imageInfo{};
+				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageInfo.imageView = BlockMeshGenerator::GetInstance().GetTextures()[j].GetImageView();  // Assuming Texture class has a method to get ImageView
+				imageInfo.sampler = BlockMeshGenerator::GetInstance().GetTextures()[j].GetSampler();
+
+				// Update descriptor write with image info
+				descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				descriptorWrite.dstSet = m_DescriptorSets[i];
+				descriptorWrite.dstBinding = static_cast<uint32_t>(j + 1);  // Assuming the first binding is used for the uniform buffer
+				descriptorWrite.dstArrayElement = 0;
+				descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				descriptorWrite.descriptorCount = 1;
+				descriptorWrite.pBufferInfo = nullptr;
+				descriptorWrite.pImageInfo = &imageInfo;
+				descriptorWrite.pTexelBufferView = nullptr;
+
+				// Update descriptor sets
+				vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+			}
+		}
+	}
+
+	void CreateFaceDescriptorSetLayout(VkDevice device)
+	{
+		VkDescriptorSetLayoutBinding faceLayoutBinding{};
+		faceLayoutBinding.binding = 0;
+		faceLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		faceLayoutBinding.descriptorCount = 1;
+		faceLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = 1;
+		layoutInfo.pBindings = &faceLayoutBinding;
+
+		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &m_FaceDescriptorSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create face descriptor set layout!");
+		}
+	}
+
+	void CreateFaceDescriptorPool(VkDevice device)
+	{
+		VkDescriptorPoolSize poolSize{};
+		poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSize.descriptorCount = m_MaxFaceDescriptorSets;
+
+		// The sets come and go with the chunks
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+		poolInfo.poolSizeCount = 1;
+		poolInfo.pPoolSizes = &poolSize;
+		poolInfo.maxSets = m_MaxFaceDescriptorSets;
+
+		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &m_FaceDescriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to create face descriptor pool!");
+		}
+	}
+
+	// Set 1 for a buffer of face records
+	VkDescriptorSet AllocateFaceDescriptorSet(VkDevice device, VkBuffer faceBuffer)
+	{
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = m_FaceDescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &m_FaceDescriptorSetLayout;
+
+		VkDescriptorSet descriptorSet;
+		if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS)
+		{
+			throw std::runtime_error("failed to allocate face descriptor set!");
+		}
+
+		WriteFaceDescriptorSet(device, descriptorSet, faceBuffer);
+		return descriptorSet;
+	}
+
+	// Points an existing set at another buffer, the set must not be in use by the gpu
+	static void WriteFaceDescriptorSet(VkDevice device, VkDescriptorSet descriptorSet, VkBuffer faceBuffer)
+	{
+		VkDescriptorBufferInfo bufferInfo{};
+		bufferInfo.buffer = faceBuffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = VK_WHOLE_SIZE;
+
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = descriptorSet;
+		descriptorWrite.dstBinding = 0;
+		descriptorWrite.dstArrayElement = 0;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.pBufferInfo = &bufferInfo;
+
+		vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+	}
+
+	void FreeFaceDescriptorSet(VkDevice device, VkDescriptorSet descriptorSet)
+	{
+		vkFreeDescriptorSets(device, m_FaceDescriptorPool, 1, &descriptorSet);
+	}
+
+	// Draws with the face records of a chunk, set 0 stays bound
+	void BindFaceDescriptorSet(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet) const
+	{
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 1, 1, &descriptorSet, 0, nullptr);
+	}
+
+	void Destroy(VkDevice device)
+	{
+		vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+
+		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+			vkDestroyBuffer(device, m_UniformBuffers[i], nullptr);
+			FreeMemory(device, m_UniformBuffersMemory[i]);
+		}
+
+		vkDestroyDescriptorPool(device, m_DescriptorPool, nullptr);
+		// Frees the face sets of the chunks that still have one
+		vkDestroyDescriptorPool(device, m_FaceDescriptorPool, nullptr);
+
+		vkDestroyDescriptorSetLayout(device, m_DescriptorSetLayout, nullptr);
+		vkDestroyDescriptorSetLayout(device, m_FaceDescriptorSetLayout, nullptr);
+	}
+
+	void BindDescriptorSets(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+	{
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0, 1, &m_DescriptorSets[imageIndex], 0, nullptr);
+	}
+
+	VkPipelineLayout GetHandle() const { return m_PipelineLayout; }
+
+private:
+	VkDescriptorSetLayout m_DescriptorSetLayout;
+	VkPipelineLayout m_PipelineLayout;
+
+	std::vector<VkBuffer> m_UniformBuffers;
+	std::vector<VkDeviceMemory> m_UniformBuffersMemory;
+	std::vector<void*> m_UniformBuffersMapped;
+	const size_t MAX_FRAMES_IN_FLIGHT{ 3 };
+
+	VkDescriptorPool m_DescriptorPool;
+	std::vector<VkDescriptorSet> m_DescriptorSets;
+
+	VkDescriptorSetLayout m_FaceDescriptorSetLayout{ VK_NULL_HANDLE };
+	VkDescriptorPool m_FaceDescriptorPool{ VK_NULL_HANDLE };
+};
@@ -0,0 +1,46 @@
+#include "Profiler.h"
+#include <iostream>
+
+void Profiler::AddCount(std::string_view name, uint64_t count)
+{
+	GetEntry(name).total += static_cast<double>(count);
+}
+
+void Profiler::AddTime(std::string_view name, double milliseconds)
+{
+	Entry& entry = GetEntry(name);
+	entry.total += milliseconds;
+	entry.isTime = true;
+}
+
+void Profiler::Print()
+{
+	if (m_FrameCount == 0)
+	{
+		return;
+	}
+
+	const double frames = static_cast<double>(m_FrameCount);
+	for (auto& [name, entry] : m_Entries)
+	{
+		std::cout << "  " << name << ": " << entry.total / frames;
+		if (entry.isTime)
+		{
+			std::cout << " ms";
+		}
+		std::cout << '\n';
+		entry.total = 0.0;
+	}
+
+	m_FrameCount = 0;
+}
+
+Profiler::Entry& Profiler::GetEntry(std::string_view name)
+{
+	const auto it = m_Entries.find(name);
+	if (it != m_Entries.end())
+	{
+		return it->second;
+	}
+	return m_Entries.emplace(std::string{ name }, Entry{}).first->second;
+}
@@ -0,0 +1,76 @@
+#pragma once
+//Standard includes
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+// Collects per-frame counters and timings and prints their averages together with the FPS
+class Profiler final
+{
+public:
+	static Profiler& GetInstance()
+	{
+		static Profiler instance;
+		return instance;
+	}
+
+	Profiler(const Profiler&) = delete;
+	Profiler(Profiler&&) noexcept = delete;
+	Profiler& operator=(const Profiler&) = delete;
+	Profiler& operator=(Profiler&&) noexcept = delete;
+
+	// Adds to a counter, the printed value is the average per frame.
+	// Only the first call with a name allocates, so the profiler stays out of the heap allocation counts.
+	void AddCount(std::string_view name, uint64_t count);
+	// Adds a measured duration in milliseconds, the printed value is the average per frame
+	void AddTime(std::string_view name, double milliseconds);
+
+	void EndFrame() { ++m_FrameCount; }
+
+	// Prints the averages since the previous print and resets all entries
+	void Print();
+
+private:
+	Profiler() = default;
+
+	struct Entry
+	{
+		double total{};
+		bool isTime{};
+	};
+
+	// Transparent so the entries can be found with a string_view
+	std::map<std::string, Entry, std::less<>> m_Entries{};
+	uint64_t m_FrameCount{};
+
+	Entry& GetEntry(std::string_view name);
+};
+
+// Measures the lifetime of the scope and adds it to the profiler
+class ScopedTimer final
+{
+public:
+	explicit ScopedTimer(const char* name)
+		: m_Name{ name }
+		, m_Start{ std::chrono::high_resolution_clock::now() }
+	{
+	}
+
+	~ScopedTimer()
+	{
+		const std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - m_Start;
+		Profiler::GetInstance().AddTime(m_Name, duration.count());
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer(ScopedTimer&&) noexcept = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(ScopedTimer&&) noexcept = delete;
+
+private:
+	const char* m_Name;
+	std::chrono::high_resolution_clock::time_point m_Start;
+};
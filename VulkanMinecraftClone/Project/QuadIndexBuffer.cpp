@@ -0,0 +1,61 @@
+#include "QuadIndexBuffer.h"
+#include "vulkanbase/VulkanUtil.h"
+#include <cstring>
+#include <iostream>
+
+void QuadIndexBuffer::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
+{
+	const std::vector<uint16_t> indices = CreateIndices(m_MaxQuadsPerDraw);
+	const VkDeviceSize bufferSize = GetByteSize();
+
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+	CreateBuffer(
+		device,
+		physicalDevice,
+		bufferSize,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
+
+	void* data;
+	vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
+	memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
+	vkUnmapMemory(device, stagingBufferMemory);
+
+	CreateBuffer(
+		device,
+		physicalDevice,
+		bufferSize,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_IndexBuffer, m_IndexBufferMemory, MemoryTag::Meshes);
+
+	CopyBuffer(device, commandPool, stagingBuffer, m_IndexBuffer, bufferSize);
+
+	vkDestroyBuffer(device, stagingBuffer, nullptr);
+	FreeMemory(device, stagingBufferMemory);
+
+	std::cout << "Shared quad index buffer: " << m_MaxQuadsPerDraw << " quads, " << bufferSize / 1024 << " KB\n";
+}
+
+void QuadIndexBuffer::Destroy(VkDevice device)
+{
+	vkDestroyBuffer(device, m_IndexBuffer, nullptr);
+	FreeMemory(device, m_IndexBufferMemory);
+	m_IndexBuffer = VK_NULL_HANDLE;
+	m_IndexBufferMemory = VK_NULL_HANDLE;
+}
+
+void QuadIndexBuffer::Bind(VkCommandBuffer commandBuffer) const
+{
+	vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
+}
+
+uint32_t QuadIndexBuffer::DrawQuads(VkCommandBuffer commandBuffer, uint32_t firstQuad, uint32_t quadCount) const
+{
+	return SplitDraws(firstQuad, quadCount, [commandBuffer](uint32_t indexCount, int32_t vertexOffset)
+		{
+			vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, vertexOffset, 0);
+		});
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// One index buffer shared by every quad mesh: quad q is drawn from the vertices 4q to 4q + 3 as (0, 1, 2, 2, 3, 0).
+// Meshes store the four corners of a quad in that order and point vertexOffset at their first quad,
+// so chunks never build, store or upload indices of their own.
+// The indices are 16 bit, a draw of more quads than fit in them is split into several draws.
+class QuadIndexBuffer final
+{
+public:
+	static constexpr uint32_t m_VerticesPerQuad = 4;
+	static constexpr uint32_t m_IndicesPerQuad = 6;
+	static constexpr uint32_t m_MaxQuadsPerDraw = (UINT16_MAX + 1) / m_VerticesPerQuad;
+
+	static std::vector<uint16_t> CreateIndices(uint32_t quadCount)
+	{
+		std::vector<uint16_t> indices(static_cast<size_t>(quadCount) * m_IndicesPerQuad);
+		for (uint32_t quad = 0; quad < quadCount; ++quad)
+		{
+			const uint16_t firstVertex = static_cast<uint16_t>(quad * m_VerticesPerQuad);
+			uint16_t* pIndex = &indices[static_cast<size_t>(quad) * m_IndicesPerQuad];
+			pIndex[0] = firstVertex;
+			pIndex[1] = static_cast<uint16_t>(firstVertex + 1);
+			pIndex[2] = static_cast<uint16_t>(firstVertex + 2);
+			pIndex[3] = static_cast<uint16_t>(firstVertex + 2);
+			pIndex[4] = static_cast<uint16_t>(firstVertex + 3);
+			pIndex[5] = firstVertex;
+		}
+		return indices;
+	}
+
+	// Calls draw(indexCount, vertexOffset) for every draw the quads are split into, returns the amount of draws
+	template<typename DrawFunction>
+	static uint32_t SplitDraws(uint32_t firstQuad, uint32_t quadCount, DrawFunction draw)
+	{
+		uint32_t drawCount = 0;
+		while (quadCount > 0)
+		{
+			const uint32_t batchQuads = std::min(quadCount, m_MaxQuadsPerDraw);
+			draw(batchQuads * m_IndicesPerQuad, static_cast<int32_t>(firstQuad * m_VerticesPerQuad));
+			firstQuad += batchQuads;
+			quadCount -= batchQuads;
+			++drawCount;
+		}
+		return drawCount;
+	}
+
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
+	void Destroy(VkDevice device);
+
+	void Bind(VkCommandBuffer commandBuffer) const;
+	// Draws the quads of the bound vertex buffer, returns the amount of draw calls it took
+	uint32_t DrawQuads(VkCommandBuffer commandBuffer, uint32_t firstQuad, uint32_t quadCount) const;
+
+	VkDeviceSize GetByteSize() const { return sizeof(uint16_t) * m_IndicesPerQuad * m_MaxQuadsPerDraw; }
+
+private:
+	VkBuffer m_IndexBuffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_IndexBufferMemory{ VK_NULL_HANDLE };
+};
@@ -0,0 +1,83 @@
+#include "SectionConnectivity.h"
+#include <vector>
+
+uint16_t SectionConnectivity::Calculate(const OpacityGrid& isOpaque)
+{
+    constexpr int size = m_SectionSize;
+    constexpr int last = m_SectionSize - 1;
+
+    std::array<bool, m_VoxelCount> isVisited{};
+    std::vector<int> stack;
+    stack.reserve(m_VoxelCount);
+
+    uint16_t connectivity = 0;
+    for (int start = 0; start < m_VoxelCount; ++start)
+    {
+        if (isOpaque[start] || isVisited[start])
+        {
+            continue;
+        }
+
+        // Collect the faces touched by this region
+        uint8_t touchedFaces = 0;
+        isVisited[start] = true;
+        stack.push_back(start);
+        while (!stack.empty())
+        {
+            const int index = stack.back();
+            stack.pop_back();
+
+            const int x = index % size;
+            const int y = (index / size) % size;
+            const int z = index / (size * size);
+
+            if (y == 0) touchedFaces |= 1 << 0;
+            if (x == last) touchedFaces |= 1 << 1;
+            if (z == 0) touchedFaces |= 1 << 2;
+            if (z == last) touchedFaces |= 1 << 3;
+            if (y == last) touchedFaces |= 1 << 4;
+            if (x == 0) touchedFaces |= 1 << 5;
+
+            for (int face = 0; face < m_FaceCount; ++face)
+            {
+                const std::array<int, 3> offset = GetFaceOffset(face);
+                const int nx = x + offset[0];
+                const int ny = y + offset[1];
+                const int nz = z + offset[2];
+                if (nx < 0 || nx >= size || ny < 0 || ny >= size || nz < 0 || nz >= size)
+                {
+                    continue;
+                }
+
+                const int neighbor = nx + ny * size + nz * size * size;
+                if (!isOpaque[neighbor] && !isVisited[neighbor])
+                {
+                    isVisited[neighbor] = true;
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+
+        for (int faceA = 0; faceA < m_FaceCount; ++faceA)
+        {
+            if ((touchedFaces & (1 << faceA)) == 0)
+            {
+                continue;
+            }
+            for (int faceB = faceA + 1; faceB < m_FaceCount; ++faceB)
+            {
+                if ((touchedFaces & (1 << faceB)) != 0)
+                {
+                    connectivity |= 1 << GetPairBit(faceA, faceB);
+                }
+            }
+        }
+
+        if (connectivity == m_AllConnected)
+        {
+            break;
+        }
+    }
+
+    return connectivity;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Describes which faces of a cubic chunk section can see each other through non opaque blocks.
+// Faces are indexed in the same order as the Direction enum: Down, East, North, South, Up, West.
+// Every one of the 15 face pairs is one bit of the connectivity mask.
+class SectionConnectivity final
+{
+public:
+    static constexpr int m_SectionSize = 16;
+    static constexpr int m_VoxelCount = m_SectionSize * m_SectionSize * m_SectionSize;
+    static constexpr int m_FaceCount = 6;
+    static constexpr uint16_t m_AllConnected = 0x7FFF;
+
+    // Opacity of every block of a section, indexed with x + y * size + z * size * size
+    using OpacityGrid = std::array<bool, m_VoxelCount>;
+
+    // Flood fills the non opaque blocks and connects all the faces every filled region touches
+    static uint16_t Calculate(const OpacityGrid& isOpaque);
+
+    static bool AreConnected(uint16_t connectivity, int faceA, int faceB)
+    {
+        return faceA == faceB || (connectivity & (1 << GetPairBit(faceA, faceB))) != 0;
+    }
+
+    static int GetOppositeFace(int face)
+    {
+        constexpr std::array<int, m_FaceCount> oppositeFaces{ 4, 5, 3, 2, 0, 1 };
+        return oppositeFaces[face];
+    }
+
+    // Offset to the neighboring section behind a face
+    static std::array<int, 3> GetFaceOffset(int face)
+    {
+        constexpr std::array<std::array<int, 3>, m_FaceCount> faceOffsets{ {
+            { 0, -1, 0 },
+            { 1, 0, 0 },
+            { 0, 0, -1 },
+            { 0, 0, 1 },
+            { 0, 1, 0 },
+            { -1, 0, 0 } } };
+        return faceOffsets[face];
+    }
+
+    // Breadth first search from the sections in the queue over every section that can be seen from them.
+    // A section is only left through a face connected to the face it was entered through, and never against a
+    // direction already travelled, so the search doesn't walk back towards the camera.
+    // Node needs an entryFace (-1 for the sections the search starts in) and the travelledFaces bits,
+    // getConnectivity(node) returns the connectivity of its section and enter(node, face, neighbor) fills in the
+    // section behind the face and returns false when it is missing, already visited or out of view.
+    template<typename Node, typename GetConnectivity, typename Enter>
+    static void Search(std::vector<Node>& queue, GetConnectivity getConnectivity, Enter enter)
+    {
+        for (std::size_t head = 0; head < queue.size(); ++head)
+        {
+            const Node node = queue[head];
+            const uint16_t connectivity = getConnectivity(node);
+
+            for (int face = 0; face < m_FaceCount; ++face)
+            {
+                const int oppositeFace = GetOppositeFace(face);
+
+                // Never walk back towards the camera
+                if (node.travelledFaces & (1 << oppositeFace))
+                {
+                    continue;
+                }
+
+                // The section has to be see through from the face it was entered to the face it is left
+                if (node.entryFace >= 0 && !AreConnected(connectivity, node.entryFace, face))
+                {
+                    continue;
+                }
+
+                Node neighbor = node;
+                if (!enter(node, face, neighbor))
+                {
+                    continue;
+                }
+
+                neighbor.entryFace = oppositeFace;
+                neighbor.travelledFaces = static_cast<uint8_t>(node.travelledFaces | (1 << face));
+                queue.push_back(neighbor);
+            }
+        }
+    }
+
+private:
+    static int GetPairBit(int faceA, int faceB)
+    {
+        if (faceA > faceB)
+        {
+            std::swap(faceA, faceB);
+        }
+        return faceA * m_FaceCount - faceA * (faceA + 1) / 2 + faceB - faceA - 1;
+    }
+};
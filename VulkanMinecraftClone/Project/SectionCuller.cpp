@@ -0,0 +1,65 @@
+#include "SectionCuller.h"
+#include "QuadIndexBuffer.h"
+
+static_assert(sizeof(SectionCuller::SectionRecord) == 32, "The shader reads the records with the std430 layout");
+
+SectionCuller::FrustumPlanes SectionCuller::ExtractFrustumPlanes(const glm::mat4& viewProjection)
+{
+	// Rows of the matrix, glm stores columns
+	const auto row = [&viewProjection](int index)
+		{
+			return glm::vec4(viewProjection[0][index], viewProjection[1][index], viewProjection[2][index], viewProjection[3][index]);
+		};
+
+	// Left, right, bottom, top, near and far. The near plane is the one of a -1 to 1 depth range, which also
+	// holds everything of a 0 to 1 depth range, so it stays conservative whichever way glm was configured.
+	FrustumPlanes planes{
+		row(3) + row(0),
+		row(3) - row(0),
+		row(3) + row(1),
+		row(3) - row(1),
+		row(3) + row(2),
+		row(3) - row(2) };
+
+	for (glm::vec4& plane : planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return planes;
+}
+
+bool SectionCuller::IsBoxVisible(const FrustumPlanes& planes, const glm::vec3& min, const glm::vec3& max)
+{
+	for (const glm::vec4& plane : planes)
+	{
+		// The corner furthest along the plane normal
+		const glm::vec3 corner{ plane.x >= 0.f ? max.x : min.x, plane.y >= 0.f ? max.y : min.y, plane.z >= 0.f ? max.z : min.z };
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void SectionCuller::Cull(const std::vector<SectionRecord>& records, const FrustumPlanes& planes,
+	std::vector<uint32_t>& drawCounts, std::vector<VkDrawIndexedIndirectCommand>& drawCommands)
+{
+	const size_t slotCount = records.size() / m_SectionsPerChunk;
+	drawCounts.assign(slotCount, 0);
+	drawCommands.assign(records.size(), VkDrawIndexedIndirectCommand{});
+
+	for (size_t index = 0; index < records.size(); ++index)
+	{
+		const SectionRecord& record = records[index];
+		if (record.quadCount == 0 || !IsBoxVisible(planes, record.min, record.max))
+		{
+			continue;
+		}
+
+		const size_t slot = index / m_SectionsPerChunk;
+		const uint32_t drawIndex = drawCounts[slot]++;
+		drawCommands[slot * m_SectionsPerChunk + drawIndex] = VkDrawIndexedIndirectCommand{
+			record.quadCount * QuadIndexBuffer::m_IndicesPerQuad, 1, 0, static_cast<int32_t>(record.firstQuad * QuadIndexBuffer::m_VerticesPerQuad), 0 };
+	}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Frustum culling of the section records the GpuCuller keeps per chunk slot, the cpu reference of shaders/cullSections.comp.
+// Only the draw command struct is used from Vulkan, so it can be run headless.
+class SectionCuller final
+{
+public:
+	// Same as Chunk::m_SectionCount and sectionsPerChunk in the shader
+	static constexpr uint32_t m_SectionsPerChunk = 128;
+
+	// Same layout as SectionRecord in the shader, std430
+	struct SectionRecord
+	{
+		glm::vec3 min;
+		uint32_t firstQuad;
+		glm::vec3 max;
+		uint32_t quadCount;
+	};
+
+	// Planes point inwards, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+	using FrustumPlanes = std::array<glm::vec4, 6>;
+
+	static FrustumPlanes ExtractFrustumPlanes(const glm::mat4& viewProjection);
+	// Conservative, a box crossing the corner of two planes outside the frustum is still visible
+	static bool IsBoxVisible(const FrustumPlanes& planes, const glm::vec3& min, const glm::vec3& max);
+
+	// Does what the compute shader does, the draw commands of every slot are in section order
+	static void Cull(const std::vector<SectionRecord>& records, const FrustumPlanes& planes,
+		std::vector<uint32_t>& drawCounts, std::vector<VkDrawIndexedIndirectCommand>& drawCommands);
+};
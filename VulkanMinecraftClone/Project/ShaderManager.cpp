@@ -0,0 +1,187 @@
+#include "ShaderManager.h"
+#include "Hash.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+SpirvCache::SpirvCache(const std::string& directory, Compiler compiler)
+	: m_Directory{ directory }
+	, m_Compiler{ std::move(compiler) }
+{
+	std::error_code error;
+	std::filesystem::create_directories(m_Directory, error);
+}
+
+uint64_t SpirvCache::GetKey(const std::string& fileName, const std::string& source)
+{
+	// File names can't hold a null character, so it separates the name from the source
+	const char separator = '\0';
+	const uint64_t nameHash = HashBytes(&separator, sizeof(separator), HashBytes(fileName.data(), fileName.size()));
+	return HashBytes(source.data(), source.size(), nameHash);
+}
+
+std::string SpirvCache::GetPath(uint64_t key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(key));
+	return (m_Directory / name).string();
+}
+
+std::string SpirvCache::Compile(const std::string& sourcePath, bool& isCached)
+{
+	std::ifstream file(sourcePath, std::ios::binary);
+	if (!file.is_open())
+	{
+		return {};
+	}
+	std::stringstream source;
+	source << file.rdbuf();
+
+	const std::string fileName = std::filesystem::path(sourcePath).filename().string();
+	const std::string spirvPath = GetPath(GetKey(fileName, source.str()));
+	isCached = IsValidSpirv(spirvPath);
+	if (isCached)
+	{
+		return spirvPath;
+	}
+
+	// Compiled next to the final name and renamed, a failed or interrupted compile never leaves a broken entry behind
+	const std::string temporaryPath = spirvPath + ".tmp";
+	if (!m_Compiler(sourcePath, temporaryPath) || !IsValidSpirv(temporaryPath))
+	{
+		std::error_code error;
+		std::filesystem::remove(temporaryPath, error);
+		return {};
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, spirvPath, error);
+	return error ? std::string{} : spirvPath;
+}
+
+bool SpirvCache::IsValidSpirv(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const std::streamoff size = file.tellg();
+	uint32_t magic{};
+	file.seekg(0);
+	return size >= 20 && size % 4 == 0 && file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) && magic == 0x07230203;
+}
+
+void ShaderManager::Start(const std::string& sourceDirectory, const std::string& binaryDirectory, const std::string& compilerPath)
+{
+	Stop();
+
+	m_SourceDirectory = sourceDirectory;
+	m_BinaryDirectory = binaryDirectory;
+	m_pCache = std::make_unique<SpirvCache>((m_BinaryDirectory / "cache").string(),
+		[compilerPath](const std::string& sourcePath, const std::string& outputPath)
+		{
+			std::string command = "\"" + compilerPath + "\" \"" + sourcePath + "\" -o \"" + outputPath + "\"";
+#ifdef _WIN32
+			// cmd.exe strips the outer quotes of the whole command
+			command = "\"" + command + "\"";
+#endif
+			return std::system(command.c_str()) == 0;
+		});
+
+	std::error_code error;
+	if (!std::filesystem::is_directory(m_SourceDirectory, error))
+	{
+		std::cout << "Shader hot reload disabled, " << sourceDirectory << " doesn't exist\n";
+		return;
+	}
+
+	Poll(true);
+	m_IsRunning = true;
+	m_Watcher = std::thread(&ShaderManager::Watch, this);
+}
+
+void ShaderManager::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_IsRunning = false;
+	}
+	m_StopCondition.notify_all();
+	if (m_Watcher.joinable())
+	{
+		m_Watcher.join();
+	}
+}
+
+std::vector<ShaderManager::ReloadedShader> ShaderManager::TakeReloadedShaders()
+{
+	std::vector<ReloadedShader> reloadedShaders;
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	reloadedShaders.swap(m_ReloadedShaders);
+	return reloadedShaders;
+}
+
+void ShaderManager::Watch()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	while (!m_StopCondition.wait_for(lock, m_PollInterval, [this]() { return !m_IsRunning; }))
+	{
+		lock.unlock();
+		Poll(false);
+		lock.lock();
+	}
+}
+
+void ShaderManager::Poll(bool isFirstPoll)
+{
+	std::error_code error;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_SourceDirectory, error))
+	{
+		const std::filesystem::path& path = entry.path();
+		if (path.extension() != ".vert" && path.extension() != ".frag")
+		{
+			continue;
+		}
+
+		const std::filesystem::file_time_type writeTime = entry.last_write_time(error);
+		if (error)
+		{
+			continue;
+		}
+		const std::string fileName = path.filename().string();
+		auto found = m_WriteTimes.find(fileName);
+		if (found != m_WriteTimes.end() && found->second == writeTime)
+		{
+			continue;
+		}
+		m_WriteTimes[fileName] = writeTime;
+		if (isFirstPoll)
+		{
+			continue;
+		}
+
+		ReloadedShader reloadedShader{ fileName, false, 0.0, std::chrono::high_resolution_clock::now() };
+		const std::string spirvPath = m_pCache->Compile(path.string(), reloadedShader.isCached);
+		const std::chrono::duration<double, std::milli> compileTime = std::chrono::high_resolution_clock::now() - reloadedShader.changeTime;
+		reloadedShader.compileMilliseconds = compileTime.count();
+		if (spirvPath.empty())
+		{
+			std::cout << "Failed to compile " << fileName << ", keeping the previous version\n";
+			continue;
+		}
+
+		std::filesystem::copy_file(spirvPath, m_BinaryDirectory / (fileName + ".spv"), std::filesystem::copy_options::overwrite_existing, error);
+		if (error)
+		{
+			std::cout << "Failed to replace " << fileName << ".spv: " << error.message() << '\n';
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_ReloadedShaders.push_back(std::move(reloadedShader));
+	}
+}
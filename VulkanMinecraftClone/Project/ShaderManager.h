@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Compiled SPIR-V stored by the hash of the shader source, so saving a file without changes or reverting an edit
+// doesn't run the compiler again. The compiler is passed in, which keeps the cache testable without glslc.
+class SpirvCache final
+{
+public:
+	// Compiles sourcePath into outputPath, returns false on errors
+	using Compiler = std::function<bool(const std::string& sourcePath, const std::string& outputPath)>;
+
+	SpirvCache(const std::string& directory, Compiler compiler);
+
+	// The file name is part of the key because glslc picks the shader stage from the extension
+	static uint64_t GetKey(const std::string& fileName, const std::string& source);
+	std::string GetPath(uint64_t key) const;
+
+	// Returns the path of the SPIR-V of the current content of the source, or an empty string when it doesn't compile
+	std::string Compile(const std::string& sourcePath, bool& isCached);
+
+	static bool IsValidSpirv(const std::string& path);
+
+private:
+	std::filesystem::path m_Directory;
+	Compiler m_Compiler;
+};
+
+// Watches the GLSL sources for changes on a background thread and recompiles them with glslc, so the land and water
+// shaders can be edited while the game runs. The new SPIR-V replaces the one the pipelines load,
+// the pipelines themselves are rebuilt by the render loop at a frame boundary.
+// Changes are found by polling the modification times, which works the same on every platform.
+class ShaderManager final
+{
+public:
+	// Saving a file is noticed at most this much later
+	static constexpr std::chrono::milliseconds m_PollInterval{ 200 };
+
+	struct ReloadedShader
+	{
+		// Name of the source, e.g. shaderLand.frag
+		std::string fileName;
+		bool isCached;
+		double compileMilliseconds;
+		// When the change was noticed
+		std::chrono::high_resolution_clock::time_point changeTime;
+	};
+
+	static ShaderManager& GetInstance()
+	{
+		static ShaderManager instance;
+		return instance;
+	}
+
+	ShaderManager(const ShaderManager&) = delete;
+	ShaderManager(ShaderManager&&) noexcept = delete;
+	ShaderManager& operator=(const ShaderManager&) = delete;
+	ShaderManager& operator=(ShaderManager&&) noexcept = delete;
+
+	// binaryDirectory is where the pipelines load <name>.spv from, the cache goes in a subdirectory of it
+	void Start(const std::string& sourceDirectory, const std::string& binaryDirectory, const std::string& compilerPath);
+	void Stop();
+
+	// Shaders that were recompiled since the last call, called by the render loop
+	std::vector<ReloadedShader> TakeReloadedShaders();
+
+private:
+	ShaderManager() = default;
+	~ShaderManager() { Stop(); }
+
+	std::filesystem::path m_SourceDirectory;
+	std::filesystem::path m_BinaryDirectory;
+	std::unique_ptr<SpirvCache> m_pCache;
+	std::unordered_map<std::string, std::filesystem::file_time_type> m_WriteTimes;
+
+	std::thread m_Watcher;
+	std::atomic<bool> m_IsRunning{ false };
+	std::mutex m_Mutex;
+	std::condition_variable m_StopCondition;
+	std::vector<ReloadedShader> m_ReloadedShaders;
+
+	void Watch();
+	void Poll(bool isFirstPoll);
+};
@@ -32,7 +32,7 @@ void SwapchainManager::Cleanup()
 
 	vkDestroyImage(m_Device, m_DepthImage, nullptr);
 	vkDestroyImageView(m_Device, m_DepthImageView, nullptr);
-	vkFreeMemory(m_Device, m_DepthImageMemory, nullptr);
+	FreeMemory(m_Device, m_DepthImageMemory);
 }
 
 SwapChainSupportDetails SwapchainManager::QuerySwapChainSupport(VkPhysicalDevice device)
@@ -233,7 +233,7 @@ void SwapchainManager::CreateDepthResources()
 	allocInfo.allocationSize = memRequirements.size;
 	allocInfo.memoryTypeIndex = FindMemoryType(m_PhysicalDevice, memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-	if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &m_DepthImageMemory) != VK_SUCCESS) {
+	if (AllocateMemory(m_Device, allocInfo, MemoryTag::Textures, m_DepthImageMemory) != VK_SUCCESS) {
 		throw std::runtime_error("failed to allocate image memory!");
 	}
 
@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "BlockRegistry.h"
+#include "vendor/SimplexNoise.h"
+
+// The height map of the default terrain, ChunkGenerator::GetHeight reads the column heights from this noise
+constexpr int TERRAIN_NOISE_FRACTALS = 8;
+
+inline SimplexNoise CreateTerrainNoise()
+{
+    // frequency, amplitude, lacunarity, persistence
+    const float frequency = 0.005f;
+    const float amplitude = 1.f;
+    const float lacunarity = 2.f;
+    const float persistence = 1 / lacunarity;
+    return SimplexNoise{ frequency, amplitude, lacunarity, persistence };
+}
+
+// Height of the column at the world x and z, the minimum and maximum height are fractions of the column height.
+// The result is clamped to 0 - columnHeight.
+inline int GetTerrainHeight(const SimplexNoise& noise, int x, int z, int columnHeight, float minHeight, float maxHeight)
+{
+    const float heightNoise = noise.fractal(TERRAIN_NOISE_FRACTALS, static_cast<float>(x), static_cast<float>(z));
+    const int height = static_cast<int>(heightNoise * (columnHeight * (maxHeight - minHeight)) + columnHeight * minHeight);
+    return std::clamp(height, 0, columnHeight);
+}
+
+// The blocks of a column of terrain from the bottom up, worked out once from the height of the column.
+// Low columns are sand with water up to sea level above it, the others stone, up to three dirt and a grass block.
+// Every layer starts where the one below it ends and the last one is the air up to the top of the column,
+// so writing the layers writes every block of the column exactly once.
+struct TerrainColumn final
+{
+    struct Layer
+    {
+        BlockType blockType;
+        int endY; // One above the top block of the layer
+    };
+
+    std::array<Layer, 4> layers{};
+    int layerCount{};
+
+    // The height is the y of the top block, a height of columnHeight leaves the top block out.
+    // The sea level is a fraction of the column height.
+    static TerrainColumn Create(int height, int columnHeight, float seaLevel)
+    {
+        TerrainColumn column{};
+        const float seaHeight = columnHeight * seaLevel;
+        // The base of the mountains is sand inside the water
+        if (height <= seaHeight + 3)
+        {
+            column.Add(BlockType::Sand, height + 1, columnHeight);
+            column.Add(BlockType::Water, static_cast<int>(std::ceil(seaHeight)), columnHeight);
+        }
+        else
+        {
+            // Fewer layers of dirt right above the shore
+            const int dirtLayers = static_cast<int>(std::min(height - (seaHeight + 1), 3.f));
+            column.Add(BlockType::Stone, height - dirtLayers, columnHeight);
+            column.Add(BlockType::Dirt, height, columnHeight);
+            column.Add(BlockType::GrassBlock, height + 1, columnHeight);
+        }
+        column.Add(BlockType::Air, columnHeight, columnHeight);
+        return column;
+    }
+
+    int GetBeginY(int layer) const { return layer == 0 ? 0 : layers[layer - 1].endY; }
+    // Bottom of the air above the terrain, the top of the column when the terrain reaches it
+    int GetAirBeginY() const
+    {
+        const int topLayer = layerCount - 1;
+        return layers[topLayer].blockType == BlockType::Air ? GetBeginY(topLayer) : layers[topLayer].endY;
+    }
+
+private:
+    // Leaves out the layers that would be empty, like the water over sand above sea level
+    void Add(BlockType blockType, int endY, int columnHeight)
+    {
+        endY = std::min(endY, columnHeight);
+        if (endY > (layerCount == 0 ? 0 : layers[layerCount - 1].endY))
+        {
+            layers[layerCount++] = { blockType, endY };
+        }
+    }
+};
+
+// Writes the terrain of every column of the blocks, pHeights holds the height of the column at x and z at x + z * width.
+// The layer that all columns start with and the air above the highest column are written as boxes, a row at a time
+// in the layouts with contiguous rows, the rest of every column as spans.
+template<typename Storage>
+void WriteTerrainColumns(Storage& blocks, const int* pHeights, float seaLevel)
+{
+    constexpr int width = Storage::m_Width;
+    constexpr int height = Storage::m_Height;
+    constexpr int depth = Storage::m_Depth;
+
+    const BlockType bottomType = TerrainColumn::Create(pHeights[0], height, seaLevel).layers[0].blockType;
+    int bottomEndY = height;
+    int airBeginY = 0;
+    for (int column = 0; column < width * depth; ++column)
+    {
+        const TerrainColumn terrainColumn = TerrainColumn::Create(pHeights[column], height, seaLevel);
+        const TerrainColumn::Layer& bottom = terrainColumn.layers[0];
+        bottomEndY = bottom.blockType == bottomType ? std::min(bottomEndY, bottom.endY) : 0;
+        airBeginY = std::max(airBeginY, terrainColumn.GetAirBeginY());
+    }
+
+    blocks.FillBox(glm::ivec3(0), glm::ivec3(width, bottomEndY, depth), bottomType);
+    blocks.FillBox(glm::ivec3(0, airBeginY, 0), glm::ivec3(width, height, depth), BlockType::Air);
+
+    for (int z = 0; z < depth; ++z)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const TerrainColumn terrainColumn = TerrainColumn::Create(pHeights[x + z * width], height, seaLevel);
+            for (int layer = 0; layer < terrainColumn.layerCount; ++layer)
+            {
+                const int beginY = std::max(terrainColumn.GetBeginY(layer), bottomEndY);
+                const int endY = std::min(terrainColumn.layers[layer].endY, airBeginY);
+                blocks.FillSpan(x, z, beginY, endY, terrainColumn.layers[layer].blockType);
+            }
+        }
+    }
+}
@@ -3,6 +3,11 @@
 #define STBI_WINDOWS_UTF8
 #include "vendor/stb_image.h"
 #include "SwapchainManager.h"
+#include "TextureArrayBuilder.h"
+#include "MappedFile.h"
+#include "BlockRegistry.h"
+#include <chrono>
+#include <iostream>
 
 
 void Texture::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
@@ -15,22 +20,60 @@ void Texture::Init(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPo
 void Texture::Destroy(VkDevice device)
 {
 	vkDestroyImage(device, textureImage, nullptr);
-	vkFreeMemory(device, textureImageMemory, nullptr);
+	FreeMemory(device, textureImageMemory);
 	vkDestroySampler(device, textureSampler, nullptr);
 	vkDestroyImageView(device, textureImageView, nullptr);
 }
 void Texture::CreateTextureImage(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool)
 {
-	int texWidth{}, texHeight{}, texChannels{};
-	
-	stbi_uc* pixels = stbi_load("textures/terrainatlas.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+	const auto startTime = std::chrono::high_resolution_clock::now();
 
-	VkDeviceSize imageSize = texWidth * texHeight * 4;
+	// Compressed when the device can sample it, the cache is baked again when its format doesn't match
+	const TextureArrayFormat arrayFormat = IsBc1Supported(physicalDevice) ? TextureArrayFormat::Bc1Srgb : TextureArrayFormat::Rgba8Srgb;
+	textureFormat = arrayFormat == TextureArrayFormat::Bc1Srgb ? VK_FORMAT_BC1_RGBA_SRGB_BLOCK : VK_FORMAT_R8G8B8A8_SRGB;
 
-	if (!pixels)
+	const MappedFile atlasFile("textures/terrainatlas.png");
+	if (!atlasFile.IsOpen())
 	{
 		throw std::runtime_error("failed to load texture image!");
 	}
+	const uint64_t atlasHash = TextureArrayBuilder::Hash(atlasFile.GetData(), atlasFile.GetSize());
+
+	// Decoding, slicing, building the mips and compressing is only done when the atlas changed,
+	// otherwise the mapped cache is copied straight into the staging buffer
+	MappedFile cacheFile("textures/terrainatlas.cache");
+	TextureArrayData textureArray{};
+	const uint8_t* pPixels{};
+	const bool isCached = TextureArrayBuilder::ParseCache(cacheFile.GetData(), cacheFile.GetSize(), atlasHash, arrayFormat, textureArray, pPixels);
+	if (!isCached)
+	{
+		cacheFile.Close();
+
+		int texWidth{}, texHeight{}, texChannels{};
+		stbi_uc* pixels = stbi_load_from_memory(atlasFile.GetData(), static_cast<int>(atlasFile.GetSize()), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+		if (!pixels)
+		{
+			throw std::runtime_error("failed to load texture image!");
+		}
+
+		textureArray = TextureArrayBuilder::Slice(pixels, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), BlockRegistry::m_AtlasSize);
+		stbi_image_free(pixels);
+		TextureArrayBuilder::GenerateMips(textureArray);
+		if (arrayFormat == TextureArrayFormat::Bc1Srgb)
+		{
+			textureArray = TextureArrayBuilder::CompressBc1(textureArray);
+		}
+
+		if (!TextureArrayBuilder::SaveCache("textures/terrainatlas.cache", atlasHash, textureArray))
+		{
+			std::cout << "Failed to write the texture cache\n";
+		}
+		pPixels = textureArray.pixels.data();
+	}
+	mipLevels = textureArray.mipCount;
+	layerCount = textureArray.layerCount;
+
+	VkDeviceSize imageSize = textureArray.GetByteSize();
 
 	VkBuffer stagingBuffer;
 	VkDeviceMemory stagingBufferMemory;
@@ -39,45 +82,76 @@ void Texture::CreateTextureImage(VkDevice device, VkPhysicalDevice physicalDevic
 		imageSize,
 		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
 		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		stagingBuffer, stagingBufferMemory);
+		stagingBuffer, stagingBufferMemory, MemoryTag::Transient);
 
 	void* data;
 	vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-	memcpy(data, pixels, static_cast<size_t>(imageSize));
+	memcpy(data, pPixels, static_cast<size_t>(imageSize));
 	vkUnmapMemory(device, stagingBufferMemory);
 
-	stbi_image_free(pixels);
-
 	createImage(device, physicalDevice,
-		texWidth,
-		texHeight,
-		VK_FORMAT_R8G8B8A8_SRGB,
+		textureArray.tileSize,
+		textureArray.tileSize,
+		textureFormat,
 		VK_IMAGE_TILING_OPTIMAL,
 		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 		textureImage, textureImageMemory);
 
-	transitionImageLayout(device, commandPool, textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	copyBufferToImage(device, commandPool, stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-	transitionImageLayout(device, commandPool, textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	transitionImageLayout(device, commandPool, textureImage, textureFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels, layerCount);
+
+	// One copy per mip level, each covering all layers
+	std::vector<VkBufferImageCopy> regions(mipLevels);
+	for (uint32_t mip = 0; mip < mipLevels; ++mip)
+	{
+		VkBufferImageCopy& region = regions[mip];
+		region.bufferOffset = textureArray.mipOffsets[mip];
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = mip;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = layerCount;
+		region.imageExtent = { textureArray.GetMipSize(mip), textureArray.GetMipSize(mip), 1 };
+	}
+	VkCommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
+	vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+	endSingleTimeCommands(device, commandPool, commandBuffer);
+
+	transitionImageLayout(device, commandPool, textureImage, textureFormat, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels, layerCount);
 
 	vkDestroyBuffer(device, stagingBuffer, nullptr);
-	vkFreeMemory(device, stagingBufferMemory, nullptr);
+	FreeMemory(device, stagingBufferMemory);
+
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(device, textureImage, &memRequirements);
+	const std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - startTime;
+	std::cout << "Block textures " << (isCached ? "loaded from cache" : "baked") << " in " << duration.count() << " ms: "
+		<< layerCount << " layers, " << mipLevels << " mips, "
+		<< (arrayFormat == TextureArrayFormat::Bc1Srgb ? "BC1" : "RGBA8") << ", " << memRequirements.size / 1024 << " KB\n";
 }
+bool Texture::IsBc1Supported(VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_BC1_RGBA_SRGB_BLOCK, &formatProperties);
+	return supportedFeatures.textureCompressionBC
+		&& (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+}
+
 void Texture::CreateTextureImageView(VkDevice device)
 {
 	VkImageViewCreateInfo viewInfo{};
 	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
 	viewInfo.image = textureImage;
-	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-	viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	viewInfo.format = textureFormat;
 	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	viewInfo.subresourceRange.baseMipLevel = 0;
-	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.levelCount = mipLevels;
 	viewInfo.subresourceRange.baseArrayLayer = 0;
-	viewInfo.subresourceRange.layerCount = 1;
+	viewInfo.subresourceRange.layerCount = layerCount;
 
-	VkImageView imageView;
 	if (vkCreateImageView(device, &viewInfo, nullptr, &textureImageView) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create texture image view!");
 	}
@@ -111,7 +185,7 @@ void Texture::CreateTextureSampler(VkDevice device, VkPhysicalDevice physicalDev
 	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 	samplerInfo.mipLodBias = 0.0f;
 	samplerInfo.minLod = 0.0f;
-	samplerInfo.maxLod = 0.0f;
+	samplerInfo.maxLod = static_cast<float>(mipLevels);
 
 	if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) 
 	{
@@ -127,8 +201,8 @@ void Texture::createImage(VkDevice device, VkPhysicalDevice physicalDevice, uint
 	imageInfo.extent.width = width;
 	imageInfo.extent.height = height;
 	imageInfo.extent.depth = 1;
-	imageInfo.mipLevels = 1;
-	imageInfo.arrayLayers = 1;
+	imageInfo.mipLevels = mipLevels;
+	imageInfo.arrayLayers = layerCount;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
 	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -148,7 +222,7 @@ void Texture::createImage(VkDevice device, VkPhysicalDevice physicalDevice, uint
 	allocInfo.allocationSize = memRequirements.size;
 	allocInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
 
-	if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
+	if (AllocateMemory(device, allocInfo, MemoryTag::Textures, imageMemory) != VK_SUCCESS) {
 		throw std::runtime_error("failed to allocate image memory!");
 	}
 
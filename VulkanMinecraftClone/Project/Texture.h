@@ -15,6 +15,8 @@ public:
 	VkImageView GetImageView() const { return textureImageView; }
 	VkSampler GetSampler() const { return textureSampler; }
 private:
+	// Whether BC1 textures can be sampled, the device is created with textureCompressionBC enabled when it is supported
+	static bool IsBc1Supported(VkPhysicalDevice physicalDevice);
 	void CreateTextureImage(VkDevice device, VkPhysicalDevice physicalDevice, VkCommandPool commandPool);
 	void CreateTextureImageView(VkDevice device);
 	void CreateTextureSampler(VkDevice device, VkPhysicalDevice physicalDevice);
@@ -24,5 +26,9 @@ private:
 	VkDeviceMemory textureImageMemory;
 	VkImageView textureImageView;
 	VkSampler textureSampler;
+	// The atlas is uploaded as an array with one layer per tile
+	VkFormat textureFormat{ VK_FORMAT_R8G8B8A8_SRGB };
+	uint32_t mipLevels{ 1 };
+	uint32_t layerCount{ 1 };
 };
 
@@ -0,0 +1,461 @@
+#include "TextureArrayBuilder.h"
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "Hash.h"
+#include "MappedFile.h"
+
+namespace
+{
+	constexpr uint32_t g_CacheMagic = 0x59415254; // "TRAY"
+	constexpr uint32_t g_CacheVersion = 2;
+
+	struct CacheHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t sourceHash;
+		uint32_t tileSize;
+		uint32_t layerCount;
+		uint32_t mipCount;
+		TextureArrayFormat format;
+	};
+
+	float SrgbToLinear(float value)
+	{
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	uint8_t LinearToSrgb(float value)
+	{
+		const float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
+		return static_cast<uint8_t>(std::lround(std::fmin(std::fmax(srgb, 0.f), 1.f) * 255.f));
+	}
+
+	const std::array<float, 256>& GetLinearTable()
+	{
+		static const std::array<float, 256> table = []()
+			{
+				std::array<float, 256> values{};
+				for (size_t i = 0; i < values.size(); ++i)
+				{
+					values[i] = SrgbToLinear(i / 255.f);
+				}
+				return values;
+			}();
+		return table;
+	}
+
+	// Fills in the mip count and offsets for the tile size, layer count and format, the pixels are left to the caller
+	void LayoutMips(TextureArrayData& data)
+	{
+		data.mipCount = 1;
+		while ((data.tileSize >> data.mipCount) > 0)
+		{
+			++data.mipCount;
+		}
+
+		size_t size = 0;
+		data.mipOffsets.resize(data.mipCount);
+		for (uint32_t mip = 0; mip < data.mipCount; ++mip)
+		{
+			data.mipOffsets[mip] = size;
+			size += data.GetLayerByteSize(mip) * data.layerCount;
+		}
+	}
+
+	uint16_t PackRgb565(const float* pColor)
+	{
+		const auto quantize = [](float value, int maxValue)
+			{
+				return static_cast<uint16_t>(std::lround(std::fmin(std::fmax(value, 0.f), 255.f) * maxValue / 255.f));
+			};
+		return static_cast<uint16_t>((quantize(pColor[0], 31) << 11) | (quantize(pColor[1], 63) << 5) | quantize(pColor[2], 31));
+	}
+
+	void UnpackRgb565(uint16_t packed, int* pColor)
+	{
+		const int red = (packed >> 11) & 31;
+		const int green = (packed >> 5) & 63;
+		const int blue = packed & 31;
+		pColor[0] = (red << 3) | (red >> 2);
+		pColor[1] = (green << 2) | (green >> 4);
+		pColor[2] = (blue << 3) | (blue >> 2);
+	}
+
+	// Orders the endpoints for the block mode and picks the closest palette entry for every texel, returns the squared error
+	int ChooseBc1Indices(const std::array<const uint8_t*, 16>& texels, bool hasAlpha, uint16_t& color0, uint16_t& color1, uint32_t& indices)
+	{
+		// color0 > color1 selects the four color mode, color0 <= color1 the three color mode with transparent black
+		if (hasAlpha == (color0 > color1))
+		{
+			std::swap(color0, color1);
+		}
+
+		// Equal endpoints fall into the three color mode as well, a single color block just never uses index 3
+		const bool isThreeColor = color0 <= color1;
+		int palette[4][3]{};
+		UnpackRgb565(color0, palette[0]);
+		UnpackRgb565(color1, palette[1]);
+		const int paletteSize = isThreeColor ? 3 : 4;
+		for (int channel = 0; channel < 3; ++channel)
+		{
+			if (isThreeColor)
+			{
+				palette[2][channel] = (palette[0][channel] + palette[1][channel]) / 2;
+			}
+			else
+			{
+				palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+				palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+			}
+		}
+
+		indices = 0;
+		int error = 0;
+		for (size_t texel = 0; texel < texels.size(); ++texel)
+		{
+			const uint8_t* pTexel = texels[texel];
+			uint32_t bestIndex = 3;
+			if (!hasAlpha || pTexel[3] >= 128)
+			{
+				int bestDistance = INT_MAX;
+				for (int index = 0; index < paletteSize; ++index)
+				{
+					const int red = pTexel[0] - palette[index][0];
+					const int green = pTexel[1] - palette[index][1];
+					const int blue = pTexel[2] - palette[index][2];
+					const int distance = red * red + green * green + blue * blue;
+					if (distance < bestDistance)
+					{
+						bestDistance = distance;
+						bestIndex = static_cast<uint32_t>(index);
+					}
+				}
+				error += bestDistance;
+			}
+			indices |= bestIndex << (texel * 2);
+		}
+		return error;
+	}
+
+	// texels holds the 16 rgba texels of the block row by row
+	void EncodeBc1Block(const std::array<const uint8_t*, 16>& texels, uint8_t* pBlock)
+	{
+		bool hasAlpha = false;
+		int colorCount = 0;
+		float mean[3]{};
+		for (const uint8_t* pTexel : texels)
+		{
+			if (pTexel[3] < 128)
+			{
+				hasAlpha = true;
+				continue;
+			}
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				mean[channel] += pTexel[channel];
+			}
+			++colorCount;
+		}
+
+		uint16_t color0 = 0;
+		uint16_t color1 = 0;
+		if (colorCount > 0)
+		{
+			for (float& channel : mean)
+			{
+				channel /= colorCount;
+			}
+
+			// Principal axis of the colors through a few power iterations on the covariance
+			float covariance[3][3]{};
+			for (const uint8_t* pTexel : texels)
+			{
+				if (pTexel[3] < 128)
+				{
+					continue;
+				}
+				const float offset[3]{ pTexel[0] - mean[0], pTexel[1] - mean[1], pTexel[2] - mean[2] };
+				for (int row = 0; row < 3; ++row)
+				{
+					for (int column = 0; column < 3; ++column)
+					{
+						covariance[row][column] += offset[row] * offset[column];
+					}
+				}
+			}
+			float axis[3]{ 1.f, 1.f, 1.f };
+			for (int iteration = 0; iteration < 8; ++iteration)
+			{
+				float next[3]{};
+				for (int row = 0; row < 3; ++row)
+				{
+					next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+				}
+				const float length = std::fmax(std::fabs(next[0]), std::fmax(std::fabs(next[1]), std::fabs(next[2])));
+				if (length < 1e-6f)
+				{
+					break;
+				}
+				for (int channel = 0; channel < 3; ++channel)
+				{
+					axis[channel] = next[channel] / length;
+				}
+			}
+
+			// The extremes along the axis become the endpoints
+			float minProjection = FLT_MAX;
+			float maxProjection = -FLT_MAX;
+			for (const uint8_t* pTexel : texels)
+			{
+				if (pTexel[3] < 128)
+				{
+					continue;
+				}
+				const float projection = (pTexel[0] - mean[0]) * axis[0] + (pTexel[1] - mean[1]) * axis[1] + (pTexel[2] - mean[2]) * axis[2];
+				minProjection = std::fmin(minProjection, projection);
+				maxProjection = std::fmax(maxProjection, projection);
+			}
+			const float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+			float endpoint0[3]{};
+			float endpoint1[3]{};
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				endpoint0[channel] = mean[channel] + axis[channel] * maxProjection / axisLengthSquared;
+				endpoint1[channel] = mean[channel] + axis[channel] * minProjection / axisLengthSquared;
+			}
+			color0 = PackRgb565(endpoint0);
+			color1 = PackRgb565(endpoint1);
+		}
+
+		uint32_t indices = 0;
+		int error = ChooseBc1Indices(texels, hasAlpha, color0, color1, indices);
+
+		// Refit the endpoints to the chosen indices with least squares, as long as that lowers the error
+		for (int iteration = 0; iteration < 2 && colorCount > 0 && error > 0; ++iteration)
+		{
+			const bool isThreeColor = color0 <= color1;
+			float weightSums[3]{};
+			float colorSums[2][3]{};
+			for (size_t texel = 0; texel < texels.size(); ++texel)
+			{
+				const uint32_t index = (indices >> (texel * 2)) & 3;
+				if (isThreeColor && index == 3)
+				{
+					continue;
+				}
+				// How far the palette entry lies towards color1
+				const float weight = index < 2 ? static_cast<float>(index) : isThreeColor ? 0.5f : (index == 2 ? 1.f / 3.f : 2.f / 3.f);
+				weightSums[0] += (1.f - weight) * (1.f - weight);
+				weightSums[1] += (1.f - weight) * weight;
+				weightSums[2] += weight * weight;
+				for (int channel = 0; channel < 3; ++channel)
+				{
+					colorSums[0][channel] += (1.f - weight) * texels[texel][channel];
+					colorSums[1][channel] += weight * texels[texel][channel];
+				}
+			}
+
+			const float determinant = weightSums[0] * weightSums[2] - weightSums[1] * weightSums[1];
+			if (std::fabs(determinant) < 1e-6f)
+			{
+				break;
+			}
+			float endpoint0[3]{};
+			float endpoint1[3]{};
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				endpoint0[channel] = (colorSums[0][channel] * weightSums[2] - colorSums[1][channel] * weightSums[1]) / determinant;
+				endpoint1[channel] = (colorSums[1][channel] * weightSums[0] - colorSums[0][channel] * weightSums[1]) / determinant;
+			}
+
+			uint16_t refitColor0 = PackRgb565(endpoint0);
+			uint16_t refitColor1 = PackRgb565(endpoint1);
+			uint32_t refitIndices = 0;
+			const int refitError = ChooseBc1Indices(texels, hasAlpha, refitColor0, refitColor1, refitIndices);
+			if (refitError >= error)
+			{
+				break;
+			}
+			error = refitError;
+			color0 = refitColor0;
+			color1 = refitColor1;
+			indices = refitIndices;
+		}
+
+		pBlock[0] = static_cast<uint8_t>(color0 & 0xFF);
+		pBlock[1] = static_cast<uint8_t>(color0 >> 8);
+		pBlock[2] = static_cast<uint8_t>(color1 & 0xFF);
+		pBlock[3] = static_cast<uint8_t>(color1 >> 8);
+		memcpy(pBlock + 4, &indices, sizeof(indices));
+	}
+}
+
+TextureArrayData TextureArrayBuilder::Slice(const uint8_t* pAtlas, uint32_t atlasWidth, uint32_t atlasHeight, uint32_t tilesPerRow)
+{
+	TextureArrayData data{};
+	data.tileSize = atlasWidth / tilesPerRow;
+	data.layerCount = tilesPerRow * (atlasHeight / data.tileSize);
+	LayoutMips(data);
+	data.pixels.resize(data.GetByteSize());
+
+	const size_t tileRowBytes = static_cast<size_t>(data.tileSize) * 4;
+	for (uint32_t layer = 0; layer < data.layerCount; ++layer)
+	{
+		const uint32_t column = layer % tilesPerRow;
+		const uint32_t row = layer / tilesPerRow;
+		for (uint32_t y = 0; y < data.tileSize; ++y)
+		{
+			const uint8_t* pSource = pAtlas + ((static_cast<size_t>(row) * data.tileSize + y) * atlasWidth + static_cast<size_t>(column) * data.tileSize) * 4;
+			memcpy(&data.pixels[data.mipOffsets[0] + (static_cast<size_t>(layer) * data.tileSize + y) * tileRowBytes], pSource, tileRowBytes);
+		}
+	}
+	return data;
+}
+
+void TextureArrayBuilder::GenerateMips(TextureArrayData& data)
+{
+	const std::array<float, 256>& toLinear = GetLinearTable();
+
+	for (uint32_t mip = 1; mip < data.mipCount; ++mip)
+	{
+		const uint32_t size = data.GetMipSize(mip);
+		for (uint32_t layer = 0; layer < data.layerCount; ++layer)
+		{
+			for (uint32_t y = 0; y < size; ++y)
+			{
+				for (uint32_t x = 0; x < size; ++x)
+				{
+					const std::array<const uint8_t*, 4> sources{
+						data.GetPixel(mip - 1, layer, x * 2, y * 2),
+						data.GetPixel(mip - 1, layer, x * 2 + 1, y * 2),
+						data.GetPixel(mip - 1, layer, x * 2, y * 2 + 1),
+						data.GetPixel(mip - 1, layer, x * 2 + 1, y * 2 + 1) };
+
+					uint8_t* pTarget = data.GetPixel(mip, layer, x, y);
+					for (int channel = 0; channel < 3; ++channel)
+					{
+						float sum = 0.f;
+						for (const uint8_t* pSource : sources)
+						{
+							sum += toLinear[pSource[channel]];
+						}
+						pTarget[channel] = LinearToSrgb(sum / 4.f);
+					}
+
+					// Alpha is stored linearly
+					int alphaSum = 0;
+					for (const uint8_t* pSource : sources)
+					{
+						alphaSum += pSource[3];
+					}
+					pTarget[3] = static_cast<uint8_t>((alphaSum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+TextureArrayData TextureArrayBuilder::CompressBc1(const TextureArrayData& data)
+{
+	TextureArrayData compressed{};
+	compressed.format = TextureArrayFormat::Bc1Srgb;
+	compressed.tileSize = data.tileSize;
+	compressed.layerCount = data.layerCount;
+	LayoutMips(compressed);
+	compressed.pixels.resize(compressed.GetByteSize());
+
+	std::array<const uint8_t*, 16> texels{};
+	uint8_t* pBlock = compressed.pixels.data();
+	for (uint32_t mip = 0; mip < data.mipCount; ++mip)
+	{
+		const uint32_t size = data.GetMipSize(mip);
+		for (uint32_t layer = 0; layer < data.layerCount; ++layer)
+		{
+			for (uint32_t blockY = 0; blockY < size; blockY += 4)
+			{
+				for (uint32_t blockX = 0; blockX < size; blockX += 4)
+				{
+					// Mips smaller than a block repeat their last row and column
+					for (uint32_t texel = 0; texel < 16; ++texel)
+					{
+						const uint32_t x = std::min(blockX + texel % 4, size - 1);
+						const uint32_t y = std::min(blockY + texel / 4, size - 1);
+						texels[texel] = data.GetPixel(mip, layer, x, y);
+					}
+					EncodeBc1Block(texels, pBlock);
+					pBlock += 8;
+				}
+			}
+		}
+	}
+	return compressed;
+}
+
+uint64_t TextureArrayBuilder::Hash(const uint8_t* pBytes, size_t size)
+{
+	return HashBytes(pBytes, size);
+}
+
+bool TextureArrayBuilder::ParseCache(const uint8_t* pBytes, size_t size, uint64_t sourceHash, TextureArrayFormat format, TextureArrayData& data, const uint8_t*& pPixels)
+{
+	CacheHeader header{};
+	if (pBytes == nullptr || size < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, pBytes, sizeof(header));
+	if (header.magic != g_CacheMagic || header.version != g_CacheVersion || header.sourceHash != sourceHash || header.format != format
+		|| header.tileSize == 0 || header.tileSize > 4096 || header.layerCount == 0 || header.layerCount > 4096)
+	{
+		return false;
+	}
+
+	TextureArrayData cached{};
+	cached.format = header.format;
+	cached.tileSize = header.tileSize;
+	cached.layerCount = header.layerCount;
+	LayoutMips(cached);
+	if (cached.mipCount != header.mipCount || size != sizeof(header) + cached.GetByteSize())
+	{
+		return false;
+	}
+
+	data = std::move(cached);
+	pPixels = pBytes + sizeof(header);
+	return true;
+}
+
+bool TextureArrayBuilder::LoadCache(const std::string& path, uint64_t sourceHash, TextureArrayFormat format, TextureArrayData& data)
+{
+	const MappedFile file(path);
+	TextureArrayData cached{};
+	const uint8_t* pPixels{};
+	if (!ParseCache(file.GetData(), file.GetSize(), sourceHash, format, cached, pPixels))
+	{
+		return false;
+	}
+
+	cached.pixels.assign(pPixels, pPixels + cached.GetByteSize());
+	data = std::move(cached);
+	return true;
+}
+
+bool TextureArrayBuilder::SaveCache(const std::string& path, uint64_t sourceHash, const TextureArrayData& data)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	const CacheHeader header{ g_CacheMagic, g_CacheVersion, sourceHash, data.tileSize, data.layerCount, data.mipCount, data.format };
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(data.pixels.data()), data.pixels.size());
+	return static_cast<bool>(file);
+}
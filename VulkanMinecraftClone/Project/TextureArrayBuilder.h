@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Stored in the cache, don't reorder
+enum class TextureArrayFormat : uint32_t
+{
+	Rgba8Srgb,
+	// 4x4 texel blocks of 8 bytes, opaque or with 1 bit alpha
+	Bc1Srgb
+};
+
+// Pixels of a texture array with its full mip chain, in srgb.
+// Every mip level stores all its layers back to back, the way vkCmdCopyBufferToImage expects one region per level.
+struct TextureArrayData
+{
+	TextureArrayFormat format{ TextureArrayFormat::Rgba8Srgb };
+	uint32_t tileSize{};
+	uint32_t layerCount{};
+	uint32_t mipCount{};
+	// Byte offset of every mip level inside pixels
+	std::vector<size_t> mipOffsets;
+	std::vector<uint8_t> pixels;
+
+	uint32_t GetMipSize(uint32_t mip) const { return tileSize >> mip; }
+	// Size of one layer of the mip, compressed mips are rounded up to whole blocks
+	size_t GetLayerByteSize(uint32_t mip) const
+	{
+		if (format == TextureArrayFormat::Bc1Srgb)
+		{
+			const size_t blocks = (GetMipSize(mip) + 3) / 4;
+			return blocks * blocks * 8;
+		}
+		return static_cast<size_t>(GetMipSize(mip)) * GetMipSize(mip) * 4;
+	}
+	size_t GetByteSize() const { return mipOffsets.empty() ? 0 : mipOffsets.back() + GetLayerByteSize(mipCount - 1) * layerCount; }
+
+	// Only for Rgba8Srgb
+	size_t GetPixelOffset(uint32_t mip, uint32_t layer, uint32_t x, uint32_t y) const
+	{
+		const uint32_t mipSize = GetMipSize(mip);
+		return mipOffsets[mip] + ((static_cast<size_t>(layer) * mipSize + y) * mipSize + x) * 4;
+	}
+	const uint8_t* GetPixel(uint32_t mip, uint32_t layer, uint32_t x, uint32_t y) const { return &pixels[GetPixelOffset(mip, layer, x, y)]; }
+	uint8_t* GetPixel(uint32_t mip, uint32_t layer, uint32_t x, uint32_t y) { return &pixels[GetPixelOffset(mip, layer, x, y)]; }
+};
+
+// Cpu side of the block textures: slices the atlas into one layer per tile, builds the mips and optionally compresses them,
+// so the texture can be sampled as a 2D array without bleeding between tiles.
+// The result is baked into a cache next to the atlas, keyed by a hash of the png file. The cache is laid out exactly like
+// the staging buffer, so at startup it is memory mapped and copied to the gpu without decoding anything.
+// Nothing in here needs Vulkan, baking and validating the cache can be done headless.
+class TextureArrayBuilder final
+{
+public:
+	// Tiles are numbered row by row, layer = row * tilesPerRow + column, same as BlockRegistry::GetFaceLayer
+	static TextureArrayData Slice(const uint8_t* pAtlas, uint32_t atlasWidth, uint32_t atlasHeight, uint32_t tilesPerRow);
+
+	// Fills in every mip level down to 1x1, averaging 2x2 texels in linear space
+	static void GenerateMips(TextureArrayData& data);
+
+	// Encodes every mip of an Rgba8Srgb array, blocks with texels below half alpha use the 1 bit alpha mode
+	static TextureArrayData CompressBc1(const TextureArrayData& data);
+
+	static uint64_t Hash(const uint8_t* pBytes, size_t size);
+
+	// Validates a cache that is already in memory, pPixels points into pBytes afterwards and data gets everything but the pixels.
+	// Returns false when the cache is damaged, was made from another source or holds another format.
+	static bool ParseCache(const uint8_t* pBytes, size_t size, uint64_t sourceHash, TextureArrayFormat format, TextureArrayData& data, const uint8_t*& pPixels);
+	// Same checks, but copies the pixels into data
+	static bool LoadCache(const std::string& path, uint64_t sourceHash, TextureArrayFormat format, TextureArrayData& data);
+	static bool SaveCache(const std::string& path, uint64_t sourceHash, const TextureArrayData& data);
+};
@@ -0,0 +1,307 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "BlockRegistry.h"
+
+// Index layouts of a Width x Height x Depth box of blocks, named after their axes from fastest to slowest.
+// The layout decides which neighbors are close in memory, which is what the generation, meshing and lighting loops pay for.
+
+// x + (y + z * height) * width, a row along x then the rows up a slice
+template<int Width, int Height, int Depth>
+struct LinearXYZ final
+{
+    static constexpr const char* m_Name = "linear XYZ";
+    // Every row along x is contiguous, the face visibility reads a row at a time
+    static constexpr bool m_IsRowContiguous = true;
+    // Distance between a block and the one above it, the bulk writes step up a column with it. 0 when it isn't fixed.
+    static constexpr size_t m_ColumnStride = Width;
+
+    static size_t GetIndex(int x, int y, int z)
+    {
+        return static_cast<size_t>(x) + (static_cast<size_t>(y) + static_cast<size_t>(z) * Height) * Width;
+    }
+    static glm::ivec3 GetPosition(size_t index)
+    {
+        return { static_cast<int>(index % Width), static_cast<int>(index / Width % Height), static_cast<int>(index / (static_cast<size_t>(Width) * Height)) };
+    }
+};
+
+// x + (z + y * depth) * width, horizontal slices stacked up
+template<int Width, int Height, int Depth>
+struct LinearXZY final
+{
+    static constexpr const char* m_Name = "linear XZY";
+    static constexpr bool m_IsRowContiguous = true;
+    static constexpr size_t m_ColumnStride = static_cast<size_t>(Width) * Depth;
+
+    static size_t GetIndex(int x, int y, int z)
+    {
+        return static_cast<size_t>(x) + (static_cast<size_t>(z) + static_cast<size_t>(y) * Depth) * Width;
+    }
+    static glm::ivec3 GetPosition(size_t index)
+    {
+        return { static_cast<int>(index % Width), static_cast<int>(index / (static_cast<size_t>(Width) * Depth)), static_cast<int>(index / Width % Depth) };
+    }
+};
+
+// y + (z + x * depth) * height, every column is contiguous
+template<int Width, int Height, int Depth>
+struct LinearYZX final
+{
+    static constexpr const char* m_Name = "linear YZX";
+    static constexpr bool m_IsRowContiguous = false;
+    static constexpr size_t m_ColumnStride = 1;
+
+    static size_t GetIndex(int x, int y, int z)
+    {
+        return static_cast<size_t>(y) + (static_cast<size_t>(z) + static_cast<size_t>(x) * Depth) * Height;
+    }
+    static glm::ivec3 GetPosition(size_t index)
+    {
+        return { static_cast<int>(index / (static_cast<size_t>(Height) * Depth)), static_cast<int>(index % Height), static_cast<int>(index / Height % Depth) };
+    }
+};
+
+// Z-curve, the bits of x, y and z are interleaved so every aligned 2^n cube is contiguous.
+// Axes with more bits than the others keep their top bits above the interleaved ones, so the size stays Width * Height * Depth.
+// Encoding is one lookup per axis, decoding one lookup per byte of the index.
+template<int Width, int Height, int Depth>
+class MortonLayout final
+{
+    static constexpr int GetBitCount(int size)
+    {
+        int bitCount = 0;
+        while ((1 << bitCount) < size)
+        {
+            ++bitCount;
+        }
+        return bitCount;
+    }
+
+    static constexpr std::array<int, 3> m_AxisBitCounts{ GetBitCount(Width), GetBitCount(Height), GetBitCount(Depth) };
+    static constexpr int m_BitCount = m_AxisBitCounts[0] + m_AxisBitCounts[1] + m_AxisBitCounts[2];
+
+    static_assert((1 << m_AxisBitCounts[0]) == Width && (1 << m_AxisBitCounts[1]) == Height && (1 << m_AxisBitCounts[2]) == Depth,
+        "a morton layout needs power of two dimensions");
+    static_assert(m_BitCount <= 32, "the morton index has to fit in 32 bits");
+    static constexpr int m_ByteCount = (m_BitCount + 7) / 8;
+
+    struct Tables
+    {
+        std::array<uint32_t, Width> x;
+        std::array<uint32_t, Height> y;
+        std::array<uint32_t, Depth> z;
+        // Axis and bit of that axis for every bit of the index
+        std::array<uint8_t, m_BitCount> bitAxes;
+        std::array<uint8_t, m_BitCount> axisBits;
+        // Position bits of every value of every byte of the index
+        std::array<std::array<std::array<uint16_t, 3>, 256>, m_ByteCount> bytePositions;
+    };
+
+    static constexpr Tables CreateTables()
+    {
+        Tables tables{};
+        int indexBit = 0;
+        for (int axisBit = 0; indexBit < m_BitCount; ++axisBit)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (axisBit < m_AxisBitCounts[axis])
+                {
+                    tables.bitAxes[indexBit] = static_cast<uint8_t>(axis);
+                    tables.axisBits[indexBit] = static_cast<uint8_t>(axisBit);
+                    ++indexBit;
+                }
+            }
+        }
+
+        for (int bit = 0; bit < m_BitCount; ++bit)
+        {
+            const int axisBit = tables.axisBits[bit];
+            const auto spread = [&](auto& table)
+                {
+                    for (size_t coordinate = 0; coordinate < table.size(); ++coordinate)
+                    {
+                        table[coordinate] |= static_cast<uint32_t>((coordinate >> axisBit) & 1) << bit;
+                    }
+                };
+            switch (tables.bitAxes[bit])
+            {
+            case 0: spread(tables.x); break;
+            case 1: spread(tables.y); break;
+            default: spread(tables.z); break;
+            }
+
+            for (int value = 0; value < 256; ++value)
+            {
+                if ((value >> (bit % 8)) & 1)
+                {
+                    tables.bytePositions[bit / 8][value][tables.bitAxes[bit]] |= static_cast<uint16_t>(1 << axisBit);
+                }
+            }
+        }
+        return tables;
+    }
+
+    static constexpr Tables m_Tables = CreateTables();
+
+public:
+    static constexpr const char* m_Name = "morton";
+    static constexpr bool m_IsRowContiguous = false;
+    static constexpr size_t m_ColumnStride = 0;
+
+    static size_t GetIndex(int x, int y, int z)
+    {
+        return m_Tables.x[x] | m_Tables.y[y] | m_Tables.z[z];
+    }
+    static glm::ivec3 GetPosition(size_t index)
+    {
+        glm::ivec3 position{};
+        for (int byte = 0; byte < m_ByteCount; ++byte)
+        {
+            const std::array<uint16_t, 3>& bytePosition = m_Tables.bytePositions[byte][(index >> (byte * 8)) & 0xFF];
+            position.x |= bytePosition[0];
+            position.y |= bytePosition[1];
+            position.z |= bytePosition[2];
+        }
+        return position;
+    }
+};
+
+// The blocks of a box whose size and index layout are fixed at compile time.
+// Positions are not bounds checked, callers check them against the size first.
+template<int Width, int Height, int Depth, template<int, int, int> class Layout>
+class VoxelStorage final
+{
+public:
+    using LayoutType = Layout<Width, Height, Depth>;
+
+    static constexpr int m_Width = Width;
+    static constexpr int m_Height = Height;
+    static constexpr int m_Depth = Depth;
+    static constexpr size_t m_BlockCount = static_cast<size_t>(Width) * Height * Depth;
+
+    VoxelStorage()
+        : m_Blocks(m_BlockCount, BlockType::Air)
+    {
+    }
+
+    static size_t GetIndex(int x, int y, int z) { return LayoutType::GetIndex(x, y, z); }
+    static glm::ivec3 GetPosition(size_t index) { return LayoutType::GetPosition(index); }
+
+    BlockType Get(int x, int y, int z) const { return m_Blocks[GetIndex(x, y, z)]; }
+    void Set(int x, int y, int z, BlockType blockType) { m_Blocks[GetIndex(x, y, z)] = blockType; }
+
+    BlockType operator[](size_t index) const { return m_Blocks[index]; }
+    BlockType& operator[](size_t index) { return m_Blocks[index]; }
+
+    void Fill(BlockType blockType) { std::fill(m_Blocks.begin(), m_Blocks.end(), blockType); }
+
+    const BlockType* GetData() const { return m_Blocks.data(); }
+
+    // Bulk writes for the terrain generation, they go straight to the blocks a column or a row at a time instead of
+    // working out the index of every block. The ranges are [begin, end) and have to lie inside the box.
+
+    // Writes the blocks from beginY up to endY of the column at x and z
+    void FillSpan(int x, int z, int beginY, int endY, BlockType blockType)
+    {
+        if constexpr (LayoutType::m_ColumnStride == 1)
+        {
+            std::fill_n(m_Blocks.begin() + GetIndex(x, beginY, z), std::max(endY - beginY, 0), blockType);
+        }
+        else if constexpr (LayoutType::m_ColumnStride != 0)
+        {
+            size_t index = GetIndex(x, beginY, z);
+            for (int y = beginY; y < endY; ++y, index += LayoutType::m_ColumnStride)
+            {
+                m_Blocks[index] = blockType;
+            }
+        }
+        else
+        {
+            for (int y = beginY; y < endY; ++y)
+            {
+                Set(x, y, z, blockType);
+            }
+        }
+    }
+
+    // Writes every block from min up to max
+    void FillBox(const glm::ivec3& min, const glm::ivec3& max, BlockType blockType)
+    {
+        if (min.x >= max.x || min.y >= max.y || min.z >= max.z)
+        {
+            return;
+        }
+
+        if (min == glm::ivec3(0) && max == glm::ivec3(Width, Height, Depth))
+        {
+            Fill(blockType);
+        }
+        else if constexpr (LayoutType::m_IsRowContiguous)
+        {
+            for (int z = min.z; z < max.z; ++z)
+            {
+                for (int y = min.y; y < max.y; ++y)
+                {
+                    std::fill_n(m_Blocks.begin() + GetIndex(min.x, y, z), max.x - min.x, blockType);
+                }
+            }
+        }
+        else
+        {
+            for (int z = min.z; z < max.z; ++z)
+            {
+                for (int x = min.x; x < max.x; ++x)
+                {
+                    FillSpan(x, z, min.y, max.y, blockType);
+                }
+            }
+        }
+    }
+
+    // Copies the Height blocks of pColumn, from the bottom up, into the column at x and z
+    void CopyColumn(int x, int z, const BlockType* pColumn)
+    {
+        if constexpr (LayoutType::m_ColumnStride == 1)
+        {
+            std::copy_n(pColumn, Height, m_Blocks.begin() + GetIndex(x, 0, z));
+        }
+        else if constexpr (LayoutType::m_ColumnStride != 0)
+        {
+            size_t index = GetIndex(x, 0, z);
+            for (int y = 0; y < Height; ++y, index += LayoutType::m_ColumnStride)
+            {
+                m_Blocks[index] = pColumn[y];
+            }
+        }
+        else
+        {
+            for (int y = 0; y < Height; ++y)
+            {
+                Set(x, y, z, pColumn[y]);
+            }
+        }
+    }
+
+private:
+    BlockStorage m_Blocks;
+};
+
+// Size of a chunk in blocks, the Chunk and the LightEngine take theirs from here
+constexpr int CHUNK_WIDTH = 64;
+constexpr int CHUNK_HEIGHT = 128;
+constexpr int CHUNK_DEPTH = 64;
+
+// The layout of the chunks is picked when building, with the CHUNK_LAYOUT CMake option
+#if defined(CHUNK_LAYOUT_XZY)
+using ChunkBlocks = VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearXZY>;
+#elif defined(CHUNK_LAYOUT_YZX)
+using ChunkBlocks = VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearYZX>;
+#elif defined(CHUNK_LAYOUT_MORTON)
+using ChunkBlocks = VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, MortonLayout>;
+#else
+using ChunkBlocks = VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearXYZ>;
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <vector>
+
+class Chunk;
+
+// Distance order of the water draws, closest first and kept between frames. Chunks are added when they are created and removed when they
+// are destroyed, the distances are only refreshed when the camera enters another chunk or chunks were added. By then the
+// previous order is nearly sorted, so an insertion sort re-sorts it in close to linear time.
+// Only stores the chunk pointers, nothing in here touches a Chunk or Vulkan.
+class WaterDrawOrder final
+{
+public:
+    struct Entry
+    {
+        // Distance from the camera to the center of the chunk at the time of the last sort
+        float distance;
+        glm::vec3 center;
+        Chunk* chunk;
+    };
+
+    void Add(Chunk* chunk, const glm::vec3& center)
+    {
+        m_Entries.push_back({ 0.f, center, chunk });
+        m_IsDirty = true;
+    }
+
+    // Keeps the order of the other chunks
+    void Remove(Chunk* chunk)
+    {
+        m_Entries.erase(std::remove_if(m_Entries.begin(), m_Entries.end(), [chunk](const Entry& entry) { return entry.chunk == chunk; }), m_Entries.end());
+    }
+
+    bool IsSorted(const glm::ivec3& cameraChunkPosition) const { return !m_IsDirty && cameraChunkPosition == m_CameraChunkPosition; }
+
+    // Refreshes the distances and re-sorts the previous order
+    void Sort(const glm::vec3& cameraPosition, const glm::ivec3& cameraChunkPosition)
+    {
+        for (Entry& entry : m_Entries)
+        {
+            entry.distance = glm::distance(cameraPosition, entry.center);
+        }
+
+        // Insertion sort, moving one chunk only swaps a few neighbors so this is close to linear
+        for (size_t i = 1; i < m_Entries.size(); ++i)
+        {
+            const Entry entry = m_Entries[i];
+            size_t j = i;
+            while (j > 0 && m_Entries[j - 1].distance > entry.distance)
+            {
+                m_Entries[j] = m_Entries[j - 1];
+                --j;
+            }
+            m_Entries[j] = entry;
+        }
+
+        m_CameraChunkPosition = cameraChunkPosition;
+        m_IsDirty = false;
+    }
+
+    // Closest chunk first
+    const std::vector<Entry>& GetEntries() const { return m_Entries; }
+
+private:
+    std::vector<Entry> m_Entries;
+    glm::ivec3 m_CameraChunkPosition{};
+    bool m_IsDirty{ true };
+};
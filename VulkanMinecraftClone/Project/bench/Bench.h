@@ -0,0 +1,45 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Small benchmark runner for the parts of the game that run without a window or gpu, the counterpart of tests/Test.h.
+// BENCHMARK registers a benchmark, it prints its own table and returns false when the code it timed gave a wrong result.
+// Run the VoxelBench target from a release build, next to the copied textures.
+namespace Bench
+{
+    constexpr int g_RunCount = 15;
+
+    struct Case
+    {
+        const char* pName;
+        bool (*pFunction)();
+    };
+
+    std::vector<Case>& GetCases();
+
+    struct Registrar final
+    {
+        Registrar(const char* pName, bool (*pFunction)()) { GetCases().push_back({ pName, pFunction }); }
+    };
+
+    // Median of the runs in microseconds
+    template<typename Function>
+    double Time(Function&& function)
+    {
+        std::vector<double> times;
+        for (int run = 0; run < g_RunCount; ++run)
+        {
+            const auto start = std::chrono::high_resolution_clock::now();
+            function();
+            times.push_back(std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+        std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+        return times[times.size() / 2];
+    }
+}
+
+#define BENCHMARK(name) \
+    static bool name(); \
+    static const Bench::Registrar g_##name##Registrar{ #name, name }; \
+    static bool name()
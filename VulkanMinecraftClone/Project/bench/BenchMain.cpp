@@ -0,0 +1,37 @@
+// Runs every BENCHMARK, or only the ones whose name contains the first argument
+#include "bench/Bench.h"
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+std::vector<Bench::Case>& Bench::GetCases()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* pFilter = argc > 1 ? argv[1] : nullptr;
+    std::cout << std::fixed << std::setprecision(1);
+    int runCount = 0;
+    int failedCount = 0;
+    for (const Bench::Case& benchCase : Bench::GetCases())
+    {
+        if (pFilter != nullptr && std::strstr(benchCase.pName, pFilter) == nullptr)
+        {
+            continue;
+        }
+
+        std::cout << '\n' << benchCase.pName << '\n';
+        ++runCount;
+        if (!benchCase.pFunction())
+        {
+            ++failedCount;
+            std::cout << "FAILED " << benchCase.pName << '\n';
+        }
+    }
+
+    std::cout << '\n' << runCount - failedCount << " of " << runCount << " benchmarks gave valid results\n";
+    return failedCount == 0 && runCount > 0 ? 0 : 1;
+}
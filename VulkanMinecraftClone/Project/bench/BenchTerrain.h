@@ -0,0 +1,69 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "TerrainColumn.h"
+#include "VoxelStorage.h"
+#include "vendor/SimplexNoise.h"
+
+// Chunks of the default terrain for the benchmarks, built without the ChunkGenerator.
+// The noise has no seed, so a chunk position always gives the same blocks.
+namespace Bench
+{
+    // Same as Chunk::m_SeaLevel
+    constexpr float g_SeaLevel = 0.3f;
+
+    // Column heights the way ChunkGenerator::GetHeight makes them, for the chunk at chunkX and chunkZ
+    inline std::vector<int> CreateChunkHeights(int chunkX, int chunkZ)
+    {
+        const SimplexNoise noise = CreateTerrainNoise();
+        std::vector<int> heights(static_cast<size_t>(CHUNK_WIDTH) * CHUNK_DEPTH);
+        for (int z = 0; z < CHUNK_DEPTH; ++z)
+        {
+            for (int x = 0; x < CHUNK_WIDTH; ++x)
+            {
+                heights[x + z * CHUNK_WIDTH] = GetTerrainHeight(noise, chunkX * CHUNK_WIDTH + x, chunkZ * CHUNK_DEPTH + z, CHUNK_HEIGHT, 0.f, 1.f);
+            }
+        }
+        return heights;
+    }
+
+    // The blocks Chunk::GenerateTerrain writes before it plants the trees
+    inline std::unique_ptr<ChunkBlocks> CreateChunk(int chunkX, int chunkZ)
+    {
+        auto pBlocks = std::make_unique<ChunkBlocks>();
+        WriteTerrainColumns(*pBlocks, CreateChunkHeights(chunkX, chunkZ).data(), g_SeaLevel);
+        return pBlocks;
+    }
+
+    // Trunks with a layer of leaves on a grid over the grass, simpler than the random trees of Chunk::GenerateTerrain
+    inline void PlantTrees(ChunkBlocks& blocks)
+    {
+        for (int treeZ = 4; treeZ < ChunkBlocks::m_Depth - 4; treeZ += 9)
+        {
+            for (int treeX = 4; treeX < ChunkBlocks::m_Width - 4; treeX += 9)
+            {
+                int groundY = ChunkBlocks::m_Height - 1;
+                while (groundY > 0 && blocks.Get(treeX, groundY, treeZ) == BlockType::Air)
+                {
+                    --groundY;
+                }
+                if (blocks.Get(treeX, groundY, treeZ) != BlockType::GrassBlock || groundY + 6 >= ChunkBlocks::m_Height)
+                {
+                    continue;
+                }
+
+                for (int y = groundY + 1; y <= groundY + 4; ++y)
+                {
+                    blocks.Set(treeX, y, treeZ, BlockType::Log);
+                }
+                for (int z = treeZ - 2; z <= treeZ + 2; ++z)
+                {
+                    for (int x = treeX - 2; x <= treeX + 2; ++x)
+                    {
+                        blocks.Set(x, groundY + 5, z, BlockType::Leaves);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,169 @@
+// Benchmark of the per block face visibility loop of the land mesher before the row masks, with the block properties of
+// the BlockRegistry against the hardcoded checks it replaced: an unordered_map of face offsets, Air, Leaves and Water
+// compared by name and a bounds checked lookup for every neighbor. Both loops are checked to find the same faces.
+#include "bench/Bench.h"
+#include "bench/BenchTerrain.h"
+#include "BlockRegistry.h"
+#include "FaceTable.h"
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace
+{
+    constexpr int g_Width = ChunkBlocks::m_Width;
+    constexpr int g_Height = ChunkBlocks::m_Height;
+    constexpr int g_Depth = ChunkBlocks::m_Depth;
+
+    // Blocks outside of the chunk count as air
+    BlockType GetBlock(const ChunkBlocks& blocks, int x, int y, int z)
+    {
+        if (x < 0 || x >= g_Width || y < 0 || y >= g_Height || z < 0 || z >= g_Depth)
+        {
+            return BlockType::Air;
+        }
+        return blocks.Get(x, y, z);
+    }
+
+    // Visible faces and a sum over their block index and direction, so both loops have to find the same faces
+    struct FaceCount
+    {
+        uint64_t faceCount;
+        uint64_t faceSum;
+
+        void Add(int x, int y, int z, int direction)
+        {
+            ++faceCount;
+            faceSum += (ChunkBlocks::GetIndex(x, y, z) * FACE_COUNT + direction) * 2654435761u;
+        }
+    };
+
+    // The loop before the registry, with Chunk::IsSameBlockType and Chunk::IsOpaqueBlock
+    const std::unordered_map<Direction, glm::ivec3> g_FaceOffsets{
+        { Direction::Down, { 0, -1, 0 } },
+        { Direction::East, { 1, 0, 0 } },
+        { Direction::North, { 0, 0, -1 } },
+        { Direction::South, { 0, 0, 1 } },
+        { Direction::Up, { 0, 1, 0 } },
+        { Direction::West, { -1, 0, 0 } }
+    };
+
+    bool IsSameBlockTypeOld(const ChunkBlocks& blocks, BlockType blockType, int x, int y, int z)
+    {
+        if (x < 0 || x >= g_Width || y < 0 || y >= g_Height || z < 0 || z >= g_Depth)
+        {
+            return false;
+        }
+        return blocks.Get(x, y, z) == blockType;
+    }
+
+    bool IsOpaqueBlockOld(const ChunkBlocks& blocks, int x, int y, int z)
+    {
+        if (x < 0 || x >= g_Width || y < 0 || y >= g_Height || z < 0 || z >= g_Depth)
+        {
+            return false;
+        }
+        const BlockType blockType = blocks.Get(x, y, z);
+        return blockType != BlockType::Air && blockType != BlockType::Leaves && blockType != BlockType::Water;
+    }
+
+    FaceCount CountFacesOld(const ChunkBlocks& blocks)
+    {
+        FaceCount count{};
+        for (int x = 0; x < g_Width; ++x)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                for (int z = 0; z < g_Depth; ++z)
+                {
+                    const BlockType blockType = blocks.Get(x, y, z);
+                    if (blockType == BlockType::Air || blockType == BlockType::Water)
+                    {
+                        continue;
+                    }
+
+                    for (const auto& [direction, offset] : g_FaceOffsets)
+                    {
+                        const int nx = x + offset.x;
+                        const int ny = y + offset.y;
+                        const int nz = z + offset.z;
+                        if (blockType != BlockType::Leaves && IsSameBlockTypeOld(blocks, blockType, nx, ny, nz))
+                        {
+                            continue;
+                        }
+                        if (!IsOpaqueBlockOld(blocks, nx, ny, nz))
+                        {
+                            count.Add(x, y, z, static_cast<int>(direction));
+                        }
+                    }
+                }
+            }
+        }
+        return count;
+    }
+
+    // The loop with the registry masks and the face table
+    FaceCount CountFacesRegistry(const ChunkBlocks& blocks)
+    {
+        const BlockRegistry& registry = BlockRegistry::GetInstance();
+        FaceCount count{};
+        for (int x = 0; x < g_Width; ++x)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                for (int z = 0; z < g_Depth; ++z)
+                {
+                    const BlockType blockType = blocks.Get(x, y, z);
+                    if (registry.GetRenderLayer(blockType) != RenderLayer::Land)
+                    {
+                        continue;
+                    }
+
+                    const bool cullsSameType = registry.CullsSameType(blockType);
+                    for (int face = 0; face < FACE_COUNT; ++face)
+                    {
+                        const auto& offset = FACE_TABLE[face].normal;
+                        const BlockType neighborBlockType = GetBlock(blocks, x + offset[0], y + offset[1], z + offset[2]);
+                        if (registry.IsOpaque(neighborBlockType) || (cullsSameType && neighborBlockType == blockType))
+                        {
+                            continue;
+                        }
+                        count.Add(x, y, z, face);
+                    }
+                }
+            }
+        }
+        return count;
+    }
+}
+
+BENCHMARK(RegistryVisibilityLoop)
+{
+    if (!BlockRegistry::GetInstance().Load("textures/blockdata.json"))
+    {
+        return false;
+    }
+
+    std::cout << g_Width << " x " << g_Height << " x " << g_Depth << " chunks of the default terrain with trees, median of " << Bench::g_RunCount << " runs in us\n";
+    std::cout << std::setw(16) << std::left << "chunk" << std::right << std::setw(12) << "faces" << std::setw(12) << "old" << std::setw(12) << "registry" << '\n';
+    for (const glm::ivec2& chunkPosition : { glm::ivec2{ 0, 0 }, glm::ivec2{ 3, -2 }, glm::ivec2{ -7, 5 } })
+    {
+        const std::unique_ptr<ChunkBlocks> pBlocks = Bench::CreateChunk(chunkPosition.x, chunkPosition.y);
+        Bench::PlantTrees(*pBlocks);
+
+        FaceCount oldCount{};
+        FaceCount registryCount{};
+        const double oldTime = Bench::Time([&]() { oldCount = CountFacesOld(*pBlocks); });
+        const double registryTime = Bench::Time([&]() { registryCount = CountFacesRegistry(*pBlocks); });
+        if (oldCount.faceCount != registryCount.faceCount || oldCount.faceSum != registryCount.faceSum)
+        {
+            std::cout << "The registry loop finds " << registryCount.faceCount << " faces instead of " << oldCount.faceCount << '\n';
+            return false;
+        }
+
+        std::cout << std::setw(16) << std::left << (std::to_string(chunkPosition.x) + ", " + std::to_string(chunkPosition.y)) << std::right
+            << std::setw(12) << oldCount.faceCount << std::setw(12) << oldTime << std::setw(12) << registryTime << '\n';
+    }
+    return true;
+}
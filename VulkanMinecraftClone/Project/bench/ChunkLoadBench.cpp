@@ -0,0 +1,167 @@
+// Benchmark of the heap traffic of loading chunks while flying, with fresh chunks and with pooled chunks and scratch storage.
+// The chunks hold what a Chunk keeps on the heap without the gpu: the blocks, the light and the land vertices.
+// A load generates the terrain with trees, lights the chunk on its own and meshes the land, the way Chunk::Load and
+// Chunk::MeshLand do. Fresh chunks also mesh in new scratch storage every load, the way the chunks did before the ChunkPool.
+// The allocations are counted with the AllocationCounter, so the VoxelBench target is built with MEMORY_PROFILING.
+#include "bench/Bench.h"
+#include "bench/BenchTerrain.h"
+#include "AllocationCounter.h"
+#include "LandMesher.h"
+#include "LightEngine.h"
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Same as ChunkPool::m_MaxPooledChunks
+    constexpr size_t g_MaxPooledChunks = 32;
+    // The loaded chunks are a square of (2 * g_LoadRadius + 1)^2 chunks around the camera
+    constexpr int g_LoadRadius = 3;
+    // Chunk borders the camera crosses, every crossing loads and unloads a row of chunks
+    constexpr int g_FlightLength = 24;
+
+    struct LoadedChunk
+    {
+        ChunkBlocks blocks;
+        LightData light{ ChunkBlocks::m_BlockCount };
+        TaggedVector<Vertex, MemoryTag::Meshes> landVertices;
+        LandMesher::SectionRanges landSections{};
+    };
+
+    struct MeshScratch
+    {
+        FaceVisibility faceVisibility{ ChunkBlocks::m_Height, ChunkBlocks::m_Depth };
+        TaggedVector<Vertex, MemoryTag::Transient> landVertices;
+    };
+
+    struct FlightResult
+    {
+        size_t loadCount;
+        AllocationCounter::Snapshot allocations;
+        // Most heap memory the tagged containers held at once during the flight, the loaded and pooled chunks and the scratch
+        uint64_t peakTaggedBytes;
+        uint64_t peakResidentBytes;
+    };
+
+    uint64_t GetTaggedBytes()
+    {
+        const MemoryTracker& memoryTracker = MemoryTracker::GetInstance();
+        return memoryTracker.GetHostBytes(MemoryTag::Voxels) + memoryTracker.GetHostBytes(MemoryTag::Meshes) + memoryTracker.GetHostBytes(MemoryTag::Transient);
+    }
+
+    const LandMesher::LightLookup g_GetLight = [](int, int, int) { return glm::vec2{ 1.f, 0.f }; };
+
+    void GenerateChunk(LoadedChunk& chunk, int chunkX, int chunkZ)
+    {
+        WriteTerrainColumns(chunk.blocks, Bench::CreateChunkHeights(chunkX, chunkZ).data(), Bench::g_SeaLevel);
+        Bench::PlantTrees(chunk.blocks);
+        LightEngine::LightChunk(chunk.blocks, chunk.light);
+    }
+
+    std::unique_ptr<LoadedChunk> LoadFresh(int chunkX, int chunkZ)
+    {
+        auto pChunk = std::make_unique<LoadedChunk>();
+        GenerateChunk(*pChunk, chunkX, chunkZ);
+        FaceVisibility faceVisibility{ ChunkBlocks::m_Height, ChunkBlocks::m_Depth };
+        TaggedVector<Vertex, MemoryTag::Transient> vertices;
+        LandMesher::Build(pChunk->blocks, faceVisibility, true, g_GetLight, vertices, pChunk->landSections);
+        pChunk->landVertices.assign(vertices.begin(), vertices.end());
+        return pChunk;
+    }
+
+    std::unique_ptr<LoadedChunk> LoadPooled(int chunkX, int chunkZ, std::vector<std::unique_ptr<LoadedChunk>>& freeChunks, MeshScratch& meshScratch)
+    {
+        std::unique_ptr<LoadedChunk> pChunk;
+        if (freeChunks.empty())
+        {
+            pChunk = std::make_unique<LoadedChunk>();
+        }
+        else
+        {
+            pChunk = std::move(freeChunks.back());
+            freeChunks.pop_back();
+            pChunk->light.Fill(LightData::m_MaxLevel, 0);
+        }
+        GenerateChunk(*pChunk, chunkX, chunkZ);
+        LandMesher::Build(pChunk->blocks, meshScratch.faceVisibility, true, g_GetLight, meshScratch.landVertices, pChunk->landSections);
+        pChunk->landVertices.assign(meshScratch.landVertices.begin(), meshScratch.landVertices.end());
+        return pChunk;
+    }
+
+    // Flies along +x, only the loads and unloads after the first chunks were loaded are counted
+    FlightResult Fly(bool isPooled)
+    {
+        std::map<std::pair<int, int>, std::unique_ptr<LoadedChunk>> loadedChunks;
+        std::vector<std::unique_ptr<LoadedChunk>> freeChunks;
+        MeshScratch meshScratch;
+        const auto load = [&](int chunkX, int chunkZ)
+            {
+                loadedChunks[{ chunkX, chunkZ }] = isPooled ? LoadPooled(chunkX, chunkZ, freeChunks, meshScratch) : LoadFresh(chunkX, chunkZ);
+            };
+
+        for (int chunkZ = -g_LoadRadius; chunkZ <= g_LoadRadius; ++chunkZ)
+        {
+            for (int chunkX = -g_LoadRadius; chunkX <= g_LoadRadius; ++chunkX)
+            {
+                load(chunkX, chunkZ);
+            }
+        }
+
+        FlightResult result{};
+        const AllocationCounter::Snapshot start = AllocationCounter::GetSnapshot();
+        for (int cameraX = 1; cameraX <= g_FlightLength; ++cameraX)
+        {
+            for (int chunkZ = -g_LoadRadius; chunkZ <= g_LoadRadius; ++chunkZ)
+            {
+                auto unloaded = loadedChunks.find({ cameraX - g_LoadRadius - 1, chunkZ });
+                if (isPooled && freeChunks.size() < g_MaxPooledChunks)
+                {
+                    freeChunks.push_back(std::move(unloaded->second));
+                }
+                loadedChunks.erase(unloaded);
+
+                load(cameraX + g_LoadRadius, chunkZ);
+                ++result.loadCount;
+                result.peakTaggedBytes = std::max(result.peakTaggedBytes, GetTaggedBytes());
+            }
+        }
+        const AllocationCounter::Snapshot end = AllocationCounter::GetSnapshot();
+        result.allocations = { end.allocationCount - start.allocationCount, end.allocatedBytes - start.allocatedBytes };
+        result.peakResidentBytes = AllocationCounter::GetPeakResidentBytes();
+        return result;
+    }
+}
+
+BENCHMARK(ChunkLoadAllocations)
+{
+    if (!AllocationCounter::IsEnabled())
+    {
+        std::cout << "Needs MEMORY_PROFILING to count the allocations\n";
+        return false;
+    }
+    if (!BlockRegistry::GetInstance().Load("textures/blockdata.json"))
+    {
+        return false;
+    }
+
+    constexpr int loadWidth = 2 * g_LoadRadius + 1;
+    std::cout << loadWidth << " x " << loadWidth << " chunks loaded, " << g_FlightLength << " chunk borders crossed, per load\n";
+    std::cout << "Tagged is the most the chunks and the scratch held at once, the peak resident memory is of the whole process so far\n";
+    std::cout << std::setw(16) << std::left << "chunks" << std::right << std::setw(12) << "loads" << std::setw(12) << "allocs" << std::setw(12) << "KB"
+        << std::setw(12) << "tagged MB" << std::setw(16) << "peak RSS MB" << '\n';
+
+    for (const bool isPooled : { true, false })
+    {
+        const FlightResult result = Fly(isPooled);
+        const double loadCount = static_cast<double>(result.loadCount);
+        std::cout << std::setw(16) << std::left << (isPooled ? "pool, scratch" : "fresh") << std::right << std::setw(12) << result.loadCount
+            << std::setw(12) << result.allocations.allocationCount / loadCount << std::setw(12) << result.allocations.allocatedBytes / loadCount / 1024.0
+            << std::setw(12) << result.peakTaggedBytes / (1024.0 * 1024.0) << std::setw(16) << result.peakResidentBytes / (1024.0 * 1024.0) << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,206 @@
+// Benchmarks of the chunk draw orders on chunks laid out on a square grid around the camera, the chunk pointers are never
+// dereferenced. The water order is checked against std::sort of the same chunks, the land order to hold every chunk once
+// in rings that never get closer to the camera.
+#include "bench/Bench.h"
+#include "ChunkDrawOrder.h"
+#include "WaterDrawOrder.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr float g_ChunkSize = 64.f;
+
+    // Stand ins for the chunks, only their addresses are used
+    struct FakeChunks
+    {
+        std::vector<char> storage;
+        std::vector<glm::ivec3> positions;
+
+        Chunk* Get(size_t index) { return reinterpret_cast<Chunk*>(storage.data() + index); }
+    };
+
+    // The first chunkCount chunks of the smallest square grid that holds them, centered on chunk 0, 0
+    FakeChunks CreateChunks(int chunkCount)
+    {
+        int side = 1;
+        while (side * side < chunkCount)
+        {
+            side += 2;
+        }
+
+        FakeChunks chunks;
+        chunks.storage.resize(chunkCount);
+        for (int index = 0; index < chunkCount; ++index)
+        {
+            chunks.positions.push_back({ index % side - side / 2, 0, index / side - side / 2 });
+        }
+        return chunks;
+    }
+
+    glm::vec3 GetCenter(const glm::ivec3& chunkPosition)
+    {
+        return glm::vec3(chunkPosition) * g_ChunkSize + glm::vec3(g_ChunkSize / 2.f);
+    }
+
+    // Times the water order of every frame the way RenderWater built it before the order was kept: a distance list
+    // of every chunk, sorted with std::sort. Against that the kept order is re-sorted after the camera crossed a chunk,
+    // frames without a crossing don't sort at all.
+    bool RunWaterDrawOrder(int chunkCount)
+    {
+        FakeChunks chunks = CreateChunks(chunkCount);
+        WaterDrawOrder waterDrawOrder;
+        for (int index = 0; index < chunkCount; ++index)
+        {
+            waterDrawOrder.Add(chunks.Get(index), GetCenter(chunks.positions[index]));
+        }
+
+        // The camera walks back and forth over a chunk border, every sort follows a crossing
+        const glm::ivec3 cameraChunks[2]{ { 0, 0, 0 }, { 1, 0, 0 } };
+        int cameraIndex = 0;
+        const auto getCameraPosition = [&]() { return GetCenter(cameraChunks[cameraIndex]) + glm::vec3(0.f, 40.f, 0.f); };
+        waterDrawOrder.Sort(getCameraPosition(), cameraChunks[cameraIndex]);
+
+        std::vector<std::pair<float, Chunk*>> chunkDistances;
+        const auto sortDistances = [&]()
+            {
+                const glm::vec3 cameraPosition = getCameraPosition();
+                chunkDistances.clear();
+                for (int index = 0; index < chunkCount; ++index)
+                {
+                    chunkDistances.emplace_back(glm::distance(cameraPosition, GetCenter(chunks.positions[index])), chunks.Get(index));
+                }
+                std::sort(chunkDistances.begin(), chunkDistances.end());
+            };
+        const double perFrameTime = Bench::Time(sortDistances);
+        const double crossingTime = Bench::Time([&]()
+            {
+                cameraIndex ^= 1;
+                waterDrawOrder.Sort(getCameraPosition(), cameraChunks[cameraIndex]);
+            });
+
+        // The kept order has the same distances as the fresh std::sort of the last camera position
+        cameraIndex ^= 1;
+        waterDrawOrder.Sort(getCameraPosition(), cameraChunks[cameraIndex]);
+        sortDistances();
+        const std::vector<WaterDrawOrder::Entry>& entries = waterDrawOrder.GetEntries();
+        if (entries.size() != chunkDistances.size())
+        {
+            std::cout << "The water order holds " << entries.size() << " chunks instead of " << chunkDistances.size() << '\n';
+            return false;
+        }
+        for (size_t index = 0; index < entries.size(); ++index)
+        {
+            if (entries[index].distance != chunkDistances[index].first)
+            {
+                std::cout << "The water order differs from std::sort at " << index << '\n';
+                return false;
+            }
+        }
+
+        std::cout << std::setw(28) << std::left << "" << std::right << std::setw(12) << "us" << '\n';
+        std::cout << std::setw(28) << std::left << "std::sort every frame" << std::right << std::setw(12) << perFrameTime << '\n';
+        std::cout << std::setw(28) << std::left << "re-sort after a crossing" << std::right << std::setw(12) << crossingTime << '\n';
+        return true;
+    }
+
+    // Times a rebuild of the front to back land order, which happens when the camera enters another chunk, against a
+    // std::sort of the chunks by their distance to the camera, and the walk over the order that every frame does
+    bool RunLandDrawOrder(int chunkCount)
+    {
+        FakeChunks chunks = CreateChunks(chunkCount);
+        const glm::ivec3 cameraChunkPosition{ 1, 0, -1 };
+        const glm::vec3 cameraPosition = GetCenter(cameraChunkPosition) + glm::vec3(0.f, 40.f, 0.f);
+
+        ChunkDrawOrder drawOrder;
+        const double rebuildTime = Bench::Time([&]()
+            {
+                drawOrder.Begin(cameraChunkPosition);
+                for (int index = 0; index < chunkCount; ++index)
+                {
+                    drawOrder.Add(chunks.positions[index], chunks.Get(index));
+                }
+                drawOrder.Finish();
+            });
+
+        std::vector<std::pair<float, Chunk*>> chunkDistances;
+        const double sortTime = Bench::Time([&]()
+            {
+                chunkDistances.clear();
+                for (int index = 0; index < chunkCount; ++index)
+                {
+                    chunkDistances.emplace_back(glm::distance(cameraPosition, GetCenter(chunks.positions[index])), chunks.Get(index));
+                }
+                std::sort(chunkDistances.begin(), chunkDistances.end());
+            });
+
+        size_t walkedChunks = 0;
+        const double walkTime = Bench::Time([&]()
+            {
+                for (Chunk* chunk : drawOrder.GetChunks())
+                {
+                    walkedChunks += chunk != nullptr;
+                }
+            });
+
+        // Every chunk once, in rings that never get closer to the camera
+        const std::vector<Chunk*>& order = drawOrder.GetChunks();
+        std::vector<bool> isSeen(chunkCount, false);
+        int previousRing = 0;
+        for (Chunk* chunk : order)
+        {
+            const size_t index = static_cast<size_t>(reinterpret_cast<char*>(chunk) - chunks.storage.data());
+            if (index >= isSeen.size())
+            {
+                std::cout << "The land order holds a chunk that was never added\n";
+                return false;
+            }
+            const glm::ivec3& position = chunks.positions[index];
+            const int ring = std::max(std::abs(position.x - cameraChunkPosition.x), std::abs(position.z - cameraChunkPosition.z));
+            if (isSeen[index] || ring < previousRing)
+            {
+                std::cout << "The land order is not front to back at chunk " << index << '\n';
+                return false;
+            }
+            isSeen[index] = true;
+            previousRing = ring;
+        }
+        if (order.size() != static_cast<size_t>(chunkCount) || walkedChunks == 0)
+        {
+            std::cout << "The land order holds " << order.size() << " chunks instead of " << chunkCount << '\n';
+            return false;
+        }
+
+        std::cout << std::setw(28) << std::left << "" << std::right << std::setw(12) << "us" << '\n';
+        std::cout << std::setw(28) << std::left << "ring counting sort" << std::right << std::setw(12) << rebuildTime << '\n';
+        std::cout << std::setw(28) << std::left << "std::sort by distance" << std::right << std::setw(12) << sortTime << '\n';
+        std::cout << std::setw(28) << std::left << "walk of the order" << std::right << std::setw(12) << walkTime << '\n';
+        return true;
+    }
+}
+
+BENCHMARK(WaterDrawOrder441)
+{
+    std::cout << "441 chunks, median of " << Bench::g_RunCount << " runs\n";
+    return RunWaterDrawOrder(441);
+}
+
+BENCHMARK(WaterDrawOrder2000)
+{
+    std::cout << "2000 chunks, median of " << Bench::g_RunCount << " runs\n";
+    return RunWaterDrawOrder(2000);
+}
+
+BENCHMARK(LandDrawOrder441)
+{
+    std::cout << "441 chunks, median of " << Bench::g_RunCount << " runs\n";
+    return RunLandDrawOrder(441);
+}
+
+BENCHMARK(LandDrawOrder4225)
+{
+    std::cout << "4225 chunks, median of " << Bench::g_RunCount << " runs\n";
+    return RunLandDrawOrder(4225);
+}
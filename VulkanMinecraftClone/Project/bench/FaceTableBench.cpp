@@ -0,0 +1,229 @@
+// Benchmark of the face emission of the land mesher. WriteFaceVertices writes the corners of a face from the constexpr
+// FACE_TABLE, against the Chunk::AddFaceVertices it replaced: two unordered_map lookups for the texture, three switch
+// statements and a temporary vector per face. The faces of both are checked to have the same corners and texture corners.
+#include "bench/Bench.h"
+#include "BlockMesh.h"
+#include "BlockRegistry.h"
+#include "FaceTable.h"
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    constexpr int g_FaceCount = 1 << 20;
+    // Faces meshed before the output is cleared, about a chunk worth
+    constexpr int g_BatchFaceCount = 16384;
+    constexpr float g_AtlasSize = 16.f;
+
+    // The texture lookup of the old ChunkGenerator::GetBlockData
+    using OldBlockData = std::unordered_map<BlockType, std::unordered_map<Direction, TextureCoords>>;
+
+    // Chunk::AddFaceVertices before the face table, the texture coordinates are atlas coordinates in texCoord.xy
+    void AddFaceVerticesOld(const OldBlockData& blockData, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, BlockType blockType, Direction direction, const glm::vec3& position)
+    {
+        const auto it = blockData.find(blockType);
+        if (it == blockData.end())
+        {
+            return;
+        }
+        const auto textureCoordsIt = it->second.find(direction);
+        if (textureCoordsIt == it->second.end())
+        {
+            return;
+        }
+        const TextureCoords textureCoords = textureCoordsIt->second;
+
+        const float texCoordLeft = textureCoords.column * (1.0f / g_AtlasSize);
+        const float texCoordRight = (textureCoords.column + 1) * (1.0f / g_AtlasSize);
+        const float texCoordTop = textureCoords.row * (1.0f / g_AtlasSize);
+        const float texCoordBottom = (textureCoords.row + 1) * (1.0f / g_AtlasSize);
+
+        glm::vec3 basePosition = position;
+        switch (direction)
+        {
+        case Direction::Up: basePosition.y += 0.5f; break;
+        case Direction::Down: basePosition.y -= 0.5f; break;
+        case Direction::North: basePosition.z -= 0.5f; break;
+        case Direction::East: basePosition.x += 0.5f; break;
+        case Direction::South: basePosition.z += 0.5f; break;
+        case Direction::West: basePosition.x -= 0.5f; break;
+        }
+
+        glm::vec3 normal{};
+        switch (direction)
+        {
+        case Direction::Up: normal = { 0.0f, 1.0f, 0.0f }; break;
+        case Direction::Down: normal = { 0.0f, -1.0f, 0.0f }; break;
+        case Direction::North: normal = { 0.0f, 0.0f, -1.0f }; break;
+        case Direction::East: normal = { 1.0f, 0.0f, 0.0f }; break;
+        case Direction::South: normal = { 0.0f, 0.0f, 1.0f }; break;
+        case Direction::West: normal = { -1.0f, 0.0f, 0.0f }; break;
+        }
+
+        std::vector<Vertex> faceVertices;
+        faceVertices.reserve(4);
+        const glm::vec3& p = basePosition;
+        switch (direction)
+        {
+        case Direction::Up:
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y, p.z + 0.5f }, normal, { texCoordLeft, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y, p.z + 0.5f }, normal, { texCoordRight, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y, p.z - 0.5f }, normal, { texCoordRight, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y, p.z - 0.5f }, normal, { texCoordLeft, texCoordTop, 0.f } });
+            break;
+        case Direction::Down:
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y, p.z - 0.5f }, normal, { texCoordLeft, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y, p.z - 0.5f }, normal, { texCoordRight, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y, p.z + 0.5f }, normal, { texCoordRight, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y, p.z + 0.5f }, normal, { texCoordLeft, texCoordBottom, 0.f } });
+            break;
+        case Direction::North:
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y - 0.5f, p.z }, normal, { texCoordRight, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y + 0.5f, p.z }, normal, { texCoordRight, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y + 0.5f, p.z }, normal, { texCoordLeft, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y - 0.5f, p.z }, normal, { texCoordLeft, texCoordBottom, 0.f } });
+            break;
+        case Direction::South:
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y - 0.5f, p.z }, normal, { texCoordRight, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x + 0.5f, p.y + 0.5f, p.z }, normal, { texCoordRight, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y + 0.5f, p.z }, normal, { texCoordLeft, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x - 0.5f, p.y - 0.5f, p.z }, normal, { texCoordLeft, texCoordBottom, 0.f } });
+            break;
+        case Direction::East:
+            faceVertices.push_back(Vertex{ { p.x, p.y - 0.5f, p.z + 0.5f }, normal, { texCoordLeft, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x, p.y - 0.5f, p.z - 0.5f }, normal, { texCoordRight, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x, p.y + 0.5f, p.z - 0.5f }, normal, { texCoordRight, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x, p.y + 0.5f, p.z + 0.5f }, normal, { texCoordLeft, texCoordTop, 0.f } });
+            break;
+        case Direction::West:
+            faceVertices.push_back(Vertex{ { p.x, p.y - 0.5f, p.z - 0.5f }, normal, { texCoordLeft, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x, p.y - 0.5f, p.z + 0.5f }, normal, { texCoordRight, texCoordBottom, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x, p.y + 0.5f, p.z + 0.5f }, normal, { texCoordRight, texCoordTop, 0.f } });
+            faceVertices.push_back(Vertex{ { p.x, p.y + 0.5f, p.z - 0.5f }, normal, { texCoordLeft, texCoordTop, 0.f } });
+            break;
+        }
+
+        const uint32_t vertexOffset = static_cast<uint32_t>(vertices.size());
+        vertices.insert(vertices.end(), faceVertices.begin(), faceVertices.end());
+        indices.push_back(vertexOffset);
+        indices.push_back(vertexOffset + 1);
+        indices.push_back(vertexOffset + 2);
+        indices.push_back(vertexOffset + 2);
+        indices.push_back(vertexOffset + 3);
+        indices.push_back(vertexOffset);
+    }
+
+    struct FaceInput
+    {
+        BlockType blockType;
+        Direction direction;
+        glm::vec3 position;
+    };
+
+    // Mixed block types and directions over the positions of a chunk
+    std::vector<FaceInput> CreateFaces()
+    {
+        std::vector<FaceInput> faces(g_FaceCount);
+        for (int face = 0; face < g_FaceCount; ++face)
+        {
+            const int blockType = face % 6;
+            const int direction = blockType == 0 ? (face / 6) % 6 : blockType;
+            faces[face] = { static_cast<BlockType>(blockType), static_cast<Direction>(direction),
+                glm::vec3(face % 64, (face / 64) % 128, (face / 8192) % 64) };
+        }
+        return faces;
+    }
+
+    // Same corners in the same order, and the atlas coordinates of the old face are the texture corners of the new one
+    bool IsSameFace(const Vertex* pOld, const Vertex* pNew, const TextureCoords& textureCoords)
+    {
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            const glm::vec2 texCorner = glm::vec2(pOld[corner].texCoord.x, pOld[corner].texCoord.y) * g_AtlasSize - glm::vec2(textureCoords.column, textureCoords.row);
+            if (pOld[corner].position != pNew[corner].position || pOld[corner].normal != pNew[corner].normal || texCorner != glm::vec2(pNew[corner].texCoord.x, pNew[corner].texCoord.y))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+BENCHMARK(FaceEmission)
+{
+    BlockRegistry& registry = BlockRegistry::GetInstance();
+    if (!registry.Load("textures/blockdata.json"))
+    {
+        return false;
+    }
+    OldBlockData oldBlockData;
+    for (int blockType = 0; blockType < static_cast<int>(BlockType::Air); ++blockType)
+    {
+        for (int direction = 0; direction < FACE_COUNT; ++direction)
+        {
+            oldBlockData[static_cast<BlockType>(blockType)][static_cast<Direction>(direction)] = registry.GetFaceTexture(static_cast<BlockType>(blockType), static_cast<Direction>(direction));
+        }
+    }
+
+    const std::vector<FaceInput> faces = CreateFaces();
+    std::vector<Vertex> oldVertices;
+    std::vector<uint32_t> oldIndices;
+    oldVertices.reserve(g_BatchFaceCount * 4);
+    oldIndices.reserve(g_BatchFaceCount * 6);
+    std::vector<Vertex> newVertices;
+    newVertices.reserve(g_BatchFaceCount * 4);
+    constexpr std::array<uint8_t, 4> unoccluded{ 3, 3, 3, 3 };
+    const glm::vec2 light{ 1.f, 0.f };
+
+    // The first batch of both, face by face
+    for (int face = 0; face < g_BatchFaceCount; ++face)
+    {
+        const FaceInput& input = faces[face];
+        AddFaceVerticesOld(oldBlockData, oldVertices, oldIndices, input.blockType, input.direction, input.position);
+        WriteFaceVertices(newVertices, static_cast<int>(input.direction), input.position,
+            static_cast<float>(registry.GetFaceLayer(input.blockType, input.direction)), unoccluded, light);
+        if (!IsSameFace(&oldVertices[face * 4], &newVertices[face * 4], registry.GetFaceTexture(input.blockType, input.direction)))
+        {
+            std::cout << "The face table writes another face than the old function for face " << face << '\n';
+            return false;
+        }
+    }
+
+    size_t vertexCount = 0;
+    const double oldTime = Bench::Time([&]()
+        {
+            for (int face = 0; face < g_FaceCount; ++face)
+            {
+                if (face % g_BatchFaceCount == 0)
+                {
+                    vertexCount += oldVertices.size();
+                    oldVertices.clear();
+                    oldIndices.clear();
+                }
+                const FaceInput& input = faces[face];
+                AddFaceVerticesOld(oldBlockData, oldVertices, oldIndices, input.blockType, input.direction, input.position);
+            }
+        });
+    const double newTime = Bench::Time([&]()
+        {
+            for (int face = 0; face < g_FaceCount; ++face)
+            {
+                if (face % g_BatchFaceCount == 0)
+                {
+                    vertexCount += newVertices.size();
+                    newVertices.clear();
+                }
+                const FaceInput& input = faces[face];
+                WriteFaceVertices(newVertices, static_cast<int>(input.direction), input.position,
+                    static_cast<float>(registry.GetFaceLayer(input.blockType, input.direction)), unoccluded, light);
+            }
+        });
+
+    std::cout << g_FaceCount << " faces in batches of " << g_BatchFaceCount << ", median of " << Bench::g_RunCount << " runs\n";
+    std::cout << std::setw(28) << std::left << "" << std::right << std::setw(12) << "Mfaces/s" << '\n';
+    std::cout << std::setw(28) << std::left << "AddFaceVertices (old)" << std::right << std::setw(12) << g_FaceCount / oldTime << '\n';
+    std::cout << std::setw(28) << std::left << "WriteFaceVertices" << std::right << std::setw(12) << g_FaceCount / newTime << '\n';
+    return vertexCount > 0;
+}
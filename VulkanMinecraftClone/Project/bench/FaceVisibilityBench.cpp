@@ -0,0 +1,159 @@
+// Benchmark of FaceVisibility, the visible faces of a whole row of blocks from 64 bit masks, against the scalar loop it
+// replaced that looked at the six neighbors of every block. The face masks of every row of both are checked to be equal.
+#include "bench/Bench.h"
+#include "bench/BenchTerrain.h"
+#include "FaceVisibility.h"
+#include <bitset>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace
+{
+    constexpr int g_Width = ChunkBlocks::m_Width;
+    constexpr int g_Height = ChunkBlocks::m_Height;
+    constexpr int g_Depth = ChunkBlocks::m_Depth;
+    constexpr size_t g_RowCount = static_cast<size_t>(g_Height) * g_Depth;
+
+    static_assert(g_Width == FaceVisibility::m_RowLength, "a row of the chunk is one mask");
+
+    BlockType GetBlock(const ChunkBlocks& blocks, int x, int y, int z)
+    {
+        if (x < 0 || x >= g_Width || y < 0 || y >= g_Height || z < 0 || z >= g_Depth)
+        {
+            return BlockType::Air;
+        }
+        return blocks.Get(x, y, z);
+    }
+
+    // The per block loop of the land mesher before the masks, written to the same face masks, indexed with y + z * height
+    uint64_t GetFacesScalar(const ChunkBlocks& blocks, std::vector<FaceVisibility::FaceMasks>& rowFaces)
+    {
+        const BlockRegistry& registry = BlockRegistry::GetInstance();
+        uint64_t faceCount = 0;
+        for (int z = 0; z < g_Depth; ++z)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                FaceVisibility::FaceMasks& faces = rowFaces[y + z * g_Height];
+                faces = {};
+                for (int x = 0; x < g_Width; ++x)
+                {
+                    const BlockType blockType = blocks.Get(x, y, z);
+                    if (registry.GetRenderLayer(blockType) != RenderLayer::Land)
+                    {
+                        continue;
+                    }
+
+                    const bool cullsSameType = registry.CullsSameType(blockType);
+                    for (int face = 0; face < FACE_COUNT; ++face)
+                    {
+                        const auto& offset = FACE_TABLE[face].normal;
+                        const BlockType neighborBlockType = GetBlock(blocks, x + offset[0], y + offset[1], z + offset[2]);
+                        if (!registry.IsOpaque(neighborBlockType) && !(cullsSameType && neighborBlockType == blockType))
+                        {
+                            faces[face] |= FaceVisibility::RowMask{ 1 } << x;
+                            ++faceCount;
+                        }
+                    }
+                }
+            }
+        }
+        return faceCount;
+    }
+
+    uint64_t GetFacesMasks(FaceVisibility& faceVisibility, const ChunkBlocks& blocks, std::vector<FaceVisibility::FaceMasks>& rowFaces)
+    {
+        faceVisibility.Build(blocks);
+        uint64_t faceCount = 0;
+        for (int z = 0; z < g_Depth; ++z)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                FaceVisibility::FaceMasks& faces = rowFaces[y + z * g_Height];
+                // The masks are left alone for rows without a visible face
+                if (faceVisibility.GetVisibleFaces(y, z, faces) == 0)
+                {
+                    faces = {};
+                    continue;
+                }
+                for (const FaceVisibility::RowMask faceMask : faces)
+                {
+                    faceCount += static_cast<uint64_t>(std::bitset<64>(faceMask).count());
+                }
+            }
+        }
+        return faceCount;
+    }
+
+    // Every block set to a random type with the chance fill, so every combination of neighbors shows up
+    std::unique_ptr<ChunkBlocks> CreateRandomChunk(float fill, uint32_t seed)
+    {
+        auto pBlocks = std::make_unique<ChunkBlocks>();
+        std::mt19937 random{ seed };
+        std::uniform_real_distribution<float> chance{ 0.f, 1.f };
+        constexpr std::array<BlockType, 7> blockTypes{ BlockType::GrassBlock, BlockType::Stone, BlockType::Dirt, BlockType::Sand,
+            BlockType::Log, BlockType::Leaves, BlockType::Water };
+        for (int z = 0; z < g_Depth; ++z)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                for (int x = 0; x < g_Width; ++x)
+                {
+                    pBlocks->Set(x, y, z, chance(random) < fill ? blockTypes[random() % blockTypes.size()] : BlockType::Air);
+                }
+            }
+        }
+        return pBlocks;
+    }
+}
+
+BENCHMARK(FaceVisibilityMasks)
+{
+    if (!BlockRegistry::GetInstance().Load("textures/blockdata.json"))
+    {
+        return false;
+    }
+
+    struct Field
+    {
+        std::string name;
+        std::unique_ptr<ChunkBlocks> pBlocks;
+    };
+    std::vector<Field> fields;
+    for (const glm::ivec2& chunkPosition : { glm::ivec2{ 0, 0 }, glm::ivec2{ 3, -2 } })
+    {
+        Field field{ "terrain " + std::to_string(chunkPosition.x) + ", " + std::to_string(chunkPosition.y), Bench::CreateChunk(chunkPosition.x, chunkPosition.y) };
+        Bench::PlantTrees(*field.pBlocks);
+        fields.push_back(std::move(field));
+    }
+    for (const float fill : { 0.1f, 0.5f, 0.9f })
+    {
+        fields.push_back({ "random " + std::to_string(static_cast<int>(fill * 100.f)) + "%", CreateRandomChunk(fill, static_cast<uint32_t>(fill * 100.f)) });
+    }
+
+    std::cout << g_Width << " x " << g_Height << " x " << g_Depth << " chunks, median of " << Bench::g_RunCount << " runs in million blocks per second\n";
+    std::cout << std::setw(16) << std::left << "chunk" << std::right << std::setw(12) << "faces" << std::setw(12) << "scalar" << std::setw(12) << "masks" << '\n';
+
+    FaceVisibility faceVisibility{ g_Height, g_Depth };
+    std::vector<FaceVisibility::FaceMasks> scalarFaces(g_RowCount);
+    std::vector<FaceVisibility::FaceMasks> maskFaces(g_RowCount);
+    for (const Field& field : fields)
+    {
+        uint64_t scalarFaceCount = 0;
+        uint64_t maskFaceCount = 0;
+        const double scalarTime = Bench::Time([&]() { scalarFaceCount = GetFacesScalar(*field.pBlocks, scalarFaces); });
+        const double maskTime = Bench::Time([&]() { maskFaceCount = GetFacesMasks(faceVisibility, *field.pBlocks, maskFaces); });
+        if (scalarFaceCount != maskFaceCount || scalarFaces != maskFaces)
+        {
+            std::cout << "The masks of " << field.name << " find other faces than the scalar loop\n";
+            return false;
+        }
+
+        const double blockCount = static_cast<double>(ChunkBlocks::m_BlockCount);
+        std::cout << std::setw(16) << std::left << field.name << std::right
+            << std::setw(12) << scalarFaceCount << std::setw(12) << blockCount / scalarTime << std::setw(12) << blockCount / maskTime << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+// Benchmark of the land mesher with and without ambient occlusion, on chunks of the default terrain with trees.
+// Both have to emit the same quads into the same sections, ambient occlusion only changes the corners.
+#include "bench/Bench.h"
+#include "bench/BenchTerrain.h"
+#include "LandMesher.h"
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+BENCHMARK(LandMesherAmbientOcclusion)
+{
+    if (!BlockRegistry::GetInstance().Load("textures/blockdata.json"))
+    {
+        return false;
+    }
+
+    std::cout << ChunkBlocks::m_Width << " x " << ChunkBlocks::m_Height << " x " << ChunkBlocks::m_Depth << " chunks of the default terrain with trees, median of "
+        << Bench::g_RunCount << " runs in us\n";
+    std::cout << std::setw(16) << std::left << "chunk" << std::right << std::setw(12) << "quads" << std::setw(12) << "no ao" << std::setw(12) << "ao" << '\n';
+
+    FaceVisibility faceVisibility{ ChunkBlocks::m_Height, ChunkBlocks::m_Depth };
+    TaggedVector<Vertex, MemoryTag::Transient> vertices;
+    LandMesher::SectionRanges plainSections{};
+    LandMesher::SectionRanges occludedSections{};
+    // The light lookup of a chunk is a few array reads, a constant keeps it out of the comparison
+    const LandMesher::LightLookup getLight = [](int, int, int) { return glm::vec2{ 1.f, 0.f }; };
+    for (const glm::ivec2& chunkPosition : { glm::ivec2{ 0, 0 }, glm::ivec2{ 3, -2 }, glm::ivec2{ -7, 5 } })
+    {
+        const std::unique_ptr<ChunkBlocks> pBlocks = Bench::CreateChunk(chunkPosition.x, chunkPosition.y);
+        Bench::PlantTrees(*pBlocks);
+
+        const double plainTime = Bench::Time([&]() { LandMesher::Build(*pBlocks, faceVisibility, false, getLight, vertices, plainSections); });
+        const size_t plainVertexCount = vertices.size();
+        const double occludedTime = Bench::Time([&]() { LandMesher::Build(*pBlocks, faceVisibility, true, getLight, vertices, occludedSections); });
+        bool isSameLayout = vertices.size() == plainVertexCount;
+        for (size_t section = 0; section < plainSections.size(); ++section)
+        {
+            isSameLayout &= plainSections[section].firstQuad == occludedSections[section].firstQuad && plainSections[section].quadCount == occludedSections[section].quadCount;
+        }
+        if (!isSameLayout)
+        {
+            std::cout << "Ambient occlusion changes the quads of chunk " << chunkPosition.x << ", " << chunkPosition.y << '\n';
+            return false;
+        }
+
+        std::cout << std::setw(16) << std::left << (std::to_string(chunkPosition.x) + ", " + std::to_string(chunkPosition.y)) << std::right
+            << std::setw(12) << plainVertexCount / 4 << std::setw(12) << plainTime << std::setw(12) << occludedTime << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,128 @@
+// Benchmarks of the LightEngine on chunks of the default terrain: a single chunk the way a chunk is lit when it streams in,
+// and a 5 x 5 grid the way the chunks around the player are lit when the world loads. Both are checked against
+// LightChunk, a chunk lit together with its neighbors can only end up brighter than the chunk lit on its own.
+#include "bench/Bench.h"
+#include "bench/BenchTerrain.h"
+#include "LightEngine.h"
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+
+namespace
+{
+    // Chunks of the default terrain without a renderer, looked up by their position in chunks
+    class BenchWorld final
+    {
+    public:
+        explicit BenchWorld(int radius)
+        {
+            for (int chunkZ = -radius; chunkZ <= radius; ++chunkZ)
+            {
+                for (int chunkX = -radius; chunkX <= radius; ++chunkX)
+                {
+                    Chunk& chunk = m_Chunks[{ chunkX, chunkZ }];
+                    chunk.pBlocks = Bench::CreateChunk(chunkX, chunkZ);
+                    chunk.pLight = std::make_unique<LightData>(ChunkBlocks::m_BlockCount);
+                    m_ChunkPositions.push_back({ chunkX, 0, chunkZ });
+                }
+            }
+        }
+
+        LightEngine::ChunkLookup GetLookup()
+        {
+            return [this](const glm::ivec3& chunkPosition)
+                {
+                    const auto found = m_Chunks.find({ chunkPosition.x, chunkPosition.z });
+                    return found != m_Chunks.end() ? LightEngine::ChunkView{ found->second.pBlocks.get(), found->second.pLight.get() } : LightEngine::ChunkView{ nullptr, nullptr };
+                };
+        }
+
+        const std::vector<glm::ivec3>& GetChunkPositions() const { return m_ChunkPositions; }
+        const ChunkBlocks& GetBlocks(const glm::ivec3& chunkPosition) const { return *m_Chunks.at({ chunkPosition.x, chunkPosition.z }).pBlocks; }
+        const LightData& GetLight(const glm::ivec3& chunkPosition) const { return *m_Chunks.at({ chunkPosition.x, chunkPosition.z }).pLight; }
+
+    private:
+        struct Chunk
+        {
+            std::unique_ptr<ChunkBlocks> pBlocks;
+            std::unique_ptr<LightData> pLight;
+        };
+
+        std::map<std::pair<int, int>, Chunk> m_Chunks;
+        std::vector<glm::ivec3> m_ChunkPositions;
+    };
+
+    // False when a block of a chunk is darker than LightChunk lights it on its own
+    bool IsLitAtLeastAlone(const BenchWorld& world, bool mustMatch)
+    {
+        LightData alone{ ChunkBlocks::m_BlockCount };
+        for (const glm::ivec3& chunkPosition : world.GetChunkPositions())
+        {
+            LightEngine::LightChunk(world.GetBlocks(chunkPosition), alone);
+            const LightData& light = world.GetLight(chunkPosition);
+            for (size_t index = 0; index < ChunkBlocks::m_BlockCount; ++index)
+            {
+                const bool isDarker = light.GetSkyLight(index) < alone.GetSkyLight(index) || light.GetBlockLight(index) < alone.GetBlockLight(index);
+                const bool isBrighter = light.GetSkyLight(index) > alone.GetSkyLight(index) || light.GetBlockLight(index) > alone.GetBlockLight(index);
+                if (isDarker || (mustMatch && isBrighter))
+                {
+                    std::cout << "The chunk at " << chunkPosition.x << ", " << chunkPosition.z << " is lit differently than on its own\n";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Times LightChunks on every chunk of the world at once, and LightChunk on every chunk one after the other for comparison
+    bool RunLightChunks(int radius)
+    {
+        if (!BlockRegistry::GetInstance().Load("textures/blockdata.json"))
+        {
+            return false;
+        }
+        BenchWorld world{ radius };
+        const std::vector<glm::ivec3>& chunkPositions = world.GetChunkPositions();
+
+        double lightChunksTime = 0.0;
+        {
+            LightEngine lightEngine{ world.GetLookup() };
+            lightChunksTime = Bench::Time([&]() { lightEngine.LightChunks(chunkPositions); });
+        }
+        // A lone chunk has no borders to spread light over
+        if (!IsLitAtLeastAlone(world, chunkPositions.size() == 1))
+        {
+            return false;
+        }
+
+        LightData light{ ChunkBlocks::m_BlockCount };
+        const double lightChunkTime = Bench::Time([&]()
+            {
+                for (const glm::ivec3& chunkPosition : chunkPositions)
+                {
+                    LightEngine::LightChunk(world.GetBlocks(chunkPosition), light);
+                }
+            });
+
+        const double chunkCount = static_cast<double>(chunkPositions.size());
+        const int side = radius * 2 + 1;
+        std::cout << side << " x " << side << " chunks of the default terrain, median of " << Bench::g_RunCount << " runs in us\n";
+        std::cout << std::setw(28) << std::left << "" << std::right << std::setw(12) << "total" << std::setw(12) << "per chunk" << '\n';
+        std::cout << std::setw(28) << std::left << "LightChunks" << std::right
+            << std::setw(12) << lightChunksTime << std::setw(12) << lightChunksTime / chunkCount << '\n';
+        std::cout << std::setw(28) << std::left << "LightChunk one by one" << std::right
+            << std::setw(12) << lightChunkTime << std::setw(12) << lightChunkTime / chunkCount << '\n';
+        return true;
+    }
+}
+
+BENCHMARK(LightSingleChunk)
+{
+    return RunLightChunks(0);
+}
+
+BENCHMARK(LightChunkGrid5x5)
+{
+    return RunLightChunks(2);
+}
@@ -0,0 +1,364 @@
+// Benchmarks of the voxel storage, every layout of VoxelStorage.h is timed on the same terrain
+// for the three loops that walk the blocks: generation writes columns, meshing reads the six neighbors of every
+// block and lighting floods sky light through the open blocks.
+// The bulk writes are timed against writing block by block, tests/TerrainColumnTests.cpp checks that both give the same terrain.
+#include "bench/Bench.h"
+#include "bench/BenchTerrain.h"
+#include "VoxelStorage.h"
+#include "TerrainColumn.h"
+#include "FaceTable.h"
+#include "vendor/SimplexNoise.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using Bench::CreateChunkHeights;
+    using Bench::g_RunCount;
+    using Bench::Time;
+    constexpr uint8_t g_MaxLight = 15;
+
+    bool IsOpaque(BlockType blockType)
+    {
+        return blockType != BlockType::Air && blockType != BlockType::Water;
+    }
+
+    // Height map terrain like the default one, optionally with caves.
+    // Stored x + (y + z * height) * width no matter which storage is measured.
+    template<int Width, int Height, int Depth>
+    std::vector<BlockType> CreateTerrain(bool hasCaves)
+    {
+        const SimplexNoise noise{ 0.01f, 1.f, 2.f, 0.5f };
+        const int seaLevel = Height * 3 / 10;
+        std::vector<BlockType> terrain(static_cast<size_t>(Width) * Height * Depth, BlockType::Air);
+        for (int z = 0; z < Depth; ++z)
+        {
+            for (int x = 0; x < Width; ++x)
+            {
+                const float heightNoise = (noise.fractal(4, static_cast<float>(x), static_cast<float>(z)) + 1.f) * 0.5f;
+                const int height = std::clamp(static_cast<int>(heightNoise * Height * 0.7f), 1, Height - 1);
+                for (int y = 0; y < Height; ++y)
+                {
+                    BlockType blockType = BlockType::Air;
+                    if (y <= height)
+                    {
+                        const bool isCave = hasCaves && y > 2 && y < height - 3 && SimplexNoise::noise(x * 0.08f, y * 0.08f, z * 0.08f) > 0.45f;
+                        blockType = isCave ? BlockType::Air : y == height ? BlockType::GrassBlock : y > height - 4 ? BlockType::Dirt : BlockType::Stone;
+                    }
+                    else if (y < seaLevel)
+                    {
+                        blockType = BlockType::Water;
+                    }
+                    terrain[x + (static_cast<size_t>(y) + static_cast<size_t>(z) * Height) * Width] = blockType;
+                }
+            }
+        }
+        return terrain;
+    }
+
+    // Block by block, a column at a time
+    template<typename Storage>
+    void Generate(Storage& storage, const std::vector<BlockType>& terrain)
+    {
+        for (int x = 0; x < Storage::m_Width; ++x)
+        {
+            for (int z = 0; z < Storage::m_Depth; ++z)
+            {
+                for (int y = 0; y < Storage::m_Height; ++y)
+                {
+                    storage.Set(x, y, z, terrain[x + (static_cast<size_t>(y) + static_cast<size_t>(z) * Storage::m_Height) * Storage::m_Width]);
+                }
+            }
+        }
+    }
+
+    // Counts the faces of the opaque blocks that touch a non opaque block, blocks outside of the box count as air
+    template<typename Storage>
+    uint64_t Mesh(const Storage& storage)
+    {
+        uint64_t faceCount = 0;
+        for (int z = 0; z < Storage::m_Depth; ++z)
+        {
+            for (int y = 0; y < Storage::m_Height; ++y)
+            {
+                for (int x = 0; x < Storage::m_Width; ++x)
+                {
+                    if (!IsOpaque(storage.Get(x, y, z)))
+                    {
+                        continue;
+                    }
+                    for (int face = 0; face < FACE_COUNT; ++face)
+                    {
+                        const auto& offset = FACE_TABLE[face].normal;
+                        const int neighborX = x + offset[0];
+                        const int neighborY = y + offset[1];
+                        const int neighborZ = z + offset[2];
+                        if (neighborX < 0 || neighborX >= Storage::m_Width || neighborY < 0 || neighborY >= Storage::m_Height || neighborZ < 0 || neighborZ >= Storage::m_Depth
+                            || !IsOpaque(storage.Get(neighborX, neighborY, neighborZ)))
+                        {
+                            ++faceCount;
+                        }
+                    }
+                }
+            }
+        }
+        return faceCount;
+    }
+
+    // Sky light the way LightEngine::LightChunk does it: full light down every column, then a flood fill of the rest.
+    // The light is stored in the layout of the blocks, returns the sum of all light levels.
+    template<typename Storage>
+    uint64_t Light(const Storage& storage, std::vector<uint8_t>& light, std::vector<uint32_t>& queue)
+    {
+        std::fill(light.begin(), light.end(), uint8_t{});
+        queue.clear();
+        for (int z = 0; z < Storage::m_Depth; ++z)
+        {
+            for (int x = 0; x < Storage::m_Width; ++x)
+            {
+                for (int y = Storage::m_Height - 1; y >= 0 && !IsOpaque(storage.Get(x, y, z)); --y)
+                {
+                    const size_t index = Storage::GetIndex(x, y, z);
+                    light[index] = g_MaxLight;
+                    queue.push_back(static_cast<uint32_t>(index));
+                }
+            }
+        }
+
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            const uint32_t index = queue[head];
+            const uint8_t spreadLevel = light[index] - 1;
+            if (spreadLevel == 0)
+            {
+                continue;
+            }
+
+            const glm::ivec3 position = Storage::GetPosition(index);
+            for (int face = 0; face < FACE_COUNT; ++face)
+            {
+                const auto& offset = FACE_TABLE[face].normal;
+                const int neighborX = position.x + offset[0];
+                const int neighborY = position.y + offset[1];
+                const int neighborZ = position.z + offset[2];
+                if (neighborX < 0 || neighborX >= Storage::m_Width || neighborY < 0 || neighborY >= Storage::m_Height || neighborZ < 0 || neighborZ >= Storage::m_Depth)
+                {
+                    continue;
+                }
+
+                const size_t neighbor = Storage::GetIndex(neighborX, neighborY, neighborZ);
+                if (light[neighbor] < spreadLevel && !IsOpaque(storage[neighbor]))
+                {
+                    light[neighbor] = spreadLevel;
+                    queue.push_back(static_cast<uint32_t>(neighbor));
+                }
+            }
+        }
+
+        uint64_t lightSum = 0;
+        for (const uint8_t level : light)
+        {
+            lightSum += level;
+        }
+        return lightSum;
+    }
+
+    // Chunk::GenerateTerrain before the bulk writes, block by block through Chunk::SetBlock with the water written first
+    // and then overwritten
+    template<typename Storage>
+    void GenerateTerrainPerBlock(Storage& storage, const int* pHeights, float seaLevel)
+    {
+        constexpr int chunkHeight = Storage::m_Height;
+        const auto setBlock = [&storage](const glm::vec3& position, BlockType blockType)
+            {
+                if (position.x >= 0 && position.x < Storage::m_Width && position.y >= 0 && position.y < chunkHeight && position.z >= 0 && position.z < Storage::m_Depth)
+                {
+                    storage.Set(static_cast<int>(position.x), static_cast<int>(position.y), static_cast<int>(position.z), blockType);
+                }
+            };
+
+        storage.Fill(BlockType::Air);
+        for (int x = 0; x < Storage::m_Width; ++x)
+        {
+            for (int z = 0; z < Storage::m_Depth; ++z)
+            {
+                const int height = pHeights[x + z * Storage::m_Width];
+                for (int y = 0; y < chunkHeight * seaLevel; ++y)
+                {
+                    setBlock(glm::ivec3(x, y, z), BlockType::Water);
+                }
+                if (height <= chunkHeight * seaLevel + 3)
+                {
+                    for (int y = 0; y <= height; ++y)
+                    {
+                        setBlock(glm::ivec3(x, y, z), BlockType::Sand);
+                    }
+                }
+                if (height > chunkHeight * seaLevel + 3)
+                {
+                    int dirtLayers = (((height - (chunkHeight * seaLevel + 1)) < (3)) ? (height - (chunkHeight * seaLevel + 1)) : (3));
+                    setBlock(glm::ivec3(x, height, z), BlockType::GrassBlock);
+                    for (int y = height - 1; y > height - dirtLayers - 1; --y)
+                    {
+                        setBlock(glm::ivec3(x, y, z), BlockType::Dirt);
+                    }
+                    for (int y = height - dirtLayers - 1; y >= 0; --y)
+                    {
+                        setBlock(glm::ivec3(x, y, z), BlockType::Stone);
+                    }
+                }
+            }
+        }
+    }
+
+    struct Result
+    {
+        uint64_t faceCount;
+        uint64_t lightSum;
+    };
+
+    template<typename Storage>
+    Result Run(const std::string& name, const std::vector<BlockType>& terrain)
+    {
+        Storage storage;
+        std::vector<uint8_t> light(Storage::m_BlockCount);
+        std::vector<uint32_t> queue;
+        queue.reserve(Storage::m_BlockCount);
+
+        // Like a pooled chunk: cleared and generated
+        Result result{};
+        const double generateTime = Time([&]()
+            {
+                storage.Fill(BlockType::Air);
+                Generate(storage, terrain);
+            });
+        const double meshTime = Time([&]() { result.faceCount = Mesh(storage); });
+        const double lightTime = Time([&]() { result.lightSum = Light(storage, light, queue); });
+
+        std::cout << std::setw(16) << std::left << name << std::right
+            << std::setw(12) << generateTime << std::setw(12) << meshTime << std::setw(12) << lightTime << '\n';
+        return result;
+    }
+
+    // Prints the throughput of the bulk writes in millions of blocks per second.
+    // The writes alternate between two block types so none of them finds its blocks written already.
+    template<typename Storage>
+    void RunFill(const std::string& name, const std::vector<int>& heights)
+    {
+        constexpr float seaLevel = 0.3f;
+        constexpr int width = Storage::m_Width;
+        constexpr int height = Storage::m_Height;
+        constexpr int depth = Storage::m_Depth;
+        Storage storage;
+
+        const int* pHeights = heights.data();
+        const double perBlockTime = Time([&]() { GenerateTerrainPerBlock(storage, pHeights, seaLevel); });
+        const double terrainTime = Time([&]() { WriteTerrainColumns(storage, pHeights, seaLevel); });
+
+        BlockType blockType = BlockType::Stone;
+        const auto nextBlockType = [&blockType]() { return blockType = blockType == BlockType::Stone ? BlockType::Dirt : BlockType::Stone; };
+        const double spanTime = Time([&]()
+            {
+                const BlockType spanType = nextBlockType();
+                for (int z = 0; z < depth; ++z)
+                {
+                    for (int x = 0; x < width; ++x)
+                    {
+                        storage.FillSpan(x, z, 0, height, spanType);
+                    }
+                }
+            });
+        // One block in from every side, so it isn't a Fill of the whole box
+        const glm::ivec3 boxMin{ 1 };
+        const glm::ivec3 boxMax{ width - 1, height - 1, depth - 1 };
+        const double boxTime = Time([&]() { storage.FillBox(boxMin, boxMax, nextBlockType()); });
+
+        std::vector<BlockType> columns[2]{ std::vector<BlockType>(height, BlockType::Air), std::vector<BlockType>(height, BlockType::Air) };
+        for (int column = 0; column < 2; ++column)
+        {
+            const TerrainColumn terrainColumn = TerrainColumn::Create(height * (column + 2) / 5, height, seaLevel);
+            for (int layer = 0; layer < terrainColumn.layerCount; ++layer)
+            {
+                std::fill(columns[column].begin() + terrainColumn.GetBeginY(layer), columns[column].begin() + terrainColumn.layers[layer].endY, terrainColumn.layers[layer].blockType);
+            }
+        }
+        int columnIndex = 0;
+        const double columnTime = Time([&]()
+            {
+                const BlockType* pColumn = columns[columnIndex ^= 1].data();
+                for (int z = 0; z < depth; ++z)
+                {
+                    for (int x = 0; x < width; ++x)
+                    {
+                        storage.CopyColumn(x, z, pColumn);
+                    }
+                }
+            });
+
+        const double blockCount = static_cast<double>(Storage::m_BlockCount);
+        const double boxBlockCount = static_cast<double>(boxMax.x - boxMin.x) * (boxMax.y - boxMin.y) * (boxMax.z - boxMin.z);
+        std::cout << std::setw(16) << std::left << name << std::right
+            << std::setw(12) << blockCount / perBlockTime << std::setw(12) << blockCount / terrainTime
+            << std::setw(12) << blockCount / spanTime << std::setw(12) << boxBlockCount / boxTime << std::setw(12) << blockCount / columnTime << '\n';
+    }
+
+    void RunFillAll()
+    {
+        // A chunk of the default terrain, the noise has no seed so this always gives the same heights
+        const std::vector<int> heights = CreateChunkHeights(0, 0);
+        std::cout << '\n' << CHUNK_WIDTH << " x " << CHUNK_HEIGHT << " x " << CHUNK_DEPTH << " bulk writes, median of " << g_RunCount << " runs in million blocks per second\n";
+        std::cout << std::setw(16) << std::left << "storage" << std::right
+            << std::setw(12) << "per block" << std::setw(12) << "terrain" << std::setw(12) << "span" << std::setw(12) << "box" << std::setw(12) << "column" << '\n';
+
+        RunFill<VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearXYZ>>("linear XYZ", heights);
+        RunFill<VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearXZY>>("linear XZY", heights);
+        RunFill<VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearYZX>>("linear YZX", heights);
+        RunFill<VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, MortonLayout>>("morton", heights);
+    }
+
+    template<int Width, int Height, int Depth>
+    bool RunAll(bool hasCaves)
+    {
+        const std::vector<BlockType> terrain = CreateTerrain<Width, Height, Depth>(hasCaves);
+        std::cout << '\n' << Width << " x " << Height << " x " << Depth << (hasCaves ? " with caves" : "") << ", median of " << g_RunCount << " runs in us\n";
+        std::cout << std::setw(16) << std::left << "storage" << std::right
+            << std::setw(12) << "generate" << std::setw(12) << "mesh" << std::setw(12) << "light" << '\n';
+
+        const Result results[]{
+            Run<VoxelStorage<Width, Height, Depth, LinearXYZ>>("linear XYZ", terrain),
+            Run<VoxelStorage<Width, Height, Depth, LinearXZY>>("linear XZY", terrain),
+            Run<VoxelStorage<Width, Height, Depth, LinearYZX>>("linear YZX", terrain),
+            Run<VoxelStorage<Width, Height, Depth, MortonLayout>>("morton", terrain)
+        };
+
+        // Every storage has to see the same blocks
+        for (const Result& result : results)
+        {
+            if (result.faceCount != results[0].faceCount || result.lightSum != results[0].lightSum)
+            {
+                std::cout << "The storages disagree: " << result.faceCount << " faces and " << result.lightSum << " light instead of "
+                    << results[0].faceCount << " and " << results[0].lightSum << '\n';
+                return false;
+            }
+        }
+        std::cout << results[0].faceCount << " faces, light sum " << results[0].lightSum << '\n';
+        return true;
+    }
+}
+
+BENCHMARK(VoxelStorageLayouts)
+{
+    bool isValid = RunAll<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH>(false);
+    isValid &= RunAll<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH>(true);
+    isValid &= RunAll<32, 32, 32>(true);
+    return isValid;
+}
+
+BENCHMARK(TerrainBulkWrites)
+{
+    RunFillAll();
+    return true;
+}
@@ -0,0 +1,82 @@
+#version 450
+
+// Vertex pulling: there are no vertex inputs, every face is one packed record in the storage buffer of the chunk
+// and gl_VertexIndex picks the face and the corner. The layout of a record is described in FaceRecordBuilder.h.
+// Writes the same outputs as shaderLand.vert so both are drawn with shaderLand.frag.
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragTexCoord;
+layout(location = 2) out float fragAmbientOcclusion;
+layout(location = 3) out vec2 fragLight;
+layout(location = 4) out float fragViewDistance;
+
+// The depth only and the shading pass of the depth pre-pass have to compute the exact same depth
+invariant gl_Position;
+
+layout(binding = 0) uniform UniformBufferObject
+{
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+layout(std430, set = 1, binding = 0) readonly buffer FaceRecords
+{
+    uint faces[];
+};
+
+layout(push_constant) uniform PushConstants {
+    ivec3 translation;
+} mesh;
+
+// Same order as the Direction enum: Down, East, North, South, Up, West
+const vec3 faceNormals[6] = vec3[](
+    vec3(0, -1, 0),
+    vec3(1, 0, 0),
+    vec3(0, 0, -1),
+    vec3(0, 0, 1),
+    vec3(0, 1, 0),
+    vec3(-1, 0, 0)
+);
+
+// Corners of every face relative to the block center in units of half a block, same as FACE_TABLE in FaceTable.h
+const ivec3 faceCorners[24] = ivec3[](
+    ivec3(-1, -1, -1), ivec3(1, -1, -1), ivec3(1, -1, 1), ivec3(-1, -1, 1),
+    ivec3(1, -1, 1), ivec3(1, -1, -1), ivec3(1, 1, -1), ivec3(1, 1, 1),
+    ivec3(-1, -1, -1), ivec3(-1, 1, -1), ivec3(1, 1, -1), ivec3(1, -1, -1),
+    ivec3(1, -1, 1), ivec3(1, 1, 1), ivec3(-1, 1, 1), ivec3(-1, -1, 1),
+    ivec3(-1, 1, 1), ivec3(1, 1, 1), ivec3(1, 1, -1), ivec3(-1, 1, -1),
+    ivec3(-1, -1, -1), ivec3(-1, -1, 1), ivec3(-1, 1, 1), ivec3(-1, 1, -1)
+);
+
+// Texture corner of every face corner, x is 0 for left and 1 for right, y is 0 for top and 1 for bottom
+const vec2 faceTexCoords[24] = vec2[](
+    vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1),
+    vec2(0, 1), vec2(1, 1), vec2(1, 0), vec2(0, 0),
+    vec2(1, 1), vec2(1, 0), vec2(0, 0), vec2(0, 1),
+    vec2(1, 1), vec2(1, 0), vec2(0, 0), vec2(0, 1),
+    vec2(0, 1), vec2(1, 1), vec2(1, 0), vec2(0, 0),
+    vec2(0, 1), vec2(1, 1), vec2(1, 0), vec2(0, 0)
+);
+
+// The two triangles of a face, the same split as the indices of the cpu mesher without ambient occlusion
+const int quadCorners[6] = int[](0, 1, 2, 2, 3, 0);
+
+void main()
+{
+    uint record = faces[gl_VertexIndex / 6];
+    int corner = quadCorners[gl_VertexIndex % 6];
+
+    vec3 block = vec3(record & 0x3Fu, (record >> 6) & 0x7Fu, (record >> 13) & 0x3Fu);
+    int direction = int((record >> 19) & 0x7u);
+    float textureLayer = float((record >> 22) & 0xFFu);
+
+    vec3 position = block + vec3(faceCorners[direction * 4 + corner]) * 0.5 + vec3(mesh.translation);
+    vec4 viewPosition = ubo.view * vec4(position, 1.0);
+    gl_Position = ubo.proj * viewPosition;
+    fragViewDistance = length(viewPosition.xyz);
+    fragColor = faceNormals[direction];
+    fragTexCoord = vec3(faceTexCoords[direction * 4 + corner], textureLayer);
+    // Unoccluded and in full sky light, same as the faces of the compute mesher
+    fragAmbientOcclusion = 1.0;
+    fragLight = vec2(1.0, 0.0);
+}
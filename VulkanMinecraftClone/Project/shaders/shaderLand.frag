@@ -1,20 +1,50 @@
 #version 450
 
 layout(location = 0) in vec3 fragNormal;
-layout(location = 1) in vec2 fragTexCoords;
+layout(location = 1) in vec3 fragTexCoords;
+layout(location = 2) in float fragAmbientOcclusion;
+layout(location = 3) in vec2 fragLight;
+layout(location = 4) in float fragViewDistance;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 1) uniform sampler2D texSampler;
+layout(binding = 1) uniform sampler2DArray texSampler;
 
-const vec3 lightDir = normalize(vec3(0.5, 1.0, 0.5)); // Example light direction
-const vec3 ambientColor = vec3(0.5, 0.4, 0.3); // Warm ambient light color
+// Specialization constants, the ids match the members of ShaderConstants in GraphicsPipeline3D.h
+layout(constant_id = 0) const float lightDirectionX = 0.5;
+layout(constant_id = 1) const float lightDirectionY = 1.0;
+layout(constant_id = 2) const float lightDirectionZ = 0.5;
+layout(constant_id = 3) const float ambientRed = 0.5;
+layout(constant_id = 4) const float ambientGreen = 0.4;
+layout(constant_id = 5) const float ambientBlue = 0.3;
+layout(constant_id = 10) const bool isAmbientOcclusionEnabled = true;
+layout(constant_id = 11) const bool isFogEnabled = false;
+layout(constant_id = 12) const float fogStart = 0.0;
+layout(constant_id = 13) const float fogEnd = 0.0;
+layout(constant_id = 14) const float fogRed = 0.0;
+layout(constant_id = 15) const float fogGreen = 0.0;
+layout(constant_id = 16) const float fogBlue = 0.0;
 
 void main() {
+    vec3 lightDir = normalize(vec3(lightDirectionX, lightDirectionY, lightDirectionZ));
+    vec3 ambientColor = vec3(ambientRed, ambientGreen, ambientBlue); // Warm ambient light color
     vec3 normal = normalize(fragNormal);
     float lightIntensity = max(dot(normal, lightDir), 0.0);
     vec3 baseColor = texture(texSampler, fragTexCoords).rgb;
     vec3 litColor = baseColor * lightIntensity;
-    vec3 finalColor = ambientColor * baseColor + litColor;
+    // Every light level is 80% as bright as the one above it
+    float lightLevel = max(fragLight.x, fragLight.y);
+    float brightness = pow(0.8, (1.0 - lightLevel) * 15.0);
+    vec3 finalColor = (ambientColor * baseColor + litColor) * brightness;
+    // The disabled branches are removed when the pipeline is created
+    if (isAmbientOcclusionEnabled)
+    {
+        finalColor *= fragAmbientOcclusion;
+    }
+    if (isFogEnabled)
+    {
+        float fog = clamp((fragViewDistance - fogStart) / (fogEnd - fogStart), 0.0, 1.0);
+        finalColor = mix(finalColor, vec3(fogRed, fogGreen, fogBlue), fog);
+    }
     outColor = vec4(finalColor, 1.0);
 }
@@ -2,10 +2,18 @@
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inTexCoord;
+layout(location = 2) in vec3 inTexCoord;
+layout(location = 3) in float inAmbientOcclusion;
+layout(location = 4) in vec2 inLight;
 
 layout(location = 0) out vec3 fragColor;
-layout(location = 1) out vec2 fragTexCoord;
+layout(location = 1) out vec3 fragTexCoord;
+layout(location = 2) out float fragAmbientOcclusion;
+layout(location = 3) out vec2 fragLight;
+layout(location = 4) out float fragViewDistance;
+
+// The depth only and the shading pass of the depth pre-pass have to compute the exact same depth
+invariant gl_Position;
 
 layout(binding = 0) uniform UniformBufferObject 
 {
@@ -25,7 +33,11 @@ void main()
     translationMatrix[3].xyz = mesh.translation; // Set translation part
     //translationMatrix[3].xyz = mesh.model[3].xyz; // Set translation part
 
-    gl_Position = ubo.proj * ubo.view * translationMatrix  * vec4(inPosition, 1.0);
+    vec4 viewPosition = ubo.view * translationMatrix * vec4(inPosition, 1.0);
+    gl_Position = ubo.proj * viewPosition;
+    fragViewDistance = length(viewPosition.xyz);
     fragColor = inNormal;
     fragTexCoord = inTexCoord;
+    fragAmbientOcclusion = inAmbientOcclusion;
+    fragLight = inLight;
 }
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 450
+
+// Counts the fragments that pass the depth test, every fragment adds one to the R16_SFLOAT target of the OverdrawCounter.
+// Drawn with the land vertex shaders, their outputs are ignored.
+
+layout(location = 0) out vec4 outCount;
+
+void main() {
+    outCount = vec4(1.0, 0.0, 0.0, 0.0);
+}
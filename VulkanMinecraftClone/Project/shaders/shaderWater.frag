@@ -2,16 +2,33 @@
 
 layout(location = 0) in vec3 fragNormal;
 layout(location = 1) in vec2 fragTexCoords;
+layout(location = 2) flat in float fragTextureLayer;
+layout(location = 3) in float fragViewDistance;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 1) uniform sampler2D texSampler;
+layout(binding = 1) uniform sampler2DArray texSampler;
 
-const vec3 ambientColor = vec3(0.5, 0.4, 0.3); // Warm ambient light color
+// Specialization constants, the ids match the members of ShaderConstants in GraphicsPipeline3D.h
+layout(constant_id = 3) const float ambientRed = 0.5;
+layout(constant_id = 4) const float ambientGreen = 0.4;
+layout(constant_id = 5) const float ambientBlue = 0.3;
+layout(constant_id = 11) const bool isFogEnabled = false;
+layout(constant_id = 12) const float fogStart = 0.0;
+layout(constant_id = 13) const float fogEnd = 0.0;
+layout(constant_id = 14) const float fogRed = 0.0;
+layout(constant_id = 15) const float fogGreen = 0.0;
+layout(constant_id = 16) const float fogBlue = 0.0;
 
 void main() {
-    vec3 baseColor = texture(texSampler, fragTexCoords).rgb;
+    vec3 ambientColor = vec3(ambientRed, ambientGreen, ambientBlue); // Warm ambient light color
+    // The sampler repeats, so every layer tiles on its own
+    vec3 baseColor = texture(texSampler, vec3(fragTexCoords, fragTextureLayer)).rgb;
     vec3 finalColor = ambientColor * baseColor; // Water doesn't receive direct lighting
+    if (isFogEnabled)
+    {
+        float fog = clamp((fragViewDistance - fogStart) / (fogEnd - fogStart), 0.0, 1.0);
+        finalColor = mix(finalColor, vec3(fogRed, fogGreen, fogBlue), fog);
+    }
     outColor = vec4(finalColor, 0.5); // Adjust alpha for transparency
 }
-
@@ -1,11 +1,12 @@
 #version 450
 
-layout(location = 0) in vec3 inPosition;
-layout(location = 1) in vec3 inNormal;
-layout(location = 2) in vec2 inTexCoord;
+// Corner position in x, y, z and the packed face direction and atlas tile in w
+layout(location = 0) in ivec4 inPositionData;
 
 layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out float fragTextureLayer;
+layout(location = 3) out float fragViewDistance;
 
 layout(binding = 0) uniform UniformBufferObject 
 {
@@ -18,25 +19,58 @@ layout(push_constant) uniform PushConstants {
     float time;
 } mesh;
 
+// Specialization constants, the ids match the members of ShaderConstants in GraphicsPipeline3D.h
 // Constant offset to lower the water faces
-const float waterOffset = -0.15; // Adjust this value as needed
+layout(constant_id = 6) const float waterOffset = -0.15;
+layout(constant_id = 7) const float waveSpeed = 2.0;
+layout(constant_id = 8) const float waveFrequency = 0.5;
+layout(constant_id = 9) const float waveAmplitude = 0.1;
+
+// Same order as the Direction enum: Down, East, North, South, Up, West
+const vec3 normals[6] = vec3[](
+    vec3(0.0, -1.0, 0.0),
+    vec3(1.0, 0.0, 0.0),
+    vec3(0.0, 0.0, -1.0),
+    vec3(0.0, 0.0, 1.0),
+    vec3(0.0, 1.0, 0.0),
+    vec3(-1.0, 0.0, 0.0)
+);
 
 void main() 
 {
-    // Construct translation matrix
-    mat4 translationMatrix = mat4(1.0); // Identity matrix
-    translationMatrix[3].xyz = mesh.translation; // Set translation part
+    int direction = inPositionData.w & 0x7;
+    int textureLayer = (inPositionData.w >> 3) & 0xFF;
+
+    // Corners lie half a block away from the block centers
+    vec3 position = vec3(inPositionData.xyz) - vec3(0.5);
+    vec3 worldPosition = position + vec3(mesh.translation);
 
     // Define the displacement factor for the sine wave, using time to animate
-    // Use global position for consistent displacement across adjacent faces
-    float displacementFactor = sin(mesh.time * 2.0 + inPosition.x * 0.5 + inPosition.z * 0.5);
+    // Use global position for consistent displacement across adjacent faces and chunks
+    float displacementFactor = sin(mesh.time * waveSpeed + worldPosition.x * waveFrequency + worldPosition.z * waveFrequency);
 
     // Displace the vertex position along the y-axis based on the sine wave
     // Add the constant offset to lower the water faces
-    vec3 displacedPosition = inPosition + vec3(0.0, waterOffset + displacementFactor * 0.1, 0.0);
+    vec3 displacedPosition = worldPosition + vec3(0.0, waterOffset + displacementFactor * waveAmplitude, 0.0);
+
+    vec4 viewPosition = ubo.view * vec4(displacedPosition, 1.0);
+    gl_Position = ubo.proj * viewPosition;
+    fragViewDistance = length(viewPosition.xyz);
+    fragColor = normals[direction];
 
-    // Apply transformations and pass to output
-    gl_Position = ubo.proj * ubo.view * translationMatrix * vec4(displacedPosition, 1.0);
-    fragColor = inNormal;
-    fragTexCoord = inTexCoord;
+    // Merged faces span several blocks, the texture repeats once per block
+    vec3 corner = vec3(inPositionData.xyz);
+    if (direction == 0 || direction == 4)
+    {
+        fragTexCoord = corner.xz;
+    }
+    else if (direction == 2 || direction == 3)
+    {
+        fragTexCoord = vec2(corner.x, -corner.y);
+    }
+    else
+    {
+        fragTexCoord = vec2(corner.z, -corner.y);
+    }
+    fragTextureLayer = float(textureLayer);
 }
@@ -0,0 +1,113 @@
+#include "tests/Test.h"
+#include "BlockRegistry.h"
+#include <string>
+#include <vector>
+#include <vendor/json.hpp>
+
+namespace
+{
+    // Every block with all its faces on the first tile of the atlas
+    nlohmann::json CreateValidBlockData()
+    {
+        nlohmann::json blocks = nlohmann::json::array();
+        for (size_t index = 0; index < static_cast<size_t>(BlockType::Air); ++index)
+        {
+            nlohmann::json textures = nlohmann::json::object();
+            for (const char* faceName : BlockRegistry::m_FaceNames)
+            {
+                textures[faceName] = { { "row", 0 }, { "col", 0 } };
+            }
+            blocks.push_back({ { "id", BlockRegistry::m_BlockIds[index] }, { "textures", textures } });
+        }
+        return { { "blocks", blocks } };
+    }
+
+    nlohmann::json& GetBlock(nlohmann::json& blockData, BlockType blockType)
+    {
+        return blockData["blocks"][static_cast<size_t>(blockType)];
+    }
+
+    // The registry is shared by every test, so it starts from the file the game loads
+    BlockRegistry& LoadGameRegistry()
+    {
+        BlockRegistry& registry = BlockRegistry::GetInstance();
+        CHECK(registry.Load("textures/blockdata.json"));
+        return registry;
+    }
+}
+
+TEST_CASE(BlockRegistryLoadsTheGameData)
+{
+    const BlockRegistry& registry = LoadGameRegistry();
+    CHECK(registry.IsOpaque(BlockType::Stone));
+    CHECK(!registry.IsOpaque(BlockType::Leaves));
+    CHECK(!registry.IsOpaque(BlockType::Air));
+    CHECK(registry.GetTransparency(BlockType::Leaves) == TransparencyClass::Cutout);
+    CHECK(!registry.CullsSameType(BlockType::Leaves));
+    CHECK(registry.CullsSameType(BlockType::Water));
+    CHECK(registry.GetRenderLayer(BlockType::Water) == RenderLayer::Water);
+    CHECK(registry.GetRenderLayer(BlockType::Air) == RenderLayer::None);
+    CHECK(registry.GetLayerMask(RenderLayer::Land) == ((1u << static_cast<uint32_t>(BlockType::Water)) - 1));
+
+    // The grass block has its own top and the dirt texture at the bottom
+    CHECK(registry.GetFaceLayer(BlockType::GrassBlock, Direction::Up) == 0);
+    CHECK(registry.GetFaceLayer(BlockType::GrassBlock, Direction::Down) == registry.GetFaceLayer(BlockType::Dirt, Direction::Up));
+}
+
+TEST_CASE(BlockRegistryLoadsFromString)
+{
+    nlohmann::json blockData = CreateValidBlockData();
+    GetBlock(blockData, BlockType::Log)["emissive"] = 15;
+    GetBlock(blockData, BlockType::Sand)["textures"]["up"] = { { "row", 2 }, { "col", 5 } };
+
+    BlockRegistry& registry = BlockRegistry::GetInstance();
+    CHECK(registry.LoadFromString(blockData.dump()));
+    CHECK(registry.GetEmissiveLevel(BlockType::Log) == 15);
+    CHECK(registry.GetEmissiveLevel(BlockType::Stone) == 0);
+    CHECK(registry.GetFaceLayer(BlockType::Sand, Direction::Up) == 2 * BlockRegistry::m_AtlasSize + 5);
+    CHECK(registry.GetTransparency(BlockType::Water) == TransparencyClass::Opaque);
+
+    LoadGameRegistry();
+}
+
+// Every broken file is rejected and leaves the properties that were loaded before alone
+TEST_CASE(BlockRegistryRejectsMalformedData)
+{
+    BlockRegistry& registry = LoadGameRegistry();
+
+    std::vector<std::string> malformed{ "{ \"blocks\": [", "[]", "{ \"block\": [] }", "{ \"blocks\": {} }" };
+    const auto addMalformed = [&malformed](const auto& change)
+        {
+            nlohmann::json blockData = CreateValidBlockData();
+            change(blockData);
+            malformed.push_back(blockData.dump());
+        };
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Stone)["id"] = "marble"; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Stone)["id"] = "air"; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Stone).erase("id"); });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Stone)["id"] = 1; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Stone)["id"] = "dirt"; });
+    addMalformed([](nlohmann::json& data) { data["blocks"].erase(static_cast<size_t>(BlockType::Sand)); });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Leaves)["transparency"] = "glass"; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Water)["layer"] = 2; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Log)["emissive"] = 16; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Log)["emissive"] = -1; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Log)["emissive"] = 2.5; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Dirt).erase("textures"); });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Dirt)["textures"].erase("north"); });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Dirt)["textures"]["north"] = { { "row", 0 } }; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Dirt)["textures"]["north"] = { { "row", 16 }, { "col", 0 } }; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Dirt)["textures"]["north"] = { { "row", 0 }, { "col", -1 } }; });
+    addMalformed([](nlohmann::json& data) { GetBlock(data, BlockType::Dirt)["textures"]["north"] = "dirt"; });
+
+    for (const std::string& jsonText : malformed)
+    {
+        CHECK(!registry.LoadFromString(jsonText));
+        CHECK(registry.GetTransparency(BlockType::Leaves) == TransparencyClass::Cutout);
+        CHECK(registry.GetRenderLayer(BlockType::Water) == RenderLayer::Water);
+        CHECK(registry.GetEmissiveLevel(BlockType::Log) == 0);
+        CHECK(registry.GetFaceLayer(BlockType::GrassBlock, Direction::Up) == 0);
+    }
+
+    CHECK(!registry.Load("textures/missing.json"));
+}
@@ -0,0 +1,167 @@
+#include "tests/Test.h"
+#include "DeletionQueue.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr int g_FrameCount = 600;
+    constexpr int g_ChunksPerFrame = 8;
+    // A whole ring of chunks leaves at once when the player crosses a chunk border
+    constexpr int g_BurstFrame = 300;
+    constexpr int g_BurstChunks = 200;
+
+    // Follows the game loop of VulkanBase with one frame in flight, the resources get ids as fake handles
+    class ChurnSimulation final
+    {
+    public:
+        ChurnSimulation()
+            : m_StartFreedCount{ DeletionQueue::GetInstance().GetFreedCount() }
+        {
+        }
+
+        // What destroying a chunk puts in the queue: the land and water buffers and the cull slot
+        void RetireChunk()
+        {
+            DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+            for (int buffer = 0; buffer < 2; ++buffer)
+            {
+                // Ids start at one, a null handle is never queued
+                const uintptr_t handle = Retire() + 1;
+                deletionQueue.DestroyBuffer(reinterpret_cast<VkBuffer>(handle), reinterpret_cast<VkDeviceMemory>(handle));
+            }
+            const size_t id = Retire();
+            deletionQueue.Enqueue([this, id]() { Free(id); });
+        }
+
+        // Render: wait on the fence of the last frame, submit the next one and collect
+        void Render()
+        {
+            DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+            deletionQueue.OnFramesCompleted();
+            m_CompletedFrameCount = m_SubmittedFrameCount;
+            deletionQueue.OnFrameSubmitted();
+            ++m_SubmittedFrameCount;
+
+            const size_t freedCount = deletionQueue.Collect(DeletionQueue::m_MaxFreesPerFrame, [this](VkBuffer buffer, VkDeviceMemory memory)
+                {
+                    m_MismatchCount += reinterpret_cast<uintptr_t>(buffer) != reinterpret_cast<uintptr_t>(memory);
+                    Free(reinterpret_cast<uintptr_t>(buffer) - 1);
+                });
+            m_MaxFreesPerFrame = std::max(m_MaxFreesPerFrame, freedCount);
+        }
+
+        size_t GetRetiredCount() const { return m_RetiredFrames.size(); }
+        uint64_t GetFreedCount() const { return DeletionQueue::GetInstance().GetFreedCount() - m_StartFreedCount; }
+        size_t GetMaxFreesPerFrame() const { return m_MaxFreesPerFrame; }
+        int GetEarlyFreeCount() const { return m_EarlyFreeCount; }
+        int GetDoubleFreeCount() const { return m_DoubleFreeCount; }
+        // Buffers freed with the memory of another one
+        int GetMismatchCount() const { return m_MismatchCount; }
+
+    private:
+        // The frames submitted before each resource was retired, the last of them may still use it
+        std::vector<uint64_t> m_RetiredFrames;
+        std::vector<bool> m_IsFreed;
+        uint64_t m_SubmittedFrameCount{};
+        uint64_t m_CompletedFrameCount{};
+        uint64_t m_StartFreedCount{};
+        size_t m_MaxFreesPerFrame{};
+        int m_EarlyFreeCount{};
+        int m_DoubleFreeCount{};
+        int m_MismatchCount{};
+
+        size_t Retire()
+        {
+            m_RetiredFrames.push_back(m_SubmittedFrameCount);
+            m_IsFreed.push_back(false);
+            return m_RetiredFrames.size() - 1;
+        }
+
+        void Free(size_t id)
+        {
+            m_EarlyFreeCount += m_RetiredFrames[id] > m_CompletedFrameCount;
+            m_DoubleFreeCount += m_IsFreed[id];
+            m_IsFreed[id] = true;
+        }
+    };
+}
+
+// The headless version of the chunk churn of VulkanBase, nothing may be freed while a frame that can use it is in flight
+TEST_CASE(DeletionQueueChunkChurn)
+{
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+    ChurnSimulation simulation;
+    size_t peakPendingCount = 0;
+    for (int frame = 0; frame < g_FrameCount; ++frame)
+    {
+        const int chunkCount = frame == g_BurstFrame ? g_BurstChunks : g_ChunksPerFrame;
+        for (int chunk = 0; chunk < chunkCount; ++chunk)
+        {
+            simulation.RetireChunk();
+        }
+        simulation.Render();
+        peakPendingCount = std::max(peakPendingCount, deletionQueue.GetPendingCount());
+    }
+
+    // Two frames without churn free the rest
+    simulation.Render();
+    simulation.Render();
+
+    std::cout << "  " << simulation.GetFreedCount() << " of " << simulation.GetRetiredCount() << " retired resources freed, "
+        << deletionQueue.GetPendingCount() << " pending, " << peakPendingCount << " at most, "
+        << simulation.GetMaxFreesPerFrame() << " freed in the busiest frame\n";
+
+    CHECK(simulation.GetEarlyFreeCount() == 0);
+    CHECK(simulation.GetDoubleFreeCount() == 0);
+    CHECK(simulation.GetMismatchCount() == 0);
+    CHECK(simulation.GetFreedCount() == simulation.GetRetiredCount());
+    CHECK(deletionQueue.GetPendingCount() == 0);
+    // The burst is spread over several frames instead of stalling one
+    CHECK(simulation.GetMaxFreesPerFrame() == DeletionQueue::m_MaxFreesPerFrame);
+    CHECK(peakPendingCount > DeletionQueue::m_MaxFreesPerFrame);
+}
+
+// A frame that was submitted but not waited on keeps everything it may use
+TEST_CASE(DeletionQueueWaitsForTheFence)
+{
+    DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+    int freedCount = 0;
+    const auto countFrees = [&freedCount](VkBuffer, VkDeviceMemory) { ++freedCount; };
+    const auto enqueue = [&deletionQueue, &freedCount]() { deletionQueue.Enqueue([&freedCount]() { ++freedCount; }); };
+    const VkBuffer buffer = reinterpret_cast<VkBuffer>(uintptr_t{ 1 });
+    const VkDeviceMemory memory = reinterpret_cast<VkDeviceMemory>(uintptr_t{ 1 });
+
+    // Retired while a frame is in flight
+    deletionQueue.OnFramesCompleted();
+    deletionQueue.OnFrameSubmitted();
+    enqueue();
+    deletionQueue.DestroyBuffer(buffer, memory);
+    CHECK(deletionQueue.Collect(SIZE_MAX, countFrees) == 0);
+    deletionQueue.OnFramesCompleted();
+    CHECK(deletionQueue.Collect(SIZE_MAX, countFrees) == 2);
+    CHECK(freedCount == 2);
+
+    // Retired after waiting on the fence, no frame can use it anymore
+    enqueue();
+    deletionQueue.DestroyBuffer(buffer, memory);
+    CHECK(deletionQueue.Collect(SIZE_MAX, countFrees) == 2);
+    CHECK(freedCount == 4);
+
+    // Null handles are never queued
+    deletionQueue.DestroyBuffer(VK_NULL_HANDLE, VK_NULL_HANDLE);
+    CHECK(deletionQueue.GetPendingCount() == 0);
+
+    // At most maxFrees per call, in the order they were retired
+    for (int index = 0; index < 3; ++index)
+    {
+        enqueue();
+    }
+    CHECK(deletionQueue.Collect(2, countFrees) == 2);
+    CHECK(deletionQueue.GetPendingCount() == 1);
+    CHECK(deletionQueue.Collect(SIZE_MAX, countFrees) == 1);
+    CHECK(freedCount == 7);
+    CHECK(deletionQueue.GetPendingCount() == 0);
+}
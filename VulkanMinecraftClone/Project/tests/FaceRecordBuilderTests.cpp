@@ -0,0 +1,188 @@
+#include "tests/Test.h"
+#include "FaceRecordBuilder.h"
+#include <memory>
+#include <random>
+#include <set>
+#include <tuple>
+
+namespace
+{
+    constexpr int g_Width = CHUNK_WIDTH;
+    constexpr int g_Height = CHUNK_HEIGHT;
+    constexpr int g_Depth = CHUNK_DEPTH;
+    constexpr int g_SectionSize = 16;
+    constexpr int g_SectionsX = g_Width / g_SectionSize;
+    constexpr int g_SectionsY = g_Height / g_SectionSize;
+
+    int GetSectionIndex(int x, int y, int z)
+    {
+        return x / g_SectionSize + (y / g_SectionSize) * g_SectionsX + (z / g_SectionSize) * g_SectionsX * g_SectionsY;
+    }
+
+    struct Face
+    {
+        int x;
+        int y;
+        int z;
+        Direction direction;
+        uint32_t layer;
+
+        bool operator<(const Face& other) const
+        {
+            return std::tie(x, y, z, direction, layer) < std::tie(other.x, other.y, other.z, other.direction, other.layer);
+        }
+
+        bool operator==(const Face& other) const
+        {
+            return std::tie(x, y, z, direction, layer) == std::tie(other.x, other.y, other.z, other.direction, other.layer);
+        }
+    };
+
+    Face UnpackFace(FaceRecord record)
+    {
+        Face face{};
+        FaceRecordBuilder::Unpack(record, face.x, face.y, face.z, face.direction, face.layer);
+        return face;
+    }
+
+    struct BuiltFaces
+    {
+        TaggedVector<FaceRecord, MemoryTag::Meshes> records;
+        std::vector<FaceRecordBuilder::SectionRange> sectionRanges;
+    };
+
+    BuiltFaces Build(const ChunkBlocks& blocks)
+    {
+        BuiltFaces built;
+        FaceRecordBuilder::Build(blocks, g_Height, g_Depth, g_SectionSize, built.records, built.sectionRanges);
+        return built;
+    }
+}
+
+TEST_CASE(FaceRecordPackRoundTrip)
+{
+    for (int x : { 0, 1, g_Width - 1 })
+    {
+        for (int y : { 0, 1, FaceRecordBuilder::m_MaxHeight - 1 })
+        {
+            for (int z : { 0, 1, FaceRecordBuilder::m_MaxDepth - 1 })
+            {
+                for (int direction = 0; direction < FACE_COUNT; ++direction)
+                {
+                    for (uint32_t layer : { 0u, 1u, FaceRecordBuilder::m_MaxLayer })
+                    {
+                        const Face face = UnpackFace(FaceRecordBuilder::Pack(x, y, z, static_cast<Direction>(direction), layer));
+                        CHECK(face.x == x && face.y == y && face.z == z);
+                        CHECK(face.direction == static_cast<Direction>(direction) && face.layer == layer);
+                    }
+                }
+            }
+        }
+    }
+
+    // The top two bits are free
+    CHECK((FaceRecordBuilder::Pack(g_Width - 1, FaceRecordBuilder::m_MaxHeight - 1, FaceRecordBuilder::m_MaxDepth - 1, Direction::West, FaceRecordBuilder::m_MaxLayer) >> 30) == 0);
+}
+
+TEST_CASE(FaceRecordBuilderFixtures)
+{
+    const BlockRegistry& registry = BlockRegistry::GetInstance();
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+    auto pBlocks = std::make_unique<ChunkBlocks>();
+
+    // A single block shows every face with its own texture, water is not part of the land
+    pBlocks->Set(5, 20, 7, BlockType::GrassBlock);
+    pBlocks->Set(40, 100, 50, BlockType::Water);
+    BuiltFaces built = Build(*pBlocks);
+    CHECK(built.records.size() == FACE_COUNT);
+    CHECK(built.sectionRanges.size() == static_cast<size_t>(g_SectionsX * g_SectionsY * (g_Depth / g_SectionSize)));
+    std::set<Direction> directions;
+    for (const FaceRecord record : built.records)
+    {
+        const Face face = UnpackFace(record);
+        CHECK(face.x == 5 && face.y == 20 && face.z == 7);
+        CHECK(face.layer == registry.GetFaceLayer(BlockType::GrassBlock, face.direction));
+        directions.insert(face.direction);
+    }
+    CHECK(directions.size() == FACE_COUNT);
+    const int section = GetSectionIndex(5, 20, 7);
+    CHECK(built.sectionRanges[section].firstFace == 0 && built.sectionRanges[section].faceCount == FACE_COUNT);
+
+    // Two blocks next to each other hide the faces between them
+    pBlocks->Set(6, 20, 7, BlockType::Stone);
+    built = Build(*pBlocks);
+    CHECK(built.records.size() == 2 * FACE_COUNT - 2);
+
+    // A block in the next section along x gets the range right after it
+    pBlocks->Set(20, 20, 7, BlockType::Dirt);
+    built = Build(*pBlocks);
+    CHECK(built.sectionRanges[section].faceCount == 2 * FACE_COUNT - 2);
+    CHECK(built.sectionRanges[section + 1].firstFace == 2 * FACE_COUNT - 2);
+    CHECK(built.sectionRanges[section + 1].faceCount == FACE_COUNT);
+}
+
+// Every visible face of a random chunk comes back out of its record, in the range of its own section
+TEST_CASE(FaceRecordBuilderRoundTrip)
+{
+    const BlockRegistry& registry = BlockRegistry::GetInstance();
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+    auto pBlocks = std::make_unique<ChunkBlocks>();
+    std::mt19937 random{ 41 };
+    constexpr std::array<BlockType, 8> blockTypes{ BlockType::GrassBlock, BlockType::Stone, BlockType::Dirt, BlockType::Sand,
+        BlockType::Log, BlockType::Leaves, BlockType::Water, BlockType::Air };
+    for (int z = 0; z < g_Depth; ++z)
+    {
+        for (int y = 0; y < g_Height; ++y)
+        {
+            for (int x = 0; x < g_Width; ++x)
+            {
+                pBlocks->Set(x, y, z, random() % 3 == 0 ? blockTypes[random() % blockTypes.size()] : BlockType::Air);
+            }
+        }
+    }
+
+    // The faces the row masks find visible
+    FaceVisibility faceVisibility{ g_Height, g_Depth };
+    faceVisibility.Build(*pBlocks);
+    std::set<Face> expectedFaces;
+    FaceVisibility::FaceMasks faceMasks{};
+    for (int z = 0; z < g_Depth; ++z)
+    {
+        for (int y = 0; y < g_Height; ++y)
+        {
+            FaceVisibility::RowMask visible = faceVisibility.GetVisibleFaces(y, z, faceMasks);
+            while (visible != 0)
+            {
+                const int x = FaceVisibility::PopLowestBit(visible);
+                for (int face = 0; face < FACE_COUNT; ++face)
+                {
+                    if ((faceMasks[face] >> x) & 1)
+                    {
+                        const Direction direction = static_cast<Direction>(face);
+                        expectedFaces.insert({ x, y, z, direction, registry.GetFaceLayer(pBlocks->Get(x, y, z), direction) });
+                    }
+                }
+            }
+        }
+    }
+
+    const BuiltFaces built = Build(*pBlocks);
+    CHECK(built.records.size() == expectedFaces.size());
+
+    std::set<Face> builtFaces;
+    uint32_t nextFace = 0;
+    for (size_t section = 0; section < built.sectionRanges.size(); ++section)
+    {
+        const FaceRecordBuilder::SectionRange& range = built.sectionRanges[section];
+        CHECK(range.firstFace == nextFace);
+        nextFace += range.faceCount;
+        for (uint32_t record = range.firstFace; record < range.firstFace + range.faceCount; ++record)
+        {
+            const Face face = UnpackFace(built.records[record]);
+            CHECK(GetSectionIndex(face.x, face.y, face.z) == static_cast<int>(section));
+            builtFaces.insert(face);
+        }
+    }
+    CHECK(nextFace == built.records.size());
+    CHECK(builtFaces == expectedFaces);
+}
@@ -0,0 +1,80 @@
+#include "tests/Test.h"
+#include "FaceTable.h"
+#include "BlockMesh.h"
+#include <vector>
+
+namespace
+{
+    constexpr std::array<uint8_t, 4> g_Unoccluded{ 3, 3, 3, 3 };
+
+    bool IsNear(const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b) < 1e-5f; }
+}
+
+// The vertices a face used to get from the switch statements in Chunk::AddFaceVertices
+TEST_CASE(FaceTableGoldenFaces)
+{
+    std::vector<Vertex> vertices;
+    WriteFaceVertices(vertices, 4, glm::vec3{ 1.f, 2.f, 3.f }, 7.f, g_Unoccluded, glm::vec2{ 0.5f, 0.25f });
+    WriteFaceVertices(vertices, 2, glm::vec3{ 1.f, 2.f, 3.f }, 2.f, g_Unoccluded, glm::vec2{ 1.f, 0.f });
+    CHECK(vertices.size() == 8);
+
+    const std::array<glm::vec3, 8> positions{ {
+        { 0.5f, 2.5f, 3.5f }, { 1.5f, 2.5f, 3.5f }, { 1.5f, 2.5f, 2.5f }, { 0.5f, 2.5f, 2.5f },
+        { 0.5f, 1.5f, 2.5f }, { 0.5f, 2.5f, 2.5f }, { 1.5f, 2.5f, 2.5f }, { 1.5f, 1.5f, 2.5f } } };
+    const std::array<glm::vec3, 8> texCoords{ {
+        { 0.f, 1.f, 7.f }, { 1.f, 1.f, 7.f }, { 1.f, 0.f, 7.f }, { 0.f, 0.f, 7.f },
+        { 1.f, 1.f, 2.f }, { 1.f, 0.f, 2.f }, { 0.f, 0.f, 2.f }, { 0.f, 1.f, 2.f } } };
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        CHECK(IsNear(vertices[i].position, positions[i]));
+        CHECK(IsNear(vertices[i].texCoord, texCoords[i]));
+        CHECK(IsNear(vertices[i].normal, i < 4 ? glm::vec3{ 0.f, 1.f, 0.f } : glm::vec3{ 0.f, 0.f, -1.f }));
+        CHECK(vertices[i].ambientOcclusion == 1.f);
+    }
+    CHECK(vertices[0].light.x == 0.5f && vertices[0].light.y == 0.25f);
+}
+
+TEST_CASE(FaceTableFacesAreOutwardUnitQuads)
+{
+    const glm::vec3 position{ 5.f, 6.f, 7.f };
+    for (int face = 0; face < FACE_COUNT; ++face)
+    {
+        std::vector<Vertex> vertices;
+        WriteFaceVertices(vertices, face, position, 0.f, g_Unoccluded, glm::vec2{ 1.f, 0.f });
+        const glm::vec3 normal = vertices[0].normal;
+
+        // Every corner lies on the side of the block the normal points to
+        for (const Vertex& vertex : vertices)
+        {
+            CHECK(std::abs(glm::dot(vertex.position - position, normal) - 0.5f) < 1e-5f);
+        }
+
+        // Counter clockwise seen from outside and a block wide
+        const glm::vec3 cross = glm::cross(vertices[1].position - vertices[0].position, vertices[2].position - vertices[0].position);
+        CHECK(IsNear(cross, normal));
+
+        // Every corner of the texture is used once
+        int texCornerBits = 0;
+        for (const Vertex& vertex : vertices)
+        {
+            texCornerBits |= 1 << (static_cast<int>(vertex.texCoord.x) + 2 * static_cast<int>(vertex.texCoord.y));
+        }
+        CHECK(texCornerBits == 0xF);
+    }
+}
+
+TEST_CASE(FaceTableSplitsAlongTheDarkerDiagonal)
+{
+    // The first and third corner are lighter, so the quad starts at the second one to split through the dark corner
+    std::vector<Vertex> vertices;
+    WriteFaceVertices(vertices, 4, glm::vec3{ 0.f }, 0.f, { 3, 0, 3, 3 }, glm::vec2{ 1.f, 0.f });
+    CHECK(IsNear(vertices[0].position, glm::vec3{ 0.5f, 0.5f, 0.5f }));
+    CHECK(vertices[0].ambientOcclusion == 0.4f);
+    CHECK(vertices[1].ambientOcclusion == 1.f);
+
+    // A dark first corner keeps the order
+    vertices.clear();
+    WriteFaceVertices(vertices, 4, glm::vec3{ 0.f }, 0.f, { 0, 3, 3, 3 }, glm::vec2{ 1.f, 0.f });
+    CHECK(IsNear(vertices[0].position, glm::vec3{ -0.5f, 0.5f, 0.5f }));
+    CHECK(vertices[0].ambientOcclusion == 0.4f);
+}
@@ -0,0 +1,202 @@
+#include "tests/Test.h"
+#include "FaceVisibility.h"
+#include <fstream>
+#include <memory>
+#include <random>
+#include <vendor/json.hpp>
+
+namespace
+{
+    constexpr int g_Width = CHUNK_WIDTH;
+    constexpr int g_Height = CHUNK_HEIGHT;
+    constexpr int g_Depth = CHUNK_DEPTH;
+
+    BlockType GetBlock(const ChunkBlocks& blocks, int x, int y, int z)
+    {
+        if (x < 0 || x >= g_Width || y < 0 || y >= g_Height || z < 0 || z >= g_Depth)
+        {
+            return BlockType::Air;
+        }
+        return blocks.Get(x, y, z);
+    }
+
+    // The per block test the mesher did before the row masks
+    bool IsFaceVisible(const ChunkBlocks& blocks, int x, int y, int z, int face)
+    {
+        const BlockRegistry& registry = BlockRegistry::GetInstance();
+        const BlockType blockType = blocks.Get(x, y, z);
+        if (registry.GetRenderLayer(blockType) != RenderLayer::Land)
+        {
+            return false;
+        }
+
+        const auto& offset = FACE_TABLE[face].normal;
+        const BlockType neighbor = GetBlock(blocks, x + offset[0], y + offset[1], z + offset[2]);
+        if (registry.IsOpaque(neighbor))
+        {
+            return false;
+        }
+        return !(neighbor == blockType && registry.CullsSameType(blockType));
+    }
+
+    void FillRandom(ChunkBlocks& blocks, std::mt19937& random, float fill)
+    {
+        constexpr std::array<BlockType, 7> solidTypes{ BlockType::GrassBlock, BlockType::Stone, BlockType::Dirt, BlockType::Sand,
+            BlockType::Log, BlockType::Leaves, BlockType::Water };
+        std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+        for (int z = 0; z < g_Depth; ++z)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                for (int x = 0; x < g_Width; ++x)
+                {
+                    blocks.Set(x, y, z, unit(random) < fill ? solidTypes[random() % solidTypes.size()] : BlockType::Air);
+                }
+            }
+        }
+    }
+
+    // Returns the number of faces that differ from the per block test
+    int CountMismatches(const ChunkBlocks& blocks)
+    {
+        FaceVisibility faceVisibility{ g_Height, g_Depth };
+        faceVisibility.Build(blocks);
+
+        int mismatchCount = 0;
+        FaceVisibility::FaceMasks faceMasks{};
+        for (int z = 0; z < g_Depth; ++z)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                const FaceVisibility::RowMask visible = faceVisibility.GetVisibleFaces(y, z, faceMasks);
+                for (int x = 0; x < g_Width; ++x)
+                {
+                    bool hasVisibleFace = false;
+                    for (int face = 0; face < FACE_COUNT; ++face)
+                    {
+                        const bool isVisible = IsFaceVisible(blocks, x, y, z, face);
+                        // The masks of a row without land are left alone
+                        const bool isMaskVisible = visible != 0 && ((faceMasks[face] >> x) & 1);
+                        mismatchCount += isVisible != isMaskVisible;
+                        hasVisibleFace |= isVisible;
+                    }
+                    mismatchCount += hasVisibleFace != (((visible >> x) & 1) != 0);
+                }
+            }
+        }
+        return mismatchCount;
+    }
+
+    int CountMismatchesOnRandomFields(std::mt19937& random)
+    {
+        auto pBlocks = std::make_unique<ChunkBlocks>();
+        int mismatchCount = 0;
+        for (float fill : { 0.f, 0.1f, 0.5f, 0.9f, 1.f })
+        {
+            FillRandom(*pBlocks, random, fill);
+            mismatchCount += CountMismatches(*pBlocks);
+        }
+        return mismatchCount;
+    }
+
+    std::array<uint8_t, 4> GetAmbientOcclusion(const ChunkBlocks& blocks, int x, int y, int z, Direction direction)
+    {
+        FaceVisibility faceVisibility{ g_Height, g_Depth };
+        faceVisibility.Build(blocks);
+        std::array<uint8_t, 4> levels{};
+        faceVisibility.GetAmbientOcclusion(x, y, z, static_cast<int>(direction), levels);
+        return levels;
+    }
+}
+
+TEST_CASE(FaceVisibilityMatchesPerBlockTest)
+{
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+    std::mt19937 random{ 33 };
+    CHECK(CountMismatchesOnRandomFields(random) == 0);
+}
+
+// No shipped block is see through while hiding its own type, sand is made one to cover that path
+TEST_CASE(FaceVisibilityMatchesPerBlockTestWithTranslucentLand)
+{
+    std::ifstream jsonFile{ "textures/blockdata.json" };
+    nlohmann::json blockData = nlohmann::json::parse(jsonFile, nullptr, false);
+    CHECK(!blockData.is_discarded());
+    for (nlohmann::json& block : blockData["blocks"])
+    {
+        if (block["id"] == "sand")
+        {
+            block["transparency"] = "translucent";
+        }
+    }
+
+    BlockRegistry& registry = BlockRegistry::GetInstance();
+    CHECK(registry.LoadFromString(blockData.dump()));
+    CHECK(!registry.IsOpaque(BlockType::Sand) && registry.CullsSameType(BlockType::Sand));
+
+    std::mt19937 random{ 34 };
+    CHECK(CountMismatchesOnRandomFields(random) == 0);
+
+    CHECK(registry.Load("textures/blockdata.json"));
+}
+
+TEST_CASE(FaceVisibilityChunkBorders)
+{
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+
+    // A single block in the corner of the chunk shows all faces, the blocks outside count as air
+    auto pBlocks = std::make_unique<ChunkBlocks>();
+    pBlocks->Set(g_Width - 1, 0, 0, BlockType::Stone);
+    FaceVisibility faceVisibility{ g_Height, g_Depth };
+    faceVisibility.Build(*pBlocks);
+
+    FaceVisibility::FaceMasks faceMasks{};
+    CHECK(faceVisibility.GetVisibleFaces(0, 0, faceMasks) == FaceVisibility::RowMask{ 1 } << (g_Width - 1));
+    for (const FaceVisibility::RowMask faceMask : faceMasks)
+    {
+        CHECK(faceMask == FaceVisibility::RowMask{ 1 } << (g_Width - 1));
+    }
+    CHECK(!faceVisibility.IsOpaque(g_Width, 0, 0));
+    CHECK(faceVisibility.IsOpaque(g_Width - 1, 0, 0));
+}
+
+// The top of a block in a stone floor, the corners of the up face are -x +z, +x +z, +x -z and -x -z
+TEST_CASE(AmbientOcclusionGoldenCases)
+{
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+    auto pBlocks = std::make_unique<ChunkBlocks>();
+    for (int z = 0; z < g_Depth; ++z)
+    {
+        for (int x = 0; x < g_Width; ++x)
+        {
+            pBlocks->Set(x, 10, z, BlockType::Stone);
+        }
+    }
+
+    // Nothing on the floor
+    CHECK((GetAmbientOcclusion(*pBlocks, 10, 10, 10, Direction::Up) == std::array<uint8_t, 4>{ 3, 3, 3, 3 }));
+
+    // A block only on the diagonal darkens the one corner it touches
+    pBlocks->Set(11, 11, 11, BlockType::Stone);
+    CHECK((GetAmbientOcclusion(*pBlocks, 10, 10, 10, Direction::Up) == std::array<uint8_t, 4>{ 3, 2, 3, 3 }));
+
+    // A side and the diagonal
+    pBlocks->Set(11, 11, 10, BlockType::Stone);
+    CHECK((GetAmbientOcclusion(*pBlocks, 10, 10, 10, Direction::Up) == std::array<uint8_t, 4>{ 3, 1, 2, 3 }));
+
+    // Both sides make the corner fully dark, with or without the diagonal
+    pBlocks->Set(10, 11, 11, BlockType::Stone);
+    CHECK((GetAmbientOcclusion(*pBlocks, 10, 10, 10, Direction::Up) == std::array<uint8_t, 4>{ 2, 0, 2, 3 }));
+    pBlocks->Set(11, 11, 11, BlockType::Air);
+    CHECK((GetAmbientOcclusion(*pBlocks, 10, 10, 10, Direction::Up) == std::array<uint8_t, 4>{ 2, 0, 2, 3 }));
+
+    // See through blocks don't occlude
+    pBlocks->Set(11, 11, 10, BlockType::Leaves);
+    pBlocks->Set(10, 11, 11, BlockType::Water);
+    CHECK((GetAmbientOcclusion(*pBlocks, 10, 10, 10, Direction::Up) == std::array<uint8_t, 4>{ 3, 3, 3, 3 }));
+
+    // The east face of a floating block with a block above the one in front of it, the two upper corners are darker
+    pBlocks->Set(20, 20, 20, BlockType::Stone);
+    pBlocks->Set(21, 21, 20, BlockType::Stone);
+    CHECK((GetAmbientOcclusion(*pBlocks, 20, 20, 20, Direction::East) == std::array<uint8_t, 4>{ 3, 3, 2, 2 }));
+}
@@ -0,0 +1,320 @@
+#include "tests/Test.h"
+#include "LightEngine.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <vendor/json.hpp>
+
+namespace
+{
+    constexpr int g_Width = LightEngine::m_Width;
+    constexpr int g_Height = LightEngine::m_Height;
+    constexpr int g_Depth = LightEngine::m_Depth;
+    constexpr uint8_t g_MaxLevel = LightData::m_MaxLevel;
+
+    // Chunks without a renderer, looked up by their position in chunks
+    class TestWorld final
+    {
+    public:
+        ChunkBlocks& AddChunk(int chunkX, int chunkZ)
+        {
+            Chunk& chunk = m_Chunks[{ chunkX, chunkZ }];
+            chunk.pBlocks = std::make_unique<ChunkBlocks>();
+            chunk.pLight = std::make_unique<LightData>(ChunkBlocks::m_BlockCount);
+            return *chunk.pBlocks;
+        }
+
+        LightEngine::ChunkLookup GetLookup()
+        {
+            return [this](const glm::ivec3& chunkPosition)
+                {
+                    const auto found = m_Chunks.find({ chunkPosition.x, chunkPosition.z });
+                    return found != m_Chunks.end() ? LightEngine::ChunkView{ found->second.pBlocks.get(), found->second.pLight.get() } : LightEngine::ChunkView{ nullptr, nullptr };
+                };
+        }
+
+        std::vector<glm::ivec3> GetChunkPositions() const
+        {
+            std::vector<glm::ivec3> positions;
+            for (const auto& [position, chunk] : m_Chunks)
+            {
+                positions.push_back({ position.first, 0, position.second });
+            }
+            return positions;
+        }
+
+        ChunkBlocks& GetBlocks(const glm::ivec3& chunkPosition) { return *m_Chunks.at({ chunkPosition.x, chunkPosition.z }).pBlocks; }
+        LightData& GetLight(const glm::ivec3& chunkPosition) { return *m_Chunks.at({ chunkPosition.x, chunkPosition.z }).pLight; }
+
+        // World block positions, y is the same in every chunk
+        BlockType GetBlock(int x, int y, int z) const
+        {
+            const Chunk& chunk = m_Chunks.at({ FloorDivide(x, g_Width), FloorDivide(z, g_Depth) });
+            return chunk.pBlocks->Get(Wrap(x, g_Width), y, Wrap(z, g_Depth));
+        }
+        void SetBlock(int x, int y, int z, BlockType blockType)
+        {
+            m_Chunks.at({ FloorDivide(x, g_Width), FloorDivide(z, g_Depth) }).pBlocks->Set(Wrap(x, g_Width), y, Wrap(z, g_Depth), blockType);
+        }
+        uint8_t GetSkyLight(int x, int y, int z) const { return GetLight(x, z).GetSkyLight(GetIndex(x, y, z)); }
+        uint8_t GetBlockLight(int x, int y, int z) const { return GetLight(x, z).GetBlockLight(GetIndex(x, y, z)); }
+
+        static int FloorDivide(int value, int divisor) { return value >= 0 ? value / divisor : (value - divisor + 1) / divisor; }
+        static int Wrap(int value, int size) { return value - FloorDivide(value, size) * size; }
+
+    private:
+        struct Chunk
+        {
+            std::unique_ptr<ChunkBlocks> pBlocks;
+            std::unique_ptr<LightData> pLight;
+        };
+
+        std::map<std::pair<int, int>, Chunk> m_Chunks;
+
+        const LightData& GetLight(int x, int z) const { return *m_Chunks.at({ FloorDivide(x, g_Width), FloorDivide(z, g_Depth) }).pLight; }
+        static size_t GetIndex(int x, int y, int z) { return LightEngine::GetIndex(Wrap(x, g_Width), y, Wrap(z, g_Depth)); }
+    };
+
+    void FillLayer(ChunkBlocks& blocks, int y, BlockType blockType)
+    {
+        for (int z = 0; z < g_Depth; ++z)
+        {
+            for (int x = 0; x < g_Width; ++x)
+            {
+                blocks.Set(x, y, z, blockType);
+            }
+        }
+    }
+
+    bool Contains(const std::vector<glm::ivec3>& positions, const glm::ivec3& position)
+    {
+        return std::find(positions.begin(), positions.end(), position) != positions.end();
+    }
+
+    // The game data with the log as a light source
+    void LoadEmissiveRegistry()
+    {
+        std::ifstream jsonFile{ "textures/blockdata.json" };
+        nlohmann::json blockData = nlohmann::json::parse(jsonFile, nullptr, false);
+        CHECK(!blockData.is_discarded());
+        for (nlohmann::json& block : blockData["blocks"])
+        {
+            if (block["id"] == "log")
+            {
+                block["emissive"] = 14;
+            }
+        }
+        CHECK(BlockRegistry::GetInstance().LoadFromString(blockData.dump()));
+    }
+}
+
+TEST_CASE(LightEngineSkyLight)
+{
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+
+    // A stone floor at y 10 and a stone roof at y 50 over the second chunk, the first one is open
+    TestWorld world;
+    for (int chunkX : { 0, 1 })
+    {
+        ChunkBlocks& blocks = world.AddChunk(chunkX, 0);
+        FillLayer(blocks, 10, BlockType::Stone);
+    }
+    FillLayer(world.GetBlocks({ 1, 0, 0 }), 50, BlockType::Stone);
+
+    LightEngine lightEngine{ world.GetLookup() };
+    const std::vector<glm::ivec3> changedChunks = lightEngine.LightChunks(world.GetChunkPositions());
+    CHECK(changedChunks.size() == 2);
+
+    // Full light all the way down to the floor in the open, nothing below it
+    CHECK(world.GetSkyLight(20, 11, 20) == g_MaxLevel);
+    CHECK(world.GetSkyLight(20, 9, 20) == 0);
+    // Above the roof everything is lit, under it the light comes in sideways over the chunk border
+    CHECK(world.GetSkyLight(g_Width + 20, 51, 20) == g_MaxLevel);
+    for (int distance = 0; distance < g_MaxLevel; ++distance)
+    {
+        CHECK(world.GetSkyLight(g_Width + distance, 30, 20) == g_MaxLevel - 1 - distance);
+    }
+    CHECK(world.GetSkyLight(g_Width + g_MaxLevel, 30, 20) == 0);
+    CHECK(world.GetBlockLight(20, 30, 20) == 0);
+}
+
+TEST_CASE(LightEngineBlockLight)
+{
+    LoadEmissiveRegistry();
+
+    // A log in a sealed stone room that crosses the chunk border
+    TestWorld world;
+    for (int chunkX : { 0, 1 })
+    {
+        ChunkBlocks& blocks = world.AddChunk(chunkX, 0);
+        for (int y = 0; y < g_Height; ++y)
+        {
+            FillLayer(blocks, y, BlockType::Stone);
+        }
+    }
+    for (int x = g_Width - 10; x < g_Width + 10; ++x)
+    {
+        for (int z = 20; z < 30; ++z)
+        {
+            for (int y = 20; y < 30; ++y)
+            {
+                world.SetBlock(x, y, z, BlockType::Air);
+            }
+        }
+    }
+    world.SetBlock(g_Width - 5, 25, 25, BlockType::Log);
+
+    LightEngine lightEngine{ world.GetLookup() };
+    lightEngine.LightChunks(world.GetChunkPositions());
+    CHECK(world.GetBlockLight(g_Width - 5, 25, 25) == 14);
+    CHECK(world.GetBlockLight(g_Width - 4, 25, 25) == 13);
+    // Across the border, along x and then diagonally by steps
+    CHECK(world.GetBlockLight(g_Width + 3, 25, 25) == 6);
+    CHECK(world.GetBlockLight(g_Width + 3, 26, 24) == 4);
+    CHECK(world.GetSkyLight(g_Width + 3, 25, 25) == 0);
+
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+}
+
+// The chunks to remesh are the ones whose light changed and the neighbors of the borders that changed
+TEST_CASE(LightEngineRemeshesBorderNeighbors)
+{
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+    TestWorld world;
+    LightEngine lightEngine{ world.GetLookup() };
+
+    // A new chunk is read for the first time by every loaded neighbor
+    FillLayer(world.AddChunk(0, 0), 10, BlockType::Stone);
+    CHECK((lightEngine.LightChunks({ { 0, 0, 0 } }) == std::vector<glm::ivec3>{ { 0, 0, 0 } }));
+    FillLayer(world.AddChunk(1, 0), 10, BlockType::Stone);
+    std::vector<glm::ivec3> changedChunks = lightEngine.LightChunks({ { 1, 0, 0 } });
+    CHECK(changedChunks.size() == 2 && Contains(changedChunks, { 0, 0, 0 }) && Contains(changedChunks, { 1, 0, 0 }));
+    FillLayer(world.AddChunk(2, 0), 10, BlockType::Stone);
+
+    // A block dug out of the floor in the middle of a chunk only changes that chunk
+    world.SetBlock(g_Width + 30, 10, 30, BlockType::Air);
+    CHECK((lightEngine.UpdateBlock({ 1, 0, 0 }, { 30, 10, 30 }, BlockType::Stone) == std::vector<glm::ivec3>{ { 1, 0, 0 } }));
+
+    // Next to the border the light of the neighbor doesn't change, but its mesh shows the new light of the border
+    world.SetBlock(g_Width, 11, 30, BlockType::Stone);
+    changedChunks = lightEngine.UpdateBlock({ 1, 0, 0 }, { 0, 11, 30 }, BlockType::Air);
+    CHECK(changedChunks.size() == 2 && Contains(changedChunks, { 0, 0, 0 }) && Contains(changedChunks, { 1, 0, 0 }));
+    CHECK(world.GetSkyLight(g_Width - 1, 11, 30) == g_MaxLevel);
+
+    // Nothing changes when the block stays the same
+    CHECK(lightEngine.UpdateBlock({ 1, 0, 0 }, { 0, 11, 30 }, BlockType::Stone).empty());
+    // The lookup doesn't find unloaded chunks
+    CHECK(lightEngine.UpdateBlock({ 5, 0, 0 }, { 0, 10, 30 }, BlockType::Stone).empty());
+}
+
+// Every edit is applied incrementally and compared with lighting the whole world again
+TEST_CASE(LightEngineUpdateBlockMatchesFullRelight)
+{
+    LoadEmissiveRegistry();
+
+    // Four chunks of hilly ground with caves, trees, ponds and a few lights underground
+    std::mt19937 random{ 35 };
+    TestWorld world;
+    TestWorld reference;
+    for (int chunkZ : { 0, 1 })
+    {
+        for (int chunkX : { 0, 1 })
+        {
+            world.AddChunk(chunkX, chunkZ);
+            reference.AddChunk(chunkX, chunkZ);
+        }
+    }
+    const auto setBoth = [&world, &reference](int x, int y, int z, BlockType blockType)
+        {
+            world.SetBlock(x, y, z, blockType);
+            reference.SetBlock(x, y, z, blockType);
+        };
+    std::uniform_int_distribution<int> chance{ 0, 99 };
+    for (int z = 0; z < 2 * g_Depth; ++z)
+    {
+        for (int x = 0; x < 2 * g_Width; ++x)
+        {
+            const int groundHeight = 40 + (x / 8 + z / 11) % 6;
+            for (int y = 0; y <= groundHeight; ++y)
+            {
+                const bool isCave = y > 20 && y < 30 && (x / 4 + z / 4) % 3 == 0;
+                setBoth(x, y, z, isCave ? (chance(random) == 0 ? BlockType::Log : BlockType::Air) : BlockType::Stone);
+            }
+            if (chance(random) < 2)
+            {
+                setBoth(x, groundHeight + 1, z, BlockType::Leaves);
+                setBoth(x, groundHeight + 2, z, BlockType::Leaves);
+            }
+            else if (chance(random) < 3)
+            {
+                setBoth(x, groundHeight + 1, z, BlockType::Water);
+            }
+        }
+    }
+
+    LightEngine lightEngine{ world.GetLookup() };
+    lightEngine.LightChunks(world.GetChunkPositions());
+    const std::vector<glm::ivec3> chunkPositions = world.GetChunkPositions();
+
+    // The edits are around the corner all four chunks share, so the light crosses the borders
+    constexpr std::array<BlockType, 5> editTypes{ BlockType::Air, BlockType::Air, BlockType::Stone, BlockType::Log, BlockType::Leaves };
+    std::uniform_int_distribution<int> horizontal{ g_Width - 8, g_Width + 7 };
+    std::uniform_int_distribution<int> vertical{ 18, 48 };
+    int mismatchCount = 0;
+    int missedRemeshCount = 0;
+    int changedLightCount = 0;
+    for (int edit = 0; edit < 40; ++edit)
+    {
+        const int x = horizontal(random);
+        const int y = vertical(random);
+        const int z = horizontal(random);
+        const BlockType oldBlockType = world.GetBlock(x, y, z);
+        const BlockType blockType = editTypes[random() % editTypes.size()];
+        setBoth(x, y, z, blockType);
+
+        std::map<std::tuple<int, int>, LightData> oldLight;
+        for (const glm::ivec3& chunkPosition : chunkPositions)
+        {
+            oldLight.emplace(std::make_tuple(chunkPosition.x, chunkPosition.z), world.GetLight(chunkPosition));
+        }
+
+        const glm::ivec3 chunkPosition{ TestWorld::FloorDivide(x, g_Width), 0, TestWorld::FloorDivide(z, g_Depth) };
+        const std::vector<glm::ivec3> remeshChunks = lightEngine.UpdateBlock(chunkPosition, { TestWorld::Wrap(x, g_Width), y, TestWorld::Wrap(z, g_Depth) }, oldBlockType);
+
+        LightEngine referenceEngine{ reference.GetLookup() };
+        referenceEngine.LightChunks(reference.GetChunkPositions());
+
+        for (const glm::ivec3& position : chunkPositions)
+        {
+            const LightData& light = world.GetLight(position);
+            const LightData& expectedLight = reference.GetLight(position);
+            const LightData& previousLight = oldLight.at(std::make_tuple(position.x, position.z));
+            for (size_t index = 0; index < ChunkBlocks::m_BlockCount; ++index)
+            {
+                mismatchCount += light.GetSkyLight(index) != expectedLight.GetSkyLight(index) || light.GetBlockLight(index) != expectedLight.GetBlockLight(index);
+
+                // A changed block makes its own chunk and the neighbor across the border it lies on remeshed
+                if (light.GetSkyLight(index) == previousLight.GetSkyLight(index) && light.GetBlockLight(index) == previousLight.GetBlockLight(index))
+                {
+                    continue;
+                }
+                ++changedLightCount;
+                const glm::ivec3 blockPosition = ChunkBlocks::GetPosition(index);
+                missedRemeshCount += !Contains(remeshChunks, position);
+                if (blockPosition.x == 0 && position.x > 0) missedRemeshCount += !Contains(remeshChunks, position + glm::ivec3{ -1, 0, 0 });
+                if (blockPosition.x == g_Width - 1 && position.x < 1) missedRemeshCount += !Contains(remeshChunks, position + glm::ivec3{ 1, 0, 0 });
+                if (blockPosition.z == 0 && position.z > 0) missedRemeshCount += !Contains(remeshChunks, position + glm::ivec3{ 0, 0, -1 });
+                if (blockPosition.z == g_Depth - 1 && position.z < 1) missedRemeshCount += !Contains(remeshChunks, position + glm::ivec3{ 0, 0, 1 });
+            }
+        }
+    }
+    CHECK(mismatchCount == 0);
+    CHECK(missedRemeshCount == 0);
+    // The edits did move light around
+    CHECK(changedLightCount > 0);
+
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+}
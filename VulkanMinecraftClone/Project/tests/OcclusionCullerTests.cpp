@@ -0,0 +1,206 @@
+#include "tests/Test.h"
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+    struct Box
+    {
+        glm::vec3 min;
+        glm::vec3 max;
+    };
+
+    // Camera at the origin looking down -z with the aspect of the depth buffer
+    const glm::vec3 g_CameraPosition{ 0.f };
+
+    void BeginScene(OcclusionCuller& culler, const std::vector<Box>& occluders)
+    {
+        const glm::mat4 projection = glm::perspective(glm::radians(60.f), 2.f, 0.1f, 500.f);
+        const glm::mat4 view = glm::lookAt(g_CameraPosition, glm::vec3{ 0.f, 0.f, -1.f }, glm::vec3{ 0.f, 1.f, 0.f });
+        culler.BeginFrame(projection * view, g_CameraPosition);
+        for (const Box& occluder : occluders)
+        {
+            culler.AddOccluder(occluder.min, occluder.max);
+        }
+        culler.EndOccluders();
+    }
+
+    // Slab test of the segment from the camera to the point, hits right at the point don't block it
+    bool IsSegmentBlocked(const glm::vec3& point, const Box& occluder)
+    {
+        const glm::vec3 direction = point - g_CameraPosition;
+        float enter = 0.f;
+        float exit = 1.f;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (std::abs(direction[axis]) < 1e-6f)
+            {
+                if (g_CameraPosition[axis] < occluder.min[axis] || g_CameraPosition[axis] > occluder.max[axis])
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            float slabEnter = (occluder.min[axis] - g_CameraPosition[axis]) / direction[axis];
+            float slabExit = (occluder.max[axis] - g_CameraPosition[axis]) / direction[axis];
+            if (slabEnter > slabExit)
+            {
+                std::swap(slabEnter, slabExit);
+            }
+            enter = std::max(enter, slabEnter);
+            exit = std::min(exit, slabExit);
+        }
+        return enter <= exit && enter < 0.999f;
+    }
+
+    // The culler only rasterizes the pixel centers, so a point within a pixel of the edge of an occluder may be
+    // hidden by it. A point only counts as seen when the rays a pixel around it on screen are free too.
+    bool IsPointClearlyVisible(const glm::vec3& point, const std::vector<Box>& occluders)
+    {
+        const glm::vec3 forward = glm::normalize(point - g_CameraPosition);
+        const glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3{ 0.f, 1.f, 0.f }));
+        const glm::vec3 up = glm::cross(right, forward);
+        const float pixelOffset = 0.01f * glm::length(point - g_CameraPosition);
+        const std::array<glm::vec3, 5> offsets{ glm::vec3{ 0.f }, right, -right, up, -up };
+        for (const glm::vec3& offset : offsets)
+        {
+            const glm::vec3 target = point + offset * pixelOffset;
+            for (const Box& occluder : occluders)
+            {
+                if (IsSegmentBlocked(target, occluder))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool IsPointInView(const glm::vec3& point)
+    {
+        // 60 degrees vertically and twice as wide, kept a bit inside the edges of the screen
+        const float tanHalfHeight = std::tan(glm::radians(30.f)) * 0.95f;
+        const float distance = -point.z;
+        return distance > 1.f && std::abs(point.y) < distance * tanHalfHeight && std::abs(point.x) < distance * tanHalfHeight * 2.f;
+    }
+
+    bool IsBoxClearlyVisible(const Box& box, const std::vector<Box>& occluders)
+    {
+        constexpr int samples = 6;
+        for (int face = 0; face < 6; ++face)
+        {
+            const int axis = face / 2;
+            for (int u = 0; u < samples; ++u)
+            {
+                for (int v = 0; v < samples; ++v)
+                {
+                    glm::vec3 point;
+                    point[axis] = face % 2 == 0 ? box.min[axis] : box.max[axis];
+                    const int uAxis = (axis + 1) % 3;
+                    const int vAxis = (axis + 2) % 3;
+                    point[uAxis] = glm::mix(box.min[uAxis], box.max[uAxis], 0.01f + 0.98f * u / (samples - 1));
+                    point[vAxis] = glm::mix(box.min[vAxis], box.max[vAxis], 0.01f + 0.98f * v / (samples - 1));
+                    if (IsPointInView(point) && IsPointClearlyVisible(point, occluders))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+}
+
+TEST_CASE(OcclusionCullerWithoutOccluders)
+{
+    OcclusionCuller culler;
+    BeginScene(culler, {});
+    CHECK(culler.TestBox({ -1.f, -1.f, -21.f }, { 1.f, 1.f, -20.f }) == OcclusionCuller::Result::Visible);
+    CHECK(culler.TestBox({ 15.f, -1.f, -21.f }, { 17.f, 1.f, -20.f }) == OcclusionCuller::Result::Visible);
+}
+
+TEST_CASE(OcclusionCullerWall)
+{
+    const std::vector<Box> occluders{ { { -2.f, -2.f, -11.f }, { 2.f, 2.f, -10.f } } };
+    OcclusionCuller culler;
+    BeginScene(culler, occluders);
+
+    // Right behind the wall
+    CHECK(culler.TestBox({ -1.f, -1.f, -31.f }, { 1.f, 1.f, -30.f }) == OcclusionCuller::Result::Occluded);
+    // In front of the wall
+    CHECK(culler.TestBox({ -1.f, -1.f, -6.f }, { 1.f, 1.f, -5.f }) == OcclusionCuller::Result::Visible);
+    // Behind the wall but sticking out past its edge
+    CHECK(culler.TestBox({ 5.f, -1.f, -31.f }, { 7.f, 1.f, -30.f }) == OcclusionCuller::Result::Visible);
+    // Inside the wall is hidden by its front face only where the box is farther away
+    CHECK(culler.TestBox({ -1.f, -1.f, -10.5f }, { 1.f, 1.f, -10.f }) == OcclusionCuller::Result::Visible);
+    // Behind the camera and off to the side
+    CHECK(culler.TestBox({ -1.f, -1.f, 5.f }, { 1.f, 1.f, 6.f }) == OcclusionCuller::Result::FrustumCulled);
+    CHECK(culler.TestBox({ 200.f, -1.f, -21.f }, { 202.f, 1.f, -20.f }) == OcclusionCuller::Result::FrustumCulled);
+    CHECK(!culler.IsInFrustum({ -1.f, -1.f, 5.f }, { 1.f, 1.f, 6.f }));
+    // Crossing the near plane
+    CHECK(culler.TestBox({ -1.f, -1.f, -1.f }, { 1.f, 1.f, 1.f }) == OcclusionCuller::Result::Visible);
+}
+
+TEST_CASE(OcclusionCullerCameraInsideOccluder)
+{
+    // Every face of an occluder around the camera crosses the near plane and is skipped
+    const std::vector<Box> occluders{ { { -5.f, -5.f, -5.f }, { 5.f, 5.f, 5.f } } };
+    OcclusionCuller culler;
+    BeginScene(culler, occluders);
+    CHECK(culler.TestBox({ -1.f, -1.f, -31.f }, { 1.f, 1.f, -30.f }) == OcclusionCuller::Result::Visible);
+}
+
+// A box may only be reported occluded when no point of it can be seen past the occluders
+TEST_CASE(OcclusionCullerIsConservative)
+{
+    std::mt19937 random{ 26 };
+    std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+    const auto randomBox = [&](float minZ, float maxZ, float minSize, float maxSize)
+    {
+        const glm::vec3 size{ minSize + unit(random) * (maxSize - minSize), minSize + unit(random) * (maxSize - minSize), minSize + unit(random) * (maxSize - minSize) };
+        const float z = minZ + unit(random) * (maxZ - minZ);
+        const glm::vec3 min{ (unit(random) * 2.f - 1.f) * -z, (unit(random) * 2.f - 1.f) * -z * 0.5f, z };
+        return Box{ min, min + size };
+    };
+
+    int testedCount = 0;
+    int occludedCount = 0;
+    int wrongCount = 0;
+    for (int scene = 0; scene < 40; ++scene)
+    {
+        std::vector<Box> occluders;
+        for (int i = 0; i < 12; ++i)
+        {
+            occluders.push_back(randomBox(-20.f, -8.f, 2.f, 10.f));
+        }
+
+        OcclusionCuller culler;
+        BeginScene(culler, occluders);
+        for (int i = 0; i < 100; ++i)
+        {
+            const Box box = randomBox(-60.f, -12.f, 1.f, 4.f);
+            if (culler.TestBox(box.min, box.max) != OcclusionCuller::Result::Occluded)
+            {
+                continue;
+            }
+
+            ++occludedCount;
+            if (IsBoxClearlyVisible(box, occluders))
+            {
+                ++wrongCount;
+            }
+        }
+        testedCount += 100;
+    }
+
+    std::cout << "  " << occludedCount << " of " << testedCount << " boxes occluded, " << wrongCount << " of them visible\n";
+    CHECK(wrongCount == 0);
+    // The scenes are dense enough that the culler has to hide something
+    CHECK(occludedCount > testedCount / 10);
+}
@@ -0,0 +1,219 @@
+#include "tests/Test.h"
+#include "PackedVoxelMesher.h"
+#include "LandMesher.h"
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <tuple>
+
+namespace
+{
+    constexpr int g_Width = CHUNK_WIDTH;
+    constexpr int g_Height = CHUNK_HEIGHT;
+    constexpr int g_Depth = CHUNK_DEPTH;
+
+    // A face as both meshers emit it, the corners are sorted because the land mesher rotates them for ambient occlusion.
+    // Positions are in half blocks so they stay integers.
+    struct Face
+    {
+        std::array<std::array<int, 3>, 4> corners;
+        std::array<int, 3> normal;
+        int layer;
+
+        bool operator<(const Face& other) const
+        {
+            return std::tie(corners, normal, layer) < std::tie(other.corners, other.normal, other.layer);
+        }
+
+        bool operator==(const Face& other) const
+        {
+            return std::tie(corners, normal, layer) == std::tie(other.corners, other.normal, other.layer);
+        }
+    };
+
+    template<typename VertexIterator>
+    Face ToFace(VertexIterator pCorners)
+    {
+        Face face{};
+        for (int corner = 0; corner < 4; ++corner)
+        {
+            const glm::vec3& position = pCorners[corner].position;
+            face.corners[corner] = { static_cast<int>(position.x * 2.f), static_cast<int>(position.y * 2.f), static_cast<int>(position.z * 2.f) };
+        }
+        std::sort(face.corners.begin(), face.corners.end());
+        const glm::vec3& normal = pCorners[0].normal;
+        face.normal = { static_cast<int>(normal.x), static_cast<int>(normal.y), static_cast<int>(normal.z) };
+        face.layer = static_cast<int>(pCorners[0].texCoord.z);
+        return face;
+    }
+
+    std::vector<Face> MeshLand(const ChunkBlocks& blocks, bool isAmbientOcclusionEnabled)
+    {
+        static FaceVisibility faceVisibility{ g_Height, g_Depth };
+        TaggedVector<Vertex, MemoryTag::Transient> vertices;
+        LandMesher::SectionRanges sectionRanges{};
+        LandMesher::Build(blocks, faceVisibility, isAmbientOcclusionEnabled,
+            [](int, int, int) { return glm::vec2{ 1.f, 0.f }; }, vertices, sectionRanges);
+
+        std::vector<Face> faces;
+        for (size_t first = 0; first < vertices.size(); first += 4)
+        {
+            faces.push_back(ToFace(vertices.begin() + first));
+        }
+        std::sort(faces.begin(), faces.end());
+        return faces;
+    }
+
+    std::vector<Face> MeshPacked(const ChunkBlocks& blocks, const ChunkBlocks* pEast, const ChunkBlocks* pWest, const ChunkBlocks* pNorth, const ChunkBlocks* pSouth)
+    {
+        const PackedVoxelMesher::PackedVoxels voxels = PackedVoxelMesher::PackVoxels(blocks, pEast, pWest, pNorth, pSouth);
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        PackedVoxelMesher::MeshOnCpu(voxels, PackedVoxelMesher::CreateFaceTextures(), vertices, indices);
+        CHECK(indices.size() == vertices.size() / 4 * 6);
+
+        std::vector<Face> faces;
+        for (size_t first = 0; first < vertices.size(); first += 4)
+        {
+            faces.push_back(ToFace(vertices.begin() + first));
+        }
+        std::sort(faces.begin(), faces.end());
+        return faces;
+    }
+
+    void FillRandom(ChunkBlocks& blocks, uint32_t seed)
+    {
+        std::mt19937 random{ seed };
+        constexpr std::array<BlockType, 8> blockTypes{ BlockType::GrassBlock, BlockType::Stone, BlockType::Dirt, BlockType::Sand,
+            BlockType::Log, BlockType::Leaves, BlockType::Water, BlockType::Air };
+        for (int z = 0; z < g_Depth; ++z)
+        {
+            for (int y = 0; y < g_Height; ++y)
+            {
+                for (int x = 0; x < g_Width; ++x)
+                {
+                    blocks.Set(x, y, z, random() % 3 == 0 ? blockTypes[random() % blockTypes.size()] : BlockType::Air);
+                }
+            }
+        }
+    }
+}
+
+// Without neighbors the compute shader reference and the land mesher see air past the border, so they emit the same faces
+TEST_CASE(PackedVoxelMesherMatchesLandMesher)
+{
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+    auto pBlocks = std::make_unique<ChunkBlocks>();
+
+    // A single block shows every face
+    pBlocks->Set(5, 20, 7, BlockType::GrassBlock);
+    std::vector<Face> packedFaces = MeshPacked(*pBlocks, nullptr, nullptr, nullptr, nullptr);
+    CHECK(packedFaces.size() == FACE_COUNT);
+    CHECK(packedFaces == MeshLand(*pBlocks, false));
+
+    // Terrain like fixture, a stone floor with a dirt and grass top, a pond and a tree
+    for (int z = 0; z < g_Depth; ++z)
+    {
+        for (int x = 0; x < g_Width; ++x)
+        {
+            for (int y = 0; y < 40; ++y)
+            {
+                pBlocks->Set(x, y, z, y < 36 ? BlockType::Stone : (y < 39 ? BlockType::Dirt : BlockType::GrassBlock));
+            }
+        }
+    }
+    for (int z = 10; z < 20; ++z)
+    {
+        for (int x = 10; x < 20; ++x)
+        {
+            pBlocks->Set(x, 39, z, BlockType::Water);
+        }
+    }
+    for (int y = 40; y < 45; ++y)
+    {
+        pBlocks->Set(30, y, 30, BlockType::Log);
+    }
+    for (int z = 28; z <= 32; ++z)
+    {
+        for (int x = 28; x <= 32; ++x)
+        {
+            if (x != 30 || z != 30)
+            {
+                pBlocks->Set(x, 44, z, BlockType::Leaves);
+            }
+        }
+    }
+    packedFaces = MeshPacked(*pBlocks, nullptr, nullptr, nullptr, nullptr);
+    CHECK(!packedFaces.empty());
+    CHECK(packedFaces == MeshLand(*pBlocks, false));
+
+    // Ambient occlusion only rotates the corners of the land quads, the faces stay the same
+    for (uint32_t seed : { 3u, 29u })
+    {
+        FillRandom(*pBlocks, seed);
+        packedFaces = MeshPacked(*pBlocks, nullptr, nullptr, nullptr, nullptr);
+        CHECK(packedFaces == MeshLand(*pBlocks, false));
+        CHECK(packedFaces == MeshLand(*pBlocks, true));
+    }
+}
+
+// The land mesher treats everything past the border as air, the packed border hides the faces against opaque neighbors
+TEST_CASE(PackedVoxelMesherHidesBorderFaces)
+{
+    CHECK(BlockRegistry::GetInstance().Load("textures/blockdata.json"));
+    const BlockRegistry& registry = BlockRegistry::GetInstance();
+    auto pBlocks = std::make_unique<ChunkBlocks>();
+    auto pNeighbor = std::make_unique<ChunkBlocks>();
+    FillRandom(*pBlocks, 7);
+    FillRandom(*pNeighbor, 11);
+
+    const std::vector<Face> landFaces = MeshLand(*pBlocks, false);
+    for (int direction : { static_cast<int>(Direction::East), static_cast<int>(Direction::West), static_cast<int>(Direction::North), static_cast<int>(Direction::South) })
+    {
+        const ChunkBlocks* pEast = direction == static_cast<int>(Direction::East) ? pNeighbor.get() : nullptr;
+        const ChunkBlocks* pWest = direction == static_cast<int>(Direction::West) ? pNeighbor.get() : nullptr;
+        const ChunkBlocks* pNorth = direction == static_cast<int>(Direction::North) ? pNeighbor.get() : nullptr;
+        const ChunkBlocks* pSouth = direction == static_cast<int>(Direction::South) ? pNeighbor.get() : nullptr;
+        const std::vector<Face> packedFaces = MeshPacked(*pBlocks, pEast, pWest, pNorth, pSouth);
+
+        // Every land face stays unless it faces the neighbor and the block across the border hides it
+        const auto& normal = FACE_TABLE[direction].normal;
+        std::vector<Face> expectedFaces;
+        int hiddenFaceCount = 0;
+        for (const Face& face : landFaces)
+        {
+            if (face.normal != std::array<int, 3>{ normal[0], normal[1], normal[2] })
+            {
+                expectedFaces.push_back(face);
+                continue;
+            }
+
+            // The face lies half a block past the center of its block, in half blocks the opposite corners add up to four times the center
+            const int x = (face.corners[0][0] + face.corners[3][0] - 2 * normal[0]) / 4;
+            const int y = (face.corners[0][1] + face.corners[3][1]) / 4;
+            const int z = (face.corners[0][2] + face.corners[3][2] - 2 * normal[2]) / 4;
+            const bool isOnBorder = (normal[0] > 0 && x == g_Width - 1) || (normal[0] < 0 && x == 0)
+                || (normal[2] > 0 && z == g_Depth - 1) || (normal[2] < 0 && z == 0);
+            if (!isOnBorder)
+            {
+                expectedFaces.push_back(face);
+                continue;
+            }
+
+            const BlockType blockType = pBlocks->Get(x, y, z);
+            const BlockType neighborType = pNeighbor->Get(normal[0] != 0 ? g_Width - 1 - x : x, y, normal[2] != 0 ? g_Depth - 1 - z : z);
+            const bool isHidden = registry.IsOpaque(neighborType) || (registry.CullsSameType(blockType) && neighborType == blockType);
+            if (isHidden)
+            {
+                ++hiddenFaceCount;
+            }
+            else
+            {
+                expectedFaces.push_back(face);
+            }
+        }
+
+        CHECK(hiddenFaceCount > 0);
+        CHECK(packedFaces == expectedFaces);
+    }
+}
@@ -0,0 +1,69 @@
+#include "tests/Test.h"
+#include "QuadIndexBuffer.h"
+#include "FaceTable.h"
+#include "BlockMesh.h"
+#include <vector>
+
+TEST_CASE(QuadIndexBufferPattern)
+{
+    const std::vector<uint16_t> indices = QuadIndexBuffer::CreateIndices(QuadIndexBuffer::m_MaxQuadsPerDraw);
+    CHECK(indices.size() == static_cast<size_t>(QuadIndexBuffer::m_MaxQuadsPerDraw) * QuadIndexBuffer::m_IndicesPerQuad);
+    CHECK((std::vector<uint16_t>(indices.begin(), indices.begin() + 12) == std::vector<uint16_t>{ 0, 1, 2, 2, 3, 0, 4, 5, 6, 6, 7, 4 }));
+    // The last quad uses the last 16 bit vertex
+    CHECK(indices[indices.size() - 2] == UINT16_MAX);
+    CHECK(indices.back() == UINT16_MAX - 3);
+}
+
+// WriteFaceVertices rotates the corners of a face instead of picking its own indices, every ambient occlusion
+// combination still has to give the two triangles the per face indices used to give
+TEST_CASE(QuadIndexBufferMatchesPerFaceIndices)
+{
+    const std::vector<uint16_t> indices = QuadIndexBuffer::CreateIndices(1);
+    for (int face = 0; face < FACE_COUNT; ++face)
+    {
+        std::vector<Vertex> corners;
+        WriteFaceVertices(corners, face, glm::vec3{ 0.f }, 0.f, { 3, 3, 3, 3 }, glm::vec2{ 1.f, 0.f });
+        for (int levels = 0; levels < 256; ++levels)
+        {
+            const std::array<uint8_t, 4> ambientOcclusion{ static_cast<uint8_t>(levels & 3), static_cast<uint8_t>((levels >> 2) & 3),
+                static_cast<uint8_t>((levels >> 4) & 3), static_cast<uint8_t>((levels >> 6) & 3) };
+            std::vector<Vertex> vertices;
+            WriteFaceVertices(vertices, face, glm::vec3{ 0.f }, 0.f, ambientOcclusion, glm::vec2{ 1.f, 0.f });
+
+            const size_t firstCorner = ambientOcclusion[0] + ambientOcclusion[2] > ambientOcclusion[1] + ambientOcclusion[3] ? 1 : 0;
+            const std::array<size_t, 6> perFaceIndices{ firstCorner, firstCorner + 1, firstCorner + 2, firstCorner + 2, (firstCorner + 3) % 4, firstCorner };
+            for (size_t index = 0; index < indices.size(); ++index)
+            {
+                CHECK(vertices[indices[index]].position == corners[perFaceIndices[index]].position);
+            }
+        }
+    }
+}
+
+TEST_CASE(QuadIndexBufferSplitsDraws)
+{
+    struct Draw
+    {
+        uint32_t indexCount;
+        int32_t vertexOffset;
+    };
+    std::vector<Draw> draws;
+    const auto record = [&draws](uint32_t indexCount, int32_t vertexOffset) { draws.push_back({ indexCount, vertexOffset }); };
+
+    CHECK(QuadIndexBuffer::SplitDraws(10, 0, record) == 0);
+    CHECK(draws.empty());
+
+    // Exactly one draw worth of quads
+    CHECK(QuadIndexBuffer::SplitDraws(10, QuadIndexBuffer::m_MaxQuadsPerDraw, record) == 1);
+    CHECK(draws[0].indexCount == QuadIndexBuffer::m_MaxQuadsPerDraw * QuadIndexBuffer::m_IndicesPerQuad);
+    CHECK(draws[0].vertexOffset == 40);
+
+    // More quads than the 16 bit indices reach continue where the previous draw stopped
+    draws.clear();
+    const uint32_t quadCount = 2 * QuadIndexBuffer::m_MaxQuadsPerDraw + 100;
+    CHECK(QuadIndexBuffer::SplitDraws(10, quadCount, record) == 3);
+    CHECK(draws.size() == 3);
+    CHECK(draws[1].vertexOffset == static_cast<int32_t>((10 + QuadIndexBuffer::m_MaxQuadsPerDraw) * QuadIndexBuffer::m_VerticesPerQuad));
+    CHECK(draws[2].vertexOffset == static_cast<int32_t>((10 + 2 * QuadIndexBuffer::m_MaxQuadsPerDraw) * QuadIndexBuffer::m_VerticesPerQuad));
+    CHECK(draws[2].indexCount == 100 * QuadIndexBuffer::m_IndicesPerQuad);
+}
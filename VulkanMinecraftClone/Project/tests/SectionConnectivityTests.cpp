@@ -0,0 +1,193 @@
+#include "tests/Test.h"
+#include "SectionConnectivity.h"
+#include "BlockRegistry.h"
+#include <vector>
+
+namespace
+{
+    constexpr int g_Size = SectionConnectivity::m_SectionSize;
+
+    int GetFace(Direction direction) { return static_cast<int>(direction); }
+
+    int GetIndex(int x, int y, int z) { return x + y * g_Size + z * g_Size * g_Size; }
+
+    SectionConnectivity::OpacityGrid CreateGrid(bool isOpaque)
+    {
+        SectionConnectivity::OpacityGrid grid;
+        grid.fill(isOpaque);
+        return grid;
+    }
+
+    // A row of sections along x, y and z with the connectivity of every section, the search can't leave it
+    struct SectionWorld
+    {
+        struct Node
+        {
+            int x;
+            int y;
+            int z;
+            int entryFace;
+            uint8_t travelledFaces;
+        };
+
+        int sizeX;
+        int sizeY;
+        int sizeZ;
+        std::vector<uint16_t> connectivity;
+        std::vector<bool> isVisited;
+
+        SectionWorld(int x, int y, int z)
+            : sizeX{ x }, sizeY{ y }, sizeZ{ z }
+            , connectivity(x * y * z, SectionConnectivity::m_AllConnected)
+            , isVisited(x * y * z, false)
+        {
+        }
+
+        int GetSection(int x, int y, int z) const { return x + y * sizeX + z * sizeX * sizeY; }
+
+        int Search(int startX, int startY, int startZ)
+        {
+            std::vector<Node> queue{ { startX, startY, startZ, -1, 0 } };
+            isVisited[GetSection(startX, startY, startZ)] = true;
+            SectionConnectivity::Search(queue,
+                [this](const Node& node) { return connectivity[GetSection(node.x, node.y, node.z)]; },
+                [this](const Node& node, int face, Node& neighbor)
+                {
+                    const std::array<int, 3> offset = SectionConnectivity::GetFaceOffset(face);
+                    neighbor.x = node.x + offset[0];
+                    neighbor.y = node.y + offset[1];
+                    neighbor.z = node.z + offset[2];
+                    if (neighbor.x < 0 || neighbor.x >= sizeX || neighbor.y < 0 || neighbor.y >= sizeY || neighbor.z < 0 || neighbor.z >= sizeZ)
+                    {
+                        return false;
+                    }
+
+                    const int section = GetSection(neighbor.x, neighbor.y, neighbor.z);
+                    if (isVisited[section])
+                    {
+                        return false;
+                    }
+                    isVisited[section] = true;
+                    return true;
+                });
+            return static_cast<int>(queue.size());
+        }
+    };
+}
+
+TEST_CASE(SectionConnectivityOpenAndSolid)
+{
+    CHECK(SectionConnectivity::Calculate(CreateGrid(false)) == SectionConnectivity::m_AllConnected);
+    CHECK(SectionConnectivity::Calculate(CreateGrid(true)) == 0);
+
+    // A pocket of air that touches no face connects nothing
+    SectionConnectivity::OpacityGrid grid = CreateGrid(true);
+    grid[GetIndex(7, 7, 7)] = false;
+    grid[GetIndex(8, 7, 7)] = false;
+    CHECK(SectionConnectivity::Calculate(grid) == 0);
+}
+
+TEST_CASE(SectionConnectivityWall)
+{
+    // A wall through the middle of the section along x splits it into a west and an east half
+    SectionConnectivity::OpacityGrid grid = CreateGrid(false);
+    for (int z = 0; z < g_Size; ++z)
+    {
+        for (int y = 0; y < g_Size; ++y)
+        {
+            grid[GetIndex(8, y, z)] = true;
+        }
+    }
+
+    const uint16_t connectivity = SectionConnectivity::Calculate(grid);
+    CHECK(!SectionConnectivity::AreConnected(connectivity, GetFace(Direction::West), GetFace(Direction::East)));
+    CHECK(SectionConnectivity::AreConnected(connectivity, GetFace(Direction::West), GetFace(Direction::Up)));
+    CHECK(SectionConnectivity::AreConnected(connectivity, GetFace(Direction::East), GetFace(Direction::North)));
+    CHECK(SectionConnectivity::AreConnected(connectivity, GetFace(Direction::Down), GetFace(Direction::Up)));
+    CHECK(SectionConnectivity::AreConnected(connectivity, GetFace(Direction::North), GetFace(Direction::South)));
+}
+
+TEST_CASE(SectionConnectivityTunnel)
+{
+    // A shaft of air straight through solid stone from the bottom to the top
+    SectionConnectivity::OpacityGrid grid = CreateGrid(true);
+    for (int y = 0; y < g_Size; ++y)
+    {
+        grid[GetIndex(5, y, 9)] = false;
+    }
+
+    const uint16_t connectivity = SectionConnectivity::Calculate(grid);
+    for (int faceA = 0; faceA < SectionConnectivity::m_FaceCount; ++faceA)
+    {
+        for (int faceB = faceA + 1; faceB < SectionConnectivity::m_FaceCount; ++faceB)
+        {
+            const bool isShaft = faceA == GetFace(Direction::Down) && faceB == GetFace(Direction::Up);
+            CHECK(SectionConnectivity::AreConnected(connectivity, faceA, faceB) == isShaft);
+        }
+    }
+
+    // Bending the shaft to the east at the top connects the bottom to the east face instead
+    grid[GetIndex(5, g_Size - 1, 9)] = true;
+    for (int x = 5; x < g_Size; ++x)
+    {
+        grid[GetIndex(x, g_Size - 2, 9)] = false;
+    }
+    const uint16_t bentConnectivity = SectionConnectivity::Calculate(grid);
+    CHECK(SectionConnectivity::AreConnected(bentConnectivity, GetFace(Direction::Down), GetFace(Direction::East)));
+    CHECK(!SectionConnectivity::AreConnected(bentConnectivity, GetFace(Direction::Down), GetFace(Direction::Up)));
+}
+
+TEST_CASE(SectionSearchOpenWorld)
+{
+    // Every open section can be reached from anywhere without turning back
+    SectionWorld world{ 4, 4, 4 };
+    CHECK(world.Search(1, 2, 1) == 64);
+
+    SectionWorld cornerWorld{ 4, 4, 4 };
+    CHECK(cornerWorld.Search(0, 0, 0) == 64);
+}
+
+TEST_CASE(SectionSearchStopsAtSolidSections)
+{
+    // A solid section is seen but nothing behind it
+    SectionWorld world{ 5, 1, 1 };
+    world.connectivity[world.GetSection(2, 0, 0)] = 0;
+    CHECK(world.Search(0, 0, 0) == 3);
+    CHECK(world.isVisited[world.GetSection(2, 0, 0)]);
+    CHECK(!world.isVisited[world.GetSection(3, 0, 0)]);
+}
+
+TEST_CASE(SectionSearchFollowsTheCave)
+{
+    // Sections that only connect west to east form a cave along x between solid stone
+    SectionWorld world{ 4, 3, 1 };
+    SectionConnectivity::OpacityGrid tunnel = CreateGrid(true);
+    for (int x = 0; x < g_Size; ++x)
+    {
+        tunnel[GetIndex(x, 8, 8)] = false;
+    }
+    const uint16_t tunnelConnectivity = SectionConnectivity::Calculate(tunnel);
+    CHECK(SectionConnectivity::AreConnected(tunnelConnectivity, GetFace(Direction::West), GetFace(Direction::East)));
+
+    for (int x = 0; x < 4; ++x)
+    {
+        world.connectivity[world.GetSection(x, 0, 0)] = 0;
+        world.connectivity[world.GetSection(x, 1, 0)] = tunnelConnectivity;
+        world.connectivity[world.GetSection(x, 2, 0)] = 0;
+    }
+
+    // From inside the cave every section of it is reached, along with the stone right above and below the camera
+    CHECK(world.Search(0, 1, 0) == 6);
+    CHECK(world.isVisited[world.GetSection(3, 1, 0)]);
+    CHECK(!world.isVisited[world.GetSection(3, 2, 0)]);
+}
+
+TEST_CASE(SectionSearchNeverTurnsBack)
+{
+    // The only way around the solid section at x 1 would be a path that goes south and then north again
+    SectionWorld world{ 3, 1, 2 };
+    world.connectivity[world.GetSection(1, 0, 0)] = 0;
+    world.Search(0, 0, 0);
+    CHECK(world.isVisited[world.GetSection(2, 0, 1)]);
+    CHECK(!world.isVisited[world.GetSection(2, 0, 0)]);
+}
@@ -0,0 +1,133 @@
+#include "tests/Test.h"
+#include "SectionCuller.h"
+#include "QuadIndexBuffer.h"
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace
+{
+    glm::mat4 CreateViewProjection(const glm::vec3& position, const glm::vec3& target)
+    {
+        const glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 0.1f, 300.f);
+        return projection * glm::lookAt(position, target, glm::vec3{ 0.f, 1.f, 0.f });
+    }
+
+    // Brute force, the box is culled when all eight corners are outside the same clip plane
+    bool IsBoxVisibleByOutcodes(const glm::mat4& viewProjection, const glm::vec3& min, const glm::vec3& max)
+    {
+        int sharedOutcode = 0x3F;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            const glm::vec3 position{ corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z };
+            const glm::vec4 clip = viewProjection * glm::vec4(position, 1.f);
+            int outcode = 0;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                outcode |= (clip[axis] < -clip.w) << (axis * 2);
+                outcode |= (clip[axis] > clip.w) << (axis * 2 + 1);
+            }
+            sharedOutcode &= outcode;
+        }
+        return sharedOutcode == 0;
+    }
+
+    // Camera positions and targets around and inside a field of chunk sections
+    struct View
+    {
+        glm::vec3 position;
+        glm::vec3 target;
+    };
+
+    const std::array<View, 5> g_Views{ {
+        { { 0.f, 70.f, 0.f }, { 100.f, 60.f, 30.f } },
+        { { 0.f, 70.f, 0.f }, { -20.f, 0.f, -100.f } },
+        { { 50.f, 200.f, 50.f }, { 50.f, 0.f, 51.f } },
+        { { -100.f, 10.f, 40.f }, { 100.f, 80.f, 40.f } },
+        { { 30.f, 30.f, 30.f }, { 29.f, 31.f, 30.5f } } } };
+
+    std::vector<SectionCuller::SectionRecord> CreateRecords(std::mt19937& random, size_t slotCount)
+    {
+        std::uniform_real_distribution<float> position{ -200.f, 200.f };
+        std::uniform_real_distribution<float> size{ 0.5f, 32.f };
+        std::vector<SectionCuller::SectionRecord> records(slotCount * SectionCuller::m_SectionsPerChunk);
+        uint32_t firstQuad = 0;
+        for (SectionCuller::SectionRecord& record : records)
+        {
+            record.min = { position(random), position(random) / 2.f, position(random) };
+            record.max = record.min + glm::vec3{ size(random), size(random), size(random) };
+            // Some sections have no faces at all
+            record.quadCount = random() % 4 == 0 ? 0 : static_cast<uint32_t>(random() % 3000);
+            record.firstQuad = firstQuad;
+            firstQuad += record.quadCount;
+        }
+        return records;
+    }
+}
+
+TEST_CASE(SectionCullerMatchesOutcodes)
+{
+    std::mt19937 random{ 44 };
+    const std::vector<SectionCuller::SectionRecord> records = CreateRecords(random, 64);
+    int visibleCount = 0;
+    int mismatchCount = 0;
+    for (const View& view : g_Views)
+    {
+        const glm::mat4 viewProjection = CreateViewProjection(view.position, view.target);
+        const SectionCuller::FrustumPlanes planes = SectionCuller::ExtractFrustumPlanes(viewProjection);
+        for (const SectionCuller::SectionRecord& record : records)
+        {
+            const bool isVisible = SectionCuller::IsBoxVisible(planes, record.min, record.max);
+            mismatchCount += isVisible != IsBoxVisibleByOutcodes(viewProjection, record.min, record.max);
+            visibleCount += isVisible;
+        }
+    }
+    CHECK(mismatchCount == 0);
+    // Both outcomes are covered
+    CHECK(visibleCount > 0 && visibleCount < static_cast<int>(records.size() * g_Views.size()));
+
+    // A box around the camera is always visible, one behind it never
+    const SectionCuller::FrustumPlanes planes = SectionCuller::ExtractFrustumPlanes(CreateViewProjection(glm::vec3{ 0.f }, glm::vec3{ 0.f, 0.f, -1.f }));
+    CHECK(SectionCuller::IsBoxVisible(planes, glm::vec3{ -1.f }, glm::vec3{ 1.f }));
+    CHECK(!SectionCuller::IsBoxVisible(planes, glm::vec3{ -1.f, -1.f, 5.f }, glm::vec3{ 1.f, 1.f, 6.f }));
+}
+
+// The draw commands the compute shader has to produce, per slot the visible sections with faces first
+TEST_CASE(SectionCullerDrawCommands)
+{
+    std::mt19937 random{ 45 };
+    constexpr size_t slotCount = 16;
+    const std::vector<SectionCuller::SectionRecord> records = CreateRecords(random, slotCount);
+    const glm::mat4 viewProjection = CreateViewProjection(g_Views[0].position, g_Views[0].target);
+
+    std::vector<uint32_t> drawCounts;
+    std::vector<VkDrawIndexedIndirectCommand> drawCommands;
+    SectionCuller::Cull(records, SectionCuller::ExtractFrustumPlanes(viewProjection), drawCounts, drawCommands);
+    CHECK(drawCounts.size() == slotCount);
+    CHECK(drawCommands.size() == records.size());
+
+    for (size_t slot = 0; slot < slotCount; ++slot)
+    {
+        uint32_t drawIndex = 0;
+        for (size_t section = 0; section < SectionCuller::m_SectionsPerChunk; ++section)
+        {
+            const SectionCuller::SectionRecord& record = records[slot * SectionCuller::m_SectionsPerChunk + section];
+            if (record.quadCount == 0 || !IsBoxVisibleByOutcodes(viewProjection, record.min, record.max))
+            {
+                continue;
+            }
+
+            const VkDrawIndexedIndirectCommand& command = drawCommands[slot * SectionCuller::m_SectionsPerChunk + drawIndex++];
+            CHECK(command.indexCount == record.quadCount * QuadIndexBuffer::m_IndicesPerQuad);
+            CHECK(command.instanceCount == 1 && command.firstIndex == 0 && command.firstInstance == 0);
+            CHECK(command.vertexOffset == static_cast<int32_t>(record.firstQuad * QuadIndexBuffer::m_VerticesPerQuad));
+        }
+        CHECK(drawCounts[slot] == drawIndex);
+
+        // The commands past the count stay empty
+        for (size_t index = drawIndex; index < SectionCuller::m_SectionsPerChunk; ++index)
+        {
+            CHECK(drawCommands[slot * SectionCuller::m_SectionsPerChunk + index].instanceCount == 0);
+        }
+    }
+}
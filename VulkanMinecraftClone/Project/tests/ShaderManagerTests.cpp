@@ -0,0 +1,159 @@
+#include "tests/Test.h"
+#include "ShaderManager.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::filesystem::path GetTestDirectory()
+    {
+        return std::filesystem::temp_directory_path() / "VulkanMinecraftCloneShaderTests";
+    }
+
+    void WriteFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file << content;
+    }
+
+    // Stands in for glslc, writes the smallest module IsValidSpirv accepts and counts the compiles
+    struct FakeCompiler
+    {
+        int compileCount{};
+        bool isFailing{};
+        bool isWritingGarbage{};
+
+        SpirvCache::Compiler Get()
+        {
+            return [this](const std::string&, const std::string& outputPath)
+                {
+                    ++compileCount;
+                    if (isFailing)
+                    {
+                        // glslc can leave a partial file behind when it fails
+                        WriteFile(outputPath, "partial");
+                        return false;
+                    }
+
+                    const std::vector<uint32_t> words{ isWritingGarbage ? 0xDEADBEEF : 0x07230203, 0x00010000, 0, 1, 0 };
+                    std::ofstream file{ outputPath, std::ios::binary | std::ios::trunc };
+                    file.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(words.size() * sizeof(uint32_t)));
+                    return true;
+                };
+        }
+    };
+
+    size_t CountCacheFiles(const std::filesystem::path& directory)
+    {
+        size_t count = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+        {
+            count += entry.is_regular_file() ? 1 : 0;
+        }
+        return count;
+    }
+}
+
+// The cache is keyed by the content, not the path or the modification time
+TEST_CASE(SpirvCacheHitsOnTheSameContent)
+{
+    const std::filesystem::path directory = GetTestDirectory();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "shaders");
+    const std::filesystem::path sourcePath = directory / "shaders" / "shaderLand.frag";
+
+    FakeCompiler compiler;
+    SpirvCache cache{ (directory / "cache").string(), compiler.Get() };
+
+    WriteFile(sourcePath, "void main() {}\n");
+    bool isCached = true;
+    const std::string firstPath = cache.Compile(sourcePath.string(), isCached);
+    CHECK(!firstPath.empty() && !isCached);
+    CHECK(compiler.compileCount == 1);
+    CHECK(SpirvCache::IsValidSpirv(firstPath));
+
+    // Saving the same content again doesn't compile
+    WriteFile(sourcePath, "void main() {}\n");
+    CHECK(cache.Compile(sourcePath.string(), isCached) == firstPath && isCached);
+    CHECK(compiler.compileCount == 1);
+
+    // An edit compiles into its own entry, reverting it finds the first one again
+    WriteFile(sourcePath, "void main() { discard; }\n");
+    const std::string editedPath = cache.Compile(sourcePath.string(), isCached);
+    CHECK(!editedPath.empty() && editedPath != firstPath && !isCached);
+    CHECK(compiler.compileCount == 2);
+    WriteFile(sourcePath, "void main() {}\n");
+    CHECK(cache.Compile(sourcePath.string(), isCached) == firstPath && isCached);
+    CHECK(compiler.compileCount == 2);
+
+    // The entries outlive the cache object, a restart finds them on disk
+    SpirvCache restartedCache{ (directory / "cache").string(), compiler.Get() };
+    CHECK(restartedCache.Compile(sourcePath.string(), isCached) == firstPath && isCached);
+    CHECK(compiler.compileCount == 2);
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST_CASE(SpirvCacheKey)
+{
+    // glslc picks the stage from the extension, the same source as another stage is another entry
+    const std::string source = "void main() {}\n";
+    CHECK(SpirvCache::GetKey("shader.vert", source) != SpirvCache::GetKey("shader.frag", source));
+    CHECK(SpirvCache::GetKey("shader.vert", source) == SpirvCache::GetKey("shader.vert", source));
+    CHECK(SpirvCache::GetKey("shader.vert", source) != SpirvCache::GetKey("shader.vert", source + " "));
+    // The name and the source don't run into each other
+    CHECK(SpirvCache::GetKey("a.vert", "b") != SpirvCache::GetKey("a.ver", "tb"));
+
+    SpirvCache cache{ (GetTestDirectory() / "cache").string(), {} };
+    const uint64_t key = SpirvCache::GetKey("shader.vert", source);
+    CHECK(cache.GetPath(key) != cache.GetPath(SpirvCache::GetKey("shader.frag", source)));
+    CHECK(std::filesystem::path(cache.GetPath(key)).extension() == ".spv");
+    std::filesystem::remove_all(GetTestDirectory());
+}
+
+// A failed compile leaves nothing behind that a later lookup could take for a hit
+TEST_CASE(SpirvCacheRejectsFailedCompiles)
+{
+    const std::filesystem::path directory = GetTestDirectory();
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::filesystem::path sourcePath = directory / "shaderWater.vert";
+    const std::filesystem::path cacheDirectory = directory / "cache";
+
+    FakeCompiler compiler;
+    SpirvCache cache{ cacheDirectory.string(), compiler.Get() };
+    WriteFile(sourcePath, "syntax error\n");
+
+    bool isCached = true;
+    compiler.isFailing = true;
+    CHECK(cache.Compile(sourcePath.string(), isCached).empty());
+    CHECK(CountCacheFiles(cacheDirectory) == 0);
+
+    // Output that isn't SPIR-V is rejected the same way
+    compiler.isFailing = false;
+    compiler.isWritingGarbage = true;
+    CHECK(cache.Compile(sourcePath.string(), isCached).empty());
+    CHECK(CountCacheFiles(cacheDirectory) == 0);
+    CHECK(compiler.compileCount == 2);
+
+    // Once the compiler works the same content compiles
+    compiler.isWritingGarbage = false;
+    const std::string spirvPath = cache.Compile(sourcePath.string(), isCached);
+    CHECK(!spirvPath.empty() && !isCached);
+    CHECK(CountCacheFiles(cacheDirectory) == 1);
+
+    // A damaged entry is compiled again instead of handed to the pipelines
+    WriteFile(spirvPath, "broken");
+    CHECK(cache.Compile(sourcePath.string(), isCached) == spirvPath && !isCached);
+    CHECK(compiler.compileCount == 4);
+    CHECK(SpirvCache::IsValidSpirv(spirvPath));
+
+    // A missing source never reaches the compiler
+    CHECK(cache.Compile((directory / "missing.vert").string(), isCached).empty());
+    CHECK(compiler.compileCount == 4);
+
+    std::filesystem::remove_all(directory);
+}
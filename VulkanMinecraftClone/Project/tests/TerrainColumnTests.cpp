@@ -0,0 +1,160 @@
+#include "tests/Test.h"
+#include "TerrainColumn.h"
+#include "VoxelStorage.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    // Same as Chunk::m_SeaLevel, m_MinHeight and m_MaxHeight
+    constexpr float g_SeaLevel = 0.3f;
+    constexpr float g_MinHeight = 0.f;
+    constexpr float g_MaxHeight = 1.f;
+
+    // ChunkGenerator::GetHeight before it moved to GetTerrainHeight
+    int GetHeightPerBlock(const SimplexNoise& noise, const glm::ivec3& globalPosition)
+    {
+        float heightNoise = noise.fractal(8, globalPosition.x, globalPosition.z);
+        int terrainHeight = static_cast<int>(heightNoise * (CHUNK_HEIGHT * (g_MaxHeight - g_MinHeight)) + CHUNK_HEIGHT * g_MinHeight);
+        return std::clamp(terrainHeight, 0, CHUNK_HEIGHT);
+    }
+
+    // Chunk::GenerateTerrain before the bulk writes, block by block with the water written first and then overwritten
+    template<typename Storage>
+    void GenerateTerrainPerBlock(Storage& storage, const SimplexNoise& noise, const glm::ivec3& chunkPosition)
+    {
+        constexpr int chunkHeight = Storage::m_Height;
+        const auto setBlock = [&storage](const glm::ivec3& position, BlockType blockType)
+            {
+                if (position.x >= 0 && position.x < Storage::m_Width && position.y >= 0 && position.y < chunkHeight && position.z >= 0 && position.z < Storage::m_Depth)
+                {
+                    storage.Set(position.x, position.y, position.z, blockType);
+                }
+            };
+
+        storage.Fill(BlockType::Air);
+        for (int x = 0; x < Storage::m_Width; ++x)
+        {
+            for (int z = 0; z < Storage::m_Depth; ++z)
+            {
+                const int height = GetHeightPerBlock(noise, chunkPosition + glm::ivec3(x, 0, z));
+                for (int y = 0; y < chunkHeight * g_SeaLevel; ++y)
+                {
+                    setBlock(glm::ivec3(x, y, z), BlockType::Water);
+                }
+                if (height <= chunkHeight * g_SeaLevel + 3)
+                {
+                    for (int y = 0; y <= height; ++y)
+                    {
+                        setBlock(glm::ivec3(x, y, z), BlockType::Sand);
+                    }
+                }
+                if (height > chunkHeight * g_SeaLevel + 3)
+                {
+                    int dirtLayers = (((height - (chunkHeight * g_SeaLevel + 1)) < (3)) ? (height - (chunkHeight * g_SeaLevel + 1)) : (3));
+                    setBlock(glm::ivec3(x, height, z), BlockType::GrassBlock);
+                    for (int y = height - 1; y > height - dirtLayers - 1; --y)
+                    {
+                        setBlock(glm::ivec3(x, y, z), BlockType::Dirt);
+                    }
+                    for (int y = height - dirtLayers - 1; y >= 0; --y)
+                    {
+                        setBlock(glm::ivec3(x, y, z), BlockType::Stone);
+                    }
+                }
+            }
+        }
+    }
+
+    // Chunk::GenerateTerrain without the trees: the heights of ChunkGenerator::GetHeight written with WriteTerrainColumns
+    template<typename Storage>
+    void GenerateTerrain(Storage& storage, const SimplexNoise& noise, const glm::ivec3& chunkPosition)
+    {
+        std::vector<int> heights(static_cast<size_t>(Storage::m_Width) * Storage::m_Depth);
+        for (int z = 0; z < Storage::m_Depth; ++z)
+        {
+            for (int x = 0; x < Storage::m_Width; ++x)
+            {
+                heights[x + z * Storage::m_Width] = GetTerrainHeight(noise, chunkPosition.x + x, chunkPosition.z + z, Storage::m_Height, g_MinHeight, g_MaxHeight);
+            }
+        }
+        WriteTerrainColumns(storage, heights.data(), g_SeaLevel);
+    }
+
+    // Returns the number of chunks whose blocks differ, the chunk positions are in blocks like Chunk::GetPosition
+    template<typename Storage>
+    int CountMismatchingChunks(const std::vector<glm::ivec3>& chunkPositions)
+    {
+        const SimplexNoise noise = CreateTerrainNoise();
+        auto pReference = std::make_unique<VoxelStorage<Storage::m_Width, Storage::m_Height, Storage::m_Depth, LinearXYZ>>();
+        auto pStorage = std::make_unique<Storage>();
+
+        int mismatchCount = 0;
+        for (const glm::ivec3& chunkPosition : chunkPositions)
+        {
+            GenerateTerrainPerBlock(*pReference, noise, chunkPosition);
+            // Like a pooled chunk holding another chunk, every block has to be written
+            pStorage->Fill(BlockType::Leaves);
+            GenerateTerrain(*pStorage, noise, chunkPosition);
+
+            bool isSame = true;
+            for (int z = 0; z < Storage::m_Depth && isSame; ++z)
+            {
+                for (int y = 0; y < Storage::m_Height && isSame; ++y)
+                {
+                    for (int x = 0; x < Storage::m_Width && isSame; ++x)
+                    {
+                        isSame = pStorage->Get(x, y, z) == pReference->Get(x, y, z);
+                    }
+                }
+            }
+            mismatchCount += isSame ? 0 : 1;
+        }
+        return mismatchCount;
+    }
+
+    // Chunks from the sea to the mountains, on both sides of the origin
+    std::vector<glm::ivec3> GetChunkPositions()
+    {
+        std::vector<glm::ivec3> chunkPositions;
+        for (const glm::ivec2& chunk : { glm::ivec2{ 0, 0 }, glm::ivec2{ -1, -1 }, glm::ivec2{ 3, -2 }, glm::ivec2{ -7, 5 }, glm::ivec2{ 20, 11 }, glm::ivec2{ -13, 30 } })
+        {
+            chunkPositions.emplace_back(chunk.x * CHUNK_WIDTH, 0, chunk.y * CHUNK_DEPTH);
+        }
+        return chunkPositions;
+    }
+}
+
+TEST_CASE(TerrainColumnsMatchPerBlockTerrain)
+{
+    // The layouts the CHUNK_LAYOUT option can pick
+    using XzyBlocks = VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearXZY>;
+    using YzxBlocks = VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, LinearYZX>;
+    using MortonBlocks = VoxelStorage<CHUNK_WIDTH, CHUNK_HEIGHT, CHUNK_DEPTH, MortonLayout>;
+
+    const std::vector<glm::ivec3> chunkPositions = GetChunkPositions();
+    CHECK(CountMismatchingChunks<ChunkBlocks>(chunkPositions) == 0);
+    CHECK(CountMismatchingChunks<XzyBlocks>(chunkPositions) == 0);
+    CHECK(CountMismatchingChunks<YzxBlocks>(chunkPositions) == 0);
+    CHECK(CountMismatchingChunks<MortonBlocks>(chunkPositions) == 0);
+}
+
+// Every height a column can have, so the shore and the columns that reach the top of the chunk are covered too
+TEST_CASE(TerrainColumnsCoverEveryHeight)
+{
+    for (int height = 0; height <= CHUNK_HEIGHT; ++height)
+    {
+        const TerrainColumn column = TerrainColumn::Create(height, CHUNK_HEIGHT, g_SeaLevel);
+        CHECK(column.layerCount > 0);
+        CHECK(column.GetBeginY(0) == 0);
+        CHECK(column.layers[column.layerCount - 1].endY == CHUNK_HEIGHT);
+        for (int layer = 0; layer < column.layerCount; ++layer)
+        {
+            CHECK(column.GetBeginY(layer) < column.layers[layer].endY);
+        }
+        // The water reaches sea level over the low columns
+        CHECK(column.GetAirBeginY() == std::min(std::max(height + 1, static_cast<int>(std::ceil(CHUNK_HEIGHT * g_SeaLevel))), CHUNK_HEIGHT));
+    }
+}
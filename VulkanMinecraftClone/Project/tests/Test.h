@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+
+// Small test runner for the parts of the game that run without a window or gpu, so the Tests target needs nothing
+// beyond what the game already builds with. TEST_CASE registers a test, CHECK records a failure and keeps going.
+namespace Test
+{
+    struct Case
+    {
+        const char* pName;
+        void (*pFunction)();
+    };
+
+    std::vector<Case>& GetCases();
+    void Fail(const char* pExpression, const char* pFile, int line);
+
+    struct Registrar final
+    {
+        Registrar(const char* pName, void (*pFunction)()) { GetCases().push_back({ pName, pFunction }); }
+    };
+}
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static const Test::Registrar g_##name##Registrar{ #name, name }; \
+    static void name()
+
+#define CHECK(expression) ((expression) ? static_cast<void>(0) : Test::Fail(#expression, __FILE__, __LINE__))
@@ -0,0 +1,51 @@
+// Runs every TEST_CASE, or only the ones whose name contains the first argument
+#include "tests/Test.h"
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+    int g_FailureCount{};
+}
+
+std::vector<Test::Case>& Test::GetCases()
+{
+    static std::vector<Case> cases;
+    return cases;
+}
+
+void Test::Fail(const char* pExpression, const char* pFile, int line)
+{
+    ++g_FailureCount;
+    std::cout << pFile << '(' << line << "): CHECK(" << pExpression << ") failed\n";
+}
+
+int main(int argc, char* argv[])
+{
+    const char* pFilter = argc > 1 ? argv[1] : nullptr;
+    int runCount = 0;
+    int failedCount = 0;
+    for (const Test::Case& testCase : Test::GetCases())
+    {
+        if (pFilter != nullptr && std::strstr(testCase.pName, pFilter) == nullptr)
+        {
+            continue;
+        }
+
+        const int failuresBefore = g_FailureCount;
+        testCase.pFunction();
+        ++runCount;
+        if (g_FailureCount != failuresBefore)
+        {
+            ++failedCount;
+            std::cout << "FAILED " << testCase.pName << '\n';
+        }
+        else
+        {
+            std::cout << "passed " << testCase.pName << '\n';
+        }
+    }
+
+    std::cout << runCount - failedCount << " of " << runCount << " tests passed\n";
+    return failedCount == 0 && runCount > 0 ? 0 : 1;
+}
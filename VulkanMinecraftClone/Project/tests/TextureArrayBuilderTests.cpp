@@ -0,0 +1,244 @@
+#include "tests/Test.h"
+#include "TextureArrayBuilder.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t g_TileSize = 8;
+    constexpr uint32_t g_TilesPerRow = 2;
+    constexpr uint32_t g_AtlasSize = g_TileSize * g_TilesPerRow;
+
+    using Color = std::array<uint8_t, 4>;
+
+    // Four tiles: solid red, a black and white checker, a green tile with a transparent left half and a diagonal gradient
+    Color GetAtlasColor(uint32_t x, uint32_t y)
+    {
+        const uint32_t layer = (y / g_TileSize) * g_TilesPerRow + x / g_TileSize;
+        const uint32_t tileX = x % g_TileSize;
+        const uint32_t tileY = y % g_TileSize;
+        switch (layer)
+        {
+        case 0:
+            return { 255, 0, 0, 255 };
+        case 1:
+            return (tileX + tileY) % 2 == 0 ? Color{ 0, 0, 0, 255 } : Color{ 255, 255, 255, 255 };
+        case 2:
+            return { 0, 255, 0, static_cast<uint8_t>(tileX < g_TileSize / 2 ? 0 : 255) };
+        default:
+            return { static_cast<uint8_t>((tileX + tileY) * 16), static_cast<uint8_t>((tileX + tileY) * 8), 64, 255 };
+        }
+    }
+
+    std::vector<uint8_t> CreateAtlas()
+    {
+        std::vector<uint8_t> atlas(g_AtlasSize * g_AtlasSize * 4);
+        for (uint32_t y = 0; y < g_AtlasSize; ++y)
+        {
+            for (uint32_t x = 0; x < g_AtlasSize; ++x)
+            {
+                const Color color = GetAtlasColor(x, y);
+                std::copy(color.begin(), color.end(), &atlas[(y * g_AtlasSize + x) * 4]);
+            }
+        }
+        return atlas;
+    }
+
+    TextureArrayData CreateTextureArray()
+    {
+        const std::vector<uint8_t> atlas = CreateAtlas();
+        TextureArrayData data = TextureArrayBuilder::Slice(atlas.data(), g_AtlasSize, g_AtlasSize, g_TilesPerRow);
+        TextureArrayBuilder::GenerateMips(data);
+        return data;
+    }
+
+    bool IsColor(const uint8_t* pPixel, const Color& color, int tolerance = 0)
+    {
+        for (size_t channel = 0; channel < color.size(); ++channel)
+        {
+            if (std::abs(pPixel[channel] - color[channel]) > tolerance)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST_CASE(TextureArraySlicesTheAtlas)
+{
+    const TextureArrayData data = CreateTextureArray();
+    CHECK(data.format == TextureArrayFormat::Rgba8Srgb);
+    CHECK(data.tileSize == g_TileSize);
+    CHECK(data.layerCount == g_TilesPerRow * g_TilesPerRow);
+    CHECK(data.mipCount == 4);
+    CHECK(data.pixels.size() == data.GetByteSize());
+    // 8x8, 4x4, 2x2 and 1x1 for every layer
+    CHECK(data.GetByteSize() == (64 + 16 + 4 + 1) * 4 * data.layerCount);
+
+    // Layers are numbered row by row through the atlas like BlockRegistry::GetFaceLayer
+    for (uint32_t layer = 0; layer < data.layerCount; ++layer)
+    {
+        for (uint32_t y = 0; y < g_TileSize; ++y)
+        {
+            for (uint32_t x = 0; x < g_TileSize; ++x)
+            {
+                const uint32_t atlasX = (layer % g_TilesPerRow) * g_TileSize + x;
+                const uint32_t atlasY = (layer / g_TilesPerRow) * g_TileSize + y;
+                CHECK(IsColor(data.GetPixel(0, layer, x, y), GetAtlasColor(atlasX, atlasY)));
+            }
+        }
+    }
+}
+
+TEST_CASE(TextureArrayMipsStayInsideTheirTile)
+{
+    const TextureArrayData data = CreateTextureArray();
+    for (uint32_t mip = 1; mip < data.mipCount; ++mip)
+    {
+        const uint32_t size = data.GetMipSize(mip);
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                // The red tile never picks up the checker next to it in the atlas
+                CHECK(IsColor(data.GetPixel(mip, 0, x, y), { 255, 0, 0, 255 }));
+                // Black and white average to half the linear light, which is 188 in srgb and not 128
+                CHECK(IsColor(data.GetPixel(mip, 1, x, y), { 188, 188, 188, 255 }, 1));
+            }
+        }
+    }
+
+    // Alpha is averaged linearly, the transparent half stays transparent until the halves meet
+    CHECK(data.GetPixel(1, 2, 0, 0)[3] == 0);
+    CHECK(data.GetPixel(1, 2, 3, 0)[3] == 255);
+    CHECK(data.GetPixel(3, 2, 0, 0)[3] == 128);
+}
+
+namespace
+{
+    Color UnpackColor(uint16_t color)
+    {
+        const int red = (color >> 11) & 31;
+        const int green = (color >> 5) & 63;
+        const int blue = color & 31;
+        return { static_cast<uint8_t>((red << 3) | (red >> 2)), static_cast<uint8_t>((green << 2) | (green >> 4)), static_cast<uint8_t>((blue << 3) | (blue >> 2)), 255 };
+    }
+
+    // Decodes one 8 byte block the way the gpu does
+    std::array<Color, 16> DecodeBc1Block(const uint8_t* pBlock)
+    {
+        const uint16_t color0 = static_cast<uint16_t>(pBlock[0] | (pBlock[1] << 8));
+        const uint16_t color1 = static_cast<uint16_t>(pBlock[2] | (pBlock[3] << 8));
+        std::array<Color, 4> palette{ UnpackColor(color0), UnpackColor(color1) };
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            if (color0 > color1)
+            {
+                palette[2][channel] = static_cast<uint8_t>((2 * palette[0][channel] + palette[1][channel]) / 3);
+                palette[3][channel] = static_cast<uint8_t>((palette[0][channel] + 2 * palette[1][channel]) / 3);
+            }
+            else
+            {
+                palette[2][channel] = static_cast<uint8_t>((palette[0][channel] + palette[1][channel]) / 2);
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = color0 > color1 ? 255 : 0;
+
+        const uint32_t indices = pBlock[4] | (pBlock[5] << 8) | (pBlock[6] << 16) | (static_cast<uint32_t>(pBlock[7]) << 24);
+        std::array<Color, 16> texels;
+        for (int texel = 0; texel < 16; ++texel)
+        {
+            texels[texel] = palette[(indices >> (texel * 2)) & 3];
+        }
+        return texels;
+    }
+
+    std::string GetCachePath()
+    {
+        return (std::filesystem::temp_directory_path() / "VulkanMinecraftCloneTests.cache").string();
+    }
+}
+
+TEST_CASE(TextureArrayBc1)
+{
+    const TextureArrayData data = CreateTextureArray();
+    const TextureArrayData compressed = TextureArrayBuilder::CompressBc1(data);
+    CHECK(compressed.format == TextureArrayFormat::Bc1Srgb);
+    CHECK(compressed.mipCount == data.mipCount);
+    CHECK(compressed.pixels.size() == compressed.GetByteSize());
+    // Two blocks square at mip 0, a single block for every smaller mip
+    CHECK(compressed.GetByteSize() == (4 + 1 + 1 + 1) * 8 * data.layerCount);
+
+    // The first block of mip 0 of every layer
+    const auto getBlock = [&compressed](uint32_t layer) { return DecodeBc1Block(&compressed.pixels[compressed.mipOffsets[0] + layer * compressed.GetLayerByteSize(0)]); };
+
+    // Pure red, black, white and the two halves of the cutout tile fit the 565 endpoints exactly
+    for (const Color& texel : getBlock(0))
+    {
+        CHECK(texel == (Color{ 255, 0, 0, 255 }));
+    }
+    const std::array<Color, 16> checker = getBlock(1);
+    const std::array<Color, 16> cutout = getBlock(2);
+    for (uint32_t texel = 0; texel < 16; ++texel)
+    {
+        CHECK(checker[texel] == GetAtlasColor(g_TileSize + texel % 4, texel / 4));
+        // Transparent texels use the 1 bit alpha mode, the color doesn't matter there
+        CHECK(cutout[texel][3] == GetAtlasColor(texel % 4, g_TileSize + texel / 4)[3]);
+    }
+
+    // The gradient is close, every channel within the error of the 565 endpoints and the interpolation
+    const std::array<Color, 16> gradient = getBlock(3);
+    for (uint32_t texel = 0; texel < 16; ++texel)
+    {
+        const Color source = GetAtlasColor(g_TileSize + texel % 4, g_TileSize + texel / 4);
+        CHECK(IsColor(gradient[texel].data(), source, 16));
+    }
+}
+
+TEST_CASE(TextureArrayCache)
+{
+    const TextureArrayData compressed = TextureArrayBuilder::CompressBc1(CreateTextureArray());
+    const std::vector<uint8_t> source{ 1, 2, 3, 4, 5 };
+    const uint64_t sourceHash = TextureArrayBuilder::Hash(source.data(), source.size());
+    const std::string path = GetCachePath();
+    CHECK(TextureArrayBuilder::SaveCache(path, sourceHash, compressed));
+
+    TextureArrayData loaded{};
+    CHECK(TextureArrayBuilder::LoadCache(path, sourceHash, TextureArrayFormat::Bc1Srgb, loaded));
+    CHECK(loaded.format == compressed.format);
+    CHECK(loaded.tileSize == compressed.tileSize);
+    CHECK(loaded.layerCount == compressed.layerCount);
+    CHECK(loaded.mipCount == compressed.mipCount);
+    CHECK(loaded.mipOffsets == compressed.mipOffsets);
+    CHECK(loaded.pixels == compressed.pixels);
+
+    // Another source, another format or a missing file are all rejected
+    const std::vector<uint8_t> otherSource{ 1, 2, 3, 4, 6 };
+    CHECK(TextureArrayBuilder::Hash(otherSource.data(), otherSource.size()) != sourceHash);
+    CHECK(!TextureArrayBuilder::LoadCache(path, TextureArrayBuilder::Hash(otherSource.data(), otherSource.size()), TextureArrayFormat::Bc1Srgb, loaded));
+    CHECK(!TextureArrayBuilder::LoadCache(path, sourceHash, TextureArrayFormat::Rgba8Srgb, loaded));
+    CHECK(!TextureArrayBuilder::LoadCache(path + ".missing", sourceHash, TextureArrayFormat::Bc1Srgb, loaded));
+
+    // A damaged cache is rejected in memory before anything is copied
+    std::vector<uint8_t> bytes(std::filesystem::file_size(path));
+    std::ifstream file{ path, std::ios::binary };
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    file.close();
+    TextureArrayData parsed{};
+    const uint8_t* pPixels{};
+    CHECK(TextureArrayBuilder::ParseCache(bytes.data(), bytes.size(), sourceHash, TextureArrayFormat::Bc1Srgb, parsed, pPixels));
+    CHECK(pPixels == bytes.data() + bytes.size() - compressed.GetByteSize());
+    CHECK(!TextureArrayBuilder::ParseCache(bytes.data(), bytes.size() - 1, sourceHash, TextureArrayFormat::Bc1Srgb, parsed, pPixels));
+    CHECK(!TextureArrayBuilder::ParseCache(bytes.data(), 4, sourceHash, TextureArrayFormat::Bc1Srgb, parsed, pPixels));
+    bytes[0] ^= 0xFF;
+    CHECK(!TextureArrayBuilder::ParseCache(bytes.data(), bytes.size(), sourceHash, TextureArrayFormat::Bc1Srgb, parsed, pPixels));
+
+    std::filesystem::remove(path);
+}
@@ -1,4 +1,22 @@
 #include "vulkanbase/VulkanBase.h"
+#include <ChunkGenerator.h>
+
+namespace
+{
+	ShaderConstants GetShaderConstants()
+	{
+		ShaderConstants constants{};
+		constants.fogEnd = ChunkGenerator::GetViewDistanceInBlocks();
+		constants.fogStart = constants.fogEnd * 0.6f;
+		return constants;
+	}
+
+	// The feature toggles of the game decide which pipeline variant is drawn with
+	ShaderVariant GetShaderVariant()
+	{
+		return ShaderVariant{ ChunkGenerator::GetInstance().IsAmbientOcclusionEnabled(), ChunkGenerator::GetInstance().IsFogEnabled() };
+	}
+}
 
 void VulkanBase::initWindow()
 {
@@ -17,6 +35,10 @@ void VulkanBase::initVulkan()
 	pickPhysicalDevice();
 	createLogicalDevice();
 
+	MemoryTracker::GetInstance().Initialize(m_PhysicalDevice);
+	PipelineCache::GetInstance().Initialize(m_Device, m_PhysicalDevice, "pipeline.cache");
+	DeletionQueue::GetInstance().Initialize(m_Device);
+
 	SwapchainManager::GetInstance().Initialize(instance, m_PhysicalDevice, m_Device, surface, window);
 
 	m_RenderPass = std::make_unique<RenderPass>(m_Device, m_PhysicalDevice);
@@ -32,18 +54,127 @@ void VulkanBase::initVulkan()
 	m_pGame = std::make_unique<Game>();
 	m_pGame->Init(m_Device, m_PhysicalDevice, m_CommandPool.GetHandle());
 
-	m_BasicGraphicsPipeline2D = std::make_unique<BasicGraphicsPipeline2D>(m_Device, m_RenderPass->GetHandle(), "shaders/shader2D.vert.spv",
-		"shaders/shader2D.frag.spv");
+	const auto pipelineStartTime = std::chrono::high_resolution_clock::now();
+
+	m_BasicGraphicsPipeline2D = CreatePipeline2D();
 
 	//m_GraphicsPipeline3D = std::make_unique<GraphicsPipeline3D>(m_Device, m_PhysicalDevice, m_RenderPass->GetHandle(), "shaders/shader3D.vert.spv",
 	//	"shaders/shader3D.frag.spv", m_pGame->GetTextures());	
-	m_LandGraphicsPipeline = std::make_unique<GraphicsPipeline3D>(m_Device, m_PhysicalDevice, m_RenderPass->GetHandle(), "shaders/shaderLand.vert.spv",
-		"shaders/shaderLand.frag.spv");
+	m_PipelineLayout3D = std::make_unique<PipelineLayout3D>(m_Device, m_PhysicalDevice);
+
+	m_LandGraphicsPipeline = CreateLandPipeline();
+	m_WaterGraphicsPipeline = CreateWaterPipeline();
+	m_FaceGraphicsPipeline = CreateFacePipeline();
+	ChunkGenerator::GetInstance().SetPipelineLayout(m_PipelineLayout3D.get());
+	m_OverdrawCounter.Init(m_Device, m_PhysicalDevice, m_CommandPool.GetHandle(), *m_PipelineLayout3D);
 
-	m_WaterGraphicsPipeline = std::make_unique<GraphicsPipeline3D>(m_Device, m_PhysicalDevice, m_RenderPass->GetHandle(), "shaders/shaderWater.vert.spv",
-		"shaders/shaderWater.frag.spv");
+	const std::chrono::duration<double, std::milli> pipelineTime = std::chrono::high_resolution_clock::now() - pipelineStartTime;
+	std::cout << "Graphics pipelines created in " << pipelineTime.count() << " ms, "
+		<< PipelineCache::GetInstance().GetLoadedSize() << " bytes of pipeline cache loaded\n";
 
 	createSyncObjects();
+
+#ifdef SHADER_SOURCE_DIR
+	ShaderManager::GetInstance().Start(SHADER_SOURCE_DIR, "shaders", GLSLC_EXECUTABLE);
+#endif
+}
+
+std::unique_ptr<BasicGraphicsPipeline2D> VulkanBase::CreatePipeline2D()
+{
+	return std::make_unique<BasicGraphicsPipeline2D>(m_Device, m_RenderPass->GetHandle(), "shaders/shader2D.vert.spv",
+		"shaders/shader2D.frag.spv");
+}
+
+std::unique_ptr<GraphicsPipeline3D> VulkanBase::CreateLandPipeline()
+{
+	return std::make_unique<GraphicsPipeline3D>(m_Device, *m_PipelineLayout3D, m_RenderPass->GetHandle(), "shaders/shaderLand.vert.spv",
+		"shaders/shaderLand.frag.spv", VertexLayout::Block, GetShaderConstants(), GetShaderVariant());
+}
+
+std::unique_ptr<GraphicsPipeline3D> VulkanBase::CreateWaterPipeline()
+{
+	return std::make_unique<GraphicsPipeline3D>(m_Device, *m_PipelineLayout3D, m_RenderPass->GetHandle(), "shaders/shaderWater.vert.spv",
+		"shaders/shaderWater.frag.spv", VertexLayout::Water, GetShaderConstants(), GetShaderVariant());
+}
+
+// Vertex pulling version of the land pipeline, shares the fragment shader
+std::unique_ptr<GraphicsPipeline3D> VulkanBase::CreateFacePipeline()
+{
+	return std::make_unique<GraphicsPipeline3D>(m_Device, *m_PipelineLayout3D, m_RenderPass->GetHandle(), "shaders/shaderFace.vert.spv",
+		"shaders/shaderLand.frag.spv", VertexLayout::Face, GetShaderConstants(), GetShaderVariant());
+}
+
+void VulkanBase::ReloadShaders()
+{
+	const std::vector<ShaderManager::ReloadedShader> reloadedShaders = ShaderManager::GetInstance().TakeReloadedShaders();
+	if (reloadedShaders.empty())
+	{
+		return;
+	}
+
+	// The previous frame might still use the old pipelines
+	vkDeviceWaitIdle(m_Device);
+
+	// The new pipeline is created before the old one is destroyed, so a shader that fails to load keeps the old one running
+	const auto rebuild = [this](auto& pPipeline, auto createPipeline)
+		{
+			auto pNewPipeline = (this->*createPipeline)();
+			pPipeline->DestroyPipeline(m_Device);
+			pPipeline = std::move(pNewPipeline);
+		};
+
+	for (const ShaderManager::ReloadedShader& shader : reloadedShaders)
+	{
+		const std::string shaderPath = "shaders/" + shader.fileName + ".spv";
+		try
+		{
+			if (m_LandGraphicsPipeline->UsesShader(shaderPath)) rebuild(m_LandGraphicsPipeline, &VulkanBase::CreateLandPipeline);
+			if (m_WaterGraphicsPipeline->UsesShader(shaderPath)) rebuild(m_WaterGraphicsPipeline, &VulkanBase::CreateWaterPipeline);
+			if (m_FaceGraphicsPipeline->UsesShader(shaderPath)) rebuild(m_FaceGraphicsPipeline, &VulkanBase::CreateFacePipeline);
+			if (m_BasicGraphicsPipeline2D->UsesShader(shaderPath)) rebuild(m_BasicGraphicsPipeline2D, &VulkanBase::CreatePipeline2D);
+		}
+		catch (const std::runtime_error& error)
+		{
+			std::cout << "Failed to reload " << shader.fileName << ": " << error.what() << '\n';
+			continue;
+		}
+
+		const std::chrono::duration<double, std::milli> latency = std::chrono::high_resolution_clock::now() - shader.changeTime;
+		std::cout << "Reloaded " << shader.fileName << " in " << latency.count() << " ms, ";
+		if (shader.isCached)
+		{
+			std::cout << "spir-v was cached\n";
+		}
+		else
+		{
+			std::cout << "compiling took " << shader.compileMilliseconds << " ms\n";
+		}
+	}
+}
+
+void VulkanBase::MeasureOverdraw()
+{
+	vkDeviceWaitIdle(m_Device);
+
+	ChunkGenerator& chunkGenerator = ChunkGenerator::GetInstance();
+	const bool wasFrontToBack = chunkGenerator.IsFrontToBackEnabled();
+	const auto drawLand = [this](VkCommandBuffer commandBuffer, VkPipelineLayout pipelineLayout) { m_pGame->RenderLand(commandBuffer, pipelineLayout); };
+
+	const auto measure = [&](const char* name, bool isFrontToBack, bool isDepthPrePass)
+		{
+			chunkGenerator.SetFrontToBackEnabled(isFrontToBack);
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			const OverdrawCounter::Result result = m_OverdrawCounter.Measure(drawLand, chunkGenerator.IsFaceRenderingEnabled(), isDepthPrePass);
+			const std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - startTime;
+			std::cout << name << ": " << result.fragmentCount << " fragments shaded on " << result.coveredPixelCount << " of " << result.pixelCount
+				<< " pixels, overdraw " << result.GetOverdraw() << " (" << duration.count() << " ms)\n";
+		};
+
+	measure("Map order", false, false);
+	measure("Front to back", true, false);
+	measure("Depth pre-pass", true, true);
+
+	chunkGenerator.SetFrontToBackEnabled(wasFrontToBack);
 }
 
 void VulkanBase::mainLoop()
@@ -57,14 +188,119 @@ void VulkanBase::mainLoop()
 		glfwPollEvents();
 
 		if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_ESCAPE)) glfwSetWindowShouldClose(window, true);
-
+		if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_X)) MeasureOverdraw();
+		if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_T)) StartChunkChurn();
+		if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_Y)) StartFlightBenchmark();
+		if (InputManager::GetInstance().IsKeyPressed(GLFW_KEY_M)) MemoryTracker::GetInstance().PrintReport();
+		if (m_FlightBenchmark.isRunning) UpdateFlightBenchmark();
+
+		ReloadShaders();
+		const auto frameStart = std::chrono::high_resolution_clock::now();
+		if (m_ChunkChurn.isRunning)
+		{
+			m_ChunkChurn.cycleCount += ChunkGenerator::GetInstance().ChurnChunks(m_ChurnChunksPerFrame);
+		}
 		m_pGame->Update();
 		Render();
+		if (m_ChunkChurn.isRunning)
+		{
+			const std::chrono::duration<double, std::milli> frameTime = std::chrono::high_resolution_clock::now() - frameStart;
+			UpdateChunkChurn(frameTime.count());
+		}
 	}
 	vkDeviceWaitIdle(m_Device);
+	ShaderManager::GetInstance().Stop();
 	Timer::GetInstance().Stop();
 }
 
+void VulkanBase::StartChunkChurn()
+{
+	if (m_ChunkChurn.isRunning)
+	{
+		return;
+	}
+	m_ChunkChurn = ChunkChurn{};
+	m_ChunkChurn.isRunning = true;
+	m_ChunkChurn.startValidationMessageCount = m_ValidationMessageCount;
+	std::cout << "Churning " << m_ChurnCycleCount << " chunks, " << m_ChurnChunksPerFrame << " per frame\n";
+}
+
+void VulkanBase::UpdateChunkChurn(double frameMilliseconds)
+{
+	++m_ChunkChurn.frameCount;
+	m_ChunkChurn.totalMilliseconds += frameMilliseconds;
+	m_ChunkChurn.maxMilliseconds = std::max(m_ChunkChurn.maxMilliseconds, frameMilliseconds);
+	if (frameMilliseconds > m_StallMilliseconds)
+	{
+		++m_ChunkChurn.stallCount;
+	}
+	if (m_ChunkChurn.cycleCount < m_ChurnCycleCount)
+	{
+		return;
+	}
+
+	m_ChunkChurn.isRunning = false;
+	const DeletionQueue& deletionQueue = DeletionQueue::GetInstance();
+	std::cout << "Chunk churn: " << m_ChunkChurn.cycleCount << " chunks destroyed and loaded in " << m_ChunkChurn.frameCount << " frames, "
+		<< m_ChunkChurn.totalMilliseconds / m_ChunkChurn.frameCount << " ms average and " << m_ChunkChurn.maxMilliseconds << " ms worst frame, "
+		<< m_ChunkChurn.stallCount << " frames over " << m_StallMilliseconds << " ms\n";
+	std::cout << "Deletion queue: " << deletionQueue.GetPendingCount() << " pending, " << deletionQueue.GetPeakPendingCount() << " at most, "
+		<< deletionQueue.GetFreedCount() << " freed in total\n";
+	if (enableValidationLayers)
+	{
+		std::cout << "Validation layers: " << m_ValidationMessageCount - m_ChunkChurn.startValidationMessageCount << " warnings and errors\n";
+	}
+	else
+	{
+		std::cout << "Validation layers: disabled in this build\n";
+	}
+}
+
+void VulkanBase::StartFlightBenchmark()
+{
+	if (m_FlightBenchmark.isRunning)
+	{
+		return;
+	}
+	const ChunkPool& chunkPool = ChunkGenerator::GetInstance().GetChunkPool();
+	m_FlightBenchmark = FlightBenchmark{};
+	m_FlightBenchmark.isRunning = true;
+	m_FlightBenchmark.startAllocations = AllocationCounter::GetSnapshot();
+	m_FlightBenchmark.startCreatedChunks = chunkPool.GetCreatedCount();
+	m_FlightBenchmark.startReusedChunks = chunkPool.GetReusedCount();
+	std::cout << "Flying " << m_FlightSeconds << " s at " << m_FlightSpeed << " blocks per second, chunk pooling "
+		<< (chunkPool.IsEnabled() ? "enabled" : "disabled") << '\n';
+}
+
+void VulkanBase::UpdateFlightBenchmark()
+{
+	// Moves the camera before the game updates, so the chunks around the new position load this frame
+	const float deltaTime = Timer::GetInstance().GetElapsed();
+	Camera::GetInstance().m_Position.x += m_FlightSpeed * deltaTime;
+	m_FlightBenchmark.elapsedSeconds += deltaTime;
+	if (m_FlightBenchmark.elapsedSeconds < m_FlightSeconds)
+	{
+		return;
+	}
+
+	m_FlightBenchmark.isRunning = false;
+	const ChunkPool& chunkPool = ChunkGenerator::GetInstance().GetChunkPool();
+	const AllocationCounter::Snapshot allocations = AllocationCounter::GetSnapshot();
+	const double seconds = m_FlightBenchmark.elapsedSeconds;
+	const uint64_t createdChunks = chunkPool.GetCreatedCount() - m_FlightBenchmark.startCreatedChunks;
+	const uint64_t reusedChunks = chunkPool.GetReusedCount() - m_FlightBenchmark.startReusedChunks;
+	std::cout << "Flight: " << createdChunks + reusedChunks << " chunks loaded, " << reusedChunks << " of them pooled\n";
+	if (!AllocationCounter::IsEnabled())
+	{
+		std::cout << "Heap allocations are only counted in debug builds or with MEMORY_PROFILING, peak resident "
+			<< AllocationCounter::GetPeakResidentBytes() / (1024 * 1024) << " MB\n";
+		return;
+	}
+	std::cout << "Heap: " << (allocations.allocationCount - m_FlightBenchmark.startAllocations.allocationCount) / seconds << " allocations and "
+		<< (allocations.allocatedBytes - m_FlightBenchmark.startAllocations.allocatedBytes) / seconds / (1024.0 * 1024.0) << " MB per second, peak resident "
+		<< AllocationCounter::GetPeakResidentBytes() / (1024 * 1024) << " MB\n";
+}
+
 void VulkanBase::drawFrame(uint32_t imageIndex) 
 {
 	VkExtent2D swapChainExtent = SwapchainManager::GetInstance().GetSwapchainExtent();
@@ -83,18 +319,32 @@ void VulkanBase::drawFrame(uint32_t imageIndex)
 	scissor.extent = swapChainExtent;
 	vkCmdSetScissor(m_CommandBuffer.GetVkCommandBuffer(), 0, 1, &scissor);
 
+	// The compute culling has to be recorded before the render pass starts
+	m_pGame->CullLand(m_CommandBuffer.GetVkCommandBuffer());
+
 	// 3D
 	m_RenderPass->Begin(m_CommandBuffer, SwapchainManager::GetInstance().GetSwapchainFrameBuffers(), imageIndex);
 
-	m_LandGraphicsPipeline->UpdateUniformBuffer(m_Device, imageIndex);
-	m_LandGraphicsPipeline->BindPipeline(m_CommandBuffer.GetVkCommandBuffer());
-	m_LandGraphicsPipeline->BindDescriptorSets(m_CommandBuffer.GetVkCommandBuffer(), imageIndex);
+	// Both 3D pipelines share the layout, the descriptor sets stay bound when switching from land to water
+	m_PipelineLayout3D->UpdateUniformBuffer(m_Device, imageIndex);
+	m_PipelineLayout3D->BindDescriptorSets(m_CommandBuffer.GetVkCommandBuffer(), imageIndex);
+
+	const ShaderVariant shaderVariant = GetShaderVariant();
+	GraphicsPipeline3D& landPipeline = ChunkGenerator::GetInstance().IsFaceRenderingEnabled() ? *m_FaceGraphicsPipeline : *m_LandGraphicsPipeline;
+	ShaderVariant landVariant = shaderVariant;
+	if (ChunkGenerator::GetInstance().IsDepthPrePassEnabled())
+	{
+		// Fill the depth buffer first, the shading pass then only runs the fragment shader once per pixel
+		landVariant.depthPass = DepthPass::DepthOnly;
+		landPipeline.BindPipeline(m_CommandBuffer.GetVkCommandBuffer(), landVariant);
+		m_pGame->RenderLand(m_CommandBuffer.GetVkCommandBuffer(), landPipeline.GetPipelineLayout());
+		landVariant.depthPass = DepthPass::Shade;
+	}
+	landPipeline.BindPipeline(m_CommandBuffer.GetVkCommandBuffer(), landVariant);
 
-	m_pGame->RenderLand(m_CommandBuffer.GetVkCommandBuffer(), m_LandGraphicsPipeline->GetPipelineLayout());
+	m_pGame->RenderLand(m_CommandBuffer.GetVkCommandBuffer(), landPipeline.GetPipelineLayout());
 
-	m_WaterGraphicsPipeline->UpdateUniformBuffer(m_Device, imageIndex);
-	m_WaterGraphicsPipeline->BindPipeline(m_CommandBuffer.GetVkCommandBuffer());
-	m_WaterGraphicsPipeline->BindDescriptorSets(m_CommandBuffer.GetVkCommandBuffer(), imageIndex);
+	m_WaterGraphicsPipeline->BindPipeline(m_CommandBuffer.GetVkCommandBuffer(), shaderVariant);
 
 	m_pGame->RenderWater(m_CommandBuffer.GetVkCommandBuffer(), m_WaterGraphicsPipeline->GetPipelineLayout());
 
@@ -111,6 +361,7 @@ void VulkanBase::Render()
 	// multithreading and surface setup (imageIndex).
 	vkWaitForFences(m_Device, 1, &inFlightFence, VK_TRUE, UINT64_MAX);
 	vkResetFences(m_Device, 1, &inFlightFence);
+	DeletionQueue::GetInstance().OnFramesCompleted();
 
 	uint32_t imageIndex;
 	auto swapChain = SwapchainManager::GetInstance().GetSwapchain();
@@ -141,6 +392,7 @@ void VulkanBase::Render()
 	if (vkQueueSubmit(QueueManager::GetInstance().GetGraphicsQueue(), 1, &submitInfo, inFlightFence) != VK_SUCCESS) {
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
+	DeletionQueue::GetInstance().OnFrameSubmitted();
 
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -155,10 +407,18 @@ void VulkanBase::Render()
 	presentInfo.pImageIndices = &imageIndex;
 
 	vkQueuePresentKHR(QueueManager::GetInstance().GetPresentationQueue(), &presentInfo);
+
+	// The gpu is busy with the new frame, free what the previous ones were the last to use
+	DeletionQueue::GetInstance().Collect();
 }
 
 void VulkanBase::cleanup()
 {
+	MemoryTracker::GetInstance().PrintReport();
+
+	// Some of the queued resources still need the pipeline layout
+	DeletionQueue::GetInstance().DestroyAll();
+
 	vkDestroySemaphore(m_Device, renderFinishedSemaphore, nullptr);
 	vkDestroySemaphore(m_Device, imageAvailableSemaphore, nullptr);
 	vkDestroyFence(m_Device, inFlightFence, nullptr);
@@ -170,6 +430,9 @@ void VulkanBase::cleanup()
 	m_BasicGraphicsPipeline2D->DestroyPipeline(m_Device);
 	m_LandGraphicsPipeline->DestroyPipeline(m_Device);
 	m_WaterGraphicsPipeline->DestroyPipeline(m_Device);
+	m_FaceGraphicsPipeline->DestroyPipeline(m_Device);
+	m_OverdrawCounter.Destroy();
+	m_PipelineLayout3D->Destroy(m_Device);
 
 	m_pGame->Destroy(m_Device);
 	//m_pGame.reset(nullptr);
@@ -181,6 +444,7 @@ void VulkanBase::cleanup()
 	}
 	SwapchainManager::GetInstance().Cleanup();
 
+	PipelineCache::GetInstance().Destroy(m_Device);
 	vkDestroyDevice(m_Device, nullptr);
 
 	vkDestroySurfaceKHR(instance, surface, nullptr);
@@ -260,8 +524,13 @@ void VulkanBase::createLogicalDevice() {
 	queueCreateInfo.queueFamilyIndex = indices.m_GraphicsFamily.value();
 	queueCreateInfo.queueCount = 1;
 
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
+	// Optional, the block textures fall back to RGBA8 without it
+	deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
 
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -271,8 +540,20 @@ void VulkanBase::createLogicalDevice() {
 
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+	// Optional, without it the gpu culling stays off, see ChunkGenerator::ToggleGpuCulling
+	std::vector<const char*> enabledExtensions = deviceExtensions;
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(m_PhysicalDevice, nullptr, &extensionCount, availableExtensions.data());
+	for (const auto& extension : availableExtensions) {
+		if (std::string(extension.extensionName) == VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) {
+			enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+		}
+	}
+
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+	createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
 	if (enableValidationLayers) {
 		createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -29,6 +29,11 @@
 #include "Camera.h"
 #include "InputManager.h"
 #include <Game.h>
+#include <ShaderManager.h>
+#include <OverdrawCounter.h>
+#include <DeletionQueue.h>
+#include <AllocationCounter.h>
+#include <MemoryTracker.h>
 
 const std::vector<const char*> validationLayers = 
 {
@@ -64,10 +69,55 @@ private:
 
 	std::unique_ptr<Game> m_pGame;
 	std::unique_ptr<BasicGraphicsPipeline2D> m_BasicGraphicsPipeline2D;
+	std::unique_ptr<PipelineLayout3D> m_PipelineLayout3D;
 	std::unique_ptr<GraphicsPipeline3D> m_LandGraphicsPipeline;
 	std::unique_ptr<GraphicsPipeline3D> m_WaterGraphicsPipeline;
+	std::unique_ptr<GraphicsPipeline3D> m_FaceGraphicsPipeline;
+	OverdrawCounter m_OverdrawCounter{};
 
 	void initVulkan();
+	std::unique_ptr<BasicGraphicsPipeline2D> CreatePipeline2D();
+	std::unique_ptr<GraphicsPipeline3D> CreateLandPipeline();
+	std::unique_ptr<GraphicsPipeline3D> CreateWaterPipeline();
+	std::unique_ptr<GraphicsPipeline3D> CreateFacePipeline();
+	// Rebuilds the pipelines whose shaders the ShaderManager recompiled, called between frames
+	void ReloadShaders();
+	// Counts the fragments of the land in every draw order and prints the overdraw, the game is paused meanwhile
+	void MeasureOverdraw();
+
+	// Stress test of the chunk lifetime: destroys and loads chunks every frame while they may still be drawn,
+	// then prints the frame times, the stalls and the validation messages seen meanwhile
+	static constexpr int m_ChurnChunksPerFrame = 8;
+	static constexpr int m_ChurnCycleCount = 2000;
+	static constexpr double m_StallMilliseconds = 50.0;
+	struct ChunkChurn
+	{
+		bool isRunning;
+		int cycleCount;
+		uint64_t frameCount;
+		double totalMilliseconds;
+		double maxMilliseconds;
+		int stallCount;
+		uint32_t startValidationMessageCount;
+	};
+	ChunkChurn m_ChunkChurn{};
+	void StartChunkChurn();
+	void UpdateChunkChurn(double frameMilliseconds);
+
+	// Scripted fast flight in a straight line, prints the chunks loaded, the heap allocations and the peak memory
+	static constexpr float m_FlightSpeed = 128.f;
+	static constexpr float m_FlightSeconds = 40.f;
+	struct FlightBenchmark
+	{
+		bool isRunning;
+		float elapsedSeconds;
+		AllocationCounter::Snapshot startAllocations;
+		uint64_t startCreatedChunks;
+		uint64_t startReusedChunks;
+	};
+	FlightBenchmark m_FlightBenchmark{};
+	void StartFlightBenchmark();
+	void UpdateFlightBenchmark();
 	void initWindow();
 	void mainLoop();
 	void drawFrame(uint32_t imageIndex);	
@@ -97,7 +147,13 @@ private:
 	std::vector<const char*> getRequiredExtensions();
 	bool checkDeviceExtensionSupport(VkPhysicalDevice device);
 
+	// Warnings and errors of the validation layers
+	static inline uint32_t m_ValidationMessageCount{};
+
 	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
+		if (messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) {
+			++m_ValidationMessageCount;
+		}
 		std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
 		return VK_FALSE;
 	}
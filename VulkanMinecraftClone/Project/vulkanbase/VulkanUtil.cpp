@@ -52,7 +52,27 @@ uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, Vk
 	throw std::runtime_error("failed to find suitable memory type!");
 }
 
-void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+VkResult AllocateMemory(VkDevice device, const VkMemoryAllocateInfo& allocInfo, MemoryTag tag, VkDeviceMemory& memory)
+{
+	const VkResult result = vkAllocateMemory(device, &allocInfo, nullptr, &memory);
+	if (result == VK_SUCCESS)
+	{
+		MemoryTracker::GetInstance().AddDevice(memory, tag, allocInfo.allocationSize, allocInfo.memoryTypeIndex);
+	}
+	return result;
+}
+
+void FreeMemory(VkDevice device, VkDeviceMemory memory)
+{
+	if (memory == VK_NULL_HANDLE)
+	{
+		return;
+	}
+	MemoryTracker::GetInstance().RemoveDevice(memory);
+	vkFreeMemory(device, memory, nullptr);
+}
+
+void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, MemoryTag tag)
 {
 	VkBufferCreateInfo bufferInfo{};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -72,7 +92,7 @@ void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize
 	allocInfo.allocationSize = memRequirements.size;
 	allocInfo.memoryTypeIndex = FindMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties);
 
-	if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+	if (AllocateMemory(device, allocInfo, tag, bufferMemory) != VK_SUCCESS) {
 		throw std::runtime_error("failed to allocate buffer memory!");
 	}
 
@@ -162,7 +182,7 @@ void CreateDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout& descSetLa
 	pipelineLayoutInfo.pSetLayouts = &descSetLayout;
 }
 
-void transitionImageLayout(VkDevice device, VkCommandPool commandPool, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
+void transitionImageLayout(VkDevice device, VkCommandPool commandPool, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels, uint32_t layerCount) {
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
 
 	VkImageMemoryBarrier barrier{};
@@ -174,9 +194,9 @@ void transitionImageLayout(VkDevice device, VkCommandPool commandPool, VkImage i
 	barrier.image = image;
 	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.levelCount = mipLevels;
 	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.layerCount = layerCount;
 	barrier.srcAccessMask = 0; // TODO
 	barrier.dstAccessMask = 0; // TODO
 
@@ -20,6 +20,7 @@ const bool enableValidationLayers = true;
 
 #include <vector>
 #include <fstream>
+#include "MemoryTracker.h"
 
 
 
@@ -31,7 +32,11 @@ std::vector<char> readFile(const std::string& filename);
 
 uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
-void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+// Every device allocation goes through these two, so the MemoryTracker knows what each one is for
+VkResult AllocateMemory(VkDevice device, const VkMemoryAllocateInfo& allocInfo, MemoryTag tag, VkDeviceMemory& memory);
+void FreeMemory(VkDevice device, VkDeviceMemory memory);
+
+void CreateBuffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory, MemoryTag tag = MemoryTag::Other);
 
 VkCommandBuffer beginSingleTimeCommands(VkDevice device, VkCommandPool commandPool);
 void endSingleTimeCommands(VkDevice device, VkCommandPool commandPool, VkCommandBuffer commandBuffer);
@@ -40,7 +45,7 @@ void CopyBuffer(VkDevice device, VkCommandPool commandPool, VkBuffer srcBuffer,
 
 void CreateDescriptorSetLayout(VkDevice device, VkDescriptorSetLayout& descSetLayout);
 
-void transitionImageLayout(VkDevice device, VkCommandPool commandPool, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
+void transitionImageLayout(VkDevice device, VkCommandPool commandPool, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1, uint32_t layerCount = 1);
 void copyBufferToImage(VkDevice device, VkCommandPool commandPool, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
 VkFormat findSupportedFormat(VkDevice device, VkPhysicalDevice physicalDevice, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 bool hasStencilComponent(VkFormat format);